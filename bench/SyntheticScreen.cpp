@@ -0,0 +1,281 @@
+#include "SyntheticScreen.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// 字形：6x9 的点阵放在 8x16 的字符格里，近似等宽字体
+const int GLYPH_W = 6;
+const int GLYPH_H = 9;
+const int CELL_W = 8;
+const int CELL_H = 16;
+const int GLYPH_COUNT = 64;
+const int TASKBAR_H = 40;
+const int TITLE_BAR_H = 28;
+// 幻灯片切换间隔（帧）
+const int SLIDE_FRAMES = 60;
+const int SLIDE_COUNT = 4;
+// 光标闪烁 / 时钟刷新间隔（帧）
+const int CURSOR_BLINK_FRAMES = 15;
+const int CLOCK_FRAMES = 30;
+
+// 固定种子的 LCG，保证跨平台结果一致（不用 std::mt19937 的分布，实现可能不同）
+struct Lcg {
+    uint32_t state;
+    explicit Lcg(uint32_t seed) : state(seed) {}
+    uint32_t next() { state = state * 1664525u + 1013904223u; return state >> 8; }
+    int range(int lo, int hi) { return lo + static_cast<int>(next() % static_cast<uint32_t>(hi - lo + 1)); }
+};
+
+uint32_t hash3(uint32_t a, uint32_t b, uint32_t c) {
+    uint32_t h = a * 0x9E3779B1u ^ b * 0x85EBCA77u ^ c * 0xC2B2AE3Du;
+    h ^= h >> 15; h *= 0x2C1B3C6Du; h ^= h >> 12;
+    return h;
+}
+
+struct GlyphAtlas {
+    uint16_t rows[GLYPH_COUNT][GLYPH_H];
+    GlyphAtlas() {
+        Lcg rng(0x5EED);
+        for (auto& glyph : rows) {
+            for (auto& row : glyph) {
+                row = static_cast<uint16_t>(rng.next() & ((1u << GLYPH_W) - 1));
+            }
+        }
+    }
+};
+
+const GlyphAtlas& atlas() {
+    static const GlyphAtlas instance;
+    return instance;
+}
+
+void fillRect(uint8_t* bgrx, int stride, int width, int height, int x0, int y0, int x1, int y1, uint32_t color) {
+    x0 = std::max(0, x0); y0 = std::max(0, y0);
+    x1 = std::min(width, x1); y1 = std::min(height, y1);
+    for (int y = y0; y < y1; ++y) {
+        uint32_t* row = reinterpret_cast<uint32_t*>(bgrx + static_cast<size_t>(y) * stride);
+        std::fill(row + x0, row + x1, color);
+    }
+}
+
+// 画一个字形，scale 为放大倍数
+void drawGlyph(uint8_t* bgrx, int stride, int width, int height, int x, int y, int glyph, int scale, uint32_t color) {
+    const uint16_t* rows = atlas().rows[glyph % GLYPH_COUNT];
+    for (int gy = 0; gy < GLYPH_H; ++gy) {
+        for (int gx = 0; gx < GLYPH_W; ++gx) {
+            if (rows[gy] & (1u << gx)) {
+                fillRect(bgrx, stride, width, height, x + gx * scale, y + gy * scale,
+                    x + (gx + 1) * scale, y + (gy + 1) * scale, color);
+            }
+        }
+    }
+}
+
+// 一行伪文字：若干单词，单词之间一个空格
+void drawTextLine(uint8_t* bgrx, int stride, int width, int height, int x, int y, int maxWidth,
+    uint32_t seed, int scale, uint32_t color) {
+    Lcg rng(seed);
+    const int cellW = CELL_W * scale;
+    int cursor = 0;
+    const int lineChars = rng.range(maxWidth / cellW / 3, maxWidth / cellW);
+    while (cursor < lineChars) {
+        const int word = rng.range(2, 9);
+        for (int i = 0; i < word && cursor < lineChars; ++i, ++cursor) {
+            drawGlyph(bgrx, stride, width, height, x + cursor * cellW, y, static_cast<int>(rng.next()), scale, color);
+        }
+        ++cursor;
+    }
+}
+
+uint32_t bgrx(uint8_t r, uint8_t g, uint8_t b) {
+    return static_cast<uint32_t>(b) | (static_cast<uint32_t>(g) << 8) | (static_cast<uint32_t>(r) << 16) | 0xFF000000u;
+}
+
+uint8_t clampByte(int v) {
+    return static_cast<uint8_t>(std::min(255, std::max(0, v)));
+}
+
+} // namespace
+
+SyntheticScreen::SyntheticScreen(Kind kind, int width, int height)
+    : m_kind(kind), m_width(width), m_height(height)
+{
+    // 桌面：竖直渐变 + 任务栏
+    const int tightStride = width * 4;
+    m_desktop.resize(static_cast<size_t>(tightStride) * height);
+    for (int y = 0; y < height; ++y) {
+        uint32_t* row = reinterpret_cast<uint32_t*>(m_desktop.data() + static_cast<size_t>(y) * tightStride);
+        const uint32_t c = bgrx(static_cast<uint8_t>(20 + y * 40 / height), static_cast<uint8_t>(60 + y * 60 / height),
+            static_cast<uint8_t>(120 + y * 80 / height));
+        std::fill(row, row + width, c);
+    }
+    fillRect(m_desktop.data(), tightStride, width, height, 0, height - TASKBAR_H, width, height, bgrx(32, 32, 40));
+    for (int i = 0; i < 8; ++i) {
+        const int x = 12 + i * 48;
+        fillRect(m_desktop.data(), tightStride, width, height, x, height - TASKBAR_H + 6, x + 28, height - 6,
+            bgrx(static_cast<uint8_t>(80 + i * 20), 140, static_cast<uint8_t>(200 - i * 15)));
+    }
+
+    // 滚动文档：4 屏高的文字掩码，段落之间留空行，部分行缩进（类似代码）
+    const int textWidth = width * 8 / 10 - 2 * CELL_W;
+    m_documentHeight = std::max(CELL_H, height * 4 / CELL_H * CELL_H);
+    m_document.assign(static_cast<size_t>(width) * m_documentHeight, 0);
+    Lcg rng(0xD0C);
+    for (int line = 0; line * CELL_H < m_documentHeight; ++line) {
+        if (rng.range(0, 7) == 0) continue; // 空行
+        const int indent = rng.range(0, 3) * 4 * CELL_W;
+        Lcg lineRng(static_cast<uint32_t>(line) * 7919u + 17u);
+        const int lineChars = lineRng.range(5, std::max(6, (textWidth - indent) / CELL_W));
+        int cursor = 0;
+        while (cursor < lineChars) {
+            const int word = lineRng.range(2, 9);
+            for (int i = 0; i < word && cursor < lineChars; ++i, ++cursor) {
+                const uint16_t* rows = atlas().rows[lineRng.next() % GLYPH_COUNT];
+                const int gx0 = indent + cursor * CELL_W;
+                for (int gy = 0; gy < GLYPH_H; ++gy) {
+                    uint8_t* dst = m_document.data() + static_cast<size_t>(line * CELL_H + 3 + gy) * width;
+                    for (int gx = 0; gx < GLYPH_W && gx0 + gx < width; ++gx) {
+                        if (rows[gy] & (1u << gx)) dst[gx0 + gx] = 1;
+                    }
+                }
+            }
+            ++cursor;
+        }
+    }
+
+    // 幻灯片：标题 + 要点 + 柱状图，每页配色不同
+    if (kind == Kind::Slides) {
+        for (int s = 0; s < SLIDE_COUNT; ++s) {
+            std::vector<uint8_t> slide(m_desktop);
+            uint8_t* data = slide.data();
+            const int x0 = width / 16, x1 = width * 15 / 16;
+            const int y0 = height / 16, y1 = height - TASKBAR_H - height / 32;
+            const uint32_t bg = bgrx(static_cast<uint8_t>(240 - s * 30), static_cast<uint8_t>(240 - s * 10),
+                static_cast<uint8_t>(250 - s * 20));
+            fillRect(data, tightStride, width, height, x0, y0, x1, y1, bg);
+            const int scale = std::max(1, height / 360);
+            drawTextLine(data, tightStride, width, height, x0 + 40, y0 + 30, (x1 - x0) / 2,
+                static_cast<uint32_t>(s) * 101u + 1u, scale * 2, bgrx(20, 40, 90));
+            for (int b = 0; b < 5; ++b) {
+                const int by = y0 + 30 + (CELL_H * scale * 2) + 20 + b * CELL_H * scale * 2;
+                fillRect(data, tightStride, width, height, x0 + 40, by + 4, x0 + 40 + 6 * scale, by + 4 + 6 * scale,
+                    bgrx(200, 80, 40));
+                drawTextLine(data, tightStride, width, height, x0 + 40 + 12 * scale, by, (x1 - x0) / 2 - 60,
+                    static_cast<uint32_t>(s) * 1000u + static_cast<uint32_t>(b), scale, bgrx(30, 30, 30));
+            }
+            Lcg barRng(static_cast<uint32_t>(s) + 77u);
+            const int cx0 = (x0 + x1) / 2 + 40, cy1 = y1 - 40;
+            const int barW = (x1 - cx0 - 40) / 8;
+            for (int b = 0; b < 6; ++b) {
+                const int barH = barRng.range((y1 - y0) / 8, (y1 - y0) / 2);
+                fillRect(data, tightStride, width, height, cx0 + b * barW + barW / 4, cy1 - barH,
+                    cx0 + (b + 1) * barW - barW / 4, cy1, bgrx(static_cast<uint8_t>(60 + b * 30), 120, 200));
+            }
+            m_slides.push_back(std::move(slide));
+        }
+    }
+}
+
+const char* SyntheticScreen::kindName(Kind kind)
+{
+    switch (kind) {
+    case Kind::ScrollingText: return "scroll";
+    case Kind::Slides: return "slides";
+    case Kind::Video: return "video";
+    case Kind::Idle: return "idle";
+    }
+    return "?";
+}
+
+void SyntheticScreen::render(int frameIndex, uint8_t* out, int stride) const
+{
+    switch (m_kind) {
+    case Kind::ScrollingText: renderScrollingText(frameIndex, out, stride); break;
+    case Kind::Slides: renderSlide(frameIndex, out, stride); break;
+    case Kind::Video: renderVideo(frameIndex, out, stride); break;
+    case Kind::Idle: renderIdle(frameIndex, out, stride); break;
+    }
+}
+
+void SyntheticScreen::renderDesktop(uint8_t* out, int stride) const
+{
+    const size_t rowBytes = static_cast<size_t>(m_width) * 4;
+    for (int y = 0; y < m_height; ++y) {
+        std::memcpy(out + static_cast<size_t>(y) * stride, m_desktop.data() + y * rowBytes, rowBytes);
+    }
+}
+
+void SyntheticScreen::renderScrollingText(int frameIndex, uint8_t* out, int stride) const
+{
+    renderDesktop(out, stride);
+
+    // 编辑器窗口：标题栏 + 白底文字区，文档按固定速度向上滚动
+    const int x0 = m_width / 10, x1 = m_width * 9 / 10;
+    const int y0 = m_height / 12, y1 = m_height - TASKBAR_H - 8;
+    fillRect(out, stride, m_width, m_height, x0, y0, x1, y0 + TITLE_BAR_H, 0xFF505860u);
+    const int scrollPx = std::max(2, m_height / 180);
+    const int offset = frameIndex * scrollPx;
+    const uint32_t paper = 0xFFFDFDFDu, ink = 0xFF202020u;
+    for (int y = y0 + TITLE_BAR_H; y < y1; ++y) {
+        const int docY = (offset + y - y0 - TITLE_BAR_H) % m_documentHeight;
+        const uint8_t* mask = m_document.data() + static_cast<size_t>(docY) * m_width;
+        uint32_t* row = reinterpret_cast<uint32_t*>(out + static_cast<size_t>(y) * stride);
+        for (int x = x0; x < x1; ++x) {
+            row[x] = mask[x - x0 + CELL_W] ? ink : paper;
+        }
+    }
+}
+
+void SyntheticScreen::renderSlide(int frameIndex, uint8_t* out, int stride) const
+{
+    const std::vector<uint8_t>& slide = m_slides[(frameIndex / SLIDE_FRAMES) % m_slides.size()];
+    const size_t rowBytes = static_cast<size_t>(m_width) * 4;
+    for (int y = 0; y < m_height; ++y) {
+        std::memcpy(out + static_cast<size_t>(y) * stride, slide.data() + y * rowBytes, rowBytes);
+    }
+}
+
+void SyntheticScreen::renderVideo(int frameIndex, uint8_t* out, int stride) const
+{
+    renderDesktop(out, stride);
+
+    // 视频窗口占屏幕 60%，内容为随时间移动的等离子纹理 + 颗粒噪声，每帧所有像素都变化
+    const int vw = (m_width * 6 / 10) & ~1, vh = (m_height * 6 / 10) & ~1;
+    const int vx = (m_width - vw) / 2, vy = (m_height - vh) / 2;
+    const double t = frameIndex;
+    std::vector<int> sx(vw), sy(vh), sd(vw + vh);
+    for (int x = 0; x < vw; ++x) sx[x] = static_cast<int>(64 * std::sin(x * 0.021 + t * 0.11));
+    for (int y = 0; y < vh; ++y) sy[y] = static_cast<int>(64 * std::sin(y * 0.033 - t * 0.07));
+    for (int d = 0; d < vw + vh; ++d) sd[d] = static_cast<int>(48 * std::sin(d * 0.013 + t * 0.05));
+
+    for (int y = 0; y < vh; ++y) {
+        uint8_t* row = out + static_cast<size_t>(vy + y) * stride + static_cast<size_t>(vx) * 4;
+        for (int x = 0; x < vw; ++x) {
+            const int v = sx[x] + sy[y] + sd[x + y];
+            const int grain = static_cast<int>(hash3(static_cast<uint32_t>(x), static_cast<uint32_t>(y),
+                static_cast<uint32_t>(frameIndex)) & 15) - 8;
+            row[x * 4 + 0] = clampByte(128 + v + grain);
+            row[x * 4 + 1] = clampByte(110 + v / 2 + grain);
+            row[x * 4 + 2] = clampByte(140 - v + grain);
+            row[x * 4 + 3] = 0xFF;
+        }
+    }
+}
+
+void SyntheticScreen::renderIdle(int frameIndex, uint8_t* out, int stride) const
+{
+    // 静止的编辑器窗口（不滚动），只有光标闪烁和任务栏时钟变化
+    renderScrollingText(0, out, stride);
+
+    if ((frameIndex / CURSOR_BLINK_FRAMES) % 2 == 0) {
+        const int cx = m_width / 10 + 20 * CELL_W, cy = m_height / 12 + TITLE_BAR_H + 5 * CELL_H;
+        fillRect(out, stride, m_width, m_height, cx, cy, cx + 2, cy + CELL_H, 0xFF000000u);
+    }
+    const uint32_t seconds = static_cast<uint32_t>(frameIndex / CLOCK_FRAMES);
+    for (int i = 0; i < 5; ++i) {
+        drawGlyph(out, stride, m_width, m_height, m_width - 80 + i * CELL_W, m_height - TASKBAR_H + 14,
+            static_cast<int>(hash3(seconds, static_cast<uint32_t>(i), 0) % GLYPH_COUNT), 1, 0xFFE0E0E0u);
+    }
+}
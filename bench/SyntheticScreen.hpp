@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// 确定性的合成屏幕内容（BGRX），供基准程序在没有显示器的机器上驱动编码管线
+// 同一 kind / 尺寸 / 帧号总是生成完全相同的画面，不同机器、不同次运行之间结果可比
+// - ScrollingText：白底文档逐帧向上滚动（代码 / 网页阅读）
+// - Slides：静态幻灯片，每隔一段时间整页切换
+// - Video：桌面中央的视频窗口，每帧全部变化（带颗粒噪声）
+// - Idle：静止桌面，只有光标闪烁和右下角时钟偶尔变化
+class SyntheticScreen
+{
+public:
+    enum class Kind { ScrollingText, Slides, Video, Idle };
+
+    SyntheticScreen(Kind kind, int width, int height);
+
+    static const char* kindName(Kind kind);
+
+    // 生成第 frameIndex 帧，stride 为每行字节数（>= width * 4）
+    void render(int frameIndex, uint8_t* bgrx, int stride) const;
+
+    Kind kind() const { return m_kind; }
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+
+private:
+    void renderDesktop(uint8_t* bgrx, int stride) const;
+    void renderScrollingText(int frameIndex, uint8_t* bgrx, int stride) const;
+    void renderSlide(int frameIndex, uint8_t* bgrx, int stride) const;
+    void renderVideo(int frameIndex, uint8_t* bgrx, int stride) const;
+    void renderIdle(int frameIndex, uint8_t* bgrx, int stride) const;
+
+    Kind m_kind;
+    int m_width;
+    int m_height;
+    std::vector<uint8_t> m_desktop;      // 背景桌面（BGRX，紧密排列）
+    std::vector<uint8_t> m_document;     // 滚动文档的文字掩码，每像素 1 字节
+    int m_documentHeight = 0;
+    std::vector<std::vector<uint8_t>> m_slides; // 预先生成的幻灯片（BGRX，紧密排列）
+};
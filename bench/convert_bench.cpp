@@ -0,0 +1,210 @@
+// BGRA -> I420 转换基准
+// 1. 正确性：各指令集内核之间逐字节一致，并与 swscale 输出比较误差
+// 2. 吞吐：不同分辨率 / 指令集 / 线程数下的单帧耗时，对照 swscale (BICUBIC) 基线
+//
+// 用法: convert_bench [iterations]
+#include "src/encoder/ColorConverter.h"
+
+extern "C" {
+#include <libswscale/swscale.h>
+#include <libavutil/frame.h>
+}
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct Size { int w; int h; const char* name; };
+
+const Size SIZES[] = {
+    { 1280, 720, "720p" },
+    { 1920, 1080, "1080p" },
+    { 2560, 1440, "1440p" },
+    { 3840, 2160, "4K" },
+};
+
+// 平滑渐变 + 少量文字状的硬边，近似屏幕内容
+std::vector<uint8_t> makeScreen(int w, int h, bool noise) {
+    std::vector<uint8_t> img(static_cast<size_t>(w) * h * 4);
+    std::mt19937 rng(1234);
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            uint8_t* p = &img[(static_cast<size_t>(y) * w + x) * 4];
+            if (noise) {
+                uint32_t r = rng();
+                p[0] = r & 0xFF; p[1] = (r >> 8) & 0xFF; p[2] = (r >> 16) & 0xFF;
+            }
+            else {
+                p[0] = static_cast<uint8_t>(x * 255 / w);
+                p[1] = static_cast<uint8_t>(y * 255 / h);
+                p[2] = static_cast<uint8_t>((x + y) * 255 / (w + h));
+            }
+            p[3] = 0xFF;
+        }
+    }
+    return img;
+}
+
+struct Planes {
+    AVFrame* frame = nullptr;
+    Planes(int w, int h) {
+        frame = av_frame_alloc();
+        frame->format = AV_PIX_FMT_YUV420P;
+        frame->width = w;
+        frame->height = h;
+        av_frame_get_buffer(frame, 32);
+    }
+    ~Planes() { av_frame_free(&frame); }
+};
+
+double nowMs() {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+bool samePlanes(const AVFrame* a, const AVFrame* b) {
+    for (int p = 0; p < 3; ++p) {
+        int pw = p ? a->width / 2 : a->width;
+        int ph = p ? a->height / 2 : a->height;
+        for (int y = 0; y < ph; ++y) {
+            if (!std::equal(a->data[p] + y * a->linesize[p], a->data[p] + y * a->linesize[p] + pw,
+                b->data[p] + y * b->linesize[p])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void diffPlane(const AVFrame* a, const AVFrame* b, int p, int& maxDiff, double& meanDiff) {
+    int pw = p ? a->width / 2 : a->width;
+    int ph = p ? a->height / 2 : a->height;
+    long long sum = 0;
+    maxDiff = 0;
+    for (int y = 0; y < ph; ++y) {
+        for (int x = 0; x < pw; ++x) {
+            int d = std::abs(a->data[p][y * a->linesize[p] + x] - b->data[p][y * b->linesize[p] + x]);
+            sum += d;
+            maxDiff = std::max(maxDiff, d);
+        }
+    }
+    meanDiff = static_cast<double>(sum) / (static_cast<double>(pw) * ph);
+}
+
+void convert(ColorConverter& cc, const std::vector<uint8_t>& img, int w, int h, AVFrame* out) {
+    cc.convertBgra(img.data(), w * 4, w, h, out->data, out->linesize, ColorConverter::OutputFormat::I420);
+}
+
+bool checkCorrectness() {
+    bool ok = true;
+    const ColorConverter::Isa isas[] = { ColorConverter::Isa::Scalar, ColorConverter::Isa::SSE2, ColorConverter::Isa::AVX2 };
+
+    // 宽度刻意取非 32 对齐，覆盖 SIMD 尾部处理
+    const int w = 1918, h = 1078;
+    for (bool noise : { false, true }) {
+        std::vector<uint8_t> img = makeScreen(w, h, noise);
+
+        Planes ref(w, h);
+        ColorConverter scalar(1);
+        scalar.setIsa(ColorConverter::Isa::Scalar);
+        convert(scalar, img, w, h, ref.frame);
+
+        for (ColorConverter::Isa isa : isas) {
+            ColorConverter cc(4);
+            cc.setIsa(isa);
+            Planes out(w, h);
+            convert(cc, img, w, h, out.frame);
+            bool same = samePlanes(ref.frame, out.frame);
+            std::printf("[check] %-6s %-8s bit-exact vs scalar: %s\n",
+                ColorConverter::isaName(cc.isa()), noise ? "noise" : "gradient", same ? "yes" : "NO");
+            ok = ok && same;
+        }
+
+        // swscale 的色度滤波与 2x2 平均不同，噪声图没有可比性，只比较平滑内容
+        if (noise) continue;
+        SwsContext* sws = sws_getContext(w, h, AV_PIX_FMT_BGRA, w, h, AV_PIX_FMT_YUV420P,
+            SWS_BILINEAR | SWS_ACCURATE_RND, nullptr, nullptr, nullptr);
+        Planes swsOut(w, h);
+        const uint8_t* srcData[4] = { img.data() };
+        int srcLinesize[4] = { w * 4 };
+        sws_scale(sws, srcData, srcLinesize, 0, h, swsOut.frame->data, swsOut.frame->linesize);
+        sws_freeContext(sws);
+
+        const char* names[3] = { "Y", "U", "V" };
+        for (int p = 0; p < 3; ++p) {
+            int maxDiff = 0;
+            double meanDiff = 0.0;
+            diffPlane(ref.frame, swsOut.frame, p, maxDiff, meanDiff);
+            bool planeOk = maxDiff <= 2 && meanDiff <= 1.0;
+            std::printf("[check] vs swscale plane %s: max %d, mean %.3f %s\n",
+                names[p], maxDiff, meanDiff, planeOk ? "" : "(FAIL)");
+            ok = ok && planeOk;
+        }
+    }
+    return ok;
+}
+
+void runThroughput(int iterations) {
+    std::printf("\n%-6s %-7s %-8s %12s %12s\n", "size", "isa", "threads", "ms/frame", "Mpix/s");
+    const ColorConverter::Isa isas[] = { ColorConverter::Isa::Scalar, ColorConverter::Isa::SSE2, ColorConverter::Isa::AVX2 };
+
+    for (const Size& s : SIZES) {
+        std::vector<uint8_t> img = makeScreen(s.w, s.h, false);
+        Planes out(s.w, s.h);
+        const double mpix = static_cast<double>(s.w) * s.h / 1e6;
+
+        for (ColorConverter::Isa isa : isas) {
+            for (int threads : { 1, 2, 4 }) {
+                ColorConverter cc(threads);
+                cc.setIsa(isa);
+                if (cc.isa() != isa) continue; // CPU 不支持
+                convert(cc, img, s.w, s.h, out.frame); // 预热
+                double t0 = nowMs();
+                for (int i = 0; i < iterations; ++i) convert(cc, img, s.w, s.h, out.frame);
+                double ms = (nowMs() - t0) / iterations;
+                std::printf("%-6s %-7s %-8d %12.3f %12.1f\n", s.name, ColorConverter::isaName(isa), threads, ms, mpix / ms * 1000.0);
+            }
+        }
+
+        // 基线：原编码路径使用的 swscale BICUBIC（同尺寸 / 缩放到 640x360）
+        const int dstSizes[2][2] = { { s.w, s.h }, { 640, 360 } };
+        for (const auto& d : dstSizes) {
+            SwsContext* sws = sws_getContext(s.w, s.h, AV_PIX_FMT_BGRA, d[0], d[1], AV_PIX_FMT_YUV420P,
+                SWS_BICUBIC, nullptr, nullptr, nullptr);
+            Planes swsOut(d[0], d[1]);
+            const uint8_t* srcData[4] = { img.data() };
+            int srcLinesize[4] = { s.w * 4 };
+            sws_scale(sws, srcData, srcLinesize, 0, s.h, swsOut.frame->data, swsOut.frame->linesize);
+            double t0 = nowMs();
+            for (int i = 0; i < iterations; ++i) {
+                sws_scale(sws, srcData, srcLinesize, 0, s.h, swsOut.frame->data, swsOut.frame->linesize);
+            }
+            double ms = (nowMs() - t0) / iterations;
+            std::printf("%-6s %-7s %-8s %12.3f %12.1f   (-> %dx%d)\n", s.name, "sws", "1", ms, mpix / ms * 1000.0, d[0], d[1]);
+            sws_freeContext(sws);
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 50;
+    std::printf("Detected ISA: %s\n", ColorConverter::isaName(ColorConverter::detectIsa()));
+
+    bool ok = checkCorrectness();
+    runThroughput(iterations);
+
+    if (!ok) {
+        std::printf("\nCorrectness check FAILED\n");
+        return 1;
+    }
+    return 0;
+}
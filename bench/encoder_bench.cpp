@@ -0,0 +1,326 @@
+// 编码器基准：用确定性的合成屏幕内容驱动 VideoEncoder（颜色转换 + 编码），不需要界面、采集和对端
+// 1. 内容：滚动文字 / 幻灯片切换 / 视频 / 静止桌面
+// 2. 参数扫描：以 H.264 / 1080p / ultrafast / 自动线程 / 4Mbps / intra-refresh 为基线，每次只改变一个维度
+//    （分辨率、preset、线程数、码率、关键帧策略、编码格式）；--full 时对分辨率、preset、线程数、码率做全组合
+//    其它编码格式使用各自后端的默认 preset，同一码率下比较每帧字节数 / 耗时
+// 3. 指标：颜色转换与编码耗时的 p50/p90/p99、可达帧率、平均/最大帧字节数、码率、峰值 RSS
+// 每次运行都校验编码器有输出且首帧为关键帧（x264 须每帧都有输出），失败时返回非 0
+//
+// 用法: encoder_bench [frames] [--full] [--csv file]
+#include "src/encoder/VideoEncoder.h"
+#include "bench/SyntheticScreen.hpp"
+
+#include <QDebug>
+#include <QVideoFrame>
+#include <QVideoFrameFormat>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+struct Size { int w; int h; const char* name; };
+
+const Size SIZES[] = {
+    { 1280, 720, "720p" },
+    { 1920, 1080, "1080p" },
+    { 2560, 1440, "1440p" },
+    { 3840, 2160, "4K" },
+};
+const char* PRESETS[] = { "ultrafast", "superfast", "veryfast", "faster" };
+const int THREADS[] = { 0, 1, 2, 4 };
+const int BITRATES[] = { 1000000, 4000000, 8000000 };
+const SyntheticScreen::Kind CONTENTS[] = {
+    SyntheticScreen::Kind::ScrollingText, SyntheticScreen::Kind::Slides,
+    SyntheticScreen::Kind::Video, SyntheticScreen::Kind::Idle,
+};
+// 合成内容的名义帧率，决定采集时间戳与码率换算
+const int CONTENT_FPS = 30;
+
+struct RunConfig {
+    SyntheticScreen::Kind content = SyntheticScreen::Kind::ScrollingText;
+    VideoCodec codec = VideoCodec::H264;
+    Size size = SIZES[1];
+    const char* preset = "ultrafast";
+    int threads = 0;
+    int bitrate = 4000000;
+    VideoEncoder::KeyframeMode mode = VideoEncoder::KeyframeMode::IntraRefresh;
+};
+
+struct RunResult {
+    std::vector<double> convertMs;
+    std::vector<double> encodeMs;
+    double totalMs = 0.0;
+    long long bytes = 0;
+    long long maxFrameBytes = 0;
+    int packets = 0;
+    int keyframes = 0;
+    bool firstIsKey = false;
+    double peakRssMb = 0.0;
+};
+
+const char* modeName(VideoEncoder::KeyframeMode mode) {
+    switch (mode) {
+    case VideoEncoder::KeyframeMode::Periodic: return "periodic";
+    case VideoEncoder::KeyframeMode::OnDemand: return "ondemand";
+    case VideoEncoder::KeyframeMode::IntraRefresh: return "refresh";
+    }
+    return "?";
+}
+
+// 每次运行前清零峰值 RSS（Linux 4.0+ 支持写 5 到 clear_refs），否则只能得到进程生命周期内的峰值
+void resetPeakRss() {
+#ifdef __linux__
+    if (FILE* f = std::fopen("/proc/self/clear_refs", "w")) {
+        std::fputs("5", f);
+        std::fclose(f);
+    }
+#endif
+}
+
+double peakRssMb() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
+        return pmc.PeakWorkingSetSize / (1024.0 * 1024.0);
+    }
+    return 0.0;
+#elif defined(__linux__)
+    if (FILE* f = std::fopen("/proc/self/status", "r")) {
+        char line[256];
+        while (std::fgets(line, sizeof(line), f)) {
+            long kb = 0;
+            if (std::sscanf(line, "VmHWM: %ld kB", &kb) == 1) {
+                std::fclose(f);
+                return kb / 1024.0;
+            }
+        }
+        std::fclose(f);
+    }
+    return 0.0;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / (1024.0 * 1024.0); // macOS 单位为字节
+#endif
+}
+
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    const size_t index = std::min(values.size() - 1, static_cast<size_t>(p * (values.size() - 1) + 0.5));
+    return values[index];
+}
+
+double nowMs() {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+bool runOnce(const RunConfig& config, int frames, RunResult& result) {
+    resetPeakRss();
+
+    VideoEncoder encoder;
+    encoder.setCodec(config.codec);
+    encoder.setPreset(config.preset);
+    encoder.setThreadCount(config.threads);
+    encoder.setKeyframeMode(config.mode);
+    if (!encoder.init(config.size.w, config.size.h, CONTENT_FPS, config.bitrate)) {
+        std::printf("encoder init failed: %s %s %s\n", videoCodecName(config.codec), config.size.name, config.preset);
+        return false;
+    }
+    encoder.onEncodedData = [&result](EncodedFrame::Ptr frame) {
+        if (result.packets == 0) result.firstIsKey = frame->isKeyFrame();
+        ++result.packets;
+        if (frame->isKeyFrame()) ++result.keyframes;
+        result.bytes += frame->size();
+        result.maxFrameBytes = std::max<long long>(result.maxFrameBytes, frame->size());
+    };
+
+    // 画面生成不计入耗时：同一个 QVideoFrame 每帧重写后交给编码器
+    SyntheticScreen screen(config.content, config.size.w, config.size.h);
+    QVideoFrame frame(QVideoFrameFormat(QSize(config.size.w, config.size.h), QVideoFrameFormat::Format_BGRX8888));
+    result.convertMs.reserve(frames);
+    result.encodeMs.reserve(frames);
+
+    for (int i = 0; i < frames; ++i) {
+        if (!frame.map(QVideoFrame::WriteOnly)) {
+            std::printf("map frame failed\n");
+            return false;
+        }
+        screen.render(i, frame.bits(0), frame.bytesPerLine(0));
+        frame.unmap();
+
+        FrameMeta meta;
+        meta.frameId = static_cast<quint64>(i);
+        meta.captureTimeUs = static_cast<qint64>(i) * 1000000 / CONTENT_FPS;
+
+        const double t0 = nowMs();
+        encoder.encode(frame, meta);
+        result.totalMs += nowMs() - t0;
+        result.convertMs.push_back(encoder.lastConvertUs() / 1000.0);
+        result.encodeMs.push_back(encoder.lastEncodeUs() / 1000.0);
+    }
+    result.peakRssMb = peakRssMb();
+    return true;
+}
+
+FILE* g_csv = nullptr;
+
+bool report(const RunConfig& config, int frames) {
+    RunResult r;
+    if (!runOnce(config, frames, r)) return false;
+
+    const double fps = r.totalMs > 0.0 ? frames * 1000.0 / r.totalMs : 0.0;
+    const double bytesPerFrame = r.packets ? static_cast<double>(r.bytes) / r.packets : 0.0;
+    const double kbps = bytesPerFrame * 8.0 * CONTENT_FPS / 1000.0;
+    const char* preset = *config.preset ? config.preset : "default";
+    std::printf("%-7s %-5s %-6s %-10s %3d %5.1f %-9s | %6.2f %6.2f %6.2f | %6.2f %6.2f %6.2f | %7.1f | %8.0f %8lld %7.0f | %7.1f\n",
+        SyntheticScreen::kindName(config.content), videoCodecName(config.codec), config.size.name, preset, config.threads,
+        config.bitrate / 1e6, modeName(config.mode),
+        percentile(r.convertMs, 0.5), percentile(r.convertMs, 0.9), percentile(r.convertMs, 0.99),
+        percentile(r.encodeMs, 0.5), percentile(r.encodeMs, 0.9), percentile(r.encodeMs, 0.99),
+        fps, bytesPerFrame, r.maxFrameBytes, kbps, r.peakRssMb);
+    std::fflush(stdout);
+
+    if (g_csv) {
+        std::fprintf(g_csv, "%s,%s,%s,%s,%d,%d,%s,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.2f,%.1f,%lld,%.1f,%d,%.1f\n",
+            SyntheticScreen::kindName(config.content), videoCodecName(config.codec), config.size.name, preset, config.threads,
+            config.bitrate, modeName(config.mode),
+            percentile(r.convertMs, 0.5), percentile(r.convertMs, 0.9), percentile(r.convertMs, 0.99),
+            percentile(r.encodeMs, 0.5), percentile(r.encodeMs, 0.9), percentile(r.encodeMs, 0.99),
+            fps, bytesPerFrame, r.maxFrameBytes, kbps, r.keyframes, r.peakRssMb);
+    }
+
+    // x264 zerolatency 没有帧延迟：每送入一帧就应输出一帧；其它编码器允许少量内部缓冲
+    // 首帧必须是关键帧
+    const bool countOk = config.codec == VideoCodec::H264 ? r.packets == frames : (r.packets > 0 && r.packets <= frames);
+    const bool ok = countOk && r.firstIsKey;
+    if (!ok) {
+        std::printf("[check] FAILED: %d packets for %d frames, first keyframe %s\n",
+            r.packets, frames, r.firstIsKey ? "yes" : "no");
+    }
+    return ok;
+}
+
+void printHeader() {
+    std::printf("%-7s %-5s %-6s %-10s %3s %5s %-9s | %-20s | %-20s | %7s | %8s %8s %7s | %7s\n",
+        "content", "codec", "size", "preset", "thr", "Mbps", "keyframe",
+        "convert ms p50/90/99", "encode ms p50/90/99", "fps", "B/frame", "max B", "kbps", "RSS MB");
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    int frames = 150;
+    bool full = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--full") == 0) {
+            full = true;
+        }
+        else if (std::strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+            g_csv = std::fopen(argv[++i], "w");
+        }
+        else {
+            frames = std::max(1, std::atoi(argv[i]));
+        }
+    }
+    // 编码器的初始化日志对基准输出没有意义
+    qInstallMessageHandler([](QtMsgType type, const QMessageLogContext&, const QString& msg) {
+        if (type != QtDebugMsg && type != QtInfoMsg) std::fprintf(stderr, "%s\n", qPrintable(msg));
+    });
+    if (g_csv) {
+        std::fprintf(g_csv, "content,codec,size,preset,threads,bitrate,keyframe,convert_p50_ms,convert_p90_ms,convert_p99_ms,"
+            "encode_p50_ms,encode_p90_ms,encode_p99_ms,fps,bytes_per_frame,max_frame_bytes,kbps,keyframes,peak_rss_mb\n");
+    }
+
+    const QList<VideoCodec> codecs = VideoEncoder::availableCodecs();
+    std::printf("%d frames per run at %d fps nominal, codecs:", frames, CONTENT_FPS);
+    for (VideoCodec codec : codecs) std::printf(" %s", videoCodecName(codec));
+    std::printf("\n\n");
+    printHeader();
+
+    bool ok = true;
+    for (SyntheticScreen::Kind content : CONTENTS) {
+        RunConfig base;
+        base.content = content;
+
+        if (full) {
+            for (const Size& size : SIZES) {
+                for (const char* preset : PRESETS) {
+                    for (int threads : THREADS) {
+                        for (int bitrate : BITRATES) {
+                            RunConfig config = base;
+                            config.size = size;
+                            config.preset = preset;
+                            config.threads = threads;
+                            config.bitrate = bitrate;
+                            ok = report(config, frames) && ok;
+                        }
+                    }
+                }
+            }
+            continue;
+        }
+
+        // 基线 + 逐个维度变化
+        ok = report(base, frames) && ok;
+        for (const Size& size : SIZES) {
+            if (size.w == base.size.w) continue;
+            RunConfig config = base;
+            config.size = size;
+            ok = report(config, frames) && ok;
+        }
+        for (const char* preset : PRESETS) {
+            if (std::strcmp(preset, base.preset) == 0) continue;
+            RunConfig config = base;
+            config.preset = preset;
+            ok = report(config, frames) && ok;
+        }
+        for (int threads : THREADS) {
+            if (threads == base.threads) continue;
+            RunConfig config = base;
+            config.threads = threads;
+            ok = report(config, frames) && ok;
+        }
+        for (int bitrate : BITRATES) {
+            if (bitrate == base.bitrate) continue;
+            RunConfig config = base;
+            config.bitrate = bitrate;
+            ok = report(config, frames) && ok;
+        }
+        for (VideoEncoder::KeyframeMode mode : { VideoEncoder::KeyframeMode::Periodic, VideoEncoder::KeyframeMode::OnDemand }) {
+            RunConfig config = base;
+            config.mode = mode;
+            ok = report(config, frames) && ok;
+        }
+        for (VideoCodec codec : codecs) {
+            if (codec == base.codec) continue;
+            RunConfig config = base;
+            config.codec = codec;
+            config.preset = "";
+            ok = report(config, frames) && ok;
+        }
+        std::printf("\n");
+    }
+
+    if (g_csv) std::fclose(g_csv);
+    if (!ok) {
+        std::printf("Encoder check FAILED\n");
+        return 1;
+    }
+    return 0;
+}
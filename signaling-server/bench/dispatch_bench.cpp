@@ -0,0 +1,177 @@
+// Dispatch benchmark: shared task queue vs. per-client sharded queues in WorkerPool
+//
+// Tasks go through WorkerPool::submitTask() from one thread, like one of SignalingServer's I/O
+// threads does. Each simulated client sends a numbered stream of messages; REGISTER_REQUEST
+// costs more than OFFER/ANSWER/ICE, since the real handler builds a peer list and broadcasts.
+// No message type is stealable (see is_stateless_stype()), so like SignalingServer the pool
+// is started without a stealing predicate and sharded mode keeps every client's messages in order.
+//
+// 1. uniform  all clients send at the same rate
+// 2. skewed   a few hot clients send half of all messages, so their shards get more work
+//
+// Reported per run: messages/s, the share of messages a worker saw after a later message of
+// the same client, and the busiest worker's load over the average.
+//
+// Usage: dispatch_bench [messages]   (default: 200000)
+#include "src/Worker.h"
+
+#include <QCoreApplication>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int CLIENTS = 1000;
+const int HOT_CLIENTS = 10;
+const int REGISTER_EVERY = 10;          // one message in ten is a register request
+const qint64 RELAY_WORK_NS = 2000;
+const qint64 REGISTER_WORK_NS = 20000;
+const int WORKER_COUNTS[] = { 2, 4, 8 };
+
+using Clock = std::chrono::steady_clock;
+
+const QString REGISTER_PAYLOAD = QStringLiteral("{\"type\":\"REGISTER_REQUEST\"}");
+const QString ICE_PAYLOAD = QStringLiteral(
+    "{\"type\":\"ICE\",\"to\":\"peer\",\"data\":{\"candidate\":\"candidate:1 1 udp 2122260223 192.168.1.2 54321 typ host\","
+    "\"sdpMid\":\"0\",\"sdpMLineIndex\":0}}");
+
+void busyWait(qint64 ns)
+{
+    const auto until = Clock::now() + std::chrono::nanoseconds(ns);
+    while (Clock::now() < until) {}
+}
+
+struct Message {
+    int client;
+    qint64 seq;
+    bool registers;
+};
+
+// The message stream, generated up front so the submitting thread only submits
+std::vector<Message> makeStream(int total, bool skewed)
+{
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> anyClient(0, CLIENTS - 1);
+    std::uniform_int_distribution<int> hotClient(0, HOT_CLIENTS - 1);
+    std::vector<qint64> next(CLIENTS, 0);
+    std::vector<Message> stream;
+    stream.reserve(total);
+    for (int i = 0; i < total; ++i) {
+        const int client = skewed && (i & 1) ? hotClient(rng) : anyClient(rng);
+        const qint64 seq = next[client]++;
+        stream.push_back({ client, seq, seq % REGISTER_EVERY == 0 });
+    }
+    return stream;
+}
+
+struct Result {
+    double messagesPerSecond = 0;
+    double reorderedPercent = 0;
+    double maxLoad = 0;
+};
+
+Result run(DispatchMode mode, QueueType queueType, int workers, const std::vector<Message>& stream)
+{
+    QVector<QString> ids;
+    QHash<QString, int> indexOf;
+    for (int i = 0; i < CLIENTS; ++i) {
+        ids.append(QStringLiteral("client-%1").arg(i));
+        indexOf.insert(ids.back(), i);
+    }
+
+    // Largest sequence number processed so far, per client
+    std::unique_ptr<std::atomic<qint64>[]> lastSeq(new std::atomic<qint64>[CLIENTS]);
+    for (int i = 0; i < CLIENTS; ++i) lastSeq[i].store(-1);
+    std::unique_ptr<std::atomic<quint64>[]> perWorker(new std::atomic<quint64>[workers]);
+    for (int i = 0; i < workers; ++i) perWorker[i].store(0);
+    std::atomic<quint64> processed{ 0 };
+    std::atomic<quint64> reordered{ 0 };
+    std::atomic<qint64> finishedNs{ 0 };
+    const quint64 total = stream.size();
+    const Clock::time_point start = Clock::now();
+
+    // The bench reuses _timestamp as the per-client sequence number
+    auto processor = [&](const SignalingTask& task, Worker* source) {
+        const int client = indexOf.value(task._clientId);
+        const bool registers = task._payload.size() < ICE_PAYLOAD.size();
+        busyWait(registers ? REGISTER_WORK_NS : RELAY_WORK_NS);
+
+        qint64 seen = lastSeq[client].load(std::memory_order_relaxed);
+        while (seen < task._timestamp && !lastSeq[client].compare_exchange_weak(seen, task._timestamp)) {}
+        if (seen > task._timestamp) reordered.fetch_add(1, std::memory_order_relaxed);
+        perWorker[source->getId() - 1].fetch_add(1, std::memory_order_relaxed);
+        if (processed.fetch_add(1, std::memory_order_relaxed) + 1 == total) {
+            finishedNs.store(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+        }
+    };
+
+    WorkerPool pool;
+    pool.start(workers, processor, queueType, mode);
+    for (const Message& message : stream) {
+        SignalingTask task(ids[message.client], message.registers ? REGISTER_PAYLOAD : ICE_PAYLOAD);
+        task._timestamp = message.seq;
+        pool.submitTask(task);
+    }
+    while (processed.load() < total) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    pool.stop();
+
+    quint64 busiest = 0;
+    for (int i = 0; i < workers; ++i) busiest = std::max<quint64>(busiest, perWorker[i].load());
+
+    Result result;
+    result.messagesPerSecond = total / (finishedNs.load() / 1e9);
+    result.reorderedPercent = 100.0 * reordered.load() / total;
+    result.maxLoad = busiest / (static_cast<double>(total) / workers);
+    return result;
+}
+
+void printHeader(const char* title)
+{
+    std::printf("\n%s\n%-8s %-9s %8s %12s %12s %10s\n", title, "mode", "queue", "workers", "msgs/s",
+        "reordered %", "max load");
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    // Worker start/exit lines would drown the table
+    qInstallMessageHandler([](QtMsgType type, const QMessageLogContext&, const QString& msg) {
+        if (type != QtDebugMsg && type != QtInfoMsg) std::fprintf(stderr, "%s\n", qPrintable(msg));
+    });
+
+    const int messages = argc > 1 ? std::max(1, std::atoi(argv[1])) : 200000;
+    const DispatchMode modes[] = { DispatchMode::Shared, DispatchMode::Sharded };
+    const QueueType queueTypes[] = { QueueType::Blocking, QueueType::Ring };
+
+    std::printf("Hardware threads: %u, %d clients, 1/%d register (%lld us), relay %lld us\n",
+        std::thread::hardware_concurrency(), CLIENTS, REGISTER_EVERY,
+        static_cast<long long>(REGISTER_WORK_NS / 1000), static_cast<long long>(RELAY_WORK_NS / 1000));
+
+    for (bool skewed : { false, true }) {
+        const std::vector<Message> stream = makeStream(messages, skewed);
+        printHeader(skewed ? "== skewed (10 hot clients send half of the messages) ==" : "== uniform ==");
+        for (int workers : WORKER_COUNTS) {
+            for (DispatchMode mode : modes) {
+                for (QueueType queueType : queueTypes) {
+                    const Result r = run(mode, queueType, workers, stream);
+                    std::printf("%-8s %-9s %8d %12.0f %12.3f %10.2f\n",
+                        mode == DispatchMode::Sharded ? "sharded" : "shared",
+                        queueType == QueueType::Ring ? "ring" : "blocking", workers,
+                        r.messagesPerSecond, r.reorderedPercent, r.maxLoad);
+                }
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,633 @@
+#include "LoadGenerator.h"
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMetaObject>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+namespace {
+
+const int PACE_INTERVAL_MS = 5;
+const int TRAFFIC_INTERVAL_MS = 10;
+const int POLL_INTERVAL_MS = 10;
+const double CONNECT_GRACE_SECONDS = 30;    // on top of clients / connectRate
+const double SETTLE_SECONDS = 1;            // for the last forwards and presence notices
+
+const char* const LATENCY_NAMES[LatencyKindCount] = { "connect", "register", "offer", "answer", "ice" };
+
+const QString ICE_FIELDS = QStringLiteral(
+    ",\"candidate\":\"candidate:1 1 udp 2122260223 127.0.0.1 54321 typ host\",\"sdpMid\":\"0\",\"sdpMLineIndex\":0");
+
+// Resident set size of a process in KB, or -1 where /proc is not available
+qint64 readRssKb(qint64 pid)
+{
+    QFile status(QStringLiteral("/proc/%1/status").arg(pid));
+    if (!status.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return -1;
+    }
+    while (!status.atEnd()) {
+        const QByteArray line = status.readLine();
+        if (line.startsWith("VmRSS:")) {
+            return line.mid(6).trimmed().split(' ').first().toLongLong();
+        }
+    }
+    return -1;
+}
+
+double percentileMs(const std::vector<qint64>& sorted, double q)
+{
+    if (sorted.empty()) return 0;
+    const size_t index = std::min(sorted.size() - 1, static_cast<size_t>(q * sorted.size()));
+    return sorted[index] / 1e6;
+}
+
+} // namespace
+
+qint64 loadNowNs()
+{
+    static const auto origin = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+// LoadStats >>>>>>>>>>>>>>>>>
+
+void LoadStats::merge(const LoadStats& other)
+{
+    for (int i = 0; i < LatencyKindCount; ++i) {
+        latencies[i].insert(latencies[i].end(), other.latencies[i].begin(), other.latencies[i].end());
+    }
+    peerJoined += other.peerJoined;
+    peerLeft += other.peerLeft;
+    notOnline += other.notOnline;
+    serverErrors += other.serverErrors;
+    socketErrors += other.socketErrors;
+    connectFailures += other.connectFailures;
+    dropped += other.dropped;
+    malformed += other.malformed;
+}
+
+// PeerDirectory >>>>>>>>>>>>>>>>>
+
+void PeerDirectory::add(const QString& id, const QString& room)
+{
+    QWriteLocker guard(&_lock);
+    if (_roomOf.contains(id)) return;
+    _roomOf.insert(id, room);
+    Room& members = _rooms[room];
+    members.index.insert(id, members.ids.size());
+    members.ids.append(id);
+}
+
+void PeerDirectory::remove(const QString& id)
+{
+    QWriteLocker guard(&_lock);
+    auto owner = _roomOf.find(id);
+    if (owner == _roomOf.end()) return;
+    auto room = _rooms.find(owner.value());
+    _roomOf.erase(owner);
+
+    Room& members = room.value();
+    const int position = members.index.take(id);
+    const QString last = members.ids.takeLast();
+    if (position < members.ids.size()) {
+        members.ids[position] = last;
+        members.index[last] = position;
+    }
+    if (members.ids.isEmpty()) {
+        _rooms.erase(room);
+    }
+}
+
+QString PeerDirectory::pick(const QString& exclude, const QString& room, quint32 random) const
+{
+    QReadLocker guard(&_lock);
+    auto it = _rooms.constFind(room);
+    if (it == _rooms.cend()) return QString();
+    const QVector<QString>& ids = it.value().ids;
+    const int count = ids.size();
+    if (count == 0 || (count == 1 && ids[0] == exclude)) return QString();
+    int position = static_cast<int>(random % static_cast<quint32>(count));
+    if (ids[position] == exclude) position = (position + 1) % count;
+    return ids[position];
+}
+
+int PeerDirectory::size() const
+{
+    QReadLocker guard(&_lock);
+    return _roomOf.size();
+}
+
+// LoadClient >>>>>>>>>>>>>>>>>
+
+LoadClient::LoadClient(ClientGroup* group, const QString& room)
+    : QObject(group), _group(group), _socket(new QWebSocket(QString(), QWebSocketProtocol::VersionLatest, this)),
+    _room(room)
+{
+    connect(_socket, &QWebSocket::connected, this, &LoadClient::onConnected);
+    connect(_socket, &QWebSocket::disconnected, this, &LoadClient::onDisconnected);
+    connect(_socket, &QWebSocket::textMessageReceived, this, &LoadClient::onTextMessageReceived);
+    connect(_socket, &QWebSocket::errorOccurred, this, &LoadClient::onErrorOccurred);
+}
+
+void LoadClient::open(const QUrl& url)
+{
+    _openNs = loadNowNs();
+    _socket->open(url);
+}
+
+void LoadClient::close()
+{
+    _closing = true;
+    _socket->close();
+}
+
+void LoadClient::sendOffer(const QString& target)
+{
+    sendRelay(QLatin1String("OFFER"), target, QStringLiteral(",\"sdp\":\"%1\"").arg(_group->sdp()));
+}
+
+void LoadClient::onConnected()
+{
+    _connected = true;
+    _group->clientConnected(this, loadNowNs() - _openNs);
+
+    _registerNs = loadNowNs();
+    if (_room.isEmpty()) {
+        _socket->sendTextMessage(QStringLiteral("{\"type\":\"REGISTER_REQUEST\",\"to\":\"Server\",\"data\":{\"device\":\"LoadClient\"}}"));
+    }
+    else {
+        _socket->sendTextMessage(QStringLiteral("{\"type\":\"REGISTER_REQUEST\",\"to\":\"Server\",\"data\":{\"device\":\"LoadClient\",\"room\":\"%1\"}}").arg(_room));
+    }
+    _group->messageSent();
+}
+
+void LoadClient::onDisconnected()
+{
+    if (!_closing && _connected) {
+        _group->stats().dropped++;
+    }
+    finish();
+}
+
+void LoadClient::onErrorOccurred(QAbstractSocket::SocketError error)
+{
+    Q_UNUSED(error);
+    if (_closing) return;
+    _group->stats().socketErrors++;
+    // A failed connect never emits disconnected()
+    if (!_connected) {
+        finish();
+    }
+}
+
+void LoadClient::finish()
+{
+    if (_done) return;
+    _done = true;
+    _group->clientClosed(this, _connected);
+    deleteLater();
+}
+
+void LoadClient::onTextMessageReceived(const QString& message)
+{
+    const qint64 now = loadNowNs();
+    _group->messageReceived();
+    LoadStats& stats = _group->stats();
+
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson(message.toUtf8(), &error);
+    if (error.error != QJsonParseError::NoError || !doc.isObject()) {
+        stats.malformed++;
+        return;
+    }
+    const QJsonObject json = doc.object();
+    const QString type = json.value(QLatin1String("type")).toString();
+    const QString from = json.value(QLatin1String("from")).toString();
+    const QJsonObject data = json.value(QLatin1String("data")).toObject();
+    const QJsonValue sentAt = data.value(QLatin1String("ts"));
+
+    auto record = [&](LatencyKind kind) {
+        if (sentAt.isDouble()) stats.latencies[kind].push_back(now - static_cast<qint64>(sentAt.toDouble()));
+    };
+
+    if (type == QLatin1String("REGISTER_SUCCESS")) {
+        const bool first = _id.isEmpty();
+        _id = data.value(QLatin1String("peerId")).toString();
+        if (first && !_id.isEmpty()) {
+            _group->clientRegistered(this, now - _registerNs);
+        }
+    }
+    else if (type == QLatin1String("PEER_JOINED")) {
+        stats.peerJoined++;
+    }
+    else if (type == QLatin1String("PEER_LEFT")) {
+        stats.peerLeft++;
+    }
+    else if (type == QLatin1String("OFFER")) {
+        record(LatencyOffer);
+        sendRelay(QLatin1String("ANSWER"), from, QStringLiteral(",\"sdp\":\"%1\"").arg(_group->sdp()));
+        sendIce(from);
+    }
+    else if (type == QLatin1String("ANSWER")) {
+        record(LatencyAnswer);
+        sendIce(from);
+    }
+    else if (type == QLatin1String("ICE")) {
+        record(LatencyIce);
+    }
+    else if (type == QLatin1String("ERROR_MESSAGE")) {
+        if (data.value(QLatin1String("message")).toString().endsWith(QLatin1String("is not online"))) {
+            stats.notOnline++;
+        }
+        else {
+            stats.serverErrors++;
+        }
+    }
+    else {
+        stats.malformed++;
+    }
+}
+
+void LoadClient::sendRelay(const QLatin1String& type, const QString& to, const QString& fields)
+{
+    if (_closing || to.isEmpty()) return;
+
+    QString payload;
+    payload.reserve(64 + to.size() + fields.size());
+    payload += QLatin1String("{\"type\":\"");
+    payload += type;
+    payload += QLatin1String("\",\"to\":\"");
+    payload += to;
+    payload += QLatin1String("\",\"data\":{\"ts\":");
+    payload += QString::number(loadNowNs());
+    payload += fields;
+    payload += QLatin1String("}}");
+
+    _socket->sendTextMessage(payload);
+    _group->messageSent();
+}
+
+void LoadClient::sendIce(const QString& to)
+{
+    for (int i = 0; i < _group->options().iceCount; ++i) {
+        sendRelay(QLatin1String("ICE"), to, ICE_FIELDS);
+    }
+}
+
+// ClientGroup >>>>>>>>>>>>>>>>>
+
+ClientGroup::ClientGroup(int index, const LoadOptions& options, PeerDirectory* peers)
+    : QObject(nullptr), _index(index), _options(options), _peers(peers),
+    _paceTimer(new QTimer(this)), _trafficTimer(new QTimer(this)), _rng(1234 + index)
+{
+    _sdp = QStringLiteral("v=0\\r\\no=- 0 0 IN IP4 127.0.0.1\\r\\ns=-\\r\\n");
+    if (_sdp.size() < _options.sdpSize) {
+        _sdp += QString(_options.sdpSize - _sdp.size(), QLatin1Char('a'));
+    }
+
+    _paceTimer->setInterval(PACE_INTERVAL_MS);
+    _trafficTimer->setInterval(TRAFFIC_INTERVAL_MS);
+    connect(_paceTimer, &QTimer::timeout, this, &ClientGroup::onPaceTick);
+    connect(_trafficTimer, &QTimer::timeout, this, &ClientGroup::onTrafficTick);
+}
+
+void ClientGroup::openClients(int count, double rate)
+{
+    _toOpen = count;
+    _openRate = rate;
+    _paceStartNs = loadNowNs();
+    _paceOpened = 0;
+    _paceTimer->start();
+    onPaceTick();
+}
+
+void ClientGroup::onPaceTick()
+{
+    int due = _toOpen;
+    if (_openRate > 0) {
+        const double elapsed = (loadNowNs() - _paceStartNs) / 1e9;
+        due = std::min(_toOpen, static_cast<int>(_openRate * elapsed) + 1 - _paceOpened);
+    }
+    for (int i = 0; i < due; ++i) {
+        openClient();
+    }
+    _toOpen -= std::max(0, due);
+    _paceOpened += std::max(0, due);
+    if (_toOpen <= 0) {
+        _paceTimer->stop();
+    }
+}
+
+void ClientGroup::startTraffic(double churnRate)
+{
+    _churnRate = churnRate;
+    _exchangeCredit = 0;
+    _churnCredit = 0;
+    _lastTrafficNs = loadNowNs();
+    _trafficTimer->start();
+}
+
+void ClientGroup::stopTraffic()
+{
+    _trafficTimer->stop();
+}
+
+void ClientGroup::onTrafficTick()
+{
+    const qint64 now = loadNowNs();
+    const double elapsed = (now - _lastTrafficNs) / 1e9;
+    _lastTrafficNs = now;
+
+    _exchangeCredit += _options.exchangeRate * _live.size() * elapsed;
+    while (_exchangeCredit >= 1 && !_live.isEmpty()) {
+        LoadClient* sender = _live[_rng() % _live.size()];
+        const QString target = _peers->pick(sender->id(), sender->room(), _rng());
+        if (target.isEmpty()) {
+            _exchangeCredit = 0;
+            break;
+        }
+        sender->sendOffer(target);
+        _exchangeCredit -= 1;
+    }
+
+    if (_churnRate <= 0) return;
+    _churnCredit += _churnRate * elapsed;
+    while (_churnCredit >= 1 && !_live.isEmpty()) {
+        LoadClient* victim = _live[_rng() % _live.size()];
+        retire(victim);
+        victim->close();
+
+        openClient();
+        _churnCredit -= 1;
+    }
+}
+
+void ClientGroup::openClient()
+{
+    QString room;
+    if (_options.roomSize > 0) {
+        const int rooms = std::max(1, _options.clients / _options.roomSize);
+        room = QStringLiteral("load-%1").arg(_rng() % static_cast<quint32>(rooms));
+    }
+    LoadClient* client = new LoadClient(this, room);
+    client->open(_options.url);
+    opened.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ClientGroup::closeAll()
+{
+    _paceTimer->stop();
+    _trafficTimer->stop();
+    const QList<LoadClient*> clients = findChildren<LoadClient*>(QString(), Qt::FindDirectChildrenOnly);
+    for (LoadClient* client : clients) {
+        retire(client);
+        client->close();
+    }
+}
+
+void ClientGroup::clientConnected(LoadClient* client, qint64 latencyNs)
+{
+    Q_UNUSED(client);
+    _stats.latencies[LatencyConnect].push_back(latencyNs);
+    connected.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ClientGroup::clientRegistered(LoadClient* client, qint64 latencyNs)
+{
+    _stats.latencies[LatencyRegister].push_back(latencyNs);
+    registered.fetch_add(1, std::memory_order_relaxed);
+    _live.append(client);
+    _peers->add(client->id(), client->room());
+}
+
+void ClientGroup::clientClosed(LoadClient* client, bool everConnected)
+{
+    retire(client);
+    if (everConnected) {
+        connected.fetch_sub(1, std::memory_order_relaxed);
+    }
+    else {
+        failed.fetch_add(1, std::memory_order_relaxed);
+        _stats.connectFailures++;
+    }
+}
+
+void ClientGroup::retire(LoadClient* client)
+{
+    if (_live.removeOne(client)) {
+        registered.fetch_sub(1, std::memory_order_relaxed);
+        _peers->remove(client->id());
+    }
+}
+
+// LoadGenerator >>>>>>>>>>>>>>>>>
+
+LoadGenerator::LoadGenerator(const LoadOptions& options)
+    : _options(options)
+{
+    for (int i = 0; i < _options.threads; ++i) {
+        QThread* thread = new QThread();
+        ClientGroup* group = new ClientGroup(i, _options, &_peers);
+        group->moveToThread(thread);
+        // The clients' sockets must be destroyed on the thread that uses them
+        QObject::connect(thread, &QThread::finished, group, &QObject::deleteLater);
+        _threads.append(thread);
+        _groups.append(group);
+        thread->start();
+    }
+}
+
+LoadGenerator::~LoadGenerator()
+{
+    shutdown();
+    qDeleteAll(_threads);
+}
+
+int LoadGenerator::total(std::atomic<int> ClientGroup::* counter) const
+{
+    int sum = 0;
+    for (const ClientGroup* group : _groups) sum += (group->*counter).load(std::memory_order_relaxed);
+    return sum;
+}
+
+quint64 LoadGenerator::total(std::atomic<quint64> ClientGroup::* counter) const
+{
+    quint64 sum = 0;
+    for (const ClientGroup* group : _groups) sum += (group->*counter).load(std::memory_order_relaxed);
+    return sum;
+}
+
+int LoadGenerator::run()
+{
+    static const char* const SCENARIO_NAMES[] = { "register", "relay", "churn" };
+    std::printf("Scenario %s against %s: %d clients on %d threads, connect rate %.0f/s\n",
+        SCENARIO_NAMES[static_cast<int>(_options.scenario)], qPrintable(_options.url.toString()),
+        _options.clients, _options.threads, _options.connectRate);
+    if (_options.roomSize > 0) {
+        std::printf("Rooms: %d, about %d clients each\n", std::max(1, _options.clients / _options.roomSize),
+            _options.roomSize);
+    }
+
+    _rssStartKb = _options.serverPid > 0 ? readRssKb(_options.serverPid) : -1;
+    _rssPeakKb = _rssStartKb;
+
+    for (int i = 0; i < _groups.size(); ++i) {
+        const int count = _options.clients / _groups.size() + (i < _options.clients % _groups.size() ? 1 : 0);
+        const double rate = _options.connectRate / _groups.size();
+        ClientGroup* group = _groups[i];
+        QMetaObject::invokeMethod(group, [group, count, rate]() { group->openClients(count, rate); }, Qt::QueuedConnection);
+    }
+    const double connectSeconds = waitForClients();
+
+    double trafficSeconds = 0;
+    quint64 trafficMessages = 0;
+    if (_options.scenario != Scenario::Register) {
+        const double churnRate = _options.scenario == Scenario::Churn ? _options.churnRate / _groups.size() : 0;
+        for (ClientGroup* group : _groups) {
+            QMetaObject::invokeMethod(group, [group, churnRate]() { group->startTraffic(churnRate); }, Qt::QueuedConnection);
+        }
+        const quint64 before = total(&ClientGroup::received);
+        runTraffic(_options.duration);
+        trafficMessages = total(&ClientGroup::received) - before;
+        trafficSeconds = _options.duration;
+        for (ClientGroup* group : _groups) {
+            QMetaObject::invokeMethod(group, [group]() { group->stopTraffic(); }, Qt::QueuedConnection);
+        }
+    }
+    runTraffic(SETTLE_SECONDS);
+    _rssEndKb = _options.serverPid > 0 ? readRssKb(_options.serverPid) : -1;
+
+    shutdown();
+    report(connectSeconds, trafficSeconds, trafficMessages);
+    return _results.serverErrors + _results.connectFailures + _results.malformed > 0 ? 1 : 0;
+}
+
+double LoadGenerator::waitForClients()
+{
+    const qint64 start = loadNowNs();
+    const double limit = _options.clients / std::max(1.0, _options.connectRate) + CONNECT_GRACE_SECONDS;
+    double connectSeconds = -1;
+    qint64 nextProgress = start + 1000000000LL;
+
+    for (;;) {
+        const qint64 now = loadNowNs();
+        const double elapsed = (now - start) / 1e9;
+        const int connected = total(&ClientGroup::connected);
+        const int registered = total(&ClientGroup::registered);
+        const int failed = total(&ClientGroup::failed);
+
+        if (connectSeconds < 0 && connected + failed >= _options.clients) connectSeconds = elapsed;
+        if (registered + failed >= _options.clients) break;
+        if (elapsed > limit) {
+            std::printf("Connect phase timed out after %.1fs\n", elapsed);
+            break;
+        }
+        if (now >= nextProgress) {
+            std::printf("[%5.1fs] connected %d, registered %d, failed %d\n", elapsed, connected, registered, failed);
+            std::fflush(stdout);
+            nextProgress += 1000000000LL;
+            sampleServer();
+        }
+        QThread::msleep(POLL_INTERVAL_MS);
+    }
+    return connectSeconds < 0 ? (loadNowNs() - start) / 1e9 : connectSeconds;
+}
+
+void LoadGenerator::runTraffic(double seconds)
+{
+    const qint64 start = loadNowNs();
+    const qint64 end = start + static_cast<qint64>(seconds * 1e9);
+    qint64 nextProgress = start + 1000000000LL;
+    quint64 lastReceived = total(&ClientGroup::received);
+
+    while (loadNowNs() < end) {
+        QThread::msleep(POLL_INTERVAL_MS);
+        if (loadNowNs() < nextProgress) continue;
+
+        const quint64 received = total(&ClientGroup::received);
+        std::printf("[%5.1fs] registered %d, received %llu msgs/s\n", (loadNowNs() - start) / 1e9,
+            total(&ClientGroup::registered), static_cast<unsigned long long>(received - lastReceived));
+        std::fflush(stdout);
+        lastReceived = received;
+        nextProgress += 1000000000LL;
+        sampleServer();
+    }
+}
+
+void LoadGenerator::sampleServer()
+{
+    if (_options.serverPid <= 0) return;
+    _rssPeakKb = std::max(_rssPeakKb, readRssKb(_options.serverPid));
+}
+
+void LoadGenerator::shutdown()
+{
+    if (_threads.isEmpty() || !_threads.first()->isRunning()) return;
+
+    for (ClientGroup* group : _groups) {
+        QMetaObject::invokeMethod(group, [group]() { group->closeAll(); }, Qt::BlockingQueuedConnection);
+    }
+    // Let the close handshakes go out before the event loops stop
+    QThread::msleep(200);
+    for (ClientGroup* group : _groups) {
+        QMetaObject::invokeMethod(group, [this, group]() {
+            _results.merge(group->stats());
+            _opened += group->opened.load();
+            _sent += group->sent.load();
+            _received += group->received.load();
+            }, Qt::BlockingQueuedConnection);
+    }
+    for (QThread* thread : _threads) {
+        thread->quit();
+        thread->wait();
+    }
+}
+
+void LoadGenerator::report(double connectSeconds, double trafficSeconds, quint64 trafficMessages) const
+{
+    const LoadStats& all = _results;
+    const quint64 opened = _opened;
+    std::printf("\n== connections ==\n");
+    std::printf("opened %llu, connect failures %llu, %.0f connections/s (first %d in %.2fs)\n",
+        static_cast<unsigned long long>(opened), static_cast<unsigned long long>(all.connectFailures),
+        connectSeconds > 0 ? _options.clients / connectSeconds : 0.0, _options.clients, connectSeconds);
+
+    std::printf("\n== latency (ms) ==\n%-10s %10s %9s %9s %9s %9s %9s\n", "type", "count", "p50", "p90", "p99", "p99.9", "max");
+    for (int i = 0; i < LatencyKindCount; ++i) {
+        std::vector<qint64> samples = all.latencies[i];
+        std::sort(samples.begin(), samples.end());
+        std::printf("%-10s %10zu %9.2f %9.2f %9.2f %9.2f %9.2f\n", LATENCY_NAMES[i], samples.size(),
+            percentileMs(samples, 0.50), percentileMs(samples, 0.90), percentileMs(samples, 0.99),
+            percentileMs(samples, 0.999), samples.empty() ? 0.0 : samples.back() / 1e6);
+    }
+
+    std::printf("\n== messages ==\n");
+    std::printf("sent %llu, received %llu", static_cast<unsigned long long>(_sent),
+        static_cast<unsigned long long>(_received));
+    if (trafficSeconds > 0) std::printf(", %.0f received msgs/s during traffic", trafficMessages / trafficSeconds);
+    std::printf("\nPEER_JOINED %llu", static_cast<unsigned long long>(all.peerJoined));
+    if (_options.scenario == Scenario::Register && _options.roomSize <= 0) {
+        const quint64 n = static_cast<quint64>(_options.clients);
+        std::printf(" (expected %llu for a storm from empty)", static_cast<unsigned long long>(n * (n - 1) / 2));
+    }
+    std::printf(", PEER_LEFT %llu\n", static_cast<unsigned long long>(all.peerLeft));
+
+    std::printf("\n== errors ==\n");
+    std::printf("not online %llu, server %llu, socket %llu, dropped %llu, connect %llu, malformed %llu\n",
+        static_cast<unsigned long long>(all.notOnline), static_cast<unsigned long long>(all.serverErrors),
+        static_cast<unsigned long long>(all.socketErrors), static_cast<unsigned long long>(all.dropped),
+        static_cast<unsigned long long>(all.connectFailures), static_cast<unsigned long long>(all.malformed));
+
+    std::printf("\n== server ==\n");
+    if (_options.serverPid <= 0 || _rssStartKb < 0) {
+        std::printf("RSS n/a (pass --server-pid on Linux)\n");
+    }
+    else {
+        std::printf("RSS start %.1f MB, peak %.1f MB, end %.1f MB\n", _rssStartKb / 1024.0, _rssPeakKb / 1024.0,
+            _rssEndKb / 1024.0);
+    }
+}
@@ -0,0 +1,314 @@
+#ifndef __LOAD_GENERATOR_H__
+#define __LOAD_GENERATOR_H__
+
+#include <QObject>
+#include <QReadWriteLock>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <QThread>
+#include <QUrl>
+#include <QVector>
+#include <QWebSocket>
+#include <atomic>
+#include <random>
+#include <vector>
+
+/**
+* @enum Scenario
+* @brief What the clients do once connected.
+*/
+enum class Scenario {
+    Register,   ///< Register storm: every client connects and registers as fast as the connect rate allows.
+    Relay,      ///< OFFER -> ANSWER -> ICE exchanges between random pairs of registered clients.
+    Churn       ///< Relay traffic while clients keep disconnecting and being replaced by new ones.
+};
+
+/**
+* @struct LoadOptions
+* @brief Command line configuration of a run.
+*/
+struct LoadOptions {
+    QUrl url = QUrl(QStringLiteral("ws://127.0.0.1:11290"));
+    Scenario scenario = Scenario::Relay;
+    int clients = 1000;            ///< Clients kept connected.
+    int threads = 4;               ///< Client threads, each with its own event loop.
+    double connectRate = 2000;     ///< New connections per second, over all threads.
+    double duration = 10;          ///< Seconds of traffic (relay, churn).
+    double exchangeRate = 0.5;     ///< Exchanges started per registered client per second.
+    int iceCount = 4;              ///< ICE candidates each side sends per exchange.
+    int sdpSize = 2048;            ///< Characters of SDP in OFFER / ANSWER.
+    double churnRate = 50;         ///< Clients replaced per second (churn).
+    int roomSize = 0;              ///< Average clients per room; 0 registers without a room id.
+    qint64 serverPid = 0;          ///< Server process whose RSS is sampled; 0 to skip.
+};
+
+/**
+* @brief Nanoseconds on a monotonic clock shared by all client threads.
+*/
+qint64 loadNowNs();
+
+/**
+* @enum LatencyKind
+* @brief The latencies recorded per message type.
+*/
+enum LatencyKind {
+    LatencyConnect,     ///< open() -> WebSocket connected.
+    LatencyRegister,    ///< REGISTER_REQUEST sent -> REGISTER_SUCCESS received.
+    LatencyOffer,       ///< OFFER sent -> received by the target.
+    LatencyAnswer,      ///< ANSWER sent -> received by the target.
+    LatencyIce,         ///< ICE sent -> received by the target.
+    LatencyKindCount
+};
+
+/**
+* @struct LoadStats
+* @brief Results of one client thread; merged after the threads have stopped.
+*/
+struct LoadStats {
+    std::vector<qint64> latencies[LatencyKindCount];   ///< Samples in nanoseconds.
+    quint64 peerJoined = 0;         ///< PEER_JOINED notifications received.
+    quint64 peerLeft = 0;           ///< PEER_LEFT notifications received.
+    quint64 notOnline = 0;          ///< ERROR_MESSAGE "... is not online" (expected under churn).
+    quint64 serverErrors = 0;       ///< Any other ERROR_MESSAGE.
+    quint64 socketErrors = 0;       ///< QWebSocket errors.
+    quint64 connectFailures = 0;    ///< Clients that never reached the connected state.
+    quint64 dropped = 0;            ///< Connections closed by the server or the network.
+    quint64 malformed = 0;          ///< Messages that are not JSON objects with a known type.
+
+    void merge(const LoadStats& other);
+};
+
+/**
+* @class PeerDirectory
+* @brief Ids of the registered clients of all threads by room, for picking random targets.
+*/
+class PeerDirectory
+{
+public:
+    void add(const QString& id, const QString& room);
+    void remove(const QString& id);
+
+    /**
+    * @brief A random id registered in `room` other than `exclude`, or an empty string.
+    */
+    QString pick(const QString& exclude, const QString& room, quint32 random) const;
+
+    int size() const;
+
+private:
+    /**
+    * @struct Room
+    * @brief One room's ids, unordered, and each id's position for O(1) removal.
+    */
+    struct Room {
+        QVector<QString> ids;
+        QHash<QString, int> index;
+    };
+
+    mutable QReadWriteLock _lock;
+    QHash<QString, Room> _rooms;        ///< Room id -> registered members.
+    QHash<QString, QString> _roomOf;    ///< Client id -> room id.
+};
+
+class ClientGroup;
+
+/**
+* @class LoadClient
+* @brief One simulated peer: a QWebSocket that registers and answers offers like a real client.
+*/
+class LoadClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+    * @param room Room sent with REGISTER_REQUEST; empty for the server's default room.
+    */
+    LoadClient(ClientGroup* group, const QString& room);
+
+    void open(const QUrl& url);
+
+    /**
+    * @brief Closes the connection on purpose; the client deletes itself once closed.
+    */
+    void close();
+
+    bool isRegistered() const { return !_id.isEmpty(); }
+    QString id() const { return _id; }
+    QString room() const { return _room; }
+
+    /**
+    * @brief Starts an exchange: OFFER now, ICE candidates once the ANSWER arrives.
+    */
+    void sendOffer(const QString& target);
+
+private:
+    void onConnected();
+    void onDisconnected();
+    void onTextMessageReceived(const QString& message);
+    void onErrorOccurred(QAbstractSocket::SocketError error);
+
+    /**
+    * @brief Sends OFFER / ANSWER / ICE with the send time as `data.ts`, followed by `fields`.
+    */
+    void sendRelay(const QLatin1String& type, const QString& to, const QString& fields);
+    void sendIce(const QString& to);
+
+    /**
+    * @brief Reports the end of the connection to the group, once, and deletes the client.
+    */
+    void finish();
+
+private:
+    ClientGroup* _group;
+    QWebSocket* _socket;
+    QString _id;                ///< Assigned by REGISTER_SUCCESS.
+    QString _room;              ///< Room the client registers in.
+    qint64 _openNs = 0;
+    qint64 _registerNs = 0;
+    bool _connected = false;
+    bool _closing = false;      ///< close() was called, the disconnect is expected.
+    bool _done = false;         ///< finish() has run.
+};
+
+/**
+* @class ClientGroup
+* @brief The clients of one thread, and the timers that drive them.
+*
+* Lives on its own QThread; every method except the atomics is called on that thread
+* (from other threads through QMetaObject::invokeMethod).
+*/
+class ClientGroup : public QObject
+{
+    Q_OBJECT
+
+public:
+    ClientGroup(int index, const LoadOptions& options, PeerDirectory* peers);
+
+    /**
+    * @brief Opens `count` clients at `rate` per second; each registers once connected.
+    */
+    void openClients(int count, double rate);
+
+    /**
+    * @brief Starts exchanges, and replacing clients when churnRate > 0.
+    */
+    void startTraffic(double churnRate);
+
+    void stopTraffic();
+
+    /**
+    * @brief Closes every client.
+    */
+    void closeAll();
+
+    LoadStats& stats() { return _stats; }
+    const LoadOptions& options() const { return _options; }
+    const QString& sdp() const { return _sdp; }
+
+    // Called by the group's LoadClients
+    void clientConnected(LoadClient* client, qint64 latencyNs);
+    void clientRegistered(LoadClient* client, qint64 latencyNs);
+    void clientClosed(LoadClient* client, bool everConnected);
+
+    /**
+    * @brief Stops offering a client as a sender or target.
+    */
+    void retire(LoadClient* client);
+
+    void messageSent() { sent.fetch_add(1, std::memory_order_relaxed); }
+    void messageReceived() { received.fetch_add(1, std::memory_order_relaxed); }
+
+public:
+    // Progress counters, read by the main thread while the run is going
+    std::atomic<int> connected{ 0 };    ///< Clients currently connected.
+    std::atomic<int> registered{ 0 };   ///< Clients currently registered.
+    std::atomic<int> failed{ 0 };       ///< Clients that never connected.
+    std::atomic<quint64> opened{ 0 };   ///< Clients opened so far.
+    std::atomic<quint64> sent{ 0 };     ///< Messages sent.
+    std::atomic<quint64> received{ 0 }; ///< Messages received.
+
+private:
+    void onPaceTick();
+    void onTrafficTick();
+
+    /**
+    * @brief Opens a client in a random room, or in the default room when roomSize is 0.
+    */
+    void openClient();
+
+private:
+    int _index;
+    LoadOptions _options;
+    PeerDirectory* _peers;
+    LoadStats _stats;
+    QString _sdp;                   ///< SDP filler, built once.
+    QTimer* _paceTimer;             ///< Opens clients at the requested rate.
+    QTimer* _trafficTimer;          ///< Starts exchanges and replaces clients.
+    QVector<LoadClient*> _live;     ///< Registered clients, for picking senders and churn victims.
+    std::mt19937 _rng;
+    int _toOpen = 0;
+    double _openRate = 0;
+    qint64 _paceStartNs = 0;
+    int _paceOpened = 0;
+    double _churnRate = 0;
+    double _exchangeCredit = 0;
+    double _churnCredit = 0;
+    qint64 _lastTrafficNs = 0;
+};
+
+/**
+* @class LoadGenerator
+* @brief Runs one scenario from the main thread and prints the report.
+*/
+class LoadGenerator
+{
+public:
+    explicit LoadGenerator(const LoadOptions& options);
+    ~LoadGenerator();
+
+    /**
+    * @brief Runs the scenario; returns the process exit code.
+    */
+    int run();
+
+private:
+    int total(std::atomic<int> ClientGroup::* counter) const;
+    quint64 total(std::atomic<quint64> ClientGroup::* counter) const;
+
+    /**
+    * @brief Waits for the connect phase; returns the seconds until the last client connected.
+    */
+    double waitForClients();
+
+    /**
+    * @brief Keeps the traffic running for `seconds`, printing progress once per second.
+    */
+    void runTraffic(double seconds);
+
+    void sampleServer();
+
+    /**
+    * @brief Closes the clients, collects the groups' results and stops their threads.
+    */
+    void shutdown();
+
+    void report(double connectSeconds, double trafficSeconds, quint64 trafficMessages) const;
+
+private:
+    LoadOptions _options;
+    PeerDirectory _peers;
+    QVector<QThread*> _threads;
+    QVector<ClientGroup*> _groups;     ///< Deleted on their own threads by shutdown().
+    LoadStats _results;                 ///< All groups' stats, collected by shutdown().
+    quint64 _opened = 0;                ///< Totals collected by shutdown().
+    quint64 _sent = 0;
+    quint64 _received = 0;
+    qint64 _rssStartKb = -1;
+    qint64 _rssPeakKb = -1;
+    qint64 _rssEndKb = -1;
+};
+
+#endif // __LOAD_GENERATOR_H__
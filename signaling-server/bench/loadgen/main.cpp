@@ -0,0 +1,101 @@
+// Signaling load generator: thousands of headless WebSocket clients against a running SignalingServer
+//
+// Scenarios:
+// 1. register  every client connects and registers as fast as --connect-rate allows; each
+//              registration makes the server notify all earlier clients (PEER_JOINED)
+// 2. relay     once all clients are registered, random pairs run OFFER -> ANSWER -> ICE
+//              exchanges for --duration seconds
+// 3. churn     relay traffic while --churn-rate clients per second disconnect and are
+//              replaced by new ones, so offers also hit peers that just left
+//
+// With --room-size every client registers in a random room of about that many clients, and
+// picks its exchange partners in its own room; presence is then scoped to the room.
+//
+// Reported: connect rate, connect / register / per-type forward latency percentiles, message
+// counts, presence notifications, error counts, and the server's RSS with --server-pid.
+// The exit code is 1 if any server error, failed connect or malformed message was seen.
+//
+// Usage: signaling_loadgen --scenario relay --clients 2000 --threads 4 --server-pid $(pidof signaling-server)
+#include "LoadGenerator.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+
+#include <cstdio>
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("signaling_loadgen"));
+
+    const LoadOptions defaults;
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Headless load generator for the signaling server."));
+    parser.addHelpOption();
+
+    const QCommandLineOption urlOption(QStringLiteral("url"), QStringLiteral("Server URL."),
+        QStringLiteral("url"), defaults.url.toString());
+    const QCommandLineOption scenarioOption(QStringLiteral("scenario"), QStringLiteral("register, relay or churn."),
+        QStringLiteral("name"), QStringLiteral("relay"));
+    const QCommandLineOption clientsOption(QStringLiteral("clients"), QStringLiteral("Clients kept connected."),
+        QStringLiteral("n"), QString::number(defaults.clients));
+    const QCommandLineOption threadsOption(QStringLiteral("threads"), QStringLiteral("Client threads."),
+        QStringLiteral("n"), QString::number(defaults.threads));
+    const QCommandLineOption connectRateOption(QStringLiteral("connect-rate"),
+        QStringLiteral("New connections per second; 0 opens all at once."),
+        QStringLiteral("n"), QString::number(defaults.connectRate));
+    const QCommandLineOption durationOption(QStringLiteral("duration"), QStringLiteral("Seconds of relay / churn traffic."),
+        QStringLiteral("s"), QString::number(defaults.duration));
+    const QCommandLineOption rateOption(QStringLiteral("rate"),
+        QStringLiteral("Exchanges started per registered client per second."),
+        QStringLiteral("n"), QString::number(defaults.exchangeRate));
+    const QCommandLineOption iceOption(QStringLiteral("ice"), QStringLiteral("ICE candidates per side and exchange."),
+        QStringLiteral("n"), QString::number(defaults.iceCount));
+    const QCommandLineOption sdpOption(QStringLiteral("sdp-size"), QStringLiteral("SDP characters in OFFER / ANSWER."),
+        QStringLiteral("n"), QString::number(defaults.sdpSize));
+    const QCommandLineOption churnOption(QStringLiteral("churn-rate"), QStringLiteral("Clients replaced per second (churn)."),
+        QStringLiteral("n"), QString::number(defaults.churnRate));
+    const QCommandLineOption roomOption(QStringLiteral("room-size"),
+        QStringLiteral("Average clients per room, in random rooms; 0 registers without a room id."),
+        QStringLiteral("n"), QString::number(defaults.roomSize));
+    const QCommandLineOption pidOption(QStringLiteral("server-pid"), QStringLiteral("Server process to sample RSS from (Linux)."),
+        QStringLiteral("pid"), QStringLiteral("0"));
+    parser.addOptions({ urlOption, scenarioOption, clientsOption, threadsOption, connectRateOption, durationOption,
+        rateOption, iceOption, sdpOption, churnOption, roomOption, pidOption });
+    parser.process(app);
+
+    LoadOptions options;
+    options.url = QUrl(parser.value(urlOption));
+    options.clients = qMax(1, parser.value(clientsOption).toInt());
+    options.threads = qBound(1, parser.value(threadsOption).toInt(), options.clients);
+    options.connectRate = qMax(0.0, parser.value(connectRateOption).toDouble());
+    options.duration = qMax(0.0, parser.value(durationOption).toDouble());
+    options.exchangeRate = qMax(0.0, parser.value(rateOption).toDouble());
+    options.iceCount = qMax(0, parser.value(iceOption).toInt());
+    options.sdpSize = qMax(0, parser.value(sdpOption).toInt());
+    options.churnRate = qMax(0.0, parser.value(churnOption).toDouble());
+    options.roomSize = qMax(0, parser.value(roomOption).toInt());
+    options.serverPid = parser.value(pidOption).toLongLong();
+
+    const QString scenario = parser.value(scenarioOption);
+    if (scenario == QLatin1String("register")) {
+        options.scenario = Scenario::Register;
+    }
+    else if (scenario == QLatin1String("relay")) {
+        options.scenario = Scenario::Relay;
+    }
+    else if (scenario == QLatin1String("churn")) {
+        options.scenario = Scenario::Churn;
+    }
+    else {
+        std::fprintf(stderr, "Unknown scenario: %s\n", qPrintable(scenario));
+        return 2;
+    }
+    if (!options.url.isValid()) {
+        std::fprintf(stderr, "Invalid URL: %s\n", qPrintable(parser.value(urlOption)));
+        return 2;
+    }
+
+    LoadGenerator generator(options);
+    return generator.run();
+}
@@ -0,0 +1,164 @@
+// Task queue benchmark: RingQueue (lock-free MPMC ring) vs. BlockingQueue (QMutex + QWaitCondition)
+//
+// Producers and consumers go through the TaskQueue interface like WorkerPool / Worker do;
+// consumers call pop(item, DEFAULT_TIMEOUT) in a loop, the way Worker::startLoop() does.
+//
+// 1. throughput  P producers push as fast as they can, C consumers drain; messages/s
+// 2. latency     producers pace a fixed total rate, so the queue is mostly empty and every
+//                message pays for waking a consumer; enqueue -> dequeue percentiles
+//
+// Usage: queue_bench [messages] [rate]   (default: 2000000 messages, 50000 messages/s)
+#include "src/BlockingQueue.hpp"
+#include "src/RingQueue.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int POP_TIMEOUT_MS = 100;   // Worker's DEFAULT_TIMEOUT
+const double LATENCY_SECONDS = 1.0;
+
+struct Shape { int producers; int consumers; };
+
+// 1x4 is the server's shape: the main thread feeds the worker pool
+const Shape SHAPES[] = { { 1, 1 }, { 1, 2 }, { 1, 4 }, { 2, 2 }, { 4, 4 }, { 8, 8 } };
+
+using Clock = std::chrono::steady_clock;
+
+struct Item {
+    quint64 seq = 0;
+    qint64 enqueuedNs = 0;
+};
+
+qint64 nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+TaskQueue<Item>::Ptr makeQueue(QueueType type)
+{
+    if (type == QueueType::Ring) return std::make_shared<RingQueue<Item>>();
+    return std::make_shared<BlockingQueue<Item>>();
+}
+
+const char* queueName(QueueType type)
+{
+    return type == QueueType::Ring ? "ring" : "blocking";
+}
+
+struct Result {
+    double messagesPerSecond = 0;
+    double p50Us = 0;
+    double p99Us = 0;
+    double p999Us = 0;
+    double maxUs = 0;
+};
+
+// Producers push `total` messages; with rate > 0 they pace it, otherwise they push flat out.
+// Consumers keep one latency sample per message (or every 16th when not paced).
+Result run(QueueType type, Shape shape, quint64 total, double rate)
+{
+    TaskQueue<Item>::Ptr queue = makeQueue(type);
+    std::atomic<quint64> consumed{ 0 };
+    std::atomic<qint64> finishedNs{ 0 };
+    std::vector<std::vector<qint64>> samples(shape.consumers);
+    const quint64 sampleMask = rate > 0 ? 0 : 15;
+
+    std::vector<std::thread> threads;
+    for (int c = 0; c < shape.consumers; ++c) {
+        threads.emplace_back([&, c]() {
+            std::vector<qint64>& mine = samples[c];
+            Item item;
+            while (consumed.load(std::memory_order_relaxed) < total) {
+                if (!queue->pop(item, POP_TIMEOUT_MS)) continue;
+                if ((item.seq & sampleMask) == 0) mine.push_back(nowNs() - item.enqueuedNs);
+                if (consumed.fetch_add(1, std::memory_order_relaxed) + 1 == total) {
+                    finishedNs.store(nowNs(), std::memory_order_relaxed);
+                    // The others may be parked with nothing left to pop
+                    queue->notifyAll();
+                }
+            }
+        });
+    }
+
+    const auto start = Clock::now();
+    const qint64 startNs = nowNs();
+    for (int p = 0; p < shape.producers; ++p) {
+        threads.emplace_back([&, p]() {
+            const quint64 count = total / shape.producers + (static_cast<quint64>(p) < total % shape.producers ? 1 : 0);
+            const double interval = rate > 0 ? shape.producers / rate : 0;   // seconds between this producer's messages
+            Item item;
+            for (quint64 i = 0; i < count; ++i) {
+                if (rate > 0) std::this_thread::sleep_until(start + std::chrono::duration<double>(interval * i));
+                item.seq = i;
+                item.enqueuedNs = nowNs();
+                queue->push(item);
+            }
+        });
+    }
+    for (std::thread& t : threads) t.join();
+    // Up to the last message, not the join: a consumer that parked just before the end
+    // only notices after its pop() times out
+    const double elapsed = (finishedNs.load() - startNs) / 1e9;
+
+    std::vector<qint64> all;
+    for (const std::vector<qint64>& mine : samples) all.insert(all.end(), mine.begin(), mine.end());
+    std::sort(all.begin(), all.end());
+    auto percentile = [&](double q) {
+        return all.empty() ? 0.0 : all[std::min(all.size() - 1, static_cast<size_t>(q * all.size()))] / 1000.0;
+    };
+
+    Result result;
+    result.messagesPerSecond = total / elapsed;
+    result.p50Us = percentile(0.50);
+    result.p99Us = percentile(0.99);
+    result.p999Us = percentile(0.999);
+    result.maxUs = all.empty() ? 0.0 : all.back() / 1000.0;
+    return result;
+}
+
+void printHeader(const char* title)
+{
+    std::printf("\n%s\n%-9s %-6s %14s %10s %10s %10s %10s\n", title, "queue", "PxC", "msgs/s",
+        "p50 us", "p99 us", "p99.9 us", "max us");
+}
+
+void printResult(QueueType type, Shape shape, const Result& r)
+{
+    char label[16];
+    std::snprintf(label, sizeof(label), "%dx%d", shape.producers, shape.consumers);
+    std::printf("%-9s %-6s %14.0f %10.1f %10.1f %10.1f %10.1f\n", queueName(type), label, r.messagesPerSecond,
+        r.p50Us, r.p99Us, r.p999Us, r.maxUs);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const quint64 messages = argc > 1 ? std::max(1LL, std::atoll(argv[1])) : 2000000;
+    const double rate = argc > 2 ? std::max(1.0, std::atof(argv[2])) : 50000.0;
+    const QueueType types[] = { QueueType::Blocking, QueueType::Ring };
+
+    std::printf("Hardware threads: %u\n", std::thread::hardware_concurrency());
+
+    printHeader("== throughput (unpaced; latency includes queueing, sampled 1/16) ==");
+    for (Shape shape : SHAPES) {
+        for (QueueType type : types) printResult(type, shape, run(type, shape, messages, 0));
+    }
+
+    char title[96];
+    std::snprintf(title, sizeof(title), "== latency (%.0f msgs/s paced for %.1fs) ==", rate, LATENCY_SECONDS);
+    printHeader(title);
+    for (Shape shape : SHAPES) {
+        for (QueueType type : types) {
+            printResult(type, shape, run(type, shape, static_cast<quint64>(rate * LATENCY_SECONDS), rate));
+        }
+    }
+    return 0;
+}
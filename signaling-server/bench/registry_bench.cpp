@@ -0,0 +1,269 @@
+// Session registry benchmark: SessionRegistry vs. the previous QJsonArray session list
+//
+// Legacy model: a QJsonArray of ids scanned linearly by isOnline(), rebuilt from the
+// connection hash on every disconnect. Concurrent runs wrap it in one QReadWriteLock
+// (the server previously had no lock at all, which was a data race).
+//
+// Scenarios, for each session count:
+// 1. lookup      single-threaded isOnline()/contains(), half hits / half misses
+// 2. concurrent  R reader threads doing lookups while one writer churns (remove + add)
+// 3. churn       disconnect + register cost, including the legacy list rebuild
+// 4. snapshot    peer list for a newcomer: unchanged, and right after a disconnect + register
+//
+// Usage: registry_bench [sessions...]   (default: 1000 10000 50000)
+#include "src/SessionRegistry.h"
+
+#include <QHash>
+#include <QJsonArray>
+#include <QReadWriteLock>
+#include <QString>
+#include <QUuid>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const double RUN_SECONDS = 0.3;   // each timed scenario runs for about this long
+const int READER_COUNTS[] = { 1, 2, 4, 8 };
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+QString newId()
+{
+    return QUuid::createUuid().toString(QUuid::Id128);
+}
+
+// The server's previous bookkeeping, reproduced as-is
+class LegacySessionList
+{
+public:
+    void add(const QString& id)
+    {
+        QWriteLocker guard(&_lock);
+        _sessions.insert(id, nullptr);
+        _list.append(id);
+    }
+
+    void remove(const QString& id)
+    {
+        QWriteLocker guard(&_lock);
+        _sessions.remove(id);
+        // onRemoveSession(): _session_list = getPeerList()
+        QJsonArray rebuilt;
+        for (auto it = _sessions.begin(); it != _sessions.end(); ++it) {
+            rebuilt.append(it.key());
+        }
+        _list = rebuilt;
+    }
+
+    bool isOnline(const QString& id) const
+    {
+        QReadLocker guard(&_lock);
+        for (auto it = _list.begin(); it != _list.end(); it++) {
+            if ((*it).toString() == id) return true;
+        }
+        return false;
+    }
+
+    QJsonArray peers() const
+    {
+        QReadLocker guard(&_lock);
+        return _list;
+    }
+
+private:
+    mutable QReadWriteLock _lock;
+    QHash<QString, void*> _sessions;
+    QJsonArray _list;
+};
+
+struct Fixture {
+    std::vector<QString> online;   // registered ids
+    std::vector<QString> offline;  // never registered, for misses
+};
+
+Fixture makeFixture(int sessions)
+{
+    Fixture f;
+    f.online.reserve(sessions);
+    f.offline.reserve(sessions);
+    for (int i = 0; i < sessions; ++i) {
+        f.online.push_back(newId());
+        f.offline.push_back(newId());
+    }
+    return f;
+}
+
+// Runs fn(i) repeatedly in batches until RUN_SECONDS elapse; returns ops per second
+template<class Fn>
+double timed(Fn&& fn)
+{
+    const int batch = 64;
+    uint64_t ops = 0;
+    const auto start = Clock::now();
+    double elapsed = 0;
+    do {
+        for (int i = 0; i < batch; ++i) fn(ops + i);
+        ops += batch;
+        elapsed = secondsSince(start);
+    } while (elapsed < RUN_SECONDS);
+    return ops / elapsed;
+}
+
+template<class Lookup>
+double lookupRate(const Fixture& f, Lookup&& lookup)
+{
+    std::atomic<int> sink{ 0 };   // keeps the lookups from being optimized away
+    const size_t n = f.online.size();
+    return timed([&](uint64_t i) {
+        const size_t k = (i * 2654435761u) % n;
+        const QString& id = (i & 1) ? f.offline[k] : f.online[k];
+        if (lookup(id)) sink.fetch_add(1, std::memory_order_relaxed);
+    });
+}
+
+// R readers look up while one writer removes and re-adds ids; returns total lookups per second
+template<class Lookup, class Churn>
+double concurrentRate(const Fixture& f, int readers, Lookup&& lookup, Churn&& churn, double* churnRate)
+{
+    std::atomic<bool> stop{ false };
+    std::atomic<uint64_t> lookups{ 0 };
+    std::atomic<uint64_t> churns{ 0 };
+    std::atomic<int> sink{ 0 };   // keeps the lookups from being optimized away
+    const size_t n = f.online.size();
+
+    std::vector<std::thread> threads;
+    for (int r = 0; r < readers; ++r) {
+        threads.emplace_back([&, r]() {
+            uint64_t local = 0;
+            int hits = 0;
+            std::mt19937 rng(r + 1);
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (int i = 0; i < 64; ++i) {
+                    const size_t k = rng() % n;
+                    hits += lookup((rng() & 1) ? f.offline[k] : f.online[k]) ? 1 : 0;
+                }
+                local += 64;
+            }
+            lookups.fetch_add(local, std::memory_order_relaxed);
+            sink.fetch_add(hits, std::memory_order_relaxed);
+        });
+    }
+    threads.emplace_back([&]() {
+        uint64_t local = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+            churn(f.online[local % n]);
+            ++local;
+        }
+        churns.store(local, std::memory_order_relaxed);
+    });
+
+    const auto start = Clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(RUN_SECONDS));
+    stop.store(true);
+    for (std::thread& t : threads) t.join();
+    const double elapsed = secondsSince(start);
+    if (churnRate) *churnRate = churns.load() / elapsed;
+    return lookups.load() / elapsed;
+}
+
+void printRate(const char* scenario, const char* unit, double legacy, double registry)
+{
+    std::printf("  %-26s %-10s %14.0f %14.0f %9.1fx\n", scenario, unit, legacy, registry,
+        legacy > 0 ? registry / legacy : 0.0);
+}
+
+void run(int sessions)
+{
+    std::printf("\n=== %d sessions ===\n", sessions);
+    std::printf("  %-26s %-10s %14s %14s %10s\n", "scenario", "unit", "legacy", "registry", "speedup");
+
+    const Fixture f = makeFixture(sessions);
+    LegacySessionList legacy;
+    SessionRegistry registry;
+    for (const QString& id : f.online) {
+        legacy.add(id);
+        registry.add(id);
+    }
+
+    // 1. single-threaded lookups
+    printRate("lookup", "ops/s", lookupRate(f, [&](const QString& id) { return legacy.isOnline(id); }),
+        lookupRate(f, [&](const QString& id) { return registry.contains(id); }));
+
+    // 2. concurrent readers + one churning writer
+    for (int readers : READER_COUNTS) {
+        double legacyChurn = 0;
+        double registryChurn = 0;
+        const double legacyRate = concurrentRate(f, readers,
+            [&](const QString& id) { return legacy.isOnline(id); },
+            [&](const QString& id) { legacy.remove(id); legacy.add(id); }, &legacyChurn);
+        const double registryRate = concurrentRate(f, readers,
+            [&](const QString& id) { return registry.contains(id); },
+            [&](const QString& id) { registry.remove(id); registry.add(id); }, &registryChurn);
+        char label[64];
+        std::snprintf(label, sizeof(label), "concurrent %d readers", readers);
+        printRate(label, "lookups/s", legacyRate, registryRate);
+        std::snprintf(label, sizeof(label), "  writer during %d readers", readers);
+        printRate(label, "churn/s", legacyChurn, registryChurn);
+    }
+
+    // 3. disconnect + register, single-threaded
+    size_t next = 0;
+    printRate("churn", "ops/s", timed([&](uint64_t) {
+            const QString& id = f.online[next++ % f.online.size()];
+            legacy.remove(id);
+            legacy.add(id);
+        }),
+        timed([&](uint64_t) {
+            const QString& id = f.online[next++ % f.online.size()];
+            registry.remove(id);
+            registry.add(id);
+        }));
+
+    // 4. peer list for a newcomer. The legacy list is rebuilt on every disconnect and copied
+    //    on read; the registry rebuilds its snapshot lazily, once per version
+    std::atomic<int> sink{ 0 };
+    const double legacyPeers = timed([&](uint64_t) { sink += legacy.peers().size() > 0; });
+    const double cached = timed([&](uint64_t) { sink += registry.snapshot()->ids.size() > 0; });
+    const double legacyChanged = timed([&](uint64_t i) {
+        const QString& id = f.online[i % f.online.size()];
+        legacy.remove(id);
+        legacy.add(id);
+        sink += legacy.peers().size() > 0;
+    });
+    const double registryChanged = timed([&](uint64_t i) {
+        const QString& id = f.online[i % f.online.size()];
+        registry.remove(id);
+        registry.add(id);
+        sink += registry.snapshot()->ids.size() > 0;
+    });
+    printRate("peer list (unchanged)", "ops/s", legacyPeers, cached);
+    printRate("churn + peer list", "ops/s", legacyChanged, registryChanged);
+    std::printf("  registry version after run: %llu, size %d\n",
+        static_cast<unsigned long long>(registry.version()), registry.size());
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::vector<int> sizes;
+    for (int i = 1; i < argc; ++i) sizes.push_back(std::max(1, std::atoi(argv[i])));
+    if (sizes.empty()) sizes = { 1000, 10000, 50000 };
+
+    std::printf("Hardware threads: %u, %.1fs per scenario\n", std::thread::hardware_concurrency(), RUN_SECONDS);
+    for (int sessions : sizes) run(sessions);
+    return 0;
+}
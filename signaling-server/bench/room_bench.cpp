@@ -0,0 +1,293 @@
+// Room benchmark: presence fan-out of one server-wide list vs. rooms with a shared payload
+//
+// Legacy model: handleRegister() as it was before rooms. Every newcomer gets the peer list of
+// all registered sessions, and PEER_JOINED is re-serialized once per existing session with
+// that session's id in "to", so a register storm of N clients serializes N^2 / 2 messages.
+//
+// Rooms model: the newcomer joins a RoomRegistry room and gets that room's members.
+// PEER_JOINED / PEER_LEFT are serialized once, addressed to "All", and the same string is
+// handed to every recipient, grouped per I/O thread as SignalingServer::broadcast() does.
+// Handing messages to the I/O threads is modelled by appending to in-memory queues; the
+// cost of Qt's cross-thread events, which rooms also cut to one per I/O thread, is not
+// included.
+//
+// For each session count the sessions are registered first, then a new client repeatedly
+// registers and leaves. Join rows time the register alone, leave rows time the disconnect
+// (the legacy server sent nothing on leave). Room size = session count is the default room,
+// i.e. clients that send no room id.
+//
+// Usage: room_bench [sessions...]   (default: 1000 10000)
+#include "src/SessionRegistry.h"
+#include "src/RoomRegistry.h"
+
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+#include <QUuid>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const double RUN_SECONDS = 0.5;   // timed work per row, at least one operation
+const int IO_THREADS = 2;         // recipients are grouped per I/O thread, like the server's default
+const int ROOM_SIZES[] = { 100, 10 };
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+QString newId()
+{
+    return QUuid::createUuid().toString(QUuid::Id128);
+}
+
+/**
+* @struct Traffic
+* @brief What one row produced: messages, bytes serialized, bytes handed to the sockets.
+*/
+struct Traffic {
+    quint64 operations = 0;
+    quint64 messages = 0;
+    quint64 serializedBytes = 0;
+    quint64 sentBytes = 0;
+    double seconds = 0;
+};
+
+/**
+* @struct Outbox
+* @brief Stand-in for the I/O threads' queues; cleared after every operation.
+*/
+struct Outbox {
+    std::vector<std::pair<QString, QString>> messages;   ///< One entry per recipient (legacy).
+    QHash<int, QStringList> batches[IO_THREADS];         ///< Recipients per shared payload (rooms).
+    std::vector<QString> payloads;                       ///< Payloads of the batches.
+
+    void clear()
+    {
+        messages.clear();
+        for (QHash<int, QStringList>& batch : batches) batch.clear();
+        payloads.clear();
+    }
+};
+
+QString serialize(const QJsonObject& json, Traffic* traffic)
+{
+    QString payload = QJsonDocument(json).toJson(QJsonDocument::Compact);
+    traffic->serializedBytes += payload.toUtf8().size();
+    return payload;
+}
+
+// REGISTER_SUCCESS, as the server builds it in both models
+QString registerSuccess(const QString& id, const QString& room, const QStringList& members, bool withRoom,
+    Traffic* traffic)
+{
+    QJsonArray peers;
+    for (const QString& peerId : members) {
+        if (peerId != id) peers.append(peerId);
+    }
+    QJsonObject data;
+    data.insert("peerId", id);
+    if (withRoom) data.insert("room", room);
+    data.insert("message", "Welcome!");
+    data.insert("peers", peers);
+
+    QJsonObject json;
+    json.insert("type", "REGISTER_SUCCESS");
+    json.insert("from", "Server");
+    json.insert("to", id);
+    json.insert("data", data);
+    return serialize(json, traffic);
+}
+
+// The server's previous handleRegister(), reproduced as-is
+void legacyRegister(SessionRegistry& registry, const QString& srcId, Outbox& out, Traffic* traffic)
+{
+    const bool added = registry.add(srcId);
+    SessionRegistry::SnapshotPtr snapshot = registry.snapshot();
+
+    const QString ret = registerSuccess(srcId, QString(), snapshot->ids, false, traffic);
+    out.messages.emplace_back(srcId, ret);
+    traffic->sentBytes += ret.toUtf8().size();
+    ++traffic->messages;
+
+    if (added && snapshot->ids.size() > 1) {
+        QJsonObject joinData;
+        joinData.insert("id", srcId);
+
+        QJsonObject jsonNotify;
+        jsonNotify.insert("type", "PEER_JOINED");
+        jsonNotify.insert("from", "Server");
+        jsonNotify.insert("to", QJsonValue::Null);
+        jsonNotify.insert("data", joinData);
+
+        for (const QString& targetId : snapshot->ids) {
+            if (targetId == srcId) continue;
+            jsonNotify["to"] = targetId;
+            const QString notifyPayload = serialize(jsonNotify, traffic);
+            out.messages.emplace_back(targetId, notifyPayload);
+            traffic->sentBytes += notifyPayload.toUtf8().size();
+            ++traffic->messages;
+        }
+    }
+}
+
+// SignalingServer::presenceMessage() + broadcast()
+void roomBroadcast(const char* type, const RoomRegistry::MembersPtr& members, const QString& id, const QString& room,
+    Outbox& out, Traffic* traffic)
+{
+    QJsonObject data;
+    data.insert("id", id);
+    data.insert("room", room);
+    QJsonObject json;
+    json.insert("type", type);
+    json.insert("from", "Server");
+    json.insert("to", "All");
+    json.insert("data", data);
+    const QString payload = serialize(json, traffic);
+    const quint64 size = payload.toUtf8().size();
+
+    const int batch = static_cast<int>(out.payloads.size());
+    out.payloads.push_back(payload);
+    for (const QString& targetId : members->ids) {
+        if (targetId == id) continue;
+        out.batches[qHash(targetId) % IO_THREADS][batch].append(targetId);
+        traffic->sentBytes += size;
+        ++traffic->messages;
+    }
+}
+
+// handleRegister() with rooms
+void roomRegister(RoomRegistry& rooms, const QString& srcId, const QString& room, Outbox& out, Traffic* traffic)
+{
+    const RoomRegistry::Change change = rooms.join(srcId, room);
+    const QString ret = registerSuccess(srcId, room, change.members->ids, true, traffic);
+    out.messages.emplace_back(srcId, ret);
+    traffic->sentBytes += ret.toUtf8().size();
+    ++traffic->messages;
+
+    if (change.joined && change.members->ids.size() > 1) {
+        roomBroadcast("PEER_JOINED", change.members, srcId, room, out, traffic);
+    }
+}
+
+// onDisconnected() with rooms
+void roomLeave(RoomRegistry& rooms, const QString& srcId, Outbox& out, Traffic* traffic)
+{
+    QString room;
+    RoomRegistry::MembersPtr remaining;
+    if (rooms.leave(srcId, &room, &remaining)) {
+        roomBroadcast("PEER_LEFT", remaining, srcId, room, out, traffic);
+    }
+}
+
+QString roomName(int index, int roomSize, int sessions)
+{
+    // The default room holds everyone; otherwise consecutive sessions share a room
+    return roomSize >= sessions ? QString() : QStringLiteral("room-%1").arg(index / roomSize);
+}
+
+void printHeader()
+{
+    std::printf("  %-24s %9s %12s %11s %15s %12s %9s\n", "mode", "room size", "ops/s", "msgs/op",
+        "serialized KB/op", "sent KB/op", "speedup");
+}
+
+void printRow(const char* mode, int roomSize, const Traffic& t, double baseline)
+{
+    const double rate = t.operations / t.seconds;
+    const double ops = static_cast<double>(t.operations);
+    std::printf("  %-24s %9d %12.0f %11.0f %15.1f %12.1f", mode, roomSize, rate, t.messages / ops,
+        t.serializedBytes / ops / 1024.0, t.sentBytes / ops / 1024.0);
+    if (baseline > 0) {
+        std::printf(" %8.1fx\n", rate / baseline);
+    }
+    else {
+        std::printf("\n");
+    }
+}
+
+void run(int sessions)
+{
+    std::printf("\n=== %d sessions ===\n", sessions);
+    printHeader();
+
+    std::vector<QString> ids;
+    ids.reserve(sessions);
+    for (int i = 0; i < sessions; ++i) ids.push_back(newId());
+    Outbox out;
+
+    // Legacy: one server-wide list
+    Traffic legacy;
+    {
+        SessionRegistry registry;
+        for (const QString& id : ids) registry.add(id);
+        while (legacy.operations == 0 || legacy.seconds < RUN_SECONDS) {
+            const QString id = newId();
+            const auto start = Clock::now();
+            legacyRegister(registry, id, out, &legacy);
+            legacy.seconds += secondsSince(start);
+            ++legacy.operations;
+            registry.remove(id);
+            out.clear();
+        }
+    }
+    const double baseline = legacy.operations / legacy.seconds;
+    printRow("legacy join", sessions, legacy, 0);
+
+    std::vector<int> roomSizes = { sessions };
+    for (int size : ROOM_SIZES) {
+        if (size < sessions) roomSizes.push_back(size);
+    }
+    std::mt19937 rng(7);
+    for (int roomSize : roomSizes) {
+        RoomRegistry rooms;
+        for (int i = 0; i < sessions; ++i) rooms.join(ids[i], roomName(i, roomSize, sessions));
+
+        Traffic join;
+        Traffic leave;
+        while (join.operations == 0 || join.seconds + leave.seconds < 2 * RUN_SECONDS) {
+            const QString id = newId();
+            const QString room = roomName(static_cast<int>(rng() % sessions), roomSize, sessions);
+
+            auto start = Clock::now();
+            roomRegister(rooms, id, room, out, &join);
+            join.seconds += secondsSince(start);
+            ++join.operations;
+            out.clear();
+
+            start = Clock::now();
+            roomLeave(rooms, id, out, &leave);
+            leave.seconds += secondsSince(start);
+            ++leave.operations;
+            out.clear();
+        }
+        printRow("rooms join", roomSize, join, baseline);
+        printRow("rooms leave (PEER_LEFT)", roomSize, leave, 0);
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::vector<int> sizes;
+    for (int i = 1; i < argc; ++i) sizes.push_back(std::max(2, std::atoi(argv[i])));
+    if (sizes.empty()) sizes = { 1000, 10000 };
+
+    std::printf("Hardware threads: %u, %.1fs per row\n", std::thread::hardware_concurrency(), RUN_SECONDS);
+    for (int sessions : sizes) run(sessions);
+    return 0;
+}
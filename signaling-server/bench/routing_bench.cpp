@@ -0,0 +1,232 @@
+// Relay benchmark: RoutingHeader fast path vs. the full QJsonDocument parse + rebuild
+//
+// Legacy path (dispatchMessage + handleOffer/handleAnswer/handleIce before the fast path):
+// toUtf8 -> QJsonDocument::fromJson -> read "type"/"to" -> build a new QJsonObject with
+// type/from/to/data -> toJson(Compact) -> QString for sigSendResponse.
+// Fast path: RoutingHeader::scan() over the QString, then forward() splices "from" into a
+// copy of the original text.
+//
+// 1. correctness  both paths' outputs parse to the same JSON object
+// 2. throughput   messages/s, input MB/s and heap allocations per message, per message kind
+//
+// Allocations are counted by wrapping malloc on glibc (covers Qt's containers); elsewhere
+// only operator new is counted, which misses most Qt allocations.
+//
+// Usage: routing_bench
+#include "src/RoutingHeader.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QString>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::atomic<uint64_t> g_allocations{ 0 };
+
+} // namespace
+
+#if defined(__GLIBC__)
+#define ALLOC_SOURCE "malloc"
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+
+void* malloc(size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+}
+#else
+#define ALLOC_SOURCE "operator new"
+void* operator new(size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+#endif
+
+namespace {
+
+const double RUN_SECONDS = 0.5;   // each timed scenario runs for about this long
+const QString SENDER = QStringLiteral("6f1c2a9e0b7d4e3f8a5c1d2e3f4a5b6c");
+const QString TARGET = QStringLiteral("0a1b2c3d4e5f60718293a4b5c6d7e8f9");
+
+using Clock = std::chrono::steady_clock;
+
+// A plausible SDP of roughly `bytes` characters: session header, then attribute lines
+QString makeSdp(int bytes)
+{
+    QString sdp = QStringLiteral("v=0\r\no=- 5236683884878235471 2 IN IP4 127.0.0.1\r\ns=-\r\nt=0 0\r\n"
+        "a=group:BUNDLE 0 1\r\na=msid-semantic: WMS\r\n"
+        "m=video 9 UDP/TLS/RTP/SAVPF 96 97 98\r\nc=IN IP4 0.0.0.0\r\n");
+    for (int line = 0; sdp.size() < bytes; ++line) {
+        sdp += QStringLiteral("a=rtcp-fb:%1 nack pli\r\na=fmtp:%1 level-asymmetry-allowed=1;packetization-mode=1;"
+            "profile-level-id=42e01f\r\na=ssrc:%2 cname:screen\r\n").arg(96 + line % 3).arg(1000 + line);
+    }
+    return sdp;
+}
+
+QString makeMessage(const char* type, const QJsonObject& data)
+{
+    QJsonObject message;
+    message.insert("type", type);
+    message.insert("from", SENDER);   // clients fill it in, the server must overwrite it
+    message.insert("to", TARGET);
+    message.insert("data", data);
+    return QString::fromUtf8(QJsonDocument(message).toJson(QJsonDocument::Compact));
+}
+
+struct Kind {
+    std::string name;
+    QString payload;
+};
+
+// Mirrors dispatchMessage() + handleOffer() before the fast path
+QString legacyRelay(const QString& payload, const QString& srcId)
+{
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(payload.toUtf8(), &error);
+    if (error.error != QJsonParseError::NoError || doc.isNull()) return QString();
+
+    QJsonObject root = doc.object();
+    if (!root.contains("type") || !root["type"].isString()) return QString();
+    if (!root.contains("to") || !root["to"].isString()) return QString();
+    // Both paths need the target id as a QString for isOnline() / sigSendResponse()
+    const QString targetId = root["to"].toString();
+
+    QJsonObject forward;
+    forward.insert("type", root["type"].toString());
+    forward.insert("from", srcId);
+    forward.insert("to", targetId);
+    forward.insert("data", root.contains("data") ? root["data"] : QJsonValue(QJsonObject()));
+    return targetId.isEmpty() ? QString() : QString(QJsonDocument(forward).toJson(QJsonDocument::Compact));
+}
+
+QString fastRelay(const QString& payload, const QString& srcId)
+{
+    RoutingHeader route;
+    if (!route.scan(payload) || !route.isRelay()) return QString();
+    const QString targetId = route.to().toString();
+    return targetId.isEmpty() ? QString() : route.forward(payload, srcId);
+}
+
+bool checkCorrectness(const std::vector<Kind>& kinds)
+{
+    bool ok = true;
+    for (const Kind& kind : kinds) {
+        // Relay as a sender other than the one in the payload, so a kept client "from" shows up
+        const QJsonObject expected = QJsonDocument::fromJson(legacyRelay(kind.payload, TARGET).toUtf8()).object();
+        const QJsonObject actual = QJsonDocument::fromJson(fastRelay(kind.payload, TARGET).toUtf8()).object();
+        const bool same = !expected.isEmpty() && actual == expected;
+        std::printf("[check] %-12s same as legacy: %s\n", kind.name.c_str(), same ? "yes" : "NO");
+        ok = ok && same;
+    }
+    return ok;
+}
+
+struct Result {
+    double messagesPerSecond = 0;
+    double megabytesPerSecond = 0;
+    double allocationsPerMessage = 0;
+};
+
+// Runs relay() over the payload in batches until RUN_SECONDS elapse
+template<class Relay>
+Result measure(const QString& payload, Relay&& relay)
+{
+    const int batch = 32;
+    uint64_t messages = 0;
+    size_t sink = 0;   // keeps the results from being optimized away
+    const uint64_t allocationsBefore = g_allocations.load(std::memory_order_relaxed);
+    const auto start = Clock::now();
+    double elapsed = 0;
+    do {
+        for (int i = 0; i < batch; ++i) sink += relay(payload, SENDER).size();
+        messages += batch;
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (elapsed < RUN_SECONDS);
+    const uint64_t allocations = g_allocations.load(std::memory_order_relaxed) - allocationsBefore;
+
+    Result result;
+    result.messagesPerSecond = messages / elapsed;
+    // UTF-16 in memory, but clients send UTF-8 and SDP is ASCII: count one byte per character
+    result.megabytesPerSecond = result.messagesPerSecond * payload.size() / 1e6;
+    result.allocationsPerMessage = static_cast<double>(allocations) / messages;
+    if (sink == 0) std::printf("(empty output)\n");
+    return result;
+}
+
+void runThroughput(const std::vector<Kind>& kinds)
+{
+    std::printf("\n%-12s %8s %-7s %14s %10s %12s\n", "message", "bytes", "path", "msgs/s", "MB/s", "allocs/msg");
+    for (const Kind& kind : kinds) {
+        const Result legacy = measure(kind.payload, legacyRelay);
+        const Result fast = measure(kind.payload, fastRelay);
+        std::printf("%-12s %8lld %-7s %14.0f %10.1f %12.1f\n", kind.name.c_str(), static_cast<long long>(kind.payload.size()),
+            "legacy", legacy.messagesPerSecond, legacy.megabytesPerSecond, legacy.allocationsPerMessage);
+        std::printf("%-12s %8s %-7s %14.0f %10.1f %12.1f   (%.1fx)\n", "", "", "fast", fast.messagesPerSecond,
+            fast.megabytesPerSecond, fast.allocationsPerMessage, fast.messagesPerSecond / legacy.messagesPerSecond);
+    }
+}
+
+} // namespace
+
+int main()
+{
+    QJsonObject ice;
+    ice.insert("candidate", "candidate:842163049 1 udp 1677729535 203.0.113.7 46154 typ srflx raddr 192.168.1.10 "
+        "rport 46154 generation 0 ufrag EsAw network-cost 999");
+    ice.insert("mid", "0");
+
+    std::vector<Kind> kinds;
+    kinds.push_back({ "ICE", makeMessage("ICE", ice) });
+    for (int bytes : { 2 * 1024, 8 * 1024, 32 * 1024 }) {
+        QJsonObject sdp;
+        sdp.insert("sdp", makeSdp(bytes));
+        sdp.insert("type", "offer");
+        kinds.push_back({ "OFFER " + std::to_string(bytes / 1024) + "K", makeMessage("OFFER", sdp) });
+    }
+
+    std::printf("Allocations counted via %s, %.1fs per scenario\n", ALLOC_SOURCE, RUN_SECONDS);
+    const bool ok = checkCorrectness(kinds);
+    runThroughput(kinds);
+
+    if (!ok) {
+        std::printf("\nCorrectness check FAILED\n");
+        return 1;
+    }
+    return 0;
+}
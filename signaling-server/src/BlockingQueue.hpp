@@ -1,6 +1,7 @@
 #ifndef __BLOCKING_QUEUE_HPP__  
 #define __BLOCKING_QUEUE_HPP__  
 
+#include "TaskQueue.hpp"
 #include <QQueue>  
 #include <QMutex>  
 #include <QWaitCondition>  
@@ -18,7 +19,7 @@
 * @tparam T The type of elements stored in the queue.  
 */  
 template<class T>  
-class BlockingQueue  
+class BlockingQueue : public TaskQueue<T>  
 {  
 public:
  using bqPtr = std::shared_ptr<BlockingQueue<T>>;
@@ -38,7 +39,7 @@ public:
   * @param ele The element to be added to the queue.  
   * @return true if the element is successfully added.  
   */  
- bool push(const T& ele) {  
+ bool push(const T& ele) override {  
      {  
          QMutexLocker guard(&_mutex);  
          _queue.enqueue(ele);  
@@ -51,12 +52,13 @@ public:
   * @brief Pops an element from the queue with a timeout.  
   * @param value Reference to store the dequeued element.  
   * @param timeoutMs The maximum time to wait in milliseconds.  
-  * @return true if an element is successfully dequeued, false if timeout occurs.  
+  * @return true if an element is successfully dequeued, false if timeout occurs or notifyAll() is called.  
   */  
- bool pop(T& value, int timeoutMs) {  
+ bool pop(T& value, int timeoutMs) override {  
      QMutexLocker guard(&_mutex);  
+     const quint64 generation = _generation;
      while (_queue.isEmpty()) {  
-         if (!_cond.wait(&_mutex, timeoutMs)) { 
+         if (!_cond.wait(&_mutex, timeoutMs) || generation != _generation) { 
              if (_queue.isEmpty()) {
                  return false;
              }  
@@ -71,7 +73,7 @@ public:
   * @param value Reference to store the dequeued element.  
   * @return true if an element is successfully dequeued, false otherwise.  
   */  
- bool tryPop(T& value) {
+ bool tryPop(T& value) override {
      QMutexLocker guard(&_mutex);
      if (_queue.isEmpty()) return false;
      value = std::move(_queue.dequeue());
@@ -82,7 +84,7 @@ public:
   * @brief Gets the current size of the queue.  
   * @return The number of elements in the queue.  
   */  
- size_t size() {  
+ size_t size() override {  
      QMutexLocker guard(&_mutex);  
      return _queue.size();  
  }  
@@ -91,7 +93,7 @@ public:
   * @brief Checks if the queue is empty.  
   * @return true if the queue is empty, false otherwise.  
   */  
- bool empty() {  
+ bool empty() override {  
      QMutexLocker guard(&_mutex);  
      return _queue.isEmpty();  
  }  
@@ -105,9 +107,11 @@ public:
  }  
 
  /**  
-  * @brief Notifies all waiting threads.  
+  * @brief Notifies all waiting threads; their pop() returns false if the queue is still empty.  
   */  
- void notifyAll() {  
+ void notifyAll() override {  
+     QMutexLocker guard(&_mutex);  
+     ++_generation;  
      _cond.wakeAll();  
      return;  
  }  
@@ -116,6 +120,7 @@ private:
  QQueue<T> _queue; ///< The underlying queue to store elements.  
  QMutex _mutex; ///< Mutex to ensure thread safety.  
  QWaitCondition _cond; ///< Condition variable for synchronization.  
+ quint64 _generation = 0; ///< Bumped by notifyAll() so that woken waiters give up.  
 };  
 
 #endif // __BLOCKING_QUEUE_HPP__
@@ -97,6 +97,22 @@ inline SignalingType string_to_stype(const QString& str) {
   return SignalingType::UNKNOWN;  
 }  
 
+const int MAX_STATELESS_PAYLOAD = 512;   ///< Longer messages are never classified as stateless.  
+
+/**  
+* @brief Whether a message of this type may be processed out of order with the sender's other messages.  
+*  
+* Only a type that reads and writes no per-session state may qualify. None does today:  
+* REGISTER_REQUEST joins (or moves) the session between rooms, which decides whether the sender's  
+* following OFFER/ANSWER/ICE are reachable, and the relayed types must reach the peer in the order  
+* they were sent. So every message stays on its client's shard,  
+* and SignalingServer starts the WorkerPool without a stealing predicate.  
+*/  
+inline bool is_stateless_stype(SignalingType type) {  
+  Q_UNUSED(type);  
+  return false;  
+}  
+
 /**  
 * @brief Converts a SignalingType to its string representation.  
 * @param type The SignalingType value.  
@@ -0,0 +1,146 @@
+#include "IoLoop.h"
+#include "SignalingServer.h"
+
+// Acceptor >>>>>>>>>>>>>>>>>
+
+Acceptor::Acceptor(QObject* parent)
+    : QTcpServer(parent)
+{}
+
+void Acceptor::incomingConnection(qintptr descriptor)
+{
+    emit sigIncoming(descriptor);
+}
+
+// SessionDirectory >>>>>>>>>>>>>>>>>
+
+SessionDirectory::Shard& SessionDirectory::shardFor(const QString& clientId)
+{
+    return _shards[qHash(clientId) % SHARD_COUNT];
+}
+
+const SessionDirectory::Shard& SessionDirectory::shardFor(const QString& clientId) const
+{
+    return _shards[qHash(clientId) % SHARD_COUNT];
+}
+
+void SessionDirectory::insert(const QString& clientId, IoLoop* loop)
+{
+    Shard& shard = shardFor(clientId);
+    QWriteLocker guard(&shard.lock);
+    shard.owners.insert(clientId, loop);
+}
+
+void SessionDirectory::remove(const QString& clientId)
+{
+    Shard& shard = shardFor(clientId);
+    QWriteLocker guard(&shard.lock);
+    shard.owners.remove(clientId);
+}
+
+IoLoop* SessionDirectory::find(const QString& clientId) const
+{
+    const Shard& shard = shardFor(clientId);
+    QReadLocker guard(&shard.lock);
+    return shard.owners.value(clientId, nullptr);
+}
+
+// IoLoop >>>>>>>>>>>>>>>>>
+
+IoLoop::IoLoop(int id, SessionDirectory* directory, QObject* parent)
+    : QObject(parent),
+    _loopId(id),
+    _server(new QWebSocketServer(QStringLiteral("Signaling Server"), QWebSocketServer::NonSecureMode, this)),
+    _directory(directory),
+    _sessionCount(0)
+{
+    assert(directory != nullptr);
+    QObject::connect(_server, &QWebSocketServer::newConnection, this, &IoLoop::onNewConnection);
+}
+
+IoLoop::~IoLoop()
+{
+    for (auto it = _sessions.cbegin(); it != _sessions.cend(); ++it) {
+        _directory->remove(it.key());
+    }
+}
+
+void IoLoop::addConnection(qintptr descriptor)
+{
+    QTcpSocket* socket = new QTcpSocket();
+    if (!socket->setSocketDescriptor(descriptor)) {
+        CRITICAL() << "IoLoop" << _loopId << "cannot adopt socket" << descriptor << ":" << socket->errorString();
+        delete socket;
+        return;
+    }
+    // The handshake runs on this thread; the upgraded socket arrives through newConnection
+    _server->handleConnection(socket);
+}
+
+void IoLoop::post(const QString& clientId, const QString& message)
+{
+    QMetaObject::invokeMethod(this, [this, clientId, message]() {
+        send(clientId, message);
+        }, Qt::QueuedConnection);
+}
+
+void IoLoop::post(const QStringList& clientIds, const QString& message)
+{
+    QMetaObject::invokeMethod(this, [this, clientIds, message]() {
+        for (const QString& clientId : clientIds) {
+            send(clientId, message);
+        }
+        }, Qt::QueuedConnection);
+}
+
+int IoLoop::sessionCount() const
+{
+    return _sessionCount.loadRelaxed();
+}
+
+void IoLoop::closeAll(QWebSocketProtocol::CloseCode code, const QString& reason)
+{
+    // close() may drop a session synchronously, so iterate over a copy
+    const QList<ClientSession*> sessions = _sessions.values();
+    for (ClientSession* session : sessions) {
+        session->close(code, reason);
+    }
+}
+
+void IoLoop::onNewConnection()
+{
+    while (_server->hasPendingConnections()) {
+        QWebSocket* webSocket = _server->nextPendingConnection();
+        ClientSession* session = new ClientSession(webSocket, this);
+        const QString clientId = session->id();
+
+        _sessions.insert(clientId, session);
+        _directory->insert(clientId, this);
+        _sessionCount.fetchAndAddRelaxed(1);
+
+        QObject::connect(session, &ClientSession::sigDataReady, this, &IoLoop::sigDataReady);
+        QObject::connect(session, &ClientSession::sigDisconnected, this, &IoLoop::onSessionDisconnected);
+    }
+}
+
+void IoLoop::onSessionDisconnected(const QString& clientId)
+{
+    ClientSession* session = _sessions.take(clientId);
+    if (session == nullptr) {
+        return;
+    }
+    _directory->remove(clientId);
+    _sessionCount.fetchAndSubRelaxed(1);
+    session->deleteLater();
+    emit sigDisconnected(clientId);
+}
+
+void IoLoop::send(const QString& clientId, const QString& message)
+{
+    ClientSession* session = _sessions.value(clientId, nullptr);
+    if (session == nullptr) {
+        WARNING() << clientId << " has already offlined";
+        return;
+    }
+    session->sendData(message);
+}
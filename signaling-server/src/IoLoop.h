@@ -0,0 +1,188 @@
+#ifndef __IO_LOOP_H__
+#define __IO_LOOP_H__
+
+#include "Common.hpp"
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QReadWriteLock>
+#include <QStringList>
+#include <array>
+
+class ClientSession;
+class IoLoop;
+
+/**
+* @class Acceptor
+* @brief The listening socket. Hands every accepted descriptor on, without creating a socket object.
+*
+* A socket object belongs to the thread that creates it, so accepting through
+* nextPendingConnection() would pin every connection to the listener's thread. The raw
+* descriptor is instead passed to an IoLoop, which wraps it on its own thread.
+*/
+class Acceptor : public QTcpServer
+{
+    Q_OBJECT
+
+public:
+    explicit Acceptor(QObject* parent = nullptr);
+
+signals:
+    /**
+    * @brief Emitted on the listener's thread for every accepted connection.
+    * @param descriptor The native socket descriptor, not yet owned by any object.
+    */
+    void sigIncoming(qintptr descriptor);
+
+protected:
+    void incomingConnection(qintptr descriptor) override;
+};
+
+/**
+* @class SessionDirectory
+* @brief Thread-safe map from a client id to the IoLoop that owns its socket.
+*
+* Sharded like SessionRegistry: workers look up the target of every response, so
+* lookups for different clients rarely touch the same lock. Unlike the registry it
+* holds every connected session, registered or not.
+*/
+class SessionDirectory
+{
+public:
+    static const int SHARD_COUNT = 16;
+
+    SessionDirectory() = default;
+
+    Q_DISABLE_COPY(SessionDirectory)
+
+    /**
+    * @brief Records the IoLoop owning a new session.
+    */
+    void insert(const QString& clientId, IoLoop* loop);
+
+    /**
+    * @brief Forgets a closed session.
+    */
+    void remove(const QString& clientId);
+
+    /**
+    * @brief The IoLoop owning a session, or nullptr if it is not connected.
+    */
+    IoLoop* find(const QString& clientId) const;
+
+private:
+    /**
+    * @struct Shard
+    * @brief One lock and the ids hashed to it; cache-line aligned to avoid false sharing.
+    */
+    struct alignas(64) Shard {
+        mutable QReadWriteLock lock;
+        QHash<QString, IoLoop*> owners;
+    };
+
+    Shard& shardFor(const QString& clientId);
+    const Shard& shardFor(const QString& clientId) const;
+
+private:
+    std::array<Shard, SHARD_COUNT> _shards;   ///< Sharded id -> IoLoop maps.
+};
+
+/**
+* @class IoLoop
+* @brief An I/O thread's share of the client sessions.
+*
+* Each IoLoop lives on its own QThread with its own event loop. It upgrades the
+* connections given to it with a non-listening QWebSocketServer, so the QWebSocket and
+* its ClientSession are created on, and only ever used from, that thread. Received
+* messages are forwarded through sigDataReady on the I/O thread; responses reach the
+* session through post(), which may be called from any thread.
+*/
+class IoLoop : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+    * @brief Constructs an IoLoop; move it to its thread before adding connections.
+    * @param id Index of the loop, for logging.
+    * @param directory Directory in which the loop records the sessions it owns.
+    * @param parent Pointer to the parent QObject (default is nullptr).
+    */
+    explicit IoLoop(int id, SessionDirectory* directory, QObject* parent = nullptr);
+
+    ~IoLoop();
+
+    /**
+    * @brief Takes over an accepted connection. Must run on the loop's thread.
+    * @param descriptor The native socket descriptor from Acceptor::sigIncoming.
+    */
+    void addConnection(qintptr descriptor);
+
+    /**
+    * @brief Queues a message for one of this loop's sessions. Callable from any thread.
+    * @param clientId The target session.
+    * @param message The message to send.
+    */
+    void post(const QString& clientId, const QString& message);
+
+    /**
+    * @brief Queues one message for several of this loop's sessions, as a single event. Callable from any thread.
+    * @param clientIds The target sessions.
+    * @param message The message to send, shared by all targets.
+    */
+    void post(const QStringList& clientIds, const QString& message);
+
+    /**
+    * @brief Number of open sessions; callable from any thread.
+    */
+    int sessionCount() const;
+
+    /**
+    * @brief Closes every session of the loop. Must run on the loop's thread.
+    *
+    * Responses posted before the call are written first. Each session leaves the loop
+    * once its client has acknowledged the close or the connection has dropped.
+    * @param code The WebSocket close code.
+    * @param reason The close reason sent to the clients.
+    */
+    void closeAll(QWebSocketProtocol::CloseCode code, const QString& reason);
+
+signals:
+    /**
+    * @brief Emitted on the loop's thread when a session receives a message.
+    * @param clientId The ID of the source client.
+    * @param data The message.
+    */
+    void sigDataReady(const QString& clientId, const QString& data);
+
+    /**
+    * @brief Emitted on the loop's thread after a session has closed and left the directory.
+    * @param clientId The ID of the closed session.
+    */
+    void sigDisconnected(const QString& clientId);
+
+private:
+    /**
+    * @brief Adopts the WebSocket connections whose handshake has completed.
+    */
+    void onNewConnection();
+
+    /**
+    * @brief Drops a closed session.
+    * @param clientId The ID of the closed session.
+    */
+    void onSessionDisconnected(const QString& clientId);
+
+    /**
+    * @brief Sends a message on the loop's thread.
+    */
+    void send(const QString& clientId, const QString& message);
+
+private:
+    int _loopId;                                ///< Index of the loop.
+    QWebSocketServer* _server;                  ///< Performs the handshakes; never listens.
+    QHash<QString, ClientSession*> _sessions;   ///< This loop's sessions; touched only on its thread.
+    SessionDirectory* _directory;               ///< Shared id -> IoLoop directory.
+    QAtomicInt _sessionCount;                   ///< Size of _sessions, readable from other threads.
+};
+
+#endif // __IO_LOOP_H__
@@ -0,0 +1,283 @@
+#ifndef __RING_QUEUE_HPP__
+#define __RING_QUEUE_HPP__
+
+#include "TaskQueue.hpp"
+#include <QMutex>
+#include <QWaitCondition>
+#include <QDeadlineTimer>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+/**
+* @class RingQueue
+* @brief A bounded lock-free multi-producer / multi-consumer queue.
+*
+* The ring follows Dmitry Vyukov's bounded MPMC design: every cell carries a sequence
+* number that tells producers and consumers whether it is free for the current lap, so
+* push and pop each cost one CAS on their own cache line and never take a lock.
+*
+* Waiting is adaptive. An empty pop (or a push into a full ring) first spins for a number
+* of rounds that grows while spinning pays off and shrinks while it does not, then parks
+* on a QWaitCondition. Parked threads are counted, so the fast path only touches the
+* mutex when someone is actually asleep.
+*
+* @tparam T The type of elements stored in the queue; must be default constructible.
+*/
+template<class T>
+class RingQueue : public TaskQueue<T>
+{
+public:
+    using rqPtr = std::shared_ptr<RingQueue<T>>;
+
+    static const size_t DEFAULT_CAPACITY = 16384;
+
+    /**
+    * @brief Constructs a RingQueue.
+    * @param capacity The number of slots, rounded up to a power of two (at least 2).
+    */
+    explicit RingQueue(size_t capacity = DEFAULT_CAPACITY)
+        : _cells(roundUp(capacity)), _mask(_cells.size() - 1)
+    {
+        for (size_t i = 0; i < _cells.size(); ++i) {
+            _cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~RingQueue() {}
+
+    Q_DISABLE_COPY(RingQueue)
+
+    /**
+    * @brief Pushes an element without blocking.
+    * @param ele The element to be added to the queue.
+    * @return true if the element is added, false if the ring is full.
+    */
+    bool tryPush(const T& ele) {
+        if (!enqueue(ele)) return false;
+        wake(_popWaiters, _notEmpty);
+        return true;
+    }
+
+    /**
+    * @brief Pushes an element, waiting for space while the ring is full.
+    * @param ele The element to be added to the queue.
+    * @return true once the element is added.
+    */
+    bool push(const T& ele) override {
+        if (tryPush(ele)) return true;
+        if (spin([&]() { return tryPush(ele); })) return true;
+
+        QMutexLocker guard(&_mutex);
+        _pushWaiters.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while (!enqueue(ele)) {
+            _notFull.wait(&_mutex);
+        }
+        _pushWaiters.fetch_sub(1, std::memory_order_relaxed);
+        wakeLocked(_popWaiters, _notEmpty);
+        return true;
+    }
+
+    /**
+    * @brief Pops an element, spinning briefly and then parking for up to timeoutMs.
+    * @param value Reference to store the dequeued element.
+    * @param timeoutMs The maximum time to wait in milliseconds.
+    * @return true if an element is dequeued, false on timeout or notifyAll().
+    */
+    bool pop(T& value, int timeoutMs) override {
+        if (tryPop(value)) return true;
+        if (spin([&]() { return tryPop(value); })) return true;
+
+        QMutexLocker guard(&_mutex);
+        const quint64 generation = _generation;
+        _popWaiters.fetch_add(1, std::memory_order_relaxed);
+        // Pairs with the fence in wake(): either the producer sees this waiter,
+        // or the dequeue() below sees its element
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        QDeadlineTimer deadline(timeoutMs);
+        bool popped = dequeue(value);
+        while (!popped && generation == _generation) {
+            if (!_notEmpty.wait(&_mutex, deadline)) {
+                popped = dequeue(value);
+                break;
+            }
+            popped = dequeue(value);
+        }
+        _popWaiters.fetch_sub(1, std::memory_order_relaxed);
+        if (popped) wakeLocked(_pushWaiters, _notFull);
+        return popped;
+    }
+
+    /**
+    * @brief Pops an element without blocking.
+    * @param value Reference to store the dequeued element.
+    * @return true if an element is dequeued, false if the ring is empty.
+    */
+    bool tryPop(T& value) override {
+        if (!dequeue(value)) return false;
+        wake(_pushWaiters, _notFull);
+        return true;
+    }
+
+    /**
+    * @brief Gets the number of elements; approximate while other threads are active.
+    */
+    size_t size() override {
+        const size_t tail = _dequeuePos.load(std::memory_order_relaxed);
+        const size_t head = _enqueuePos.load(std::memory_order_relaxed);
+        return head > tail ? head - tail : 0;
+    }
+
+    /**
+    * @brief Checks if the queue is empty.
+    */
+    bool empty() override {
+        return size() == 0;
+    }
+
+    /**
+    * @brief Gets the number of slots.
+    */
+    size_t capacity() const {
+        return _cells.size();
+    }
+
+    /**
+    * @brief Wakes every parked pop(); they return false even if the ring stays empty.
+    */
+    void notifyAll() override {
+        QMutexLocker guard(&_mutex);
+        ++_generation;
+        _notEmpty.wakeAll();
+    }
+
+private:
+    static const int MIN_SPIN = 16;
+    static const int MAX_SPIN = 4096;
+
+    /**
+    * @struct Cell
+    * @brief One slot; its own cache line, so neighbouring slots do not false-share.
+    */
+    struct alignas(64) Cell {
+        std::atomic<size_t> seq;
+        T data;
+    };
+
+    static size_t roundUp(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        return size;
+    }
+
+    // Claims the slot at the enqueue position once its sequence says it is free for this lap
+    bool enqueue(const T& ele) {
+        size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &_cells[pos & _mask];
+            const size_t seq = cell->seq.load(std::memory_order_acquire);
+            const intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (dif == 0) {
+                if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            }
+            else if (dif < 0) {
+                return false;
+            }
+            else {
+                pos = _enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = ele;
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Takes the slot at the dequeue position once its producer has published it
+    bool dequeue(T& value) {
+        size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &_cells[pos & _mask];
+            const size_t seq = cell->seq.load(std::memory_order_acquire);
+            const intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (dif == 0) {
+                if (_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            }
+            else if (dif < 0) {
+                return false;
+            }
+            else {
+                pos = _dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        // Move out so the slot does not keep the payload alive until the next lap
+        value = std::move(cell->data);
+        cell->data = T();
+        cell->seq.store(pos + _mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    static void cpuRelax() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#else
+        std::this_thread::yield();
+#endif
+    }
+
+    // Retries attempt() for the current spin budget; the budget doubles when spinning
+    // succeeds and halves when the caller ends up parking
+    template<class Attempt>
+    bool spin(Attempt&& attempt) {
+        const int rounds = _spinRounds.load(std::memory_order_relaxed);
+        for (int i = 0; i < rounds; ++i) {
+            cpuRelax();
+            if ((i & 63) == 63) std::this_thread::yield();
+            if (attempt()) {
+                if (rounds < MAX_SPIN) _spinRounds.store(rounds * 2, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        if (rounds > MIN_SPIN) _spinRounds.store(rounds / 2, std::memory_order_relaxed);
+        return false;
+    }
+
+    void wake(std::atomic<int>& waiters, QWaitCondition& cond) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed) > 0) {
+            // Taking the mutex orders the wake after the waiter's last check
+            QMutexLocker guard(&_mutex);
+            cond.wakeOne();
+        }
+    }
+
+    // wake() for callers that already hold _mutex
+    void wakeLocked(std::atomic<int>& waiters, QWaitCondition& cond) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed) > 0) cond.wakeOne();
+    }
+
+private:
+    std::vector<Cell> _cells;                           ///< The ring; size is a power of two.
+    const size_t _mask;                                 ///< _cells.size() - 1.
+    alignas(64) std::atomic<size_t> _enqueuePos{ 0 };   ///< Next slot to fill.
+    alignas(64) std::atomic<size_t> _dequeuePos{ 0 };   ///< Next slot to drain.
+    alignas(64) std::atomic<int> _spinRounds{ MIN_SPIN };  ///< Adaptive spin budget.
+    std::atomic<int> _popWaiters{ 0 };                  ///< Threads parked in pop().
+    std::atomic<int> _pushWaiters{ 0 };                 ///< Threads parked in push().
+    QMutex _mutex;                                      ///< Guards parking only.
+    QWaitCondition _notEmpty;                           ///< Signalled after a push.
+    QWaitCondition _notFull;                            ///< Signalled after a pop.
+    quint64 _generation = 0;                            ///< Bumped by notifyAll(), under _mutex.
+};
+
+#endif // __RING_QUEUE_HPP__
@@ -0,0 +1,143 @@
+#include "RoomRegistry.h"
+
+RoomRegistry::RoomRegistry()
+    : _roomCount(0), _empty(std::make_shared<const Members>())
+{}
+
+RoomRegistry::~RoomRegistry()
+{}
+
+RoomRegistry::ClientShard& RoomRegistry::clientShard(const QString& clientId)
+{
+    return _clients[qHash(clientId) % SHARD_COUNT];
+}
+
+const RoomRegistry::ClientShard& RoomRegistry::clientShard(const QString& clientId) const
+{
+    return _clients[qHash(clientId) % SHARD_COUNT];
+}
+
+RoomRegistry::RoomShard& RoomRegistry::roomShard(const QString& roomId)
+{
+    return _rooms[qHash(roomId) % SHARD_COUNT];
+}
+
+const RoomRegistry::RoomShard& RoomRegistry::roomShard(const QString& roomId) const
+{
+    return _rooms[qHash(roomId) % SHARD_COUNT];
+}
+
+RoomRegistry::MembersPtr RoomRegistry::addMember(const QString& roomId, const QString& clientId)
+{
+    RoomShard& shard = roomShard(roomId);
+    QWriteLocker guard(&shard.lock);
+    auto it = shard.members.find(roomId);
+    if (it == shard.members.end()) {
+        it = shard.members.insert(roomId, _empty);
+        _roomCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Copy on write: readers keep the list they already hold
+    auto fresh = std::make_shared<Members>();
+    fresh->ids = (*it)->ids;
+    fresh->ids.append(clientId);
+
+    MembersPtr result = std::move(fresh);
+    it.value() = result;
+    return result;
+}
+
+RoomRegistry::MembersPtr RoomRegistry::removeMember(const QString& roomId, const QString& clientId)
+{
+    RoomShard& shard = roomShard(roomId);
+    QWriteLocker guard(&shard.lock);
+    auto it = shard.members.find(roomId);
+    if (it == shard.members.end()) {
+        return _empty;
+    }
+
+    auto fresh = std::make_shared<Members>(**it);
+    fresh->ids.removeOne(clientId);
+    if (fresh->ids.isEmpty()) {
+        shard.members.erase(it);
+        _roomCount.fetch_sub(1, std::memory_order_relaxed);
+        return _empty;
+    }
+
+    MembersPtr result = std::move(fresh);
+    it.value() = result;
+    return result;
+}
+
+RoomRegistry::Change RoomRegistry::join(const QString& clientId, const QString& roomId)
+{
+    Change change;
+    ClientShard& shard = clientShard(clientId);
+    QWriteLocker guard(&shard.lock);
+
+    auto it = shard.rooms.find(clientId);
+    if (it != shard.rooms.end()) {
+        if (it.value() == roomId) {
+            change.members = members(roomId);
+            return change;
+        }
+        change.moved = true;
+        change.previousRoom = it.value();
+        change.previousMembers = removeMember(change.previousRoom, clientId);
+        it.value() = roomId;
+    }
+    else {
+        shard.rooms.insert(clientId, roomId);
+    }
+
+    change.joined = true;
+    change.members = addMember(roomId, clientId);
+    return change;
+}
+
+bool RoomRegistry::leave(const QString& clientId, QString* roomId, MembersPtr* members)
+{
+    ClientShard& shard = clientShard(clientId);
+    QWriteLocker guard(&shard.lock);
+
+    auto it = shard.rooms.find(clientId);
+    if (it == shard.rooms.end()) {
+        return false;
+    }
+    *roomId = it.value();
+    shard.rooms.erase(it);
+    *members = removeMember(*roomId, clientId);
+    return true;
+}
+
+bool RoomRegistry::roomOf(const QString& clientId, QString* roomId) const
+{
+    const ClientShard& shard = clientShard(clientId);
+    QReadLocker guard(&shard.lock);
+
+    auto it = shard.rooms.constFind(clientId);
+    if (it == shard.rooms.cend()) {
+        return false;
+    }
+    *roomId = it.value();
+    return true;
+}
+
+bool RoomRegistry::sameRoom(const QString& clientId, const QString& otherId) const
+{
+    QString room;
+    QString otherRoom;
+    return roomOf(clientId, &room) && roomOf(otherId, &otherRoom) && room == otherRoom;
+}
+
+RoomRegistry::MembersPtr RoomRegistry::members(const QString& roomId) const
+{
+    const RoomShard& shard = roomShard(roomId);
+    QReadLocker guard(&shard.lock);
+    return shard.members.value(roomId, _empty);
+}
+
+int RoomRegistry::roomCount() const
+{
+    return _roomCount.load(std::memory_order_relaxed);
+}
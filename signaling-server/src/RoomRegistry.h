@@ -0,0 +1,133 @@
+#ifndef __ROOM_REGISTRY_H__
+#define __ROOM_REGISTRY_H__
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QReadWriteLock>
+#include <array>
+#include <atomic>
+#include <memory>
+
+/**
+* @class RoomRegistry
+* @brief Thread-safe room membership of the registered client sessions.
+*
+* A client is in at most one room; registering without a room id puts it in the default
+* room (the empty id), which behaves like the single room the server used to have.
+*
+* Two sharded maps, like SessionRegistry: client id -> room id, and room id -> members.
+* A room's member list is an immutable, shared copy replaced on every join or leave, so
+* the presence fan-out and the peer list of a REGISTER_SUCCESS iterate over it without
+* holding any lock, and the readers of one version share a single copy.
+*
+* Operations on one client are serialized by its shard lock, which is always taken
+* before a room shard lock. All methods may be called from any thread.
+*/
+class RoomRegistry
+{
+public:
+    /**
+    * @struct Members
+    * @brief Immutable list of a room's members.
+    */
+    struct Members {
+        QStringList ids;       ///< Member ids, in join order.
+    };
+    using MembersPtr = std::shared_ptr<const Members>;
+
+    /**
+    * @struct Change
+    * @brief What a join did, for the presence notifications.
+    */
+    struct Change {
+        bool joined = false;            ///< The client was not in the room before.
+        bool moved = false;             ///< The client left previousRoom to join.
+        QString previousRoom;           ///< Room left, valid if moved.
+        MembersPtr members;             ///< The room's members after the join, the client included.
+        MembersPtr previousMembers;     ///< previousRoom's remaining members, valid if moved.
+    };
+
+    static const int SHARD_COUNT = 16;
+
+    RoomRegistry();
+    ~RoomRegistry();
+
+    Q_DISABLE_COPY(RoomRegistry)
+
+    /**
+    * @brief Puts a client in a room, taking it out of the room it was in.
+    */
+    Change join(const QString& clientId, const QString& roomId);
+
+    /**
+    * @brief Takes a client out of its room.
+    * @param roomId Receives the room it was in.
+    * @param members Receives the room's remaining members.
+    * @return False if the client was in no room.
+    */
+    bool leave(const QString& clientId, QString* roomId, MembersPtr* members);
+
+    /**
+    * @brief The room of a client.
+    * @return False if the client is in no room.
+    */
+    bool roomOf(const QString& clientId, QString* roomId) const;
+
+    /**
+    * @brief Whether both clients are in the same room.
+    */
+    bool sameRoom(const QString& clientId, const QString& otherId) const;
+
+    /**
+    * @brief The members of a room; an empty list if nobody is in it.
+    */
+    MembersPtr members(const QString& roomId) const;
+
+    /**
+    * @brief Number of non-empty rooms.
+    */
+    int roomCount() const;
+
+private:
+    /**
+    * @struct ClientShard
+    * @brief One lock and the clients hashed to it; cache-line aligned to avoid false sharing.
+    */
+    struct alignas(64) ClientShard {
+        mutable QReadWriteLock lock;
+        QHash<QString, QString> rooms;          ///< Client id -> room id.
+    };
+
+    /**
+    * @struct RoomShard
+    * @brief One lock and the rooms hashed to it.
+    */
+    struct alignas(64) RoomShard {
+        mutable QReadWriteLock lock;
+        QHash<QString, MembersPtr> members;     ///< Room id -> members; empty rooms are dropped.
+    };
+
+    ClientShard& clientShard(const QString& clientId);
+    const ClientShard& clientShard(const QString& clientId) const;
+    RoomShard& roomShard(const QString& roomId);
+    const RoomShard& roomShard(const QString& roomId) const;
+
+    /**
+    * @brief Adds a member to a room's list; returns the new list.
+    */
+    MembersPtr addMember(const QString& roomId, const QString& clientId);
+
+    /**
+    * @brief Removes a member from a room's list; returns the remaining members.
+    */
+    MembersPtr removeMember(const QString& roomId, const QString& clientId);
+
+private:
+    std::array<ClientShard, SHARD_COUNT> _clients;    ///< Sharded client -> room maps.
+    std::array<RoomShard, SHARD_COUNT> _rooms;        ///< Sharded room -> members maps.
+    std::atomic<int> _roomCount;                      ///< Number of non-empty rooms.
+    MembersPtr _empty;                                ///< Shared empty member list.
+};
+
+#endif // __ROOM_REGISTRY_H__
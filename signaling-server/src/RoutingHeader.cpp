@@ -0,0 +1,175 @@
+#include "RoutingHeader.h"
+
+static bool isJsonSpace(QChar c)
+{
+    return c == u' ' || c == u'\t' || c == u'\n' || c == u'\r';
+}
+
+// Client-to-server types only; string_to_stype() would need an owning QString
+static SignalingType clientType(QStringView name)
+{
+    if (name == u"OFFER") return SignalingType::OFFER;
+    if (name == u"ANSWER") return SignalingType::ANSWER;
+    if (name == u"ICE") return SignalingType::ICE;
+    if (name == u"REGISTER_REQUEST") return SignalingType::REGISTER_REQUEST;
+    return SignalingType::UNKNOWN;
+}
+
+qsizetype RoutingHeader::skipSpace(QStringView text, qsizetype pos) const
+{
+    while (pos < text.size() && isJsonSpace(text[pos])) ++pos;
+    return pos;
+}
+
+qsizetype RoutingHeader::skipString(QStringView text, qsizetype pos, bool* escaped) const
+{
+    // pos is on the opening quote; returns the offset just past the closing one, or -1
+    for (++pos; pos < text.size(); ++pos) {
+        const QChar c = text[pos];
+        if (c == u'"') return pos + 1;
+        if (c == u'\\') {
+            if (escaped) *escaped = true;
+            ++pos;
+        }
+    }
+    return -1;
+}
+
+qsizetype RoutingHeader::skipValue(QStringView text, qsizetype pos) const
+{
+    if (pos >= text.size()) return -1;
+    const QChar first = text[pos];
+    if (first == u'"') return skipString(text, pos, nullptr);
+
+    if (first == u'{' || first == u'[') {
+        int depth = 0;
+        while (pos < text.size()) {
+            const QChar c = text[pos];
+            if (c == u'"') {
+                pos = skipString(text, pos, nullptr);
+                if (pos < 0) return -1;
+                continue;
+            }
+            if (c == u'{' || c == u'[') {
+                ++depth;
+            }
+            else if (c == u'}' || c == u']') {
+                if (--depth == 0) return pos + 1;
+            }
+            ++pos;
+        }
+        return -1;
+    }
+
+    // Number or literal: runs up to the next separator
+    const qsizetype begin = pos;
+    while (pos < text.size()) {
+        const QChar c = text[pos];
+        if (c == u',' || c == u'}' || c == u']' || isJsonSpace(c)) break;
+        ++pos;
+    }
+    return pos > begin ? pos : -1;
+}
+
+bool RoutingHeader::scan(QStringView payload)
+{
+    *this = RoutingHeader();
+
+    qsizetype pos = skipSpace(payload, 0);
+    if (pos >= payload.size() || payload[pos] != u'{') return false;
+    _open = pos++;
+
+    bool hasType = false;
+    bool hasFrom = false;
+    qsizetype prevComma = -1;   // comma before the current member, if any
+
+    for (;;) {
+        pos = skipSpace(payload, pos);
+        if (pos >= payload.size() || payload[pos] != u'"') return false;
+
+        const qsizetype memberBegin = pos;
+        bool keyEscaped = false;
+        pos = skipString(payload, pos, &keyEscaped);
+        // An escaped name could spell a routing member in disguise; leave it to the full parser
+        if (pos < 0 || keyEscaped) return false;
+        const QStringView key = payload.sliced(memberBegin + 1, pos - memberBegin - 2);
+
+        pos = skipSpace(payload, pos);
+        if (pos >= payload.size() || payload[pos] != u':') return false;
+        pos = skipSpace(payload, pos + 1);
+
+        const qsizetype valueBegin = pos;
+        bool valueEscaped = false;
+        const bool isString = pos < payload.size() && payload[pos] == u'"';
+        pos = isString ? skipString(payload, pos, &valueEscaped) : skipValue(payload, pos);
+        if (pos < 0) return false;
+        const qsizetype memberEnd = pos;
+        bool isFrom = false;
+
+        if (key == u"type" || key == u"to") {
+            bool& seen = key == u"type" ? hasType : _hasTo;
+            if (seen || !isString || valueEscaped) return false;
+            seen = true;
+            const QStringView value = payload.sliced(valueBegin + 1, memberEnd - valueBegin - 2);
+            if (key == u"to") {
+                _to = value;
+            }
+            else {
+                _type = clientType(value);
+            }
+        }
+        else if (key == u"from") {
+            if (hasFrom) return false;
+            hasFrom = true;
+            isFrom = true;
+            // Drop the comma before it, or the one after it when it is the first member
+            _cutBegin = prevComma >= 0 ? prevComma : memberBegin;
+            _cutEnd = memberEnd;
+        }
+        else if (key == u"data") {
+            if (_hasData) return false;
+            _hasData = true;
+        }
+
+        pos = skipSpace(payload, pos);
+        if (pos >= payload.size()) return false;
+        if (payload[pos] == u'}') {
+            ++pos;
+            break;
+        }
+        if (payload[pos] != u',') return false;
+
+        if (isFrom && prevComma < 0) _cutEnd = pos + 1;
+        prevComma = pos++;
+    }
+
+    if (skipSpace(payload, pos) != payload.size()) return false;
+    return hasType;
+}
+
+bool RoutingHeader::isRelay() const
+{
+    const bool relayType = _type == SignalingType::OFFER || _type == SignalingType::ANSWER || _type == SignalingType::ICE;
+    return relayType && _hasTo && _hasData;
+}
+
+QString RoutingHeader::forward(QStringView payload, const QString& from) const
+{
+    static constexpr QLatin1StringView prefix("{\"from\":\"");
+
+    QString out;
+    out.reserve(payload.size() + from.size() + prefix.size() + 2);
+    out.append(prefix);
+    out.append(from);
+    out.append(QLatin1StringView("\","));
+
+    const QStringView body = payload.sliced(_open + 1);
+    if (_cutBegin < 0) {
+        out.append(body);
+    }
+    else {
+        out.append(payload.sliced(_open + 1, _cutBegin - _open - 1));
+        out.append(payload.sliced(_cutEnd));
+    }
+    return out;
+}
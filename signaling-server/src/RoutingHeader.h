@@ -0,0 +1,73 @@
+#ifndef __ROUTING_HEADER_H__
+#define __ROUTING_HEADER_H__
+
+#include "Common.hpp"
+#include <QStringView>
+
+/**
+* @class RoutingHeader
+* @brief Locates the top-level routing fields of a signaling message without building a JSON tree.
+*
+* `scan()` walks the top-level object once. Member names and the `type`/`to` strings are
+* recorded as offsets into the payload; nested values (such as `data` carrying a multi-KB SDP)
+* are skipped by matching brackets and strings, without allocating. `forward()` then copies
+* the original text with the sender's `from` spliced in, so relayed payloads are neither
+* parsed into a QJsonDocument nor re-serialized.
+*
+* The scan is deliberately shallow: it checks that the top level is one well-formed object,
+* not the contents of nested values, which are left to the receiving peer. Anything outside
+* the common shape (escaped member names or routing values, duplicate routing members,
+* a missing or non-string `type`, a non-string `to`) makes `scan()` return false, and a
+* message without `to` or `data` is not a relay; the caller then falls back to the full
+* QJsonDocument path, which also produces the error replies.
+*/
+class RoutingHeader
+{
+public:
+    /**
+    * @brief Scans the top level of a payload.
+    * @param payload The raw message text; must outlive any later forward() call on it.
+    * @return True if the top level is well-formed and carries a plain string `type`.
+    */
+    bool scan(QStringView payload);
+
+    /**
+    * @brief Message type, or SignalingType::UNKNOWN if the name is not known.
+    */
+    SignalingType type() const { return _type; }
+
+    /**
+    * @brief Whether the message is peer-to-peer traffic (OFFER/ANSWER/ICE) with `to` and `data`,
+    *        so that it can be relayed as-is.
+    */
+    bool isRelay() const;
+
+    /**
+    * @brief The target id, as a view into the scanned payload.
+    */
+    QStringView to() const { return _to; }
+
+    /**
+    * @brief Builds the relayed message: the original text with `"from":"<from>"` as the first
+    *        member. A `from` member sent by the client is dropped, the server decides who sent it.
+    * @param payload The payload previously passed to scan().
+    * @param from The sender's id; server-generated, so it is inserted without escaping.
+    */
+    QString forward(QStringView payload, const QString& from) const;
+
+private:
+    qsizetype skipSpace(QStringView text, qsizetype pos) const;
+    qsizetype skipString(QStringView text, qsizetype pos, bool* escaped) const;
+    qsizetype skipValue(QStringView text, qsizetype pos) const;
+
+private:
+    SignalingType _type = SignalingType::UNKNOWN;   ///< Parsed `type`.
+    bool _hasTo = false;                            ///< A string `to` member is present.
+    bool _hasData = false;                          ///< A `data` member is present.
+    QStringView _to;                                ///< `to` value, without quotes.
+    qsizetype _open = -1;                           ///< Offset of the opening brace.
+    qsizetype _cutBegin = -1;                       ///< Client `from` member to drop, with one comma...
+    qsizetype _cutEnd = -1;                         ///< ...as the half-open range [_cutBegin, _cutEnd).
+};
+
+#endif // __ROUTING_HEADER_H__
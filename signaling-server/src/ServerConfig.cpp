@@ -0,0 +1,197 @@
+#include "ServerConfig.h"
+#include <QCommandLineParser>
+#include <QFileInfo>
+#include <QLoggingCategory>
+#include <QSettings>
+
+#include <memory>
+
+namespace {
+
+/**
+* @brief Parses a decimal integer in [min, max].
+*/
+bool parseInt(const QString& text, int min, int max, int* value)
+{
+    bool ok = false;
+    const int parsed = text.trimmed().toInt(&ok);
+    if (!ok || parsed < min || parsed > max) {
+        return false;
+    }
+    *value = parsed;
+    return true;
+}
+
+bool parseLogLevel(const QString& text, QtMsgType* level)
+{
+    const QString name = text.trimmed().toLower();
+    if (name == QLatin1String("debug")) {
+        *level = QtDebugMsg;
+    }
+    else if (name == QLatin1String("info")) {
+        *level = QtInfoMsg;
+    }
+    else if (name == QLatin1String("warning")) {
+        *level = QtWarningMsg;
+    }
+    else if (name == QLatin1String("critical")) {
+        *level = QtCriticalMsg;
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool ServerConfig::parse(const QStringList& arguments, QString* error)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Headless WebRTC signaling server."));
+    const QCommandLineOption helpOption = parser.addHelpOption();
+
+    // Flags without defaults, so that a value from the config file is only overridden when given
+    const QCommandLineOption configOption(QStringLiteral("config"),
+        QStringLiteral("INI file whose [server] group holds any of the settings below; flags override it."),
+        QStringLiteral("file"));
+    const QCommandLineOption addressOption(QStringLiteral("address"),
+        QStringLiteral("Address to listen on, or \"any\" (default)."), QStringLiteral("address"));
+    const QCommandLineOption portOption(QStringLiteral("port"),
+        QStringLiteral("Port to listen on (default %1).").arg(port), QStringLiteral("port"));
+    const QCommandLineOption workersOption(QStringLiteral("workers"),
+        QStringLiteral("Worker threads (default %1).").arg(workerNum), QStringLiteral("n"));
+    const QCommandLineOption ioThreadsOption(QStringLiteral("io-threads"),
+        QStringLiteral("I/O threads owning the client sockets (default %1).").arg(ioThreadNum), QStringLiteral("n"));
+    const QCommandLineOption queueOption(QStringLiteral("queue"),
+        QStringLiteral("Worker task queue: blocking (default) or ring."), QStringLiteral("type"));
+    const QCommandLineOption dispatchOption(QStringLiteral("dispatch"),
+        QStringLiteral("Worker dispatch: sharded (default) or shared."), QStringLiteral("mode"));
+    const QCommandLineOption logLevelOption(QStringLiteral("log-level"),
+        QStringLiteral("debug, info (default), warning or critical."), QStringLiteral("level"));
+    const QCommandLineOption drainOption(QStringLiteral("drain-timeout"),
+        QStringLiteral("Milliseconds to wait for sessions to close on SIGTERM (default %1).").arg(drainTimeoutMs),
+        QStringLiteral("ms"));
+    parser.addOptions({ configOption, addressOption, portOption, workersOption, ioThreadsOption, queueOption,
+        dispatchOption, logLevelOption, drainOption });
+
+    if (!parser.parse(arguments)) {
+        *error = parser.errorText();
+        return false;
+    }
+    if (parser.isSet(helpOption)) {
+        parser.showHelp(0);
+    }
+    if (!parser.positionalArguments().isEmpty()) {
+        *error = QStringLiteral("Unexpected argument: %1").arg(parser.positionalArguments().constFirst());
+        return false;
+    }
+
+    std::unique_ptr<QSettings> file;
+    if (parser.isSet(configOption)) {
+        const QString path = parser.value(configOption);
+        if (!QFileInfo(path).isFile()) {
+            *error = QStringLiteral("Config file not found: %1").arg(path);
+            return false;
+        }
+        file.reset(new QSettings(path, QSettings::IniFormat));
+        if (file->status() != QSettings::NoError) {
+            *error = QStringLiteral("Cannot read config file: %1").arg(path);
+            return false;
+        }
+        file->beginGroup(QStringLiteral("server"));
+    }
+
+    // The flag, else the file's key of the same name; empty if neither sets it
+    auto valueOf = [&parser, &file](const QCommandLineOption& option) -> QString {
+        if (parser.isSet(option)) {
+            return parser.value(option);
+        }
+        if (file) {
+            return file->value(option.names().constFirst()).toString();
+        }
+        return QString();
+    };
+    auto invalid = [error](const QCommandLineOption& option, const QString& value) {
+        *error = QStringLiteral("Invalid %1: %2").arg(option.names().constFirst(), value);
+        return false;
+    };
+
+    QString value = valueOf(addressOption);
+    if (!value.isEmpty()) {
+        if (value.compare(QLatin1String("any"), Qt::CaseInsensitive) == 0) {
+            address = QHostAddress::Any;
+        }
+        else if (!address.setAddress(value.trimmed())) {
+            return invalid(addressOption, value);
+        }
+    }
+
+    value = valueOf(portOption);
+    if (!value.isEmpty()) {
+        int parsed = 0;
+        if (!parseInt(value, 1, 65535, &parsed)) {
+            return invalid(portOption, value);
+        }
+        port = static_cast<quint16>(parsed);
+    }
+
+    value = valueOf(workersOption);
+    if (!value.isEmpty() && !parseInt(value, 1, 1024, &workerNum)) {
+        return invalid(workersOption, value);
+    }
+
+    value = valueOf(ioThreadsOption);
+    if (!value.isEmpty() && !parseInt(value, 1, 1024, &ioThreadNum)) {
+        return invalid(ioThreadsOption, value);
+    }
+
+    value = valueOf(queueOption).trimmed().toLower();
+    if (value == QLatin1String("blocking")) {
+        queueType = QueueType::Blocking;
+    }
+    else if (value == QLatin1String("ring")) {
+        queueType = QueueType::Ring;
+    }
+    else if (!value.isEmpty()) {
+        return invalid(queueOption, value);
+    }
+
+    value = valueOf(dispatchOption).trimmed().toLower();
+    if (value == QLatin1String("sharded")) {
+        dispatchMode = DispatchMode::Sharded;
+    }
+    else if (value == QLatin1String("shared")) {
+        dispatchMode = DispatchMode::Shared;
+    }
+    else if (!value.isEmpty()) {
+        return invalid(dispatchOption, value);
+    }
+
+    value = valueOf(logLevelOption);
+    if (!value.isEmpty() && !parseLogLevel(value, &logLevel)) {
+        return invalid(logLevelOption, value);
+    }
+
+    value = valueOf(drainOption);
+    if (!value.isEmpty() && !parseInt(value, 0, 24 * 3600 * 1000, &drainTimeoutMs)) {
+        return invalid(drainOption, value);
+    }
+    return true;
+}
+
+void ServerConfig::applyLogLevel() const
+{
+    // QtMsgType is not ordered by severity (QtInfoMsg comes last), so list the disabled types
+    QStringList rules;
+    if (logLevel == QtInfoMsg || logLevel == QtWarningMsg || logLevel == QtCriticalMsg) {
+        rules << QStringLiteral("*.debug=false");
+    }
+    if (logLevel == QtWarningMsg || logLevel == QtCriticalMsg) {
+        rules << QStringLiteral("*.info=false");
+    }
+    if (logLevel == QtCriticalMsg) {
+        rules << QStringLiteral("*.warning=false");
+    }
+    QLoggingCategory::setFilterRules(rules.join(QLatin1Char('\n')));
+}
@@ -0,0 +1,50 @@
+#ifndef __SERVER_CONFIG_H__
+#define __SERVER_CONFIG_H__
+
+#include "Common.hpp"
+#include "SignalingServer.h"
+#include <QStringList>
+
+const int DEFAULT_DRAIN_TIMEOUT_MS = 5000;
+
+/**
+* @struct ServerConfig
+* @brief Settings of the headless daemon, read from an optional INI file and the command line.
+*
+* Precedence, lowest first: built-in defaults, the [server] group of the file given with
+* --config, command line flags. The file uses the long flag names as keys, e.g.
+*
+*     [server]
+*     address=0.0.0.0
+*     port=11290
+*     workers=4
+*     queue=ring
+*     log-level=warning
+*/
+struct ServerConfig {
+    QHostAddress address = QHostAddress::Any;               ///< Address to listen on.
+    quint16 port = 11290;                                   ///< Port to listen on.
+    int workerNum = DEFAULT_WORKER_NUMBER;                  ///< Worker threads.
+    int ioThreadNum = DEFAULT_IO_THREAD_NUMBER;             ///< I/O threads owning the client sockets.
+    QueueType queueType = QueueType::Blocking;              ///< Worker task queue.
+    DispatchMode dispatchMode = DispatchMode::Sharded;      ///< How messages are spread over the workers.
+    QtMsgType logLevel = QtInfoMsg;                         ///< Least severe message type that is logged.
+    int drainTimeoutMs = DEFAULT_DRAIN_TIMEOUT_MS;          ///< Longest wait for sessions to close on shutdown.
+
+    /**
+    * @brief Fills the settings from the command line, and from the file it names.
+    *
+    * Prints the help text and exits on --help.
+    * @param arguments The full argument list, program name first.
+    * @param error Receives a description of the first invalid value.
+    * @return False if an option, the config file or a value in it is invalid.
+    */
+    bool parse(const QStringList& arguments, QString* error);
+
+    /**
+    * @brief Disables the logging below logLevel for every category.
+    */
+    void applyLogLevel() const;
+};
+
+#endif // __SERVER_CONFIG_H__
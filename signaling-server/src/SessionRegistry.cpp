@@ -0,0 +1,99 @@
+#include "SessionRegistry.h"
+
+SessionRegistry::SessionRegistry()
+    : _version(0), _size(0), _snapshot(std::make_shared<const Snapshot>())
+{}
+
+SessionRegistry::~SessionRegistry()
+{}
+
+SessionRegistry::Shard& SessionRegistry::shardFor(const QString& clientId)
+{
+    return _shards[qHash(clientId) % SHARD_COUNT];
+}
+
+const SessionRegistry::Shard& SessionRegistry::shardFor(const QString& clientId) const
+{
+    return _shards[qHash(clientId) % SHARD_COUNT];
+}
+
+bool SessionRegistry::add(const QString& clientId)
+{
+    Shard& shard = shardFor(clientId);
+    {
+        QWriteLocker guard(&shard.lock);
+        if (shard.ids.contains(clientId)) return false;
+        shard.ids.insert(clientId);
+    }
+    _size.fetch_add(1, std::memory_order_relaxed);
+    _version.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+bool SessionRegistry::remove(const QString& clientId)
+{
+    Shard& shard = shardFor(clientId);
+    {
+        QWriteLocker guard(&shard.lock);
+        if (!shard.ids.remove(clientId)) return false;
+    }
+    _size.fetch_sub(1, std::memory_order_relaxed);
+    _version.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+bool SessionRegistry::contains(const QString& clientId) const
+{
+    const Shard& shard = shardFor(clientId);
+    QReadLocker guard(&shard.lock);
+    return shard.ids.contains(clientId);
+}
+
+int SessionRegistry::size() const
+{
+    return _size.load(std::memory_order_relaxed);
+}
+
+quint64 SessionRegistry::version() const
+{
+    return _version.load(std::memory_order_acquire);
+}
+
+SessionRegistry::SnapshotPtr SessionRegistry::snapshot() const
+{
+    // Fast path: nothing changed since the cached copy was built
+    const quint64 wanted = version();
+    SnapshotPtr cached = std::atomic_load(&_snapshot);
+    if (cached->version >= wanted) return cached;
+
+    QMutexLocker guard(&_snapshotMutex);
+    // Another caller may have rebuilt it while we were waiting
+    cached = std::atomic_load(&_snapshot);
+    if (cached->version >= wanted) return cached;
+
+    // Label with the version read before scanning: changes that land during the scan
+    // may already be included, and the next caller will simply rebuild once more
+    auto fresh = std::make_shared<Snapshot>();
+    fresh->version = version();
+    fresh->ids.reserve(size());
+    for (const Shard& shard : _shards) {
+        QReadLocker shardGuard(&shard.lock);
+        for (const QString& id : shard.ids) {
+            fresh->ids.append(id);
+        }
+    }
+
+    SnapshotPtr result = std::move(fresh);
+    std::atomic_store(&_snapshot, result);
+    return result;
+}
+
+void SessionRegistry::clear()
+{
+    for (Shard& shard : _shards) {
+        QWriteLocker guard(&shard.lock);
+        _size.fetch_sub(static_cast<int>(shard.ids.size()), std::memory_order_relaxed);
+        shard.ids.clear();
+    }
+    _version.fetch_add(1, std::memory_order_release);
+}
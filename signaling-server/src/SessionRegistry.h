@@ -0,0 +1,111 @@
+#ifndef __SESSION_REGISTRY_H__
+#define __SESSION_REGISTRY_H__
+
+#include <QString>
+#include <QStringList>
+#include <QSet>
+#include <QReadWriteLock>
+#include <QMutex>
+#include <array>
+#include <atomic>
+#include <memory>
+
+/**
+* @class SessionRegistry
+* @brief Thread-safe index of registered client sessions.
+*
+* Lookups are O(1) and read-mostly: the ids are spread over a fixed number of shards,
+* each guarded by its own read-write lock, so workers checking `contains()` for
+* different clients rarely touch the same lock and never block each other.
+*
+* Every successful add/remove bumps a version counter. `snapshot()` returns an
+* immutable, versioned copy of all ids for building peer lists. The copy is rebuilt
+* at most once per version and shared by all readers until the next change, so
+* readers never hold a shard lock while iterating.
+*
+* All methods may be called from any thread.
+*
+* SignalingServer no longer keeps one: RoomRegistry already knows every registered
+* client. The class stays as the baseline measured by registry_bench and room_bench.
+*/
+class SessionRegistry
+{
+public:
+    /**
+    * @struct Snapshot
+    * @brief Immutable view of the registered ids at a given version.
+    */
+    struct Snapshot {
+        quint64 version = 0;   ///< Registry version the snapshot was built from.
+        QStringList ids;       ///< Registered ids, unordered.
+    };
+    using SnapshotPtr = std::shared_ptr<const Snapshot>;
+
+    static const int SHARD_COUNT = 16;
+
+    SessionRegistry();
+    ~SessionRegistry();
+
+    Q_DISABLE_COPY(SessionRegistry)
+
+    /**
+    * @brief Registers a session id.
+    * @return True if the id was added, false if it was already registered.
+    */
+    bool add(const QString& clientId);
+
+    /**
+    * @brief Unregisters a session id.
+    * @return True if the id was removed, false if it was not registered.
+    */
+    bool remove(const QString& clientId);
+
+    /**
+    * @brief Checks whether a session id is registered.
+    */
+    bool contains(const QString& clientId) const;
+
+    /**
+    * @brief Number of registered sessions.
+    */
+    int size() const;
+
+    /**
+    * @brief Current version; changes on every successful add/remove.
+    */
+    quint64 version() const;
+
+    /**
+    * @brief Returns a snapshot that is at least as new as the version observed on entry.
+    *
+    * Concurrent callers share one rebuild; callers arriving after it get the cached copy.
+    */
+    SnapshotPtr snapshot() const;
+
+    /**
+    * @brief Removes every session.
+    */
+    void clear();
+
+private:
+    /**
+    * @struct Shard
+    * @brief One lock and the ids hashed to it; cache-line aligned to avoid false sharing.
+    */
+    struct alignas(64) Shard {
+        mutable QReadWriteLock lock;
+        QSet<QString> ids;
+    };
+
+    Shard& shardFor(const QString& clientId);
+    const Shard& shardFor(const QString& clientId) const;
+
+private:
+    std::array<Shard, SHARD_COUNT> _shards;       ///< Sharded id sets.
+    std::atomic<quint64> _version;                ///< Bumped on every change.
+    std::atomic<int> _size;                       ///< Number of registered ids.
+    mutable QMutex _snapshotMutex;                ///< Serializes snapshot rebuilds.
+    mutable SnapshotPtr _snapshot;                ///< Cached snapshot, accessed with std::atomic_load/store.
+};
+
+#endif // __SESSION_REGISTRY_H__
@@ -1,42 +1,77 @@
 #include "SignalingServer.h"
+#include <QDeadlineTimer>
+#include <QElapsedTimer>
 
-SignalingServer::SignalingServer(const QHostAddress& address, quint16 port, int workerNum)
+SignalingServer::SignalingServer(const QHostAddress& address, quint16 port, int workerNum, QueueType queueType, DispatchMode dispatchMode,
+    int ioThreadNum)
 : QObject(nullptr),
-_server(new QWebSocketServer(QStringLiteral("Signaling Server"),
-    QWebSocketServer::NonSecureMode, this)),
+_acceptor(new Acceptor(this)),
 _workerPool(new WorkerPool(this)),
 _hostAddress(address),
 _port(port),
-_isRunning(false)
+_nextIoLoop(0),
+_isRunning(false),
+_draining(0)
 {
     registerHandlers();
-    QObject::connect(_server, &QWebSocketServer::newConnection, this, &SignalingServer::onNewConnection);
-    QObject::connect(_workerPool, &WorkerPool::sigWorkerResult, this, &SignalingServer::onWorkerResult);
-    QObject::connect(this, &SignalingServer::sigAddSession, this, &SignalingServer::onAddSession);
-    QObject::connect(this, &SignalingServer::sigRemoveSession, this, &SignalingServer::onRemoveSession);
+    QObject::connect(_acceptor, &Acceptor::sigIncoming, this, &SignalingServer::onIncomingConnection);
+    // Results go from the worker thread straight to the target's I/O thread
+    QObject::connect(_workerPool, &WorkerPool::sigWorkerResult, this, &SignalingServer::onWorkerResult,
+        Qt::DirectConnection);
+
+    for (int i = 0; i < qMax(1, ioThreadNum); ++i) {
+        QThread* thread = new QThread(this);
+        IoLoop* loop = new IoLoop(i + 1, &_directory, nullptr);
+        loop->moveToThread(thread);
+
+        // Both run on the I/O thread, so reads never wait for the main thread
+        QObject::connect(loop, &IoLoop::sigDataReady, this, &SignalingServer::onClientDataReady, Qt::DirectConnection);
+        QObject::connect(loop, &IoLoop::sigDisconnected, this, &SignalingServer::onDisconnected, Qt::DirectConnection);
+        QObject::connect(thread, &QThread::finished, loop, &QObject::deleteLater);
+
+        _ioThreads.append(thread);
+        _ioLoops.append(loop);
+        thread->start();
+    }
+    INFO() << "Signaling Server uses" << _ioLoops.size() << "I/O threads.";
 
     auto processor = [this](const SignalingTask& task, Worker* source) {
         this->dispatchMessage(task, source);
     };
-    _workerPool->start(workerNum, processor);
+    // No message type is stateless yet (see is_stateless_stype()). Installing isStatelessTask
+    // would only cost a header scan per message and an empty steal pass per idle worker
+    _workerPool->start(workerNum, processor, queueType, dispatchMode, nullptr);
 }
 
-SignalingServer* SignalingServer::getInstance(const QHostAddress& address, quint16 port, int workerNum)  
+SignalingServer* SignalingServer::getInstance(const QHostAddress& address, quint16 port, int workerNum, QueueType queueType,
+    DispatchMode dispatchMode, int ioThreadNum)  
 {  
-   static SignalingServer* instance = new SignalingServer(address, port, workerNum);  
+   static SignalingServer* instance = new SignalingServer(address, port, workerNum, queueType, dispatchMode, ioThreadNum);  
    return instance;  
 }
 
 SignalingServer::~SignalingServer()
-{}
+{
+    for (QThread* thread : _ioThreads) {
+        thread->quit();
+        thread->wait();
+    }
+}
 
 bool SignalingServer::start(const QHostAddress& address, quint16 port)
 {
+    if (_draining.loadAcquire()) {
+        WARNING() << "The server has been drained and cannot start again!";
+        return false;
+    }
     if (_isRunning == false) {
-        INFO() << "Signaling Server is running! Listen on: " << address.toString() << ":" << port;
         _hostAddress = address;
         _port = port;
-        _server->listen(_hostAddress, _port);
+        if (!_acceptor->listen(_hostAddress, _port)) {
+            CRITICAL() << "Cannot listen on" << address.toString() << ":" << port << ":" << _acceptor->errorString();
+            return false;
+        }
+        INFO() << "Signaling Server is running! Listen on: " << address.toString() << ":" << port;
         _isRunning = true;
         return true;
     }
@@ -47,7 +82,7 @@ bool SignalingServer::start(const QHostAddress& address, quint16 port)
 bool SignalingServer::stop()
 {
     if (_isRunning == true) {
-        _server->close();
+        _acceptor->close();
         INFO() << "Signaling Server is closed!";
         _isRunning = false;
         return true;
@@ -56,29 +91,87 @@ bool SignalingServer::stop()
     return false;
 }
 
+bool SignalingServer::drain(int timeoutMs)
+{
+    if (!_draining.testAndSetOrdered(0, 1)) {
+        WARNING() << "The server is already drained!";
+        return false;
+    }
+    if (_isRunning) {
+        stop();
+    }
+    QElapsedTimer elapsed;
+    elapsed.start();
+
+    // 1. Messages arriving from now on are dropped; the workers finish the queued ones
+    const int pending = _workerPool->getQueueSize();
+    _workerPool->stop();
+    INFO() << "Drain: finished" << pending << "queued tasks in" << elapsed.elapsed() << "ms";
+
+    // 2. Each close is queued behind the responses the workers have posted to that I/O thread
+    for (IoLoop* loop : _ioLoops) {
+        QMetaObject::invokeMethod(loop, [loop]() {
+            loop->closeAll(QWebSocketProtocol::CloseCodeGoingAway, QStringLiteral("Server shutting down"));
+            }, Qt::BlockingQueuedConnection);
+    }
+
+    // 3. Give the clients time to acknowledge before the I/O threads stop
+    auto openSessions = [this]() {
+        int count = 0;
+        for (const IoLoop* loop : _ioLoops) {
+            count += loop->sessionCount();
+        }
+        return count;
+    };
+    const QDeadlineTimer deadline(timeoutMs);
+    int open = openSessions();
+    while (open > 0 && !deadline.hasExpired()) {
+        QThread::msleep(10);
+        open = openSessions();
+    }
+    for (QThread* thread : _ioThreads) {
+        thread->quit();
+        thread->wait();
+    }
+
+    if (open > 0) {
+        WARNING() << "Drain: " << open << "sessions did not close within" << timeoutMs << "ms";
+        return false;
+    }
+    INFO() << "Drain: all sessions closed in" << elapsed.elapsed() << "ms";
+    return true;
+}
+
 
 
 void SignalingServer::registerHandlers()
 {
     _handlerMap["REGISTER_REQUEST"] = [this](const QJsonObject& j, const QString& id, Worker* w) {
-        handleRegister(this->_session_list, j, id, w);
+        handleRegister(j, id, w);
         };
 
     _handlerMap["OFFER"] = [this](const QJsonObject& j, const QString& id, Worker* w) {
-        handleOffer(this->_session_list, j, id, w);
+        handleOffer(j, id, w);
         };
 
     _handlerMap["ANSWER"] = [this](const QJsonObject& j, const QString& id, Worker* w) {
-        handleAnswer(this->_session_list, j, id, w);
+        handleAnswer(j, id, w);
         };
 
     _handlerMap["ICE"] = [this](const QJsonObject& j, const QString& id, Worker* w) {
-        handleIce(this->_session_list, j, id, w);
+        handleIce(j, id, w);
         };
 }
 
 void SignalingServer::dispatchMessage(const SignalingTask& task, Worker* worker)
 {
+    // A. Peer-to-peer messages are relayed without parsing their (SDP-sized) data
+    RoutingHeader route;
+    if (route.scan(task._payload) && route.isRelay()) {
+        relayMessage(route, task, worker);
+        return;
+    }
+
     QJsonParseError jsonError;
     QJsonDocument doc = QJsonDocument::fromJson(task._payload.toUtf8(), &jsonError);
 
@@ -106,12 +199,54 @@ void SignalingServer::dispatchMessage(const SignalingTask& task, Worker* worker)
     return;
 }
 
-void SignalingServer::handleRegister(const QJsonArray& sessionList, const QJsonObject& jsonObj, const QString& srcId, Worker* worker)
+void SignalingServer::relayMessage(const RoutingHeader& route, const SignalingTask& task, Worker* worker)
+{
+    QString targetId = route.to().toString();
+    if (!isReachable(task._clientId, targetId)) {
+        handleError(QString("%1 is not online").arg(targetId), task._clientId, worker);
+        return;
+    }
+
+    emit worker->sigSendResponse(targetId, route.forward(task._payload, task._clientId));
+}
+
+void SignalingServer::handleRegister(const QJsonObject& jsonObj, const QString& srcId, Worker* worker)
 {
+    // Clients that name no room share the default one
+    const QJsonValue room = jsonObj["data"].toObject().value("room");
+    if (!room.isUndefined() && !room.isNull() && !room.isString()) {
+        handleError("Invalid room", srcId, worker);
+        return;
+    }
+    const QString roomId = room.toString();
+    if (roomId.size() > MAX_ROOM_ID_LENGTH) {
+        handleError("Room id too long", srcId, worker);
+        return;
+    }
+
+    // Join first, then read the members: of two clients joining concurrently,
+    // the later one always sees the earlier one
+    const RoomRegistry::Change change = _rooms.join(srcId, roomId);
+
+    // The session may have closed while the request was queued, after onDisconnected
+    // already ran; it must not stay behind in the room
+    if (_directory.find(srcId) == nullptr) {
+        QString left;
+        RoomRegistry::MembersPtr remaining;
+        _rooms.leave(srcId, &left, &remaining);
+        return;
+    }
+
+    QJsonArray peers;
+    for (const QString& peerId : change.members->ids) {
+        if (peerId != srcId) peers.append(peerId);
+    }
+
     QJsonObject data;
     data.insert("peerId", srcId);
+    data.insert("room", roomId);
     data.insert("message", "Welcome!");
-    data.insert("peers", sessionList);
+    data.insert("peers", peers);
 
     QJsonObject jsonRet = jsonObj;
     jsonRet.insert("type", stype_to_string(SignalingType::REGISTER_SUCCESS));
@@ -120,32 +255,18 @@ void SignalingServer::handleRegister(const QJsonArray& sessionList, const QJsonO
     jsonRet.insert("data", data);
 
     QString ret = QJsonDocument(jsonRet).toJson(QJsonDocument::Compact);
-    emit sigAddSession(srcId);
     emit worker->sigSendResponse(srcId, QString(ret));
 
-    if (!sessionList.isEmpty()) {
-        QJsonObject joinData;
-        joinData.insert("id", srcId);
-        
-        QJsonObject jsonNotify;
-        jsonNotify.insert("type", stype_to_string(SignalingType::PEER_JOINED));
-        jsonNotify.insert("from", "Server");
-        jsonNotify.insert("to", QJsonValue::Null);
-        jsonNotify.insert("data", joinData);
-
-        for (const QJsonValue& val : sessionList) {
-            QString targetId = val.toString();
-            if (targetId == srcId) continue;
-
-            jsonNotify["to"] = targetId;
-            QString notifyPayload = QJsonDocument(jsonNotify).toJson(QJsonDocument::Compact);
-
-            emit worker->sigSendResponse(targetId, notifyPayload);
-        }
+    if (change.moved) {
+        broadcast(change.previousMembers, srcId, presenceMessage(SignalingType::PEER_LEFT, srcId, change.previousRoom));
+    }
+    // A repeated REGISTER_REQUEST for the same room only refreshes the peer list
+    if (change.joined && !peers.isEmpty()) {
+        broadcast(change.members, srcId, presenceMessage(SignalingType::PEER_JOINED, srcId, roomId));
     }
 }
 
-void SignalingServer::handleOffer(const QJsonArray& sessionList, const QJsonObject& jsonObj, 
+void SignalingServer::handleOffer(const QJsonObject& jsonObj, 
     const QString& srcId, Worker* worker)
 {
     if (!jsonObj.contains("to") || !jsonObj["to"].isString()) {
@@ -158,8 +279,9 @@ void SignalingServer::handleOffer(const QJsonArray& sessionList, const QJsonObje
     forwardJson.insert("type", stype_to_string(SignalingType::OFFER));
     forwardJson.insert("from", srcId);
     forwardJson.insert("to", targetId);
-    if (!isOnline(sessionList, targetId)) {
+    if (!isReachable(srcId, targetId)) {
         handleError(QString("%1 is not online").arg(targetId), srcId, worker);
+        return;
     }
 
     if (jsonObj.contains("data")) {
@@ -174,7 +296,7 @@ void SignalingServer::handleOffer(const QJsonArray& sessionList, const QJsonObje
     emit worker->sigSendResponse(targetId, payload);
 }
 
-void SignalingServer::handleAnswer(const QJsonArray& sessionList, const QJsonObject& jsonObj, 
+void SignalingServer::handleAnswer(const QJsonObject& jsonObj, 
     const QString& srcId, Worker* worker)
 {
     if (!jsonObj.contains("to") || !jsonObj["to"].isString()) {
@@ -182,11 +304,12 @@ void SignalingServer::handleAnswer(const QJsonArray& sessionList, const QJsonObj
         return;
     }
     QString targetId = jsonObj["to"].toString();
-    if (!isOnline(sessionList, targetId)) {
+    if (!isReachable(srcId, targetId)) {
         char buffer[DEFAULT_BUFFER_SIZE];
         memset(buffer, 0, DEFAULT_BUFFER_SIZE);
         snprintf(buffer, DEFAULT_BUFFER_SIZE, "%s is not online", targetId.toStdString().c_str());
         handleError(QString(buffer), srcId, worker);
+        return;
     }
 
     QJsonObject forwardJson;
@@ -205,7 +328,7 @@ void SignalingServer::handleAnswer(const QJsonArray& sessionList, const QJsonObj
     emit worker->sigSendResponse(targetId, payload);
 }
 
-void SignalingServer::handleIce(const QJsonArray& sessionList, const QJsonObject& jsonObj, 
+void SignalingServer::handleIce(const QJsonObject& jsonObj, 
     const QString& srcId, Worker* worker)
 {
     if (!jsonObj.contains("to") || !jsonObj["to"].isString()) {
@@ -213,7 +336,7 @@ void SignalingServer::handleIce(const QJsonArray& sessionList, const QJsonObject
         return;
     }
     QString targetId = jsonObj["to"].toString();
-    if (!isOnline(sessionList, targetId)) {
+    if (!isReachable(srcId, targetId)) {
         char buffer[DEFAULT_BUFFER_SIZE];
         memset(buffer, 0, DEFAULT_BUFFER_SIZE);
         snprintf(buffer, DEFAULT_BUFFER_SIZE, "%s is not online", targetId.toStdString().c_str());
@@ -253,70 +376,92 @@ void SignalingServer::handleError(const QString& message, const QString& clientI
     emit worker->sigSendResponse(clientId, QString(payload));
 }
 
-QJsonArray SignalingServer::getPeerList()  
-{  
-   QJsonArray jsonArray;  
-   for (auto it = _sessions.begin(); it != _sessions.end(); ++it) {  
-       jsonArray.append(it.key());  
-   }  
-   return jsonArray;  
+bool SignalingServer::isReachable(const QString& srcId, const QString& targetId) const
+{
+    return _rooms.sameRoom(srcId, targetId);
 }
 
-bool SignalingServer::isOnline(const QJsonArray& sessionList, const QString& clientId)
+QString SignalingServer::presenceMessage(SignalingType type, const QString& clientId, const QString& roomId) const
 {
-    for (auto it = sessionList.begin(); it != sessionList.end(); it++) {
-        if ((*it).toString() == clientId) return true;
-    }
-    return false;
+    QJsonObject data;
+    data.insert("id", clientId);
+    data.insert("room", roomId);
+
+    QJsonObject json;
+    json.insert("type", stype_to_string(type));
+    json.insert("from", "Server");
+    json.insert("to", "All");
+    json.insert("data", data);
+    return QString(QJsonDocument(json).toJson(QJsonDocument::Compact));
 }
 
-void SignalingServer::onNewConnection()
+void SignalingServer::broadcast(const RoomRegistry::MembersPtr& members, const QString& skipId, const QString& message)
 {
-    auto webSocket = _server->nextPendingConnection();
-    ClientSession* session = new ClientSession(webSocket, this);
-    QString client_id = session->id();
-
-    _sessions[client_id] = session;
-
-    QObject::connect(session, &ClientSession::sigDisconnected, this, &SignalingServer::onDisconnected);
-    QObject::connect(session, &ClientSession::sigDataReady, this,
-        &SignalingServer::onClientDataReady);
+    // One event per I/O thread; the message itself is implicitly shared by all recipients
+    QHash<IoLoop*, QStringList> targets;
+    for (const QString& targetId : members->ids) {
+        if (targetId == skipId) continue;
+        IoLoop* loop = _directory.find(targetId);
+        if (loop != nullptr) {
+            targets[loop].append(targetId);
+        }
+    }
+    for (auto it = targets.cbegin(); it != targets.cend(); ++it) {
+        it.key()->post(it.value(), message);
+    }
 }
 
-void SignalingServer::onDisconnected()
+void SignalingServer::onIncomingConnection(qintptr descriptor)
 {
-     auto clientSession = qobject_cast<ClientSession*>(sender());
-    _sessions.remove(clientSession->id());
-    emit sigRemoveSession(clientSession->id());
+    // Round-robin: sessionCount() only grows after the handshake, so a burst of connects
+    // would otherwise all go to the same loop
+    IoLoop* target = _ioLoops.at(_nextIoLoop);
+    _nextIoLoop = (_nextIoLoop + 1) % _ioLoops.size();
+    QMetaObject::invokeMethod(target, [target, descriptor]() {
+        target->addConnection(descriptor);
+        }, Qt::QueuedConnection);
 }
 
-void SignalingServer::onClientDataReady(const QString& srcId, const QString& data)
+void SignalingServer::onDisconnected(const QString& clientId)
 {
-    SignalingTask task(srcId, data);
-    _workerPool->submitTask(task);
+    QString roomId;
+    RoomRegistry::MembersPtr remaining;
+    // While draining every session is closing, nobody is left to tell
+    if (_rooms.leave(clientId, &roomId, &remaining) && !_draining.loadAcquire()) {
+        broadcast(remaining, clientId, presenceMessage(SignalingType::PEER_LEFT, clientId, roomId));
+    }
 }
 
-void SignalingServer::onWorkerResult(const QString& targetClient, const QString& message)
+void SignalingServer::onClientDataReady(const QString& srcId, const QString& data)
 {
-    if (!_sessions.contains(targetClient) || _sessions[targetClient] == nullptr) {
-        WARNING() << targetClient << " has already offlined";
+    if (_draining.loadAcquire()) {
+        DEBUG() << "Draining, dropped a message from" << srcId;
         return;
     }
-    auto session = _sessions[targetClient];
-    session->sendData(message);
+    // Sharded dispatch: the pool hashes srcId to a worker, so a session's messages stay in order
+    SignalingTask task(srcId, data);
+    _workerPool->submitTask(task);
 }
 
-void SignalingServer::onAddSession(const QString& clientId)
+bool SignalingServer::isStatelessTask(const SignalingTask& task)
 {
-    _session_list.append(clientId);
+    // Runs on the I/O thread that read the message, for every message; large payloads
+    // (SDP) are never stateless, so they are not scanned at all
+    if (task._payload.size() > MAX_STATELESS_PAYLOAD) {
+        return false;
+    }
+    RoutingHeader route;
+    return route.scan(task._payload) && is_stateless_stype(route.type());
 }
 
-void SignalingServer::onRemoveSession(const QString& clientId)
+void SignalingServer::onWorkerResult(const QString& targetClient, const QString& message)
 {
-    if (_sessions.contains(clientId)) {
-        _sessions.remove(clientId);
+    IoLoop* loop = _directory.find(targetClient);
+    if (loop == nullptr) {
+        WARNING() << targetClient << " has already offlined";
+        return;
     }
-    _session_list = getPeerList();
+    loop->post(targetClient, message);
 }
 
 // ClientSession >>>>>>>>>>>>>>>>>
@@ -370,6 +515,14 @@ void ClientSession::sendData(const QString& data)
     }
 }
 
+void ClientSession::close(QWebSocketProtocol::CloseCode code, const QString& reason)
+{
+    if (_socket == nullptr) {
+        return;
+    }
+    _socket->close(code, reason);
+}
+
 void ClientSession::onTextMessageReceived(const QString& message)
 {
 	emit sigDataReady(_id, message);
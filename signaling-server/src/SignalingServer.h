@@ -2,9 +2,14 @@
 
 #include "Common.hpp"
 #include "Worker.h"  
+#include "RoomRegistry.h"
+#include "RoutingHeader.h"
+#include "IoLoop.h"
 
 const int DEFAULT_BUFFER_SIZE = 64;  
 const int DEFAULT_WORKER_NUMBER = 2;  
+const int DEFAULT_IO_THREAD_NUMBER = 2;  
+const int MAX_ROOM_ID_LENGTH = 128;  
 
 class ClientSession;  
 
@@ -14,6 +19,15 @@ class ClientSession;
 *  
 * The SignalingServer class is responsible for handling WebSocket connections,  
 * managing client sessions, and dispatching signaling tasks to a worker pool.  
+*  
+* The main thread only accepts connections. They are handed round-robin to the I/O  
+* threads (IoLoop); each socket is read and written only there, received messages  
+* are submitted to the workers from that thread, and worker results are posted straight to  
+* the owning IoLoop, found through the SessionDirectory.  
+*  
+* Registered clients are grouped in rooms (RoomRegistry): presence notifications, relayed  
+* messages and their "not online" errors never cross a room. A presence message is  
+* serialized once and the same string is queued for every recipient.  
 */  
 class SignalingServer : public QObject  
 {  
@@ -33,9 +47,12 @@ private:
     * @param address The address to bind the WebSocket server to.  
     * @param port The port to bind the WebSocket server to.  
     * @param workerNum The number of worker threads to create.  
-    * @param parent Pointer to the parent QObject (default is nullptr).  
+    * @param queueType The task queue implementation used by the worker threads.  
+    * @param dispatchMode How client messages are spread over the worker threads.  
+    * @param ioThreadNum The number of I/O threads owning the client sockets.  
     */  
-   SignalingServer(const QHostAddress& address, quint16 port, int workerNum);
+   SignalingServer(const QHostAddress& address, quint16 port, int workerNum, QueueType queueType, DispatchMode dispatchMode,
+       int ioThreadNum);
 
    Q_DISABLE_COPY(SignalingServer)
 
@@ -51,9 +68,14 @@ public:
     * @param address The address to bind the WebSocket server to. Defaults to QHostAddress::Any.  
     * @param port The port to bind the WebSocket server to. Defaults to 11290.  
     * @param workerNum The number of worker threads to create. Defaults to DEFAULT_WORKER_NUMBER.  
+    * @param queueType The worker task queue. Defaults to QueueType::Blocking.  
+    * @param dispatchMode Defaults to DispatchMode::Sharded, which keeps each client's messages in order.  
+    * @param ioThreadNum The number of I/O threads. Defaults to DEFAULT_IO_THREAD_NUMBER.  
     * @return A pointer to the singleton instance of the SignalingServer.  
     */  
-    static SignalingServer* getInstance(const QHostAddress& address = QHostAddress::Any, quint16 port = 11290, int workerNum = DEFAULT_WORKER_NUMBER);
+    static SignalingServer* getInstance(const QHostAddress& address = QHostAddress::Any, quint16 port = 11290, int workerNum = DEFAULT_WORKER_NUMBER,
+        QueueType queueType = QueueType::Blocking, DispatchMode dispatchMode = DispatchMode::Sharded,
+        int ioThreadNum = DEFAULT_IO_THREAD_NUMBER);
    
     
     /**  
@@ -75,6 +97,17 @@ public:
     */  
    bool stop();  
 
+   /**  
+    * @brief Shuts the server down without dropping the work it has already accepted.  
+    *  
+    * Stops listening and stops taking messages from the sessions, lets the workers finish  
+    * every queued task, closes the sessions (CloseCodeGoingAway) behind the responses already  
+    * posted to them, and stops the I/O threads. The server cannot be started again afterwards.  
+    * @param timeoutMs How long to wait for the clients to acknowledge the close, in milliseconds.  
+    * @return True if every session closed within the timeout.  
+    */  
+   bool drain(int timeoutMs);  
+
 private:  
    /**  
     * @brief Registers handler functions for solving signaling messages.  
@@ -88,41 +121,50 @@ private:
     */  
    void dispatchMessage(const SignalingTask& task, Worker* worker);  
 
+   /**  
+    * @brief Relays an OFFER/ANSWER/ICE message using only its scanned routing fields.  
+    * @param route The routing fields found by RoutingHeader::scan() on the task payload.  
+    * @param task The signaling task whose payload is forwarded.  
+    * @param worker Pointer to the Worker instance processing the task.  
+    */  
+   void relayMessage(const RoutingHeader& route, const SignalingTask& task, Worker* worker);  
+
    /**  
     * @brief Handles a "register" signaling message.  
-    * @param sessionList The list of active sessions.  
+    *  
+    * Joins the room named in the data, moving the client out of its current room if needed.  
+    * With DispatchMode::Sharded it runs on the client's shard like its other messages, so a  
+    * room move takes effect between the relays sent before and after it. With DispatchMode::Shared  
+    * (`--dispatch shared`) another worker may relay a later OFFER/ANSWER/ICE before the move.  
     * @param jsonObj The JSON object containing the message.  
     * @param srcId The ID of the source client.  
     * @param worker Pointer to the Worker instance processing the task.  
     */  
-   void handleRegister(const QJsonArray& sessionList, const QJsonObject& jsonObj, const QString& srcId, Worker* worker);  
+   void handleRegister(const QJsonObject& jsonObj, const QString& srcId, Worker* worker);  
 
    /**  
     * @brief Handles an "offer" signaling message.  
-    * @param sessionList The list of active sessions.  
     * @param jsonObj The JSON object containing the message.  
     * @param srcId The ID of the source client.  
     * @param worker Pointer to the Worker instance processing the task.  
     */  
-   void handleOffer(const QJsonArray& sessionList, const QJsonObject& jsonObj, const QString& srcId, Worker* worker);  
+   void handleOffer(const QJsonObject& jsonObj, const QString& srcId, Worker* worker);  
 
    /**  
     * @brief Handles an "answer" signaling message.  
-    * @param sessionList The list of active sessions.  
     * @param jsonObj The JSON object containing the message.  
     * @param srcId The ID of the source client.  
     * @param worker Pointer to the Worker instance processing the task.  
     */  
-   void handleAnswer(const QJsonArray& sessionList, const QJsonObject& jsonObj, const QString& srcId, Worker* worker);  
+   void handleAnswer(const QJsonObject& jsonObj, const QString& srcId, Worker* worker);  
 
    /**  
     * @brief Handles an "ice" signaling message.  
-    * @param sessionList The list of active sessions.  
     * @param jsonObj The JSON object containing the message.  
     * @param srcId The ID of the source client.  
     * @param worker Pointer to the Worker instance processing the task.  
     */  
-   void handleIce(const QJsonArray& sessionList, const QJsonObject& jsonObj, const QString& srcId, Worker* worker);  
+   void handleIce(const QJsonObject& jsonObj, const QString& srcId, Worker* worker);  
 
    /**  
     * @brief Handles an error message.  
@@ -133,78 +175,77 @@ private:
    void handleError(const QString& message, const QString& srcId, Worker* worker);  
 
    /**  
-    * @brief Retrieves the list of peers.  
-    * @return A JSON array containing the list of peers.  
+    * @brief Checks if a message from one client may reach another: both are registered in the same room.  
+    * @param srcId The ID of the sending client.  
+    * @param targetId The ID of the target client.  
+    * @return True if both clients are in the same room.  
     */  
-   QJsonArray getPeerList();  
+   bool isReachable(const QString& srcId, const QString& targetId) const;  
 
    /**  
-    * @brief Checks if a client is online.  
-    * @param sessionList The list of active sessions.  
-    * @param clientId The ID of the client to check.  
-    * @return True if the client is online, false otherwise.  
+    * @brief Builds a PEER_JOINED / PEER_LEFT message, addressed to "All" so one copy serves every recipient.  
+    * @param type SignalingType::PEER_JOINED or SignalingType::PEER_LEFT.  
+    * @param clientId The ID of the peer that joined or left.  
+    * @param roomId The room it joined or left.  
     */  
-   bool isOnline(const QJsonArray& sessionList, const QString& clientId);  
+   QString presenceMessage(SignalingType type, const QString& clientId, const QString& roomId) const;  
 
-signals:  
    /**  
-    * @brief Signal emitted when a new session is added.  
-    * @param clientId The ID of the new client session.  
+    * @brief Sends one message to the members of a room; callable from any thread.  
+    * @param members The recipients.  
+    * @param skipId A member that is not sent the message (the one it is about).  
+    * @param message The serialized message, shared by all recipients.  
     */  
-   void sigAddSession(const QString& clientId);  
+   void broadcast(const RoomRegistry::MembersPtr& members, const QString& skipId, const QString& message);  
 
    /**  
-    * @brief Signal emitted when a session is removed.  
-    * @param clientId The ID of the removed client session.  
+    * @brief Whether a task may be stolen by any worker in sharded dispatch (see is_stateless_stype()).  
+    *  
+    * Not passed to the WorkerPool while is_stateless_stype() accepts no type.  
+    * @param task The task being submitted.  
     */  
-   void sigRemoveSession(const QString& clientId);  
+   static bool isStatelessTask(const SignalingTask& task);  
 
 private:  
    /**  
-    * @brief Handles a new WebSocket connection.  
+    * @brief Hands an accepted connection to the next IoLoop in round-robin order.  
+    * @param descriptor The native socket descriptor.  
     */  
-   void onNewConnection();  
+   void onIncomingConnection(qintptr descriptor);  
 
    /**  
-    * @brief Handles a WebSocket disconnection.  
+    * @brief Handles a WebSocket disconnection; runs on the session's I/O thread.  
+    * @param clientId The ID of the closed session.  
     */  
-   void onDisconnected();  
+   void onDisconnected(const QString& clientId);  
 
    /**  
-    * @brief Processes data received from a client.  
+    * @brief Processes data received from a client; runs on the session's I/O thread.  
     * @param srcId The ID of the source client.  
     * @param data The data received from the client.  
     */  
    void onClientDataReady(const QString& srcId, const QString& data);  
 
    /**  
-    * @brief Handles the result of a worker's task.  
+    * @brief Posts the result of a worker's task to the target's IoLoop; runs on the worker thread.  
     * @param targetClient The ID of the target client.  
     * @param message The result message.  
     */  
    void onWorkerResult(const QString& targetClient, const QString& message);  
 
-   /**  
-    * @brief Adds a new session to the session list.  
-    * @param clientId The ID of the new client session.  
-    */  
-   void onAddSession(const QString& clientId);  
-
-   /**  
-    * @brief Removes a session from the session list.  
-    * @param clientId The ID of the removed client session.  
-    */  
-   void onRemoveSession(const QString& clientId);  
-
 private:  
-   QWebSocketServer* _server;  ///< Pointer to the WebSocket server instance.  
-   QHash<QString, ClientSession*> _sessions;  ///< Hash map of client sessions.  
+   Acceptor* _acceptor;  ///< Listening socket.  
+   QVector<QThread*> _ioThreads;  ///< One event loop thread per IoLoop.  
+   QVector<IoLoop*> _ioLoops;  ///< I/O threads' session owners.  
+   SessionDirectory _directory;  ///< Which IoLoop owns each connected session.  
    WorkerPool* _workerPool;  ///< Pointer to the worker pool instance.  
    QHash<QString, handlerFunc> _handlerMap;  ///< Map of handler functions for signaling messages.  
-   QJsonArray _session_list;  ///< List of active client sessions.  
+   RoomRegistry _rooms;  ///< Room of each registered session, shared with the workers.  
    QHostAddress _hostAddress;  ///< Address the server is bound to.  
    quint16 _port;  ///< Port the server is bound to.  
+   int _nextIoLoop;  ///< Index in _ioLoops of the loop that gets the next connection.  
    bool _isRunning;  ///< Flag indicating whether the server is running.  
+   QAtomicInt _draining;  ///< Set by drain(); messages received afterwards are dropped.  
 };  
 
 /**  
@@ -243,6 +284,13 @@ public:
     */  
    void sendData(const QString& data);  
 
+   /**  
+    * @brief Closes the connection after the data already sent; sigDisconnected follows.  
+    * @param code The WebSocket close code.  
+    * @param reason The close reason sent to the client.  
+    */  
+   void close(QWebSocketProtocol::CloseCode code, const QString& reason);  
+
 signals:  
    /**  
     * @brief Signal emitted when new data is received from the client.  
@@ -0,0 +1,68 @@
+#ifndef __TASK_QUEUE_HPP__
+#define __TASK_QUEUE_HPP__
+
+#include <cstddef>
+#include <memory>
+
+/**
+* @enum QueueType
+* @brief Selects the task queue implementation used by WorkerPool.
+*/
+enum class QueueType {
+    Blocking,   ///< BlockingQueue: unbounded QQueue behind one QMutex + QWaitCondition.
+    Ring        ///< RingQueue: bounded lock-free MPMC ring, spin-then-park waiting.
+};
+
+/**
+* @class TaskQueue
+* @brief Interface shared by the task queues a Worker can consume from.
+*
+* @tparam T The type of elements stored in the queue.
+*/
+template<class T>
+class TaskQueue
+{
+public:
+    using Ptr = std::shared_ptr<TaskQueue<T>>;
+
+    virtual ~TaskQueue() {}
+
+    /**
+    * @brief Pushes an element, waiting for space if the queue is bounded and full.
+    * @param ele The element to be added to the queue.
+    * @return true if the element is successfully added.
+    */
+    virtual bool push(const T& ele) = 0;
+
+    /**
+    * @brief Pops an element, waiting up to timeoutMs for one to arrive.
+    * @param value Reference to store the dequeued element.
+    * @param timeoutMs The maximum time to wait in milliseconds.
+    * @return true if an element is dequeued, false on timeout or notifyAll().
+    */
+    virtual bool pop(T& value, int timeoutMs) = 0;
+
+    /**
+    * @brief Pops an element without blocking.
+    * @param value Reference to store the dequeued element.
+    * @return true if an element is dequeued, false if the queue is empty.
+    */
+    virtual bool tryPop(T& value) = 0;
+
+    /**
+    * @brief Gets the current (approximate, under concurrency) size of the queue.
+    */
+    virtual size_t size() = 0;
+
+    /**
+    * @brief Checks if the queue is empty.
+    */
+    virtual bool empty() = 0;
+
+    /**
+    * @brief Wakes every thread waiting in pop().
+    */
+    virtual void notifyAll() = 0;
+};
+
+#endif // __TASK_QUEUE_HPP__
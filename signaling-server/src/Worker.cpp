@@ -1,6 +1,6 @@
 #include "Worker.h"
 
-Worker::Worker(int id, BlockingQueue<SignalingTask>::bqPtr queue, SignalingProcessor processor, QObject* parent)
+Worker::Worker(int id, TaskQueue<SignalingTask>::Ptr queue, SignalingProcessor processor, QObject* parent)
 	: QObject(parent), _workerId(id), _queue(queue), _isRunning(false), _processor(processor)
 {}
 
@@ -22,12 +22,12 @@ void Worker::startLoop()
     while (true) {
         SignalingTask task;
         if (_isRunning.loadRelaxed()) {
-            if (_queue->pop(task, DEFAULT_TIMEOUT)) {
+            if (nextTask(task)) {
                 processMessage(task);
             }
         }
         else {
-            if (_queue->tryPop(task)) {
+            if (_queue->tryPop(task) || (_hooks.steal && _hooks.steal(task))) {
                 processMessage(task);
             }
             else {
@@ -44,13 +44,45 @@ int Worker::getId()
     return _workerId;
 }
 
+void Worker::setStealHooks(StealHooks hooks)
+{
+    _hooks = std::move(hooks);
+}
+
 void Worker::processMessage(const SignalingTask& task)
 {
+    // Wake-up task from WorkerPool::wakeIdleWorker(), nothing to process
+    if (task._clientId.isEmpty()) {
+        return;
+    }
     _processor(task, this);
 }
 
+bool Worker::nextTask(SignalingTask& task)
+{
+    if (!_hooks.steal) {
+        return _queue->pop(task, DEFAULT_TIMEOUT);
+    }
+
+    // Own queue first: it holds the tasks that only this Worker may process
+    if (_queue->tryPop(task) || _hooks.steal(task)) {
+        return true;
+    }
+
+    // Announce the nap before the last look, so a stateless task submitted meanwhile
+    // is either seen here or makes the WorkerPool push a wake-up task to our queue
+    _hooks.setIdle(true);
+    if (_hooks.steal(task)) {
+        _hooks.setIdle(false);
+        return true;
+    }
+    const bool popped = _queue->pop(task, DEFAULT_TIMEOUT);
+    _hooks.setIdle(false);
+    return popped;
+}
+
 WorkerPool::WorkerPool(QObject* parent):
-    QObject(parent), _taskQueue(new BlockingQueue<SignalingTask>), _isRunning(false)
+    QObject(parent), _mode(DispatchMode::Shared), _isRunning(false)
 {}
 
 WorkerPool::~WorkerPool()
@@ -60,7 +92,8 @@ WorkerPool::~WorkerPool()
     }
 }
 
-bool WorkerPool::start(size_t threadCount, Worker::SignalingProcessor processor)
+bool WorkerPool::start(size_t threadCount, Worker::SignalingProcessor processor, QueueType queueType,
+    DispatchMode mode, StatelessPredicate isStateless)
 {
     if (!_isRunning.testAndSetRelaxed(false, true)) {
         WARNING() << "WorkerPool: Already running.";
@@ -71,22 +104,64 @@ bool WorkerPool::start(size_t threadCount, Worker::SignalingProcessor processor)
         assert(threadCount > 0);
     }
 
+    auto makeQueue = [queueType]() -> TaskQueue<SignalingTask>::Ptr {
+        if (queueType == QueueType::Ring) {
+            return std::make_shared<RingQueue<SignalingTask>>();
+        }
+        return std::make_shared<BlockingQueue<SignalingTask>>();
+    };
+
+    // Without a predicate nothing is stealable: skip the queues and the idle bookkeeping,
+    // so each Worker simply blocks on its own queue
+    const bool stealing = mode == DispatchMode::Sharded && isStateless;
+    _mode = mode;
+    _isStateless = stealing ? isStateless : nullptr;
+    _queues.clear();
+    _stealable.clear();
+    _idle.reset();
+    const int queueCount = mode == DispatchMode::Sharded ? static_cast<int>(threadCount) : 1;
+    for (int i = 0; i < queueCount; ++i) {
+        _queues.append(makeQueue());
+        if (stealing) {
+            _stealable.append(makeQueue());
+        }
+    }
+    if (stealing) {
+        _idle.reset(new std::atomic<bool>[queueCount]);
+        for (int i = 0; i < queueCount; ++i) {
+            _idle[i].store(false, std::memory_order_relaxed);
+        }
+    }
+
     for (int i = 0; i < threadCount; ++i) {
         QThread* thread = new QThread(this);
-        Worker* worker = new Worker(i + 1, _taskQueue, processor, nullptr);
+        Worker* worker = new Worker(i + 1, _queues[i % queueCount], processor, nullptr);
+        if (stealing) {
+            Worker::StealHooks hooks;
+            hooks.steal = [this, i](SignalingTask& task) { return stealTask(i, task); };
+            hooks.setIdle = [this, i](bool idle) {
+                _idle[i].store(idle, std::memory_order_relaxed);
+                // Pairs with the fence in wakeIdleWorker()
+                if (idle) std::atomic_thread_fence(std::memory_order_seq_cst);
+            };
+            worker->setStealHooks(std::move(hooks));
+        }
 
         worker->moveToThread(thread);
 
         // register signal with slot function
         connect(thread, &QThread::started, worker, &Worker::startLoop);
+        // Forwarded on the worker thread: receivers of sigWorkerResult choose how to cross threads
         connect(worker, &Worker::sigSendResponse,
-            this, &WorkerPool::onSendResponse);
+            this, &WorkerPool::onSendResponse, Qt::DirectConnection);
 
         _threads.append(thread);
         _workers.append(worker);
         thread->start();
     }
-    INFO() << "WorkerPool started with" << threadCount << "threads.";
+    INFO() << "WorkerPool started with" << threadCount << "threads," <<
+        (queueType == QueueType::Ring ? "ring" : "blocking") << "queue," <<
+        (mode == DispatchMode::Sharded ? "sharded" : "shared") << "dispatch.";
     return true;
 }
 
@@ -98,8 +173,8 @@ bool WorkerPool::stop()
         worker->stop();
     }
 
-    if (_taskQueue != nullptr) {
-        _taskQueue->notifyAll();
+    for (const TaskQueue<SignalingTask>::Ptr& queue : _queues) {
+        queue->notifyAll();
     }
 
     for (QThread* thread : _threads) {
@@ -116,15 +191,68 @@ bool WorkerPool::stop()
 
 bool WorkerPool::submitTask(const SignalingTask& task)
 {
-    if (_isRunning.loadRelaxed() == false || _taskQueue == nullptr) {
+    if (_isRunning.loadRelaxed() == false || _queues.isEmpty()) {
         CRITICAL() << "WorkerPool is not running!";
         return false;
     }
-    _taskQueue->push(task);
+    if (_mode == DispatchMode::Shared) {
+        _queues[0]->push(task);
+        return true;
+    }
+
+    const int shard = shardOf(task._clientId);
+    if (_isStateless && _isStateless(task)) {
+        _stealable[shard]->push(task);
+        wakeIdleWorker(shard);
+    }
+    else {
+        _queues[shard]->push(task);
+    }
     return true;
 }
 
-int WorkerPool::getQueueSize() const { return _taskQueue->size(); }
+int WorkerPool::getQueueSize() const
+{
+    size_t size = 0;
+    for (const TaskQueue<SignalingTask>::Ptr& queue : _queues) {
+        size += queue->size();
+    }
+    for (const TaskQueue<SignalingTask>::Ptr& queue : _stealable) {
+        size += queue->size();
+    }
+    return static_cast<int>(size);
+}
+
+int WorkerPool::shardOf(const QString& clientId) const
+{
+    return static_cast<int>(qHash(clientId) % static_cast<size_t>(_queues.size()));
+}
+
+bool WorkerPool::stealTask(int index, SignalingTask& task)
+{
+    const int count = _stealable.size();
+    for (int i = 0; i < count; ++i) {
+        if (_stealable[(index + i) % count]->tryPop(task)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkerPool::wakeIdleWorker(int first)
+{
+    // Pairs with the fence in the Workers' setIdle hook: either the Worker's last look
+    // finds the task just pushed, or its idle flag is seen here
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int count = _queues.size();
+    for (int i = 0; i < count; ++i) {
+        const int index = (first + i) % count;
+        if (_idle[index].load(std::memory_order_relaxed) && _idle[index].exchange(false)) {
+            _queues[index]->push(SignalingTask());
+            return;
+        }
+    }
+}
 
 void WorkerPool::onSendResponse(const QString& targetId, const QString& json)
 {
@@ -3,14 +3,24 @@
 
 #include "Common.hpp"  
 #include "BlockingQueue.hpp"  
+#include "RingQueue.hpp"  
 
 const int DEFAULT_TIMEOUT = 100;  
 
+/**  
+* @enum DispatchMode  
+* @brief How WorkerPool hands tasks to its Workers.  
+*/  
+enum class DispatchMode {  
+    Shared,     ///< One queue shared by all Workers; a client's messages may be handled out of order.  
+    Sharded     ///< One queue per Worker, chosen by client id; a client's messages are handled in order.  
+};  
+
 /**  
 * @class Worker  
 * @brief Represents a worker thread that processes tasks from a shared blocking queue.  
 *  
-* The Worker class is responsible for continuously fetching tasks from a shared blocking queue,  
+* The Worker class is responsible for continuously fetching tasks from a shared task queue,  
 * processing them, and emitting signals to notify the main thread of the results.  
 */  
 class Worker : public QObject  
@@ -25,14 +35,23 @@ public:
    */  
   using SignalingProcessor = std::function<void(const SignalingTask& task, Worker* source)>;  
 
+  /**  
+   * @struct StealHooks  
+   * @brief Lets an idle Worker take stateless tasks queued for any Worker (sharded dispatch).  
+   */  
+  struct StealHooks {  
+      std::function<bool(SignalingTask& task)> steal;   ///< Takes a stealable task, own shard first.  
+      std::function<void(bool idle)> setIdle;           ///< Publishes that the Worker is about to park.  
+  };  
+
   /**  
    * @brief Constructs a Worker instance.  
    * @param id Unique identifier for the Worker.  
-   * @param queue Pointer to the shared blocking queue containing tasks.  
+   * @param queue Pointer to the shared task queue containing tasks.  
    * @param processor Function to process tasks.  
    * @param parent Pointer to the parent QObject (default is nullptr).  
    */  
-  explicit Worker(int id, BlockingQueue<SignalingTask>::bqPtr queue, SignalingProcessor processor, QObject* parent = nullptr);  
+  explicit Worker(int id, TaskQueue<SignalingTask>::Ptr queue, SignalingProcessor processor, QObject* parent = nullptr);  
   /**  
    * @brief Destructor for the Worker class.  
    */  
@@ -56,6 +75,12 @@ public:
    */  
   int getId();
 
+  /**  
+   * @brief Enables work stealing; must be called before the loop starts.  
+   * @param hooks Callbacks provided by the WorkerPool.  
+   */  
+  void setStealHooks(StealHooks hooks);
+
 signals:  
   /**  
    * @brief Signal emitted when a task is processed and a response is ready.  
@@ -76,11 +101,19 @@ private:
    */  
   void processMessage(const SignalingTask& task);  
 
+  /**  
+   * @brief Waits up to DEFAULT_TIMEOUT for the next task: own queue first, then stolen ones.  
+   * @param task Receives the task.  
+   * @return True if a task was taken.  
+   */  
+  bool nextTask(SignalingTask& task);  
+
 private:  
   int _workerId;  ///< Unique identifier for the Worker.  
-  BlockingQueue<SignalingTask>::bqPtr _queue;  ///< Shared blocking queue for tasks.  
+  TaskQueue<SignalingTask>::Ptr _queue;  ///< Shared task queue.  
   QAtomicInt _isRunning;  ///< Atomic flag indicating whether the Worker is running.  
   SignalingProcessor _processor;  ///< Function to process tasks.  
+  StealHooks _hooks;  ///< Work stealing callbacks; empty in shared dispatch.  
 };  
 
 /**  
@@ -89,6 +122,12 @@ private:
 *  
 * The WorkerPool class is responsible for creating and managing multiple Worker threads,  
 * distributing tasks among them, and ensuring safe shutdown of all threads.  
+*  
+* In sharded dispatch every Worker owns a queue and a client's tasks always go to the  
+* same one, so they are processed in arrival order without cross-worker contention.  
+* Tasks the StatelessPredicate accepts go to a per-Worker stealable queue instead, which  
+* idle Workers drain as well; an idle Worker is woken by an empty wake-up task. Without a  
+* predicate there are no stealable queues and the Workers only wait on their own.  
 */  
 class WorkerPool : public QObject  
 {  
@@ -108,13 +147,22 @@ public:
 
    Q_DISABLE_COPY(WorkerPool)  ///< Disables copy and assignment.
 
+   /**  
+    * @brief Type alias for the test deciding whether a task may be processed by any Worker.  
+    */  
+   using StatelessPredicate = std::function<bool(const SignalingTask& task)>;
+
    /**  
     * @brief Starts the thread pool and creates Worker instances.  
     * @param threadCount The number of threads to create.  
     * @param processor The task processing logic to inject into each Worker.  
+    * @param queueType The task queue implementation used for the Workers' queues.  
+    * @param mode Shared queue, or one queue per Worker chosen by client id.  
+    * @param isStateless Sharded only: tasks it accepts may be stolen by any Worker; nullptr disables stealing.  
     * @return True if the thread pool starts successfully, false otherwise.  
     */  
-   bool start(size_t threadCount, Worker::SignalingProcessor processor);  
+   bool start(size_t threadCount, Worker::SignalingProcessor processor, QueueType queueType = QueueType::Blocking,  
+       DispatchMode mode = DispatchMode::Sharded, StatelessPredicate isStateless = nullptr);  
 
    /**  
     * @brief Stops all Worker loops and waits for all threads to exit safely.
@@ -130,14 +178,14 @@ public:
    bool submitTask(const SignalingTask& task);  
 
    /**  
-    * @brief Retrieves the current size of the task queue.  
-    * @return The size of the task queue.  
+    * @brief Retrieves the current size of the task queues.  
+    * @return The number of queued tasks over all queues.  
     */  
    int getQueueSize() const;  
 
 signals:  
    /**  
-    * @brief Forwards the processing results from Workers to the TcpSignalingServer.  
+    * @brief Forwards the processing results from Workers to the TcpSignalingServer; emitted on the Worker's thread.  
     * @param targetId The target client ID.  
     * @param json The response data.  
     */  
@@ -154,8 +202,27 @@ private:
     */  
    void handleWorkerFinished();  
 
+   /**  
+    * @brief Picks the Worker queue for a client: the same one for all of its tasks.  
+    */  
+   int shardOf(const QString& clientId) const;  
+
+   /**  
+    * @brief Takes a stealable task, starting with the given Worker's own queue.  
+    */  
+   bool stealTask(int index, SignalingTask& task);  
+
+   /**  
+    * @brief Sends a wake-up task to one parked Worker, preferring the given one.  
+    */  
+   void wakeIdleWorker(int first);  
+
 private:  
-   BlockingQueue<SignalingTask>::bqPtr _taskQueue;  ///< Task queue owned by the WorkerPool.  
+   DispatchMode _mode;                              ///< Dispatch mode chosen by start().  
+   QVector<TaskQueue<SignalingTask>::Ptr> _queues;  ///< The shared queue, or one per Worker when sharded.  
+   QVector<TaskQueue<SignalingTask>::Ptr> _stealable;  ///< Sharded: stateless tasks per Worker, open to stealing.  
+   std::unique_ptr<std::atomic<bool>[]> _idle;     ///< Sharded: Workers about to park on their queue.  
+   StatelessPredicate _isStateless;                 ///< Sharded: which tasks may be stolen.  
    QVector<QThread*> _threads;                      ///< Container for QThread instances.  
    QVector<Worker*> _workers;                       ///< Container for Worker objects.  
    QAtomicInt _isRunning;                           ///< Atomic flag indicating whether the thread pool is running.  
@@ -0,0 +1,70 @@
+// Headless signaling server: no QApplication and no window, configured from flags or an INI file
+//
+// SIGTERM / SIGINT drain the server (see SignalingServer::drain()) and exit with 0 once every
+// session has closed, 1 if some did not close within --drain-timeout. A second signal during
+// the drain exits at once.
+//
+// Usage: signaling-server-daemon --config /etc/signaling-server.ini --log-level warning
+#include "ServerConfig.h"
+#include "SignalingServer.h"
+
+#include <QCoreApplication>
+#include <QTimer>
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+volatile std::sig_atomic_t g_stopRequested = 0;
+
+void onStopSignal(int)
+{
+    // Only async-signal-safe work here; the main thread polls the flag
+    if (g_stopRequested) {
+        std::_Exit(1);
+    }
+    g_stopRequested = 1;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("signaling-server-daemon"));
+
+    ServerConfig config;
+    QString error;
+    if (!config.parse(QCoreApplication::arguments(), &error)) {
+        std::fprintf(stderr, "%s\n", qPrintable(error));
+        return 2;
+    }
+    config.applyLogLevel();
+
+    std::signal(SIGTERM, onStopSignal);
+    std::signal(SIGINT, onStopSignal);
+
+    SignalingServer* server = SignalingServer::getInstance(config.address, config.port, config.workerNum,
+        config.queueType, config.dispatchMode, config.ioThreadNum);
+    if (!server->start(config.address, config.port)) {
+        return 1;
+    }
+
+    int exitCode = 0;
+    QTimer stopPoll;
+    QObject::connect(&stopPoll, &QTimer::timeout, &app, [&]() {
+        if (!g_stopRequested) {
+            return;
+        }
+        stopPoll.stop();
+        INFO() << "Stop requested, draining";
+        exitCode = server->drain(config.drainTimeoutMs) ? 0 : 1;
+        QCoreApplication::quit();
+    });
+    stopPoll.start(100);
+
+    app.exec();
+    return exitCode;
+}
@@ -0,0 +1,110 @@
+#include "CaptureScheduler.h"
+#include <QDebug>
+#include <algorithm>
+
+// 采集时钟抖动容忍量：显示器刷新间隔不会刚好等于采样间隔
+static const qint64 ADMIT_JITTER_US = 2000;
+
+CaptureScheduler::CaptureScheduler()
+    : CaptureScheduler(Config())
+{}
+
+CaptureScheduler::CaptureScheduler(const Config& config)
+    : m_config(config)
+{}
+
+void CaptureScheduler::setConfig(const Config& config)
+{
+    QMutexLocker guard(&m_mutex);
+    m_config = config;
+}
+
+CaptureScheduler::Config CaptureScheduler::config() const
+{
+    QMutexLocker guard(&m_mutex);
+    return m_config;
+}
+
+CaptureScheduler::Mode CaptureScheduler::mode() const
+{
+    QMutexLocker guard(&m_mutex);
+    return m_mode;
+}
+
+void CaptureScheduler::reset()
+{
+    QMutexLocker guard(&m_mutex);
+    m_mode = Mode::Normal;
+    m_lastAdmitUs = -1;
+    m_lastChangeUs = -1;
+    m_burstUntilUs = -1;
+    m_changedStreak = 0;
+}
+
+const char* CaptureScheduler::modeName(Mode mode)
+{
+    switch (mode) {
+    case Mode::Idle: return "Idle";
+    case Mode::Burst: return "Burst";
+    default: return "Normal";
+    }
+}
+
+qint64 CaptureScheduler::intervalUsLocked() const
+{
+    int fps = m_config.targetFps;
+    if (m_mode == Mode::Idle) fps = m_config.idleFps;
+    else if (m_mode == Mode::Burst) fps = m_config.maxFps;
+    return 1000000 / std::max(1, fps);
+}
+
+void CaptureScheduler::setModeLocked(Mode mode)
+{
+    if (m_mode == mode) return;
+    qDebug() << "Capture scheduler:" << modeName(m_mode) << "->" << modeName(mode);
+    m_mode = mode;
+}
+
+bool CaptureScheduler::admit(qint64 captureTimeUs)
+{
+    QMutexLocker guard(&m_mutex);
+
+    // Burst 到期回落；Idle 只能由 reportFrame 检测到变化后退出
+    if (m_mode == Mode::Burst && captureTimeUs >= m_burstUntilUs) {
+        setModeLocked(Mode::Normal);
+    }
+
+    // 首帧或时钟回绕（重新开始采集）直接接收
+    if (m_lastAdmitUs < 0 || captureTimeUs < m_lastAdmitUs ||
+        captureTimeUs - m_lastAdmitUs >= intervalUsLocked() - ADMIT_JITTER_US) {
+        m_lastAdmitUs = captureTimeUs;
+        return true;
+    }
+    return false;
+}
+
+void CaptureScheduler::reportFrame(qint64 captureTimeUs, double dirtyRatio, bool identical)
+{
+    QMutexLocker guard(&m_mutex);
+    if (m_lastChangeUs < 0) m_lastChangeUs = captureTimeUs;
+
+    if (identical) {
+        m_changedStreak = 0;
+        if (m_mode == Mode::Normal &&
+            captureTimeUs - m_lastChangeUs >= static_cast<qint64>(m_config.idleAfterMs) * 1000) {
+            setModeLocked(Mode::Idle);
+        }
+        return;
+    }
+
+    m_lastChangeUs = captureTimeUs;
+    ++m_changedStreak;
+
+    if (dirtyRatio >= m_config.burstDirtyRatio || m_changedStreak >= m_config.burstChangedFrames) {
+        m_burstUntilUs = captureTimeUs + static_cast<qint64>(m_config.burstHoldMs) * 1000;
+        setModeLocked(Mode::Burst);
+    }
+    else if (m_mode == Mode::Idle) {
+        setModeLocked(Mode::Normal);
+    }
+}
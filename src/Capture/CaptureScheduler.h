@@ -0,0 +1,54 @@
+#pragma once
+#include <QMutex>
+#include <QtGlobal>
+
+// 内容自适应的采集帧率调度
+// - Normal：按目标帧率采样
+// - Idle：画面持续不变时降到 idleFps（约 1 fps）
+// - Burst：大面积变化或连续变化（滚动、视频）时升到 maxFps，并保持一段时间
+// 所有时间均来自采集时钟（微秒）
+// admit() 在采集线程调用，reportFrame() 在编码线程调用
+class CaptureScheduler
+{
+public:
+    enum class Mode { Normal, Idle, Burst };
+
+    struct Config {
+        int targetFps = 15;             // 常规帧率
+        int maxFps = 30;                // Burst 帧率
+        int idleFps = 1;                // Idle 帧率
+        int idleAfterMs = 2000;         // 画面多久不变进入 Idle
+        int burstHoldMs = 1000;         // 最后一次活动后 Burst 维持时长
+        double burstDirtyRatio = 0.25;  // 单帧变化面积达到该比例即进入 Burst
+        int burstChangedFrames = 3;     // 连续变化帧数达到该值即进入 Burst
+    };
+
+    CaptureScheduler();
+    explicit CaptureScheduler(const Config& config);
+
+    void setConfig(const Config& config);
+    Config config() const;
+
+    // 是否接收这一帧；接收时会记录为本次采样时间
+    bool admit(qint64 captureTimeUs);
+
+    // 报告一帧的比较结果，用于切换模式
+    void reportFrame(qint64 captureTimeUs, double dirtyRatio, bool identical);
+
+    Mode mode() const;
+    void reset();
+
+    static const char* modeName(Mode mode);
+
+private:
+    qint64 intervalUsLocked() const;
+    void setModeLocked(Mode mode);
+
+    mutable QMutex m_mutex;
+    Config m_config;
+    Mode m_mode = Mode::Normal;
+    qint64 m_lastAdmitUs = -1;
+    qint64 m_lastChangeUs = -1;
+    qint64 m_burstUntilUs = -1;
+    int m_changedStreak = 0;
+};
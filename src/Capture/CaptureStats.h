@@ -0,0 +1,22 @@
+#pragma once
+#include <QtGlobal>
+#include <atomic>
+#include <memory>
+
+// 采集/编码管线的计数器，采集线程与编码线程共享
+struct CaptureStats
+{
+    using Ptr = std::shared_ptr<CaptureStats>;
+
+    std::atomic<quint64> droppedFrames{ 0 };     // 编码线程未运行或帧无效而丢弃
+    std::atomic<quint64> throttledFrames{ 0 };   // 被帧率调度跳过
+    std::atomic<quint64> supersededFrames{ 0 };  // 还未编码就被更新的帧覆盖
+    std::atomic<quint64> identicalFrames{ 0 };   // 与上一帧相同而跳过编码
+    std::atomic<quint64> encodedFrames{ 0 };     // 实际送入编码器
+    std::atomic<quint64> losslessTiles{ 0 };     // 混合编码：发送的无损块与作废的块数
+    std::atomic<quint64> losslessBytes{ 0 };     // 混合编码：块更新消息的总字节数
+
+    static void inc(std::atomic<quint64>& counter) {
+        counter.fetch_add(1, std::memory_order_relaxed);
+    }
+};
@@ -0,0 +1,26 @@
+#pragma once
+#include <QRect>
+#include <QVideoFrame>
+#include <QVector>
+#include <QtGlobal>
+
+// 每一帧随画面一起向下游（编码器/传输）传递的元数据
+struct FrameMeta
+{
+    quint64 frameId = 0;          // 采集帧序号（只统计送去编码的帧）
+    qint64 captureTimeUs = -1;    // 采集时钟时间戳（微秒），-1 表示未知
+    bool fullFrame = true;        // 首帧、分辨率变化或无法比较的格式：整帧视为脏
+    QVector<QRect> dirtyRects;    // 相对上一帧发生变化的区域（按 64x64 块对齐）
+    double dirtyRatio = 1.0;      // 变化块占全部块的比例
+    int layer = 0;                // simulcast 层序号，0 为最高一层；不开 simulcast 时总是 0
+
+    // 与上一帧完全相同，可以跳过编码
+    bool isIdentical() const { return !fullFrame && dirtyRects.isEmpty(); }
+};
+
+// 采集线程交给编码线程的一帧：画面 + 采集时刻
+struct CapturedFrame
+{
+    QVideoFrame frame;
+    qint64 captureTimeUs = -1;
+};
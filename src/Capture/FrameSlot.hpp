@@ -0,0 +1,64 @@
+#pragma once
+#include <QMutex>
+#include <QWaitCondition>
+#include <memory>
+#include <utility>
+
+// 单生产者/单消费者的"最新帧"槽位
+// 采集线程 put() 覆盖旧帧，编码线程 take() 取走最新一帧
+// 槽位容量固定为 1：编码慢时旧帧被直接覆盖而不是排队，延迟不会累积
+template<class T>
+class FrameSlot
+{
+public:
+    using Ptr = std::shared_ptr<FrameSlot<T>>;
+
+    FrameSlot() {}
+    ~FrameSlot() {}
+
+    // 放入一帧，返回 true 表示覆盖了一帧尚未被取走的旧帧
+    bool put(T value) {
+        bool superseded = false;
+        {
+            QMutexLocker guard(&m_mutex);
+            superseded = m_hasValue;
+            m_value = std::move(value);
+            m_hasValue = true;
+        }
+        m_cond.wakeOne();
+        return superseded;
+    }
+
+    // 取出最新帧，槽位为空时最多等待 timeoutMs 毫秒
+    bool take(T& value, int timeoutMs) {
+        QMutexLocker guard(&m_mutex);
+        if (!m_hasValue) {
+            m_cond.wait(&m_mutex, timeoutMs);
+            if (!m_hasValue) return false;
+        }
+        value = std::move(m_value);
+        m_value = T();
+        m_hasValue = false;
+        return true;
+    }
+
+    // 丢弃槽位中未被消费的帧，返回是否真的丢弃了一帧
+    bool clear() {
+        QMutexLocker guard(&m_mutex);
+        bool had = m_hasValue;
+        m_value = T();
+        m_hasValue = false;
+        return had;
+    }
+
+    // 唤醒等待中的消费者（用于退出）
+    void notifyAll() {
+        m_cond.wakeAll();
+    }
+
+private:
+    T m_value{};
+    bool m_hasValue = false;
+    QMutex m_mutex;
+    QWaitCondition m_cond;
+};
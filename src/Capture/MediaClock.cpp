@@ -0,0 +1,29 @@
+#include "MediaClock.h"
+
+MediaClock::MediaClock()
+    : m_origin(std::chrono::steady_clock::now())
+    , m_originWallUs(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count())
+{}
+
+qint64 MediaClock::nowUs() const
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - m_origin).count();
+}
+
+qint64 MediaClock::rtpTicks(qint64 mediaUs)
+{
+    return mediaUs * RTP_CLOCK_RATE / 1000000;
+}
+
+quint32 MediaClock::rtpTimestamp(qint64 mediaUs)
+{
+    return static_cast<quint32>(rtpTicks(mediaUs));
+}
+
+qint64 MediaClock::wallClockUs(qint64 mediaUs) const
+{
+    // 墙上时间只在启动时采样一次，之后跟随单调时钟，不受系统时间跳变影响
+    return m_originWallUs + mediaUs;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <QtGlobal>
+#include <chrono>
+#include <memory>
+
+// RTP 视频时钟频率
+const int RTP_CLOCK_RATE = 90000;
+
+// 发送端媒体时钟，由 ScreenCaptureService 持有，进程内只启动一次（多次开始/停止采集时间戳仍单调）
+// - 采集线程在收到帧时打时间戳（nowUs），随 FrameMeta 经颜色转换、编码、传输，
+//   在编码器里换算成 90kHz 的 pts / RTP 时间戳
+// - 同时记录启动时刻的墙上时间，发送 SR 时据此给出 NTP <-> RTP 的对应关系，
+//   接收端可以把任一帧的 RTP 时间戳换算回发送端的采集时刻
+class MediaClock
+{
+public:
+    using Ptr = std::shared_ptr<MediaClock>;
+
+    MediaClock();
+
+    // 自时钟启动以来的微秒数（单调）
+    qint64 nowUs() const;
+
+    // 媒体时间 -> 90kHz 时钟计数（编码器 pts，不回绕）
+    static qint64 rtpTicks(qint64 mediaUs);
+    // 媒体时间 -> RTP 时间戳（rtpTicks 按 32 位回绕）
+    static quint32 rtpTimestamp(qint64 mediaUs);
+
+    // 媒体时间 -> 墙上时间（Unix 微秒）
+    qint64 wallClockUs(qint64 mediaUs) const;
+
+private:
+    std::chrono::steady_clock::time_point m_origin;
+    qint64 m_originWallUs = 0;
+};
@@ -1,12 +1,16 @@
 #include "ScreenCaptureService.h"
 #include "../encoder/VideoEncoder.h" 
+#include "../encoder/EncodeWorker.h"
+#include "../encoder/SimulcastEncoder.h"
 // #include "../network/RtcRtpSender.h" 
 #include <QGuiApplication>
 #include <QScreen>
 #include <QDebug>
+#include <algorithm>
 
 ScreenCaptureService::ScreenCaptureService(QObject* parent)
     : QObject(parent)
+    , m_mediaClock(std::make_shared<MediaClock>())
 {
     init();
 }
@@ -16,6 +20,9 @@ ScreenCaptureService::~ScreenCaptureService()
     stopCapture();
     // Qt Ķ(parent)Զڴ棬
     // Ϊ˱գֶֹͣһ¸
+
+    // ڶϣڱ̣߳Ҫֶͷ
+    releaseEncoder();
 }
 
 void ScreenCaptureService::init()
@@ -36,42 +43,87 @@ void ScreenCaptureService::init()
     m_videoSink = new QVideoSink(this);
     m_session->setVideoOutput(m_videoSink); // ᵼ½ڣ
 
-    // źţÿĻˢ£frameChanged 
+    m_frameSlot = std::make_shared<FrameSlot<CapturedFrame>>();
+    m_stats = std::make_shared<CaptureStats>();
+
+    // źţÿĻˢ£frameChanged Ƶʵʾˢʣ
+    // ɵǰģʽ֡ʲٰ֡Žλڱ߳ɣ
+    // λδȡߵľֱ֡ӱ
     connect(m_videoSink, &QVideoSink::videoFrameChanged, this, [this](const QVideoFrame& frame) {
-        if (m_encoder && frame.isValid()) {
-            // һ֡
-            m_encoder->encode(frame);
+        if (!m_encodeWorker || !frame.isValid()) {
+            CaptureStats::inc(m_stats->droppedFrames);
+            return;
+        }
+        const qint64 captureTimeUs = captureTimestampUs();
+        if (!m_scheduler.admit(captureTimeUs)) {
+            CaptureStats::inc(m_stats->throttledFrames);
+            return;
+        }
+        if (m_frameSlot->put(CapturedFrame{ frame, captureTimeUs })) {
+            CaptureStats::inc(m_stats->supersededFrames);
         }
     });
 }
 
+void ScreenCaptureService::startEncodeThread()
+{
+    if (m_encodeThread || (!m_encoder && !m_simulcastEncoder)) return;
+
+    m_encodeThread = new QThread(this);
+    if (m_simulcastEncoder) {
+        m_encodeWorker = new EncodeWorker(m_frameSlot, m_simulcastEncoder, m_stats, &m_scheduler);
+    }
+    else {
+        m_encodeWorker = new EncodeWorker(m_frameSlot, m_encoder, m_stats, &m_scheduler);
+    }
+    m_encodeWorker->setHybridTilesEnabled(m_hybridTiles);
+    m_encodeWorker->moveToThread(m_encodeThread);
+    connect(m_encodeWorker, &EncodeWorker::tileUpdateReady, this, &ScreenCaptureService::tileUpdateReady,
+        Qt::DirectConnection);
+
+    connect(m_encodeThread, &QThread::started, m_encodeWorker, &EncodeWorker::startLoop);
+    connect(m_encodeThread, &QThread::finished, m_encodeWorker, &QObject::deleteLater);
+    m_encodeThread->start();
+}
+
+void ScreenCaptureService::stopEncodeThread()
+{
+    if (!m_encodeThread) return;
+
+    // startLoop ѭҪ˳¼ѭӦ quit()
+    m_encodeWorker->stop();
+    m_encodeThread->quit();
+    m_encodeThread->wait();
+    delete m_encodeThread;
+    m_encodeThread = nullptr;
+    m_encodeWorker = nullptr; //  QThread::finished -> deleteLater ͷ
+
+    if (m_frameSlot->clear()) {
+        CaptureStats::inc(m_stats->droppedFrames);
+    }
+}
+
 void ScreenCaptureService::startCapture()
 {   
-    if (!m_encoder) {
-        m_encoder = new VideoEncoder(this);
-        // 1080p, 30fps, 4Mbps (Ա֤)
-        if (m_encoder->init(640, 360, 15, 4000000)) {
-            qDebug() << "Video Encoder Initialized!";
-        }
-        else {
-            qDebug() << "Encoder Init Failed!";
-            return;
-        }
-
-        // 3. Encoder -> Sender
-        m_encoder->onEncodedData = [this](const std::vector<uint8_t>& data, uint32_t ts) {
-            QByteArray qData(reinterpret_cast<const char*>(data.data()), data.size());
-            emit encodedFrameReady(qData, ts);
-            // qDebug() << "Captured data is :" << data <<"\n";
-            // stopCapture();
-            };
+    const bool simulcast = !m_simulcastLayers.isEmpty();
+    const bool stale = (m_encoder && (simulcast || m_encoder->codec() != m_videoCodec)) ||
+        (m_simulcastEncoder && (!simulcast || m_simulcastEncoder->codec() != m_videoCodec ||
+            m_simulcastEncoder->layers() != m_simulcastLayers));
+    if (stale) {
+        // Э˱ʽл simulcast ạٰ̃ͣ߳ؽ
+        stopEncodeThread();
+        releaseEncoder();
     }
 
-    // û׼ãӡ
-    if (!m_encoder) {
+    if (!m_encoder && !m_simulcastEncoder && !createEncoder()) {
+        // û׼ãӡ
         qDebug() << "Warning: Encoder not initialized yet. Frames will be dropped.";
+        return;
     }
 
+    m_scheduler.reset();
+    startEncodeThread();
+
     if (m_screenCapture) {
         m_screenCapture->start();
         qDebug() << "Screen Capture Started!";
@@ -79,6 +131,59 @@ void ScreenCaptureService::startCapture()
     }
 }
 
+bool ScreenCaptureService::createEncoder()
+{
+    // ֡ʰ֡ãʵ֡ɲɼʱɱ֡ʣ
+    const int fps = m_scheduler.config().maxFps;
+
+    if (!m_simulcastLayers.isEmpty()) {
+        m_simulcastEncoder = new SimulcastEncoder();
+        m_simulcastEncoder->setCodec(m_videoCodec);
+        m_simulcastEncoder->setKeyframeMode(m_keyframeMode, m_keyframeIntervalMs);
+        if (!m_simulcastEncoder->init(m_simulcastLayers, fps)) {
+            qDebug() << "Simulcast Encoder Init Failed!";
+            releaseEncoder();
+            return false;
+        }
+        qDebug() << "Simulcast Encoder Initialized with" << m_simulcastLayers.size() << "layers";
+        // صڸı̣߳encodedFrameReady ԶзʽͶݸ
+        m_simulcastEncoder->onEncodedData = [this](EncodedFrame::Ptr frame) {
+            emit encodedFrameReady(frame);
+            };
+        return true;
+    }
+
+    m_encoder = new VideoEncoder();
+    m_encoder->setCodec(m_videoCodec);
+    m_encoder->setKeyframeMode(m_keyframeMode, m_keyframeIntervalMs);
+    if (m_encoder->init(640, 360, fps, m_targetBitrate)) {
+        qDebug() << "Video Encoder Initialized!";
+    }
+    else {
+        qDebug() << "Encoder Init Failed!";
+        releaseEncoder();
+        return false;
+    }
+
+    // 3. Encoder -> Sender
+    // ע⣺صڱ̣߳encodedFrameReady ԶзʽͶݸ
+    m_encoder->onEncodedData = [this](EncodedFrame::Ptr frame) {
+        emit encodedFrameReady(frame);
+        // qDebug() << "Captured data is :" << data <<"\n";
+        // stopCapture();
+        };
+    return true;
+}
+
+void ScreenCaptureService::releaseEncoder()
+{
+    delete m_encoder;
+    m_encoder = nullptr;
+    // ʱͣ߳
+    delete m_simulcastEncoder;
+    m_simulcastEncoder = nullptr;
+}
+
 void ScreenCaptureService::stopCapture()
 {
     if (m_screenCapture) {
@@ -86,6 +191,7 @@ void ScreenCaptureService::stopCapture()
         qDebug() << "Screen Capture Stopped!";
         emit captureStateChanged(false);
     }
+    stopEncodeThread();
 }
 
 // void ScreenCaptureService::initEncoder()
@@ -159,3 +265,125 @@ QVideoWidget* ScreenCaptureService::getVideoPreviewWidget()
 {
     return m_previewWidget;
 }
+
+quint64 ScreenCaptureService::droppedFrameCount() const
+{
+    return m_stats->droppedFrames.load(std::memory_order_relaxed);
+}
+
+quint64 ScreenCaptureService::supersededFrameCount() const
+{
+    return m_stats->supersededFrames.load(std::memory_order_relaxed);
+}
+
+quint64 ScreenCaptureService::throttledFrameCount() const
+{
+    return m_stats->throttledFrames.load(std::memory_order_relaxed);
+}
+
+quint64 ScreenCaptureService::identicalFrameCount() const
+{
+    return m_stats->identicalFrames.load(std::memory_order_relaxed);
+}
+
+void ScreenCaptureService::setSchedulerConfig(const CaptureScheduler::Config& config)
+{
+    m_scheduler.setConfig(config);
+}
+
+CaptureScheduler::Config ScreenCaptureService::schedulerConfig() const
+{
+    return m_scheduler.config();
+}
+
+void ScreenCaptureService::setTargetFrameRate(int fps)
+{
+    CaptureScheduler::Config config = m_scheduler.config();
+    config.targetFps = fps;
+    config.maxFps = std::max(config.maxFps, fps);
+    m_scheduler.setConfig(config);
+}
+
+void ScreenCaptureService::setTargetBitrate(int bitrate)
+{
+    if (bitrate <= 0) return;
+    m_targetBitrate = bitrate;
+    if (m_encoder) {
+        m_encoder->setTargetBitrate(bitrate);
+    }
+    else if (m_simulcastEncoder && m_simulcastEncoder->layerCount() == 1) {
+        m_simulcastEncoder->setLayerBitrate(0, bitrate);
+    }
+}
+
+void ScreenCaptureService::setSimulcastLayers(const QVector<SimulcastLayer>& layers)
+{
+    m_simulcastLayers = layers;
+}
+
+QVector<SimulcastLayer> ScreenCaptureService::simulcastLayers() const
+{
+    return m_simulcastLayers;
+}
+
+void ScreenCaptureService::setHybridTilesEnabled(bool enabled)
+{
+    m_hybridTiles = enabled;
+}
+
+void ScreenCaptureService::resetTileCache()
+{
+    if (m_encodeWorker) {
+        m_encodeWorker->resetHybridTiles();
+    }
+}
+
+void ScreenCaptureService::confirmTileUpdate(TileUpdate::Ptr update, bool delivered)
+{
+    if (m_encodeWorker) {
+        m_encodeWorker->confirmHybridTiles(std::move(update), delivered);
+    }
+}
+
+quint64 ScreenCaptureService::losslessTileCount() const
+{
+    return m_stats->losslessTiles.load(std::memory_order_relaxed);
+}
+
+quint64 ScreenCaptureService::losslessTileBytes() const
+{
+    return m_stats->losslessBytes.load(std::memory_order_relaxed);
+}
+
+void ScreenCaptureService::requestKeyframe(int layer)
+{
+    if (m_encoder) {
+        m_encoder->requestKeyframe();
+    }
+    else if (m_simulcastEncoder) {
+        m_simulcastEncoder->requestKeyframe(layer);
+    }
+}
+
+void ScreenCaptureService::setKeyframeMode(VideoEncoder::KeyframeMode mode, int intervalMs)
+{
+    m_keyframeMode = mode;
+    m_keyframeIntervalMs = intervalMs;
+}
+
+void ScreenCaptureService::setVideoCodec(VideoCodec codec)
+{
+    m_videoCodec = codec;
+}
+
+qint64 ScreenCaptureService::captureTimestampUs() const
+{
+    // ʹòɼ˴֡ϵ startTimeƽ̨˵ʱͬ޷ǽʱӦ
+    // ͳһ֡ʱýʱӴ֮ pts / RTP ʱ
+    return m_mediaClock->nowUs();
+}
+
+MediaClock::Ptr ScreenCaptureService::mediaClock() const
+{
+    return m_mediaClock;
+}
@@ -5,11 +5,23 @@
 #include <QMediaCaptureSession>
 #include <QScreenCapture>
 #include <QVideoWidget>
+#include <QThread>
 #include <memory>  // for std::unique_ptr
+#include <QRect>
+#include <QVector>
 #include "../encoder/VideoEncoder.h"
+#include "../encoder/SimulcastLayer.h"
+#include "../encoder/TileUpdate.h"
+#include "FrameSlot.hpp"
+#include "CaptureStats.h"
+#include "CaptureScheduler.h"
+#include "FrameMeta.h"
+#include "MediaClock.h"
 // #include "../network/RtcRtpSender.h" 
 
 class RtcRtpSender;
+class EncodeWorker;
+class SimulcastEncoder;
 
 // ̳ QObject ΪʹźŲۻ
 class ScreenCaptureService : public QObject
@@ -31,21 +43,95 @@ public:
     // UIָ
     QVideoWidget* getVideoPreviewWidget();
 
+    // ѹͳƣ֡߳δ/֡Ч뱻֡ǵ֡
+    quint64 droppedFrameCount() const;
+    quint64 supersededFrameCount() const;
+    // ֡ʵ֡
+    quint64 throttledFrameCount() const;
+    // һ֡ȫͬ֡
+    quint64 identicalFrameCount() const;
+
+    // ɼ֡ʵȣĿ֡ / Idle ֡ / Burst ֡ʵ
+    // ע maxFps ڱʼ״ startCaptureʱЧ
+    void setSchedulerConfig(const CaptureScheduler::Config& config);
+    CaptureScheduler::Config schedulerConfig() const;
+    void setTargetFrameRate(int fps);
+
+    // ؼ֡ն˶ / PLI
+    // simulcast ģʽֻ layer һ㣬layer < 0 ʱв
+    void requestKeyframe(int layer = -1);
+
+    // Ͷýʱӣ֡ʱ SR  NTP <-> RTP ӦϵĹͬԴ
+    MediaClock::Ptr mediaClock() const;
+
+    // ؼ֡ԣڱʼ״ startCaptureʱЧ
+    void setKeyframeMode(VideoEncoder::KeyframeMode mode, int intervalMs = 0);
+
+    // ԶЭ̳ıʽһ startCapture ʱЧʽ仯ʱؽ
+    void setVideoCodec(VideoCodec codec);
+
+    // ĿʣbpsɷͶ˴ҲԵ
+    // simulcast ģʽ¸㱣õʣֻתһ㣬ﲻ
+    // ֻһʱ뵥·ͬһ㣩
+    void setTargetBitrate(int bitrate);
+
+    // simulcastһβɼֱͬʱ루 = رգ·룩һ startCapture ʱЧ
+    //  meta().layer Ϊţɴ˰ڵĴӿѡ
+    void setSimulcastLayers(const QVector<SimulcastLayer>& layers);
+    QVector<SimulcastLayer> simulcastLayers() const;
+
+    // ϱ룺ֹĿͣtileUpdateReady˶ճƵ
+    // ڱ߳startCaptureʱЧ
+    void setHybridTilesEnabled(bool enabled);
+    // Զӡ黺Ѷʧʱã·Ϣȫֹ
+    void resetTileCache();
+    // tileUpdateReady ϢķͽûʹĿ·
+    void confirmTileUpdate(TileUpdate::Ptr update, bool delivered);
+    // ϱ뷢͵Ŀϣֽ
+    quint64 losslessTileCount() const;
+    quint64 losslessTileBytes() const;
+
 signals:
     // 磺״̬ (ѡ)
     void captureStateChanged(bool isRunning);
 
     void videoDataReady(const std::vector<uint8_t>& data);
-    void encodedFrameReady(const QByteArray& encodedData, uint32_t timestamp);
+    // ÿ֡һΣ access unitĻ
+    // 仯Ϣ frame->meta() 
+    void encodedFrameReady(EncodedFrame::Ptr frame);
+    // ϱģʽµһ£ڱ̷߳
+    void tileUpdateReady(TileUpdate::Ptr update);
 
 private:
     void init();
+    void startEncodeThread();
+    void stopEncodeThread();
+    // ǰô· simulcastʧʱ false
+    bool createEncoder();
+    void releaseEncoder();
+    // ɼʱ̣ýʱӣ΢룩
+    qint64 captureTimestampUs() const;
 
     QMediaCaptureSession* m_session = nullptr;
     QScreenCapture* m_screenCapture = nullptr;
     QVideoWidget* m_previewWidget = nullptr; // һԤС
     QVideoSink* m_videoSink = nullptr; // ȡ֡
-    VideoEncoder* m_encoder = nullptr; // ѹ֡
+    VideoEncoder* m_encoder = nullptr; // ѹ֡ڱ̣߳ڶ
+    SimulcastEncoder* m_simulcastEncoder = nullptr; // simulcast ģʽ´ m_encoder
+
+    // ɼ ->  ӣɼֻ߳д֡߳ȡ֡
+    FrameSlot<CapturedFrame>::Ptr m_frameSlot;
+    QThread* m_encodeThread = nullptr;
+    EncodeWorker* m_encodeWorker = nullptr;
+    CaptureStats::Ptr m_stats;
+    CaptureScheduler m_scheduler;
+    MediaClock::Ptr m_mediaClock;
+    int m_targetBitrate = 4000000;
+    VideoEncoder::KeyframeMode m_keyframeMode = VideoEncoder::KeyframeMode::IntraRefresh;
+    int m_keyframeIntervalMs = 0;
+    VideoCodec m_videoCodec = VideoCodec::H264;
+    QVector<SimulcastLayer> m_simulcastLayers;
+    bool m_hybridTiles = false;
 
     // WebRTC RTP 
     // ʹָ (unique_ptr) ڴ棬ֶ delete
@@ -0,0 +1,164 @@
+#include "TileDiffer.h"
+#include "../encoder/ColorConverter.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define TD_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(TD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define TD_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TD_TARGET_AVX2
+#endif
+
+namespace {
+
+// 逐行比较，遇到第一个不同的 16/32 字节块立即返回
+#ifdef TD_X86
+bool rowEqualSSE2(const uint8_t* a, const uint8_t* b, int bytes) {
+    int i = 0;
+    for (; i + 64 <= bytes; i += 64) {
+        __m128i e0 = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+        __m128i e1 = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i + 16)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i + 16)));
+        __m128i e2 = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i + 32)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i + 32)));
+        __m128i e3 = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i + 48)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i + 48)));
+        __m128i all = _mm_and_si128(_mm_and_si128(e0, e1), _mm_and_si128(e2, e3));
+        if (_mm_movemask_epi8(all) != 0xFFFF) return false;
+    }
+    return std::memcmp(a + i, b + i, bytes - i) == 0;
+}
+
+TD_TARGET_AVX2 bool rowEqualAVX2(const uint8_t* a, const uint8_t* b, int bytes) {
+    int i = 0;
+    for (; i + 128 <= bytes; i += 128) {
+        __m256i e0 = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+        __m256i e1 = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i + 32)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i + 32)));
+        __m256i e2 = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i + 64)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i + 64)));
+        __m256i e3 = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i + 96)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i + 96)));
+        __m256i all = _mm256_and_si256(_mm256_and_si256(e0, e1), _mm256_and_si256(e2, e3));
+        if (_mm256_movemask_epi8(all) != -1) return false;
+    }
+    return rowEqualSSE2(a + i, b + i, bytes - i);
+}
+#endif
+
+bool rowEqual(const uint8_t* a, const uint8_t* b, int bytes, bool useAvx2) {
+#ifdef TD_X86
+    return useAvx2 ? rowEqualAVX2(a, b, bytes) : rowEqualSSE2(a, b, bytes);
+#else
+    (void)useAvx2;
+    return std::memcmp(a, b, bytes) == 0;
+#endif
+}
+
+} // namespace
+
+TileDiffer::TileDiffer()
+    : m_useAvx2(ColorConverter::detectIsa() == ColorConverter::Isa::AVX2)
+{}
+
+void TileDiffer::reset()
+{
+    m_ref.clear();
+    m_width = 0;
+    m_height = 0;
+}
+
+TileDiffer::Result TileDiffer::diff(const uint8_t* pixels, int stride, int width, int height)
+{
+    Result result;
+    const int tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    const int tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+    const int refStride = width * 4;
+    result.totalTiles = tilesX * tilesY;
+    result.tilesX = tilesX;
+    result.tilesY = tilesY;
+
+    // 没有参考帧：整帧拷贝，整帧视为脏
+    if (m_ref.empty() || width != m_width || height != m_height) {
+        m_width = width;
+        m_height = height;
+        m_ref.resize(static_cast<size_t>(refStride) * height);
+        for (int y = 0; y < height; ++y) {
+            std::memcpy(&m_ref[static_cast<size_t>(y) * refStride], pixels + static_cast<ptrdiff_t>(y) * stride, refStride);
+        }
+        result.fullFrame = true;
+        result.dirtyTiles = result.totalTiles;
+        result.dirtyMask.assign(result.totalTiles, 1);
+        result.dirtyRects.append(QRect(0, 0, width, height));
+        return result;
+    }
+
+    result.dirtyMask.assign(result.totalTiles, 0);
+
+    // 上一块行中仍可向下延伸的矩形（在 dirtyRects 中的下标）
+    QVector<int> openRects;
+    QVector<int> nextOpen;
+
+    for (int ty = 0; ty < tilesY; ++ty) {
+        const int y0 = ty * TILE_SIZE;
+        const int tileH = std::min(TILE_SIZE, height - y0);
+        int runStart = -1;
+        nextOpen.clear();
+
+        // 生成本行的水平连续脏块，并尝试与上一行同位置同宽度的矩形合并
+        auto closeRun = [&](int runEnd) {
+            QRect run(runStart * TILE_SIZE, y0, std::min(runEnd * TILE_SIZE, width) - runStart * TILE_SIZE, tileH);
+            for (int idx : openRects) {
+                QRect& prev = result.dirtyRects[idx];
+                if (prev.x() == run.x() && prev.width() == run.width() && prev.y() + prev.height() == y0) {
+                    prev.setHeight(prev.height() + tileH);
+                    nextOpen.append(idx);
+                    return;
+                }
+            }
+            result.dirtyRects.append(run);
+            nextOpen.append(result.dirtyRects.size() - 1);
+        };
+
+        for (int tx = 0; tx < tilesX; ++tx) {
+            const int x0 = tx * TILE_SIZE;
+            const int rowBytes = std::min(TILE_SIZE, width - x0) * 4;
+
+            int firstDiffRow = -1;
+            for (int y = y0; y < y0 + tileH; ++y) {
+                const uint8_t* cur = pixels + static_cast<ptrdiff_t>(y) * stride + x0 * 4;
+                const uint8_t* ref = &m_ref[static_cast<size_t>(y) * refStride + x0 * 4];
+                if (!rowEqual(cur, ref, rowBytes, m_useAvx2)) {
+                    firstDiffRow = y;
+                    break;
+                }
+            }
+
+            if (firstDiffRow >= 0) {
+                // 之前的行已确认相同，只需从第一处不同的行开始更新参考帧
+                for (int y = firstDiffRow; y < y0 + tileH; ++y) {
+                    std::memcpy(&m_ref[static_cast<size_t>(y) * refStride + x0 * 4],
+                        pixels + static_cast<ptrdiff_t>(y) * stride + x0 * 4, rowBytes);
+                }
+                ++result.dirtyTiles;
+                result.dirtyMask[static_cast<size_t>(ty) * tilesX + tx] = 1;
+                if (runStart < 0) runStart = tx;
+            }
+            else if (runStart >= 0) {
+                closeRun(tx);
+                runStart = -1;
+            }
+        }
+        if (runStart >= 0) closeRun(tilesX);
+        openRects.swap(nextOpen);
+    }
+    return result;
+}
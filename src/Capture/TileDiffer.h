@@ -0,0 +1,37 @@
+#pragma once
+#include <QRect>
+#include <QVector>
+#include <cstdint>
+#include <vector>
+
+// 按 64x64 块比较相邻两帧（4 字节/像素格式），输出变化区域
+// 内部保存上一帧的拷贝，只有变化的块会被重新拷贝
+class TileDiffer
+{
+public:
+    static const int TILE_SIZE = 64;
+
+    struct Result {
+        bool fullFrame = false;      // 没有可比较的参考帧（首帧/尺寸变化）
+        QVector<QRect> dirtyRects;   // 合并后的脏矩形
+        int dirtyTiles = 0;
+        int totalTiles = 0;
+        int tilesX = 0;
+        int tilesY = 0;
+        std::vector<uint8_t> dirtyMask; // 按行排列的每块是否变化（1 = 变化）
+    };
+
+    TileDiffer();
+
+    // 与参考帧比较并用当前帧更新参考帧
+    Result diff(const uint8_t* pixels, int stride, int width, int height);
+
+    // 丢弃参考帧，下一帧视为整帧变化
+    void reset();
+
+private:
+    std::vector<uint8_t> m_ref;
+    int m_width = 0;
+    int m_height = 0;
+    bool m_useAvx2 = false;
+};
@@ -0,0 +1,79 @@
+#include "AVFrameVideoBuffer.h"
+#include <QDebug>
+
+extern "C" {
+#include <libavutil/pixdesc.h>
+}
+
+AVFrameVideoBuffer::AVFrameVideoBuffer(AVFrame* frame)
+    : m_frame(frame)
+{
+    m_format = QVideoFrameFormat(QSize(frame->width, frame->height), toQtPixelFormat(frame->format));
+
+    // 编码端（ColorConverter / swscale）输出 BT.601 limited range
+    const bool fullRange = frame->color_range == AVCOL_RANGE_JPEG ||
+        frame->format == AV_PIX_FMT_YUVJ420P;
+    m_format.setColorRange(fullRange ? QVideoFrameFormat::ColorRange_Full : QVideoFrameFormat::ColorRange_Video);
+    m_format.setColorSpace(frame->colorspace == AVCOL_SPC_BT709 ?
+        QVideoFrameFormat::ColorSpace_BT709 : QVideoFrameFormat::ColorSpace_BT601);
+}
+
+AVFrameVideoBuffer::~AVFrameVideoBuffer()
+{
+    av_frame_free(&m_frame);
+}
+
+QAbstractVideoBuffer::MapData AVFrameVideoBuffer::map(QVideoFrame::MapMode mode)
+{
+    MapData data;
+    // 解码器的缓冲区可能仍被当作参考帧，只允许读
+    if (mode != QVideoFrame::ReadOnly) return data;
+
+    const int planes = m_format.planeCount();
+    for (int i = 0; i < planes; ++i) {
+        // NV12 的 UV 平面和 YUV420P 的 U/V 平面都是半高
+        const int height = i == 0 ? m_frame->height : (m_frame->height + 1) / 2;
+        data.bytesPerLine[i] = m_frame->linesize[i];
+        data.data[i] = m_frame->data[i];
+        data.dataSize[i] = m_frame->linesize[i] * height;
+    }
+    data.planeCount = planes;
+    return data;
+}
+
+void AVFrameVideoBuffer::unmap()
+{
+    // 数据一直驻留在 AVFrame 中，无需处理
+}
+
+QVideoFrameFormat AVFrameVideoBuffer::format() const
+{
+    return m_format;
+}
+
+QVideoFrameFormat::PixelFormat AVFrameVideoBuffer::toQtPixelFormat(int avFormat)
+{
+    switch (avFormat) {
+    case AV_PIX_FMT_YUV420P:
+    case AV_PIX_FMT_YUVJ420P:
+        return QVideoFrameFormat::Format_YUV420P;
+    case AV_PIX_FMT_NV12:
+        return QVideoFrameFormat::Format_NV12;
+    default:
+        return QVideoFrameFormat::Format_Invalid;
+    }
+}
+
+QVideoFrame AVFrameVideoBuffer::wrap(AVFrame* frame)
+{
+    if (!frame) return QVideoFrame();
+
+    // 负 linesize（上下翻转）无法直接映射
+    if (toQtPixelFormat(frame->format) == QVideoFrameFormat::Format_Invalid || frame->linesize[0] <= 0) {
+        qDebug() << "Unsupported decoded frame format:"
+            << av_get_pix_fmt_name(static_cast<AVPixelFormat>(frame->format));
+        av_frame_free(&frame);
+        return QVideoFrame();
+    }
+    return QVideoFrame(std::make_unique<AVFrameVideoBuffer>(frame));
+}
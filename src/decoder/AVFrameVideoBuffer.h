@@ -0,0 +1,33 @@
+#pragma once
+#include <QAbstractVideoBuffer>
+#include <QVideoFrame>
+#include <QVideoFrameFormat>
+
+extern "C" {
+#include <libavutil/frame.h>
+}
+
+// 把解码器输出的 AVFrame 直接包装成 QVideoFrame 的缓冲区
+// map() 只返回 AVFrame 的平面指针，不做 RGB 转换也不拷贝；
+// 持有 AVFrame 的引用，QVideoFrame 最后一个副本释放时才归还给解码器的缓冲池
+class AVFrameVideoBuffer : public QAbstractVideoBuffer
+{
+public:
+    // 接管 frame 的所有权
+    explicit AVFrameVideoBuffer(AVFrame* frame);
+    ~AVFrameVideoBuffer() override;
+
+    MapData map(QVideoFrame::MapMode mode) override;
+    void unmap() override;
+    QVideoFrameFormat format() const override;
+
+    // 可以直接包装的 AVPixelFormat，不支持时返回 Format_Invalid
+    static QVideoFrameFormat::PixelFormat toQtPixelFormat(int avFormat);
+
+    // 包装 frame（接管所有权），格式不支持时释放 frame 并返回无效的 QVideoFrame
+    static QVideoFrame wrap(AVFrame* frame);
+
+private:
+    AVFrame* m_frame = nullptr;
+    QVideoFrameFormat m_format;
+};
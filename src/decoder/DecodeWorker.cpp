@@ -0,0 +1,80 @@
+#include "DecodeWorker.h"
+#include "VideoDecoder.h"
+#include "AVFrameVideoBuffer.h"
+#include <QDebug>
+
+// 取帧等待超时，保证 stop() 之后能及时退出
+static const int QUEUE_WAIT_TIMEOUT_MS = 100;
+
+DecodeWorker::DecodeWorker(PacketQueue::Ptr queue, VideoDecoder* decoder, ReceiveStats::Ptr stats,
+    QObject* parent)
+    : QObject(parent), m_queue(queue), m_decoder(decoder), m_stats(stats), m_stopRequested(false)
+{}
+
+DecodeWorker::~DecodeWorker()
+{}
+
+void DecodeWorker::startLoop()
+{
+    qDebug() << "Decode thread start";
+    if (m_decoder) {
+        m_decoder->onDecodedFrame = [this](AVFrame* frame) {
+            m_stats->decodeTime.add(ReceiveStats::nowUs() - m_decodeStartUs);
+            // 解码器是低延迟模式，输出帧的 pts 就是送入时的 RTP 时间戳
+            const quint32 rtpTimestamp = static_cast<quint32>(frame->pts);
+            QVideoFrame videoFrame = AVFrameVideoBuffer::wrap(frame);
+            if (!videoFrame.isValid()) return;
+            ReceiveStats::inc(m_stats->decodedFrames);
+            emit frameDecoded(videoFrame, m_receivedUs, rtpTimestamp);
+        };
+    }
+    while (!m_stopRequested.loadRelaxed()) {
+        EncodedPacket packet;
+        if (!m_queue->pop(packet, QUEUE_WAIT_TIMEOUT_MS)) {
+            continue;
+        }
+        decodePacket(packet);
+    }
+    if (m_decoder) m_decoder->onDecodedFrame = nullptr;
+    qDebug() << "Decode thread exit";
+    emit finished();
+}
+
+void DecodeWorker::stop()
+{
+    m_stopRequested.storeRelaxed(true);
+    m_queue->notifyAll();
+}
+
+void DecodeWorker::decodePacket(const EncodedPacket& packet)
+{
+    if (!m_decoder) return;
+
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(packet.data.constData());
+    const int size = packet.data.size();
+
+    // 参考链断开后，只有关键帧能重新开始解码
+    if (packet.discontinuity && !m_waitKeyframe) {
+        m_waitKeyframe = true;
+        emit keyframeNeeded();
+    }
+    if (m_waitKeyframe) {
+        if (!m_decoder->isKeyFrame(data, size)) {
+            ReceiveStats::inc(m_stats->droppedFrames);
+            emit keyframeNeeded();
+            return;
+        }
+        m_decoder->flush();
+        m_waitKeyframe = false;
+    }
+
+    m_decodeStartUs = ReceiveStats::nowUs();
+    m_receivedUs = packet.receivedUs;
+    m_stats->queueDelay.add(m_decodeStartUs - packet.receivedUs);
+
+    if (!m_decoder->decode(data, size, packet.rtpTimestamp)) {
+        ReceiveStats::inc(m_stats->decodeErrors);
+        m_waitKeyframe = true;
+        emit keyframeNeeded();
+    }
+}
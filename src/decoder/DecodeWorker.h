@@ -0,0 +1,43 @@
+#pragma once
+#include <QObject>
+#include <QAtomicInt>
+#include <QVideoFrame>
+#include "PacketQueue.hpp"
+#include "ReceiveStats.h"
+
+class VideoDecoder;
+
+// 解码线程：按顺序从 PacketQueue 取帧交给 VideoDecoder
+// 通过 moveToThread 运行在独立线程；解码出错或队列溢出后丢弃后续帧，
+// 直到收到下一个关键帧，并通过 keyframeNeeded 请求发送端补发
+class DecodeWorker : public QObject
+{
+    Q_OBJECT
+public:
+    DecodeWorker(PacketQueue::Ptr queue, VideoDecoder* decoder, ReceiveStats::Ptr stats,
+        QObject* parent = nullptr);
+    ~DecodeWorker();
+
+    // 线程主循环，由 QThread::started 触发
+    void startLoop();
+    // 请求退出主循环（线程安全）
+    void stop();
+
+signals:
+    // frame 直接引用解码器输出的 AVFrame；receivedUs 用于计算端到端延迟，
+    // rtpTimestamp 为该帧的发送端采集时间戳，用于播放节奏与单向延迟
+    void frameDecoded(const QVideoFrame& frame, qint64 receivedUs, quint32 rtpTimestamp);
+    void keyframeNeeded();
+    void finished();
+
+private:
+    void decodePacket(const EncodedPacket& packet);
+
+    PacketQueue::Ptr m_queue;
+    VideoDecoder* m_decoder = nullptr; // 不持有，生命周期由 VideoReceiver 管理
+    ReceiveStats::Ptr m_stats;
+    bool m_waitKeyframe = true;        // 以下只在解码线程访问
+    qint64 m_decodeStartUs = 0;
+    qint64 m_receivedUs = -1;
+    QAtomicInt m_stopRequested;
+};
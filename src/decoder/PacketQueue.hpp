@@ -0,0 +1,77 @@
+#pragma once
+#include <QByteArray>
+#include <QMutex>
+#include <QWaitCondition>
+#include <deque>
+#include <memory>
+
+// 一帧待解码的 access unit
+struct EncodedPacket
+{
+    QByteArray data;
+    qint64 receivedUs = -1;   // 收到完整帧的时间（单调时钟，微秒）
+    quint32 rtpTimestamp = 0; // 发送端 90kHz 采集时间戳
+    bool discontinuity = false; // 之前有帧因队列溢出被丢弃，参考链已断开
+};
+
+// 网络线程 -> 解码线程 的有界 FIFO
+// 与采集端的 FrameSlot 不同，参考帧不能跳过，所以这里按顺序排队；
+// 队列满说明解码跟不上，丢弃积压的旧帧后放入本帧，解码端从下一个关键帧重新开始
+// （本帧可能就是用来恢复的关键帧，不能一起丢掉）
+class PacketQueue
+{
+public:
+    using Ptr = std::shared_ptr<PacketQueue>;
+
+    explicit PacketQueue(int capacity) : m_capacity(capacity > 0 ? capacity : 1) {}
+
+    // 放入一帧，返回因队列已满而丢弃的旧帧数，0 表示没有丢帧
+    int push(EncodedPacket packet) {
+        int dropped = 0;
+        {
+            QMutexLocker guard(&m_mutex);
+            if (static_cast<int>(m_queue.size()) >= m_capacity) {
+                dropped = static_cast<int>(m_queue.size());
+                m_queue.clear();
+                m_discontinuity = true;
+            }
+            packet.discontinuity = m_discontinuity;
+            m_discontinuity = false;
+            m_queue.push_back(std::move(packet));
+        }
+        m_cond.wakeOne();
+        return dropped;
+    }
+
+    // 取出最早的一帧，队列为空时最多等待 timeoutMs 毫秒
+    bool pop(EncodedPacket& packet, int timeoutMs) {
+        QMutexLocker guard(&m_mutex);
+        if (m_queue.empty()) {
+            m_cond.wait(&m_mutex, timeoutMs);
+            if (m_queue.empty()) return false;
+        }
+        packet = std::move(m_queue.front());
+        m_queue.pop_front();
+        return true;
+    }
+
+    // 清空队列，返回丢弃的帧数
+    int clear() {
+        QMutexLocker guard(&m_mutex);
+        int n = static_cast<int>(m_queue.size());
+        m_queue.clear();
+        return n;
+    }
+
+    // 唤醒等待中的消费者（用于退出）
+    void notifyAll() {
+        m_cond.wakeAll();
+    }
+
+private:
+    std::deque<EncodedPacket> m_queue;
+    const int m_capacity;
+    bool m_discontinuity = false;
+    QMutex m_mutex;
+    QWaitCondition m_cond;
+};
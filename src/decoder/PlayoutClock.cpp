@@ -0,0 +1,62 @@
+#include "PlayoutClock.h"
+#include <algorithm>
+#include <cstdlib>
+
+// 发送端时钟频率（与 RTP 时间戳一致）
+static const qint64 RTP_CLOCK_RATE_HZ = 90000;
+// 每帧允许基准传输时延变慢的量：约 30fps 时每秒 3ms
+static const qint64 BASE_TRANSIT_RELAX_US = 100;
+// 与基准相差超过该值视为时间线跳变（发送端重启等），重新开始
+static const qint64 RESYNC_THRESHOLD_US = 2 * 1000 * 1000;
+
+PlayoutClock::PlayoutClock(qint64 maxDelayUs)
+    : m_maxDelayUs(maxDelayUs)
+{}
+
+void PlayoutClock::reset()
+{
+    m_started = false;
+    m_jitterUs = 0;
+}
+
+qint64 PlayoutClock::playoutDelayUs() const
+{
+    return std::min(m_jitterUs * 2, m_maxDelayUs);
+}
+
+qint64 PlayoutClock::senderTimeUs(quint32 rtpTimestamp)
+{
+    // 按有符号差值展开，允许少量乱序
+    m_extendedRtp += static_cast<qint32>(rtpTimestamp - m_lastRtp);
+    m_lastRtp = rtpTimestamp;
+    return m_extendedRtp * 1000000 / RTP_CLOCK_RATE_HZ;
+}
+
+qint64 PlayoutClock::schedule(quint32 rtpTimestamp, qint64 receivedUs, qint64 nowUs)
+{
+    if (!m_started) {
+        m_started = true;
+        m_lastRtp = rtpTimestamp;
+        m_extendedRtp = 0;
+        m_baseTransitUs = receivedUs;
+        m_lastTransitUs = receivedUs;
+        return 0;
+    }
+
+    const qint64 senderUs = senderTimeUs(rtpTimestamp);
+    const qint64 transitUs = receivedUs - senderUs;
+    if (std::llabs(transitUs - m_baseTransitUs) > RESYNC_THRESHOLD_US) {
+        reset();
+        return schedule(rtpTimestamp, receivedUs, nowUs);
+    }
+
+    // RFC 3550 6.4.1：J += (|D| - J) / 16
+    const qint64 d = std::llabs(transitUs - m_lastTransitUs);
+    m_jitterUs += (d - m_jitterUs) / 16;
+    m_lastTransitUs = transitUs;
+
+    m_baseTransitUs = std::min(transitUs, m_baseTransitUs + BASE_TRANSIT_RELAX_US);
+
+    const qint64 dueUs = senderUs + m_baseTransitUs + playoutDelayUs();
+    return std::min(dueUs - nowUs, m_maxDelayUs);
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <QtGlobal>
+
+// 接收端播放节奏：按发送端的帧间隔安排显示时刻，吸收网络抖动造成的成批到达
+// 显示时刻 = 发送端采集时间 + 基准传输时延 + 播放延迟
+// - 基准传输时延：近期最快到达的帧的 (接收时刻 - 采集时间)，缓慢放宽以跟随时钟漂移和路由变化
+// - 播放延迟：到达抖动（RFC 3550 的 interarrival jitter）的 2 倍，不超过 maxDelayUs
+// 只比较两端各自单调时钟的差值，不要求两端系统时间同步
+// 只在 GUI 线程使用
+class PlayoutClock
+{
+public:
+    explicit PlayoutClock(qint64 maxDelayUs = 80 * 1000);
+
+    void reset();
+
+    // 返回该帧相对 nowUs 还需等待的微秒数，<= 0 表示立即显示
+    // receivedUs / nowUs 为接收端单调时钟（ReceiveStats::nowUs）
+    qint64 schedule(quint32 rtpTimestamp, qint64 receivedUs, qint64 nowUs);
+
+    qint64 jitterUs() const { return m_jitterUs; }
+    qint64 playoutDelayUs() const;
+
+private:
+    // 32 位 RTP 时间戳展开为不回绕的发送端时间（微秒）
+    qint64 senderTimeUs(quint32 rtpTimestamp);
+
+    qint64 m_maxDelayUs;
+    bool m_started = false;
+    quint32 m_lastRtp = 0;
+    qint64 m_extendedRtp = 0;
+    qint64 m_baseTransitUs = 0;
+    qint64 m_lastTransitUs = 0;
+    qint64 m_jitterUs = 0;
+};
@@ -0,0 +1,63 @@
+#pragma once
+#include <QtGlobal>
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+// 单项延迟统计（微秒），多线程累加
+struct LatencyCounter
+{
+    std::atomic<quint64> count{ 0 };
+    std::atomic<qint64> totalUs{ 0 };
+    std::atomic<qint64> maxUs{ 0 };
+    std::atomic<qint64> lastUs{ 0 };
+
+    void add(qint64 us) {
+        if (us < 0) return;
+        count.fetch_add(1, std::memory_order_relaxed);
+        totalUs.fetch_add(us, std::memory_order_relaxed);
+        lastUs.store(us, std::memory_order_relaxed);
+        qint64 prev = maxUs.load(std::memory_order_relaxed);
+        while (us > prev && !maxUs.compare_exchange_weak(prev, us, std::memory_order_relaxed)) {}
+    }
+
+    double averageMs() const {
+        const quint64 n = count.load(std::memory_order_relaxed);
+        return n ? totalUs.load(std::memory_order_relaxed) / 1000.0 / n : 0.0;
+    }
+};
+
+// 接收/解码/显示管线的计数器，网络线程、解码线程与 GUI 线程共享
+struct ReceiveStats
+{
+    using Ptr = std::shared_ptr<ReceiveStats>;
+
+    std::atomic<quint64> receivedFrames{ 0 };    // 收到的完整帧
+    std::atomic<quint64> decodedFrames{ 0 };     // 解码输出的帧
+    std::atomic<quint64> presentedFrames{ 0 };   // 交给 QVideoSink 的帧
+    std::atomic<quint64> droppedFrames{ 0 };     // 队列溢出或等待关键帧时丢弃
+    std::atomic<quint64> decodeErrors{ 0 };
+    std::atomic<quint64> keyframeRequests{ 0 };
+
+    LatencyCounter queueDelay;   // 收到 -> 开始解码
+    LatencyCounter decodeTime;   // 送入解码器 -> 输出画面
+    LatencyCounter endToEnd;     // 收到 -> 显示
+    LatencyCounter oneWay;       // 发送端采集 -> 显示（由 SR 换算，需要两端系统时间同步）
+    LatencyCounter playoutDelay; // 为平滑播放节奏而推迟显示的时间
+
+    static void inc(std::atomic<quint64>& counter) {
+        counter.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // 各线程统一使用的单调时钟（微秒）
+    static qint64 nowUs() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // 墙上时间（Unix 微秒），只用于和发送端的 NTP 时间比较
+    static qint64 wallClockUs() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+};
@@ -0,0 +1,135 @@
+#include "TileCompositor.h"
+#include "../encoder/TileCodec.h"
+#include <QDebug>
+#include <QPainter>
+#include <QRect>
+#include <algorithm>
+
+// 90kHz 时间戳允许回绕：a 不晚于 b
+static bool notAfter(quint32 a, quint32 b)
+{
+    return static_cast<qint32>(a - b) <= 0;
+}
+
+bool TileCompositor::push(const QByteArray& message, qint64 nowUs)
+{
+    Pending pending;
+    std::vector<TileUpdate::Tile> tiles;
+    if (!TileUpdate::parse(reinterpret_cast<const uint8_t*>(message.constData()),
+        static_cast<size_t>(message.size()), pending.header, tiles)) {
+        qDebug() << "Malformed tile update, size" << message.size();
+        return false;
+    }
+    pending.needsVideo = pending.header.isReset() ||
+        std::any_of(tiles.begin(), tiles.end(), [](const TileUpdate::Tile& tile) { return tile.isInvalidation(); });
+    pending.message = message;
+    pending.receivedUs = nowUs;
+    m_pending.push_back(std::move(pending));
+    return true;
+}
+
+bool TileCompositor::advance(bool hasVideo, quint32 videoTimestamp, qint64 nowUs)
+{
+    bool changed = false;
+    while (!m_pending.empty()) {
+        const Pending& front = m_pending.front();
+        const bool ready = !front.needsVideo ||
+            (hasVideo && notAfter(front.header.timestamp, videoTimestamp)) ||
+            nowUs - front.receivedUs >= MAX_VIDEO_WAIT_US;
+        if (!ready) break;
+        apply(front);
+        m_pending.pop_front();
+        changed = true;
+    }
+    return changed;
+}
+
+void TileCompositor::apply(const Pending& pending)
+{
+    const TileUpdate::Header& header = pending.header;
+    if (header.width > TileUpdate::MAX_DIMENSION || header.height > TileUpdate::MAX_DIMENSION ||
+        header.tileSize < TileUpdate::MIN_TILE_SIZE) {
+        qDebug() << "Tile update too large" << header.width << "x" << header.height;
+        return;
+    }
+    if (header.isReset() || m_canvas.width() != header.width || m_canvas.height() != header.height ||
+        m_tileSize != header.tileSize) {
+        m_canvas = QImage(header.width, header.height, QImage::Format_RGB32);
+        if (m_canvas.isNull()) {
+            qDebug() << "Cannot allocate tile canvas" << header.width << "x" << header.height;
+            m_tileSize = 0;
+            m_tilesX = 0;
+            m_valid.clear();
+            m_validTiles = 0;
+            return;
+        }
+        m_tileSize = header.tileSize;
+        m_tilesX = (header.width + m_tileSize - 1) / m_tileSize;
+        const int tilesY = (header.height + m_tileSize - 1) / m_tileSize;
+        m_valid.assign(static_cast<size_t>(m_tilesX) * tilesY, 0);
+        m_validTiles = 0;
+    }
+
+    std::vector<TileUpdate::Tile> tiles;
+    TileUpdate::Header parsed;
+    TileUpdate::parse(reinterpret_cast<const uint8_t*>(pending.message.constData()),
+        static_cast<size_t>(pending.message.size()), parsed, tiles);
+
+    for (const TileUpdate::Tile& tile : tiles) {
+        bool valid = false;
+        if (!tile.isInvalidation()) {
+            // 直接解码进画布，块内的 UP 操作读取的上一行也在画布里
+            const QRect rect = tileRect(tile.index);
+            uint8_t* dst = m_canvas.bits() + static_cast<ptrdiff_t>(rect.y()) * m_canvas.bytesPerLine() + rect.x() * 4;
+            valid = TileCodec::decode(tile.data, tile.size, rect.width(), rect.height(), dst,
+                static_cast<int>(m_canvas.bytesPerLine()));
+            if (!valid) qDebug() << "Corrupt tile" << tile.index;
+        }
+        uint8_t& slot = m_valid[tile.index];
+        m_validTiles += static_cast<int>(valid) - static_cast<int>(slot);
+        slot = valid ? 1 : 0;
+    }
+}
+
+QRect TileCompositor::tileRect(uint32_t index) const
+{
+    const int x = static_cast<int>(index % m_tilesX) * m_tileSize;
+    const int y = static_cast<int>(index / m_tilesX) * m_tileSize;
+    return QRect(x, y, std::min(m_tileSize, m_canvas.width() - x), std::min(m_tileSize, m_canvas.height() - y));
+}
+
+QVideoFrame TileCompositor::compose(const QVideoFrame& video) const
+{
+    if (m_validTiles == static_cast<int>(m_valid.size())) {
+        // QVideoFrame 持有画布的隐式共享副本，之后的更新会先分离，不影响已显示的帧
+        return QVideoFrame(m_canvas);
+    }
+    if (!video.isValid()) return video;
+
+    // 视频按编码分辨率解码，放大到采集分辨率后再覆盖无损块
+    QImage image = video.toImage();
+    if (image.size() != m_canvas.size()) {
+        image = image.scaled(m_canvas.size(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+    image = image.convertToFormat(QImage::Format_RGB32);
+
+    QPainter painter(&image);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    for (size_t i = 0; i < m_valid.size(); ++i) {
+        if (!m_valid[i]) continue;
+        const QRect rect = tileRect(static_cast<uint32_t>(i));
+        painter.drawImage(rect.topLeft(), m_canvas, rect);
+    }
+    painter.end();
+    return QVideoFrame(image);
+}
+
+void TileCompositor::reset()
+{
+    m_pending.clear();
+    m_canvas = QImage();
+    m_tileSize = 0;
+    m_tilesX = 0;
+    m_valid.clear();
+    m_validTiles = 0;
+}
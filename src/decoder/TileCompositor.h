@@ -0,0 +1,53 @@
+#pragma once
+#include <QByteArray>
+#include <QImage>
+#include <QVideoFrame>
+#include <QtGlobal>
+#include <deque>
+#include <vector>
+#include "../encoder/TileUpdate.h"
+
+// 混合编码的接收端：缓存发送端的无损块，显示时覆盖在解码出的视频画面上
+// - 新的无损块到达即可使用（块静止之后才会发送，内容不早于已显示的视频）
+// - 作废 / 重置与同一时间戳的视频帧一起生效，在此之前继续显示缓存的块；
+//   消息按到达顺序应用，等待中的作废之后的消息也一起等待
+// - 没有有效块时视频帧原样显示，不做任何转换
+// 只在 GUI 线程使用
+class TileCompositor
+{
+public:
+    // 收到一条块更新消息，格式错误时返回 false
+    bool push(const QByteArray& message, qint64 nowUs);
+
+    // 即将显示时间戳为 videoTimestamp 的视频帧（hasVideo = false 时只应用不需要等待的消息）
+    // 返回缓存是否发生了变化
+    bool advance(bool hasVideo, quint32 videoTimestamp, qint64 nowUs);
+
+    bool hasTiles() const { return m_validTiles > 0; }
+    bool hasPending() const { return !m_pending.empty(); }
+    // 作废 / 重置最多等待对应视频帧的时间：视频帧丢失后画面又静止时，不会一直卡住后面的块
+    static const qint64 MAX_VIDEO_WAIT_US = 1000 * 1000;
+
+    // 视频画面 + 缓存的块；整屏都有无损块时直接使用缓存画面，不需要视频，否则 video 无效时返回无效帧
+    QVideoFrame compose(const QVideoFrame& video) const;
+
+    void reset();
+
+private:
+    struct Pending {
+        QByteArray message;
+        TileUpdate::Header header;
+        bool needsVideo = false; // 含作废或重置，要等对应的视频帧
+        qint64 receivedUs = 0;
+    };
+
+    void apply(const Pending& pending);
+    QRect tileRect(uint32_t index) const;
+
+    std::deque<Pending> m_pending;
+    QImage m_canvas;                // 采集分辨率的 BGRA 画面，只有有效块的部分有意义
+    int m_tileSize = 0;
+    int m_tilesX = 0;
+    std::vector<uint8_t> m_valid;   // 每块是否持有无损数据
+    int m_validTiles = 0;
+};
@@ -0,0 +1,160 @@
+#include "VideoDecoder.h"
+#include "../encoder/EncodedFrame.h"
+#include <QDebug>
+#include <cstring>
+
+// AV1 的 OBU 类型
+static const int AV1_OBU_SEQUENCE_HEADER = 1;
+
+// FFmpeg 自带的 AV1 解码器只支持硬件加速，软件解码需要 libdav1d 或 libaom
+static const AVCodec* findDecoder(VideoCodec codec) {
+    switch (codec) {
+    case VideoCodec::H264: return avcodec_find_decoder(AV_CODEC_ID_H264);
+    case VideoCodec::H265: return avcodec_find_decoder(AV_CODEC_ID_HEVC);
+    case VideoCodec::AV1:
+        if (const AVCodec* decoder = avcodec_find_decoder_by_name("libdav1d")) return decoder;
+        return avcodec_find_decoder_by_name("libaom-av1");
+    }
+    return nullptr;
+}
+
+VideoDecoder::VideoDecoder(QObject* parent) : QObject(parent) {
+    m_pkt = av_packet_alloc();
+}
+
+VideoDecoder::~VideoDecoder() {
+    cleanup();
+    av_packet_free(&m_pkt);
+}
+
+bool VideoDecoder::init(VideoCodec codecId, int threadCount) {
+    cleanup();
+
+    // 1. 查找解码器
+    m_codec = codecId;
+    const AVCodec* codec = findDecoder(codecId);
+    if (!codec) {
+        qDebug() << videoCodecName(codecId) << "Decoder not found!";
+        return false;
+    }
+
+    // 2. 配置上下文
+    m_codecCtx = avcodec_alloc_context3(codec);
+    m_codecCtx->flags |= AV_CODEC_FLAG_LOW_DELAY;
+    m_codecCtx->thread_count = threadCount > 0 ? threadCount : 0;
+    m_codecCtx->thread_type = FF_THREAD_SLICE;
+
+    // 3. 打开解码器
+    // dav1d 默认按线程数缓存多帧再输出，限制为 1 帧：有输入就立即输出
+    AVDictionary* opts = nullptr;
+    av_dict_set(&opts, "max_frame_delay", "1", 0);
+    const int ret = avcodec_open2(m_codecCtx, codec, &opts);
+    av_dict_free(&opts);
+    if (ret < 0) {
+        qDebug() << "Could not open decoder";
+        avcodec_free_context(&m_codecCtx);
+        return false;
+    }
+    qDebug() << "Using" << codec->name << "for" << videoCodecName(codecId);
+    return true;
+}
+
+QList<VideoCodec> VideoDecoder::availableCodecs() {
+    QList<VideoCodec> codecs;
+    for (VideoCodec codec : { VideoCodec::H264, VideoCodec::H265, VideoCodec::AV1 }) {
+        if (findDecoder(codec)) codecs.append(codec);
+    }
+    return codecs;
+}
+
+bool VideoDecoder::decode(const uint8_t* data, int size, int64_t pts) {
+    if (!m_codecCtx || !data || size <= 0) return false;
+
+    // FFmpeg 要求输入末尾有填充字节，拷到复用的缓冲区里（只在帧变大时重新分配）
+    if (m_buffer.size() < static_cast<size_t>(size) + AV_INPUT_BUFFER_PADDING_SIZE) {
+        m_buffer.resize(static_cast<size_t>(size) + AV_INPUT_BUFFER_PADDING_SIZE);
+    }
+    std::memcpy(m_buffer.data(), data, size);
+    std::memset(m_buffer.data() + size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+
+    m_pkt->data = m_buffer.data();
+    m_pkt->size = size;
+    m_pkt->pts = pts;
+    int ret = avcodec_send_packet(m_codecCtx, m_pkt);
+    m_pkt->data = nullptr;
+    m_pkt->size = 0;
+    if (ret < 0 && ret != AVERROR(EAGAIN)) {
+        return false;
+    }
+
+    // 接收解码后的画面，每次都用新的 AVFrame，所有权交给回调
+    // 出错的画面丢掉但继续取，不能把后面的帧留在解码器里
+    bool corrupted = false;
+    while (true) {
+        AVFrame* frame = av_frame_alloc();
+        ret = avcodec_receive_frame(m_codecCtx, frame);
+        if (ret < 0) {
+            av_frame_free(&frame);
+            break;
+        }
+        if (frame->decode_error_flags) {
+            corrupted = true;
+            av_frame_free(&frame);
+            continue;
+        }
+        if (onDecodedFrame) onDecodedFrame(frame);
+        else av_frame_free(&frame);
+    }
+    return !corrupted && (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF);
+}
+
+void VideoDecoder::flush() {
+    if (m_codecCtx) avcodec_flush_buffers(m_codecCtx);
+}
+
+bool VideoDecoder::isKeyFrame(const uint8_t* data, int size) const {
+    return isKeyFrame(m_codec, data, size);
+}
+
+bool VideoDecoder::isKeyFrame(VideoCodec codec, const uint8_t* data, int size) {
+    if (codec == VideoCodec::AV1) {
+        // 低开销格式：每个 OBU 都带 LEB128 的 obu_size；编码器在每个关键帧前重复序列头
+        int pos = 0;
+        while (pos < size) {
+            const uint8_t header = data[pos];
+            const int type = (header >> 3) & 0x0F;
+            if (type == AV1_OBU_SEQUENCE_HEADER) return true;
+            if (!(header & 0x02)) return false; // 没有 obu_size，之后无法定位
+            pos += (header & 0x04) ? 2 : 1;
+
+            uint64_t obuSize = 0;
+            int i = 0;
+            for (; i < 8 && pos < size; ++i) {
+                const uint8_t byte = data[pos++];
+                obuSize |= static_cast<uint64_t>(byte & 0x7F) << (7 * i);
+                if (!(byte & 0x80)) break;
+            }
+            if (i == 8 || obuSize > static_cast<uint64_t>(size - pos)) return false;
+            pos += static_cast<int>(obuSize);
+        }
+        return false;
+    }
+
+    const QVector<EncodedFrame::Nal> nals = EncodedFrame::parseAnnexB(data, size);
+    for (const EncodedFrame::Nal& nal : nals) {
+        if (codec == VideoCodec::H265) {
+            // IRAP（BLA / IDR / CRA）/ VPS / SPS
+            const int type = (data[nal.offset] >> 1) & 0x3F;
+            if ((type >= 16 && type <= 23) || type == 32 || type == 33) return true;
+        }
+        else {
+            const int type = data[nal.offset] & 0x1F;
+            if (type == 5 || type == 7) return true; // IDR / SPS（intra-refresh 的恢复点帧也带 SPS）
+        }
+    }
+    return false;
+}
+
+void VideoDecoder::cleanup() {
+    if (m_codecCtx) avcodec_free_context(&m_codecCtx);
+}
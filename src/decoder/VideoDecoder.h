@@ -0,0 +1,53 @@
+#pragma once
+#include <QObject>
+#include <QList>
+#include <functional>
+#include <vector>
+#include "../rtc/VideoCodec.hpp"
+
+// FFmpeg 是 C 语言库
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+// H.264 / H.265 / AV1 低延迟解码
+// - AV_CODEC_FLAG_LOW_DELAY：有输入就立即输出，不为 B 帧重排而缓存
+// - 只用 slice 多线程：frame 多线程会额外引入 (线程数 - 1) 帧的延迟；dav1d 同样限制为 1 帧
+class VideoDecoder : public QObject
+{
+    Q_OBJECT
+public:
+    explicit VideoDecoder(QObject* parent = nullptr);
+    ~VideoDecoder();
+
+    // threadCount <= 0 时由 FFmpeg 按 CPU 核数决定
+    bool init(VideoCodec codec = VideoCodec::H264, int threadCount = 0);
+    VideoCodec codec() const { return m_codec; }
+
+    // 当前 FFmpeg 中有解码器的格式
+    static QList<VideoCodec> availableCodecs();
+
+    // 解码一帧 access unit（H.264/H.265 为 Annex-B，AV1 为低开销格式的时间单元），
+    // 返回 false 表示码流出错（需要等待下一个关键帧）
+    // pts 原样带到输出 AVFrame 的 pts 上（接收端传入 RTP 时间戳）
+    bool decode(const uint8_t* data, int size, int64_t pts = AV_NOPTS_VALUE);
+
+    // 丢弃解码器内部的参考帧，用于跳帧后重新同步
+    void flush();
+
+    // 回调函数：解码好的画面通过这里传出去，接收方接管 AVFrame 的所有权
+    std::function<void(AVFrame*)> onDecodedFrame;
+
+    // 是否可以从这一帧开始解码：H.264 含 IDR / SPS，H.265 含 IRAP / VPS / SPS，AV1 含序列头
+    bool isKeyFrame(const uint8_t* data, int size) const;
+    static bool isKeyFrame(VideoCodec codec, const uint8_t* data, int size);
+
+private:
+    // 资源释放
+    void cleanup();
+
+    VideoCodec m_codec = VideoCodec::H264;
+    AVCodecContext* m_codecCtx = nullptr;
+    AVPacket* m_pkt = nullptr;
+    std::vector<uint8_t> m_buffer;  // 带 AV_INPUT_BUFFER_PADDING_SIZE 填充的输入缓冲区，复用
+};
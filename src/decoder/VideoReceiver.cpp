@@ -0,0 +1,252 @@
+#include "VideoReceiver.h"
+#include "VideoDecoder.h"
+#include "DecodeWorker.h"
+#include <QDebug>
+#include <algorithm>
+
+// 解码队列长度：超过说明解码跟不上，清空后等待关键帧
+static const int DECODE_QUEUE_CAPACITY = 8;
+// 两次关键帧请求的最小间隔，避免丢包时刷屏式地请求
+static const qint64 KEYFRAME_REQUEST_INTERVAL_US = 500 * 1000;
+// 延迟统计日志间隔
+static const qint64 STATS_LOG_INTERVAL_US = 5 * 1000 * 1000;
+// 显示时刻允许提前的量，避免定时器精度导致多等一个周期
+static const qint64 PRESENT_TOLERANCE_US = 1000;
+// 等待显示的帧上限，超过时不再等待节奏，直接显示最早的帧
+static const size_t MAX_PENDING_FRAMES = 8;
+
+VideoReceiver::VideoReceiver(QObject* parent)
+    : QObject(parent)
+    , m_queue(std::make_shared<PacketQueue>(DECODE_QUEUE_CAPACITY))
+    , m_stats(std::make_shared<ReceiveStats>())
+{
+    m_presentTimer = new QTimer(this);
+    m_presentTimer->setSingleShot(true);
+    m_presentTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_presentTimer, &QTimer::timeout, this, &VideoReceiver::presentDueFrames);
+}
+
+VideoReceiver::~VideoReceiver()
+{
+    stop();
+    delete m_decoder;
+}
+
+void VideoReceiver::setVideoSink(QVideoSink* sink)
+{
+    m_sink = sink;
+}
+
+void VideoReceiver::setVideoCodec(VideoCodec codec)
+{
+    if (codec == m_codec) return;
+    qDebug() << "Receive codec:" << videoCodecName(m_codec) << "->" << videoCodecName(codec);
+    m_codec = codec;
+
+    const bool running = isRunning();
+    stop();
+    delete m_decoder;
+    m_decoder = nullptr;
+    if (running) start();
+}
+
+bool VideoReceiver::start()
+{
+    if (m_decodeThread) return true;
+
+    if (!m_decoder) {
+        m_decoder = new VideoDecoder();
+        if (!m_decoder->init(m_codec)) {
+            qDebug() << "Decoder Init Failed!";
+            delete m_decoder;
+            m_decoder = nullptr;
+            return false;
+        }
+        qDebug() << "Video Decoder Initialized!";
+    }
+
+    m_hasPresented = false;
+    m_queue->clear();
+    m_playout.reset();
+    m_pending.clear();
+
+    m_decodeThread = new QThread(this);
+    m_decodeWorker = new DecodeWorker(m_queue, m_decoder, m_stats);
+    m_decodeWorker->moveToThread(m_decodeThread);
+
+    connect(m_decodeThread, &QThread::started, m_decodeWorker, &DecodeWorker::startLoop);
+    connect(m_decodeThread, &QThread::finished, m_decodeWorker, &QObject::deleteLater);
+    // 解码线程 -> GUI 线程（队列连接）
+    connect(m_decodeWorker, &DecodeWorker::frameDecoded, this, &VideoReceiver::presentFrame);
+    connect(m_decodeWorker, &DecodeWorker::keyframeNeeded, this, &VideoReceiver::requestKeyframe);
+    m_decodeThread->start();
+    return true;
+}
+
+void VideoReceiver::stop()
+{
+    if (!m_decodeThread) return;
+
+    // startLoop 是阻塞循环，需要先让它退出，事件循环才能响应 quit()
+    m_decodeWorker->stop();
+    m_decodeThread->quit();
+    m_decodeThread->wait();
+    delete m_decodeThread;
+    m_decodeThread = nullptr;
+    m_decodeWorker = nullptr; // 已由 QThread::finished -> deleteLater 释放
+
+    m_queue->clear();
+    m_presentTimer->stop();
+    m_pending.clear();
+    m_clockMapper.reset();
+    m_tiles.reset();
+    m_lastVideoFrame = QVideoFrame();
+    m_hasVideoTimestamp = false;
+}
+
+bool VideoReceiver::isRunning() const
+{
+    return m_decodeThread != nullptr;
+}
+
+void VideoReceiver::pushEncodedFrame(const QByteArray& data, quint32 rtpTimestamp)
+{
+    if (data.isEmpty()) return;
+
+    ReceiveStats::inc(m_stats->receivedFrames);
+    EncodedPacket packet;
+    packet.data = data;
+    packet.receivedUs = ReceiveStats::nowUs();
+    packet.rtpTimestamp = rtpTimestamp;
+
+    const int dropped = m_queue->push(std::move(packet));
+    if (dropped > 0) {
+        m_stats->droppedFrames.fetch_add(dropped, std::memory_order_relaxed);
+    }
+}
+
+void VideoReceiver::onSenderReport(quint64 ntpTimestamp, quint32 rtpTimestamp)
+{
+    SenderReport report;
+    report.ntpTimestamp = ntpTimestamp;
+    report.rtpTimestamp = rtpTimestamp;
+    m_clockMapper.update(report);
+}
+
+void VideoReceiver::pushTileUpdate(const QByteArray& data)
+{
+    if (!m_tiles.push(data, ReceiveStats::nowUs())) return;
+    applyTileUpdates();
+}
+
+void VideoReceiver::applyTileUpdates()
+{
+    if (m_tiles.advance(m_hasVideoTimestamp, m_lastVideoTimestamp, ReceiveStats::nowUs())) {
+        display(m_lastVideoFrame);
+    }
+    // 等待中的作废在没有新视频帧时超时生效
+    if (m_tiles.hasPending()) {
+        QTimer::singleShot(static_cast<int>(TileCompositor::MAX_VIDEO_WAIT_US / 1000), this,
+            &VideoReceiver::applyTileUpdates);
+    }
+}
+
+ReceiveStats::Ptr VideoReceiver::stats() const
+{
+    return m_stats;
+}
+
+void VideoReceiver::presentFrame(const QVideoFrame& frame, qint64 receivedUs, quint32 rtpTimestamp)
+{
+    if (!m_sink) return;
+
+    const qint64 nowUs = ReceiveStats::nowUs();
+    const qint64 waitUs = std::max<qint64>(m_playout.schedule(rtpTimestamp, receivedUs, nowUs), 0);
+    m_stats->playoutDelay.add(waitUs);
+
+    PendingFrame pending;
+    pending.frame = frame;
+    pending.receivedUs = receivedUs;
+    pending.rtpTimestamp = rtpTimestamp;
+    pending.dueUs = nowUs + waitUs;
+    m_pending.push_back(std::move(pending));
+    presentDueFrames();
+}
+
+void VideoReceiver::presentDueFrames()
+{
+    const qint64 nowUs = ReceiveStats::nowUs();
+    // 按解码顺序显示；队头还没到时间时后面的帧也一起等待
+    while (!m_pending.empty() &&
+        (m_pending.front().dueUs <= nowUs + PRESENT_TOLERANCE_US || m_pending.size() > MAX_PENDING_FRAMES)) {
+        PendingFrame pending = std::move(m_pending.front());
+        m_pending.pop_front();
+        showFrame(pending, nowUs);
+    }
+    if (!m_pending.empty()) {
+        const qint64 waitUs = m_pending.front().dueUs - nowUs;
+        m_presentTimer->start(static_cast<int>((waitUs + 999) / 1000));
+    }
+}
+
+void VideoReceiver::showFrame(const PendingFrame& pending, qint64 nowUs)
+{
+    if (!m_sink) return;
+
+    m_lastVideoFrame = pending.frame;
+    m_lastVideoTimestamp = pending.rtpTimestamp;
+    m_hasVideoTimestamp = true;
+    m_tiles.advance(true, pending.rtpTimestamp, nowUs);
+    display(pending.frame);
+    m_stats->endToEnd.add(nowUs - pending.receivedUs);
+    ReceiveStats::inc(m_stats->presentedFrames);
+
+    // SR 给出发送端墙上时间后，可以算出 采集 -> 显示 的真实单向延迟
+    int64_t captureUnixUs = 0;
+    if (m_clockMapper.toSenderUnixUs(pending.rtpTimestamp, captureUnixUs)) {
+        m_stats->oneWay.add(ReceiveStats::wallClockUs() - captureUnixUs);
+    }
+
+    if (!m_hasPresented) {
+        m_hasPresented = true;
+        emit videoStarted();
+    }
+    logStats(nowUs);
+}
+
+void VideoReceiver::display(const QVideoFrame& frame)
+{
+    if (!m_sink) return;
+    const QVideoFrame shown = m_tiles.hasTiles() ? m_tiles.compose(frame) : frame;
+    if (shown.isValid()) m_sink->setVideoFrame(shown);
+}
+
+void VideoReceiver::requestKeyframe()
+{
+    const qint64 nowUs = ReceiveStats::nowUs();
+    if (m_lastKeyframeRequestUs >= 0 && nowUs - m_lastKeyframeRequestUs < KEYFRAME_REQUEST_INTERVAL_US) {
+        return;
+    }
+    m_lastKeyframeRequestUs = nowUs;
+    ReceiveStats::inc(m_stats->keyframeRequests);
+    emit keyframeRequested();
+}
+
+void VideoReceiver::logStats(qint64 nowUs)
+{
+    if (m_lastStatsLogUs >= 0 && nowUs - m_lastStatsLogUs < STATS_LOG_INTERVAL_US) return;
+    m_lastStatsLogUs = nowUs;
+
+    qDebug().nospace() << "Receive stats: received=" << m_stats->receivedFrames.load()
+        << " decoded=" << m_stats->decodedFrames.load()
+        << " presented=" << m_stats->presentedFrames.load()
+        << " dropped=" << m_stats->droppedFrames.load()
+        << " errors=" << m_stats->decodeErrors.load()
+        << " | queue avg " << m_stats->queueDelay.averageMs() << "ms"
+        << ", decode avg " << m_stats->decodeTime.averageMs() << "ms"
+        << ", receive->present avg " << m_stats->endToEnd.averageMs()
+        << "ms max " << m_stats->endToEnd.maxUs.load() / 1000.0 << "ms"
+        << ", playout delay avg " << m_stats->playoutDelay.averageMs()
+        << "ms (jitter " << m_playout.jitterUs() / 1000.0 << "ms)"
+        << ", capture->present avg " << m_stats->oneWay.averageMs() << "ms";
+}
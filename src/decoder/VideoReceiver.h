@@ -0,0 +1,98 @@
+#pragma once
+#include <QObject>
+#include <QPointer>
+#include <QThread>
+#include <QVideoFrame>
+#include <QVideoSink>
+#include <QTimer>
+#include <deque>
+#include "PacketQueue.hpp"
+#include "ReceiveStats.h"
+#include "PlayoutClock.h"
+#include "TileCompositor.h"
+#include "../rtc/ClockSync.hpp"
+#include "../rtc/VideoCodec.hpp"
+
+class VideoDecoder;
+class DecodeWorker;
+
+// 接收端视频管线：网络线程 -> PacketQueue -> 解码线程 -> GUI 线程显示
+// 解码输出的 AVFrame 直接包装成 QVideoFrame 交给 QVideoSink，不做 RGB 转换
+// 混合编码模式下收到的无损块缓存在 TileCompositor 中，有有效块时才合成后再显示
+class VideoReceiver : public QObject
+{
+    Q_OBJECT
+public:
+    explicit VideoReceiver(QObject* parent = nullptr);
+    ~VideoReceiver();
+
+    // 显示目标，例如 QVideoWidget::videoSink()
+    void setVideoSink(QVideoSink* sink);
+
+    // 协商出的编码格式；运行中改变格式会重建解码器并等待下一个关键帧
+    void setVideoCodec(VideoCodec codec);
+
+    bool start();
+    void stop();
+    bool isRunning() const;
+
+    // 收到一帧完整的 access unit（线程安全，可直接在网络线程调用）
+    // rtpTimestamp 为发送端 90kHz 采集时间戳
+    void pushEncodedFrame(const QByteArray& data, quint32 rtpTimestamp);
+
+    // 发送端的 NTP <-> RTP 对应关系（RTCP SR 或 DataChannel 上的同等消息），在 GUI 线程调用
+    void onSenderReport(quint64 ntpTimestamp, quint32 rtpTimestamp);
+
+    // 混合编码的块更新消息（TileUpdate 格式），在 GUI 线程调用
+    // 新的无损块立即覆盖到当前画面上，画面静止、没有新的视频帧时也能显示
+    void pushTileUpdate(const QByteArray& data);
+
+    ReceiveStats::Ptr stats() const;
+
+signals:
+    // 需要发送端补发关键帧（已限频）
+    void keyframeRequested();
+    // 本次 start() 之后显示了第一帧
+    void videoStarted();
+
+private:
+    struct PendingFrame {
+        QVideoFrame frame;
+        qint64 receivedUs = 0;
+        quint32 rtpTimestamp = 0;
+        qint64 dueUs = 0;
+    };
+
+    // 解码输出 -> 按播放节奏排队；到期后交给 QVideoSink
+    void presentFrame(const QVideoFrame& frame, qint64 receivedUs, quint32 rtpTimestamp);
+    void presentDueFrames();
+    void showFrame(const PendingFrame& pending, qint64 nowUs);
+    // 视频帧 + 缓存的无损块交给 QVideoSink
+    void display(const QVideoFrame& frame);
+    // 应用不再需要等待的块更新，有变化时重新合成最近的画面
+    void applyTileUpdates();
+    void requestKeyframe();
+    void logStats(qint64 nowUs);
+
+    QPointer<QVideoSink> m_sink;
+    VideoCodec m_codec = VideoCodec::H264;
+    VideoDecoder* m_decoder = nullptr; // 运行在解码线程，不挂在对象树上
+    QThread* m_decodeThread = nullptr;
+    DecodeWorker* m_decodeWorker = nullptr;
+    PacketQueue::Ptr m_queue;
+    ReceiveStats::Ptr m_stats;
+
+    PlayoutClock m_playout;
+    RtpClockMapper m_clockMapper;
+    std::deque<PendingFrame> m_pending;
+    QTimer* m_presentTimer = nullptr;
+
+    TileCompositor m_tiles;
+    QVideoFrame m_lastVideoFrame;      // 最近显示的视频帧（未合成），块更新后重新合成
+    bool m_hasVideoTimestamp = false;
+    quint32 m_lastVideoTimestamp = 0;
+
+    bool m_hasPresented = false;
+    qint64 m_lastKeyframeRequestUs = -1;
+    qint64 m_lastStatsLogUs = -1;
+};
@@ -0,0 +1,510 @@
+#include "ColorConverter.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CC_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC 不需要额外编译选项即可使用 AVX2 intrinsics，GCC/Clang 需要按函数开启
+#if defined(CC_X86) && (defined(__GNUC__) || defined(__clang__))
+#define CC_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define CC_TARGET_AVX2
+#endif
+
+namespace {
+
+// 条带最少行数，小分辨率时避免线程调度开销大于转换本身
+const int MIN_BAND_ROWS = 64;
+const int MAX_AUTO_THREADS = 4;
+
+// BT.601 limited range 定点系数（8 位小数）
+// Y =  ( 66R + 129G +  25B + 128) >> 8 + 16
+// U =  (-38R -  74G + 112B + 128) >> 8 + 128
+// V =  (112R -  94G -  18B + 128) >> 8 + 128
+inline uint8_t rgbToY(int r, int g, int b) {
+    return static_cast<uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+}
+inline uint8_t rgbToU(int r, int g, int b) {
+    return static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+}
+inline uint8_t rgbToV(int r, int g, int b) {
+    return static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+}
+inline int avgRound(int a, int b) { return (a + b + 1) >> 1; }
+
+// ---------------- 标量内核 ----------------
+// 色度取样顺序：先上下两行求平均，再左右两像素求平均（与 SIMD 的 avg_epu8 完全一致）
+
+void rowYScalar(const uint8_t* src, uint8_t* dst, int x, int width) {
+    for (; x < width; ++x) {
+        const uint8_t* p = src + x * 4;
+        dst[x] = rgbToY(p[2], p[1], p[0]);
+    }
+}
+
+template<bool NV12>
+void rowUVScalar(const uint8_t* src0, const uint8_t* src1, uint8_t* u, uint8_t* v, int x, int width) {
+    for (; x + 1 < width; x += 2) {
+        const uint8_t* a = src0 + x * 4;
+        const uint8_t* b = src1 + x * 4;
+        int bb = avgRound(avgRound(a[0], b[0]), avgRound(a[4], b[4]));
+        int gg = avgRound(avgRound(a[1], b[1]), avgRound(a[5], b[5]));
+        int rr = avgRound(avgRound(a[2], b[2]), avgRound(a[6], b[6]));
+        int cx = x / 2;
+        if (NV12) {
+            u[cx * 2] = rgbToU(rr, gg, bb);
+            u[cx * 2 + 1] = rgbToV(rr, gg, bb);
+        }
+        else {
+            u[cx] = rgbToU(rr, gg, bb);
+            v[cx] = rgbToV(rr, gg, bb);
+        }
+    }
+}
+
+// 单平面 2x2 平均：上下两行先平均，再左右平均（取整方式与色度取样相同）
+void rowHalveScalar(const uint8_t* src0, const uint8_t* src1, uint8_t* dst, int x, int dstWidth) {
+    for (; x < dstWidth; ++x) {
+        dst[x] = static_cast<uint8_t>(avgRound(avgRound(src0[2 * x], src1[2 * x]),
+            avgRound(src0[2 * x + 1], src1[2 * x + 1])));
+    }
+}
+
+#ifdef CC_X86
+// ---------------- SSE2 内核 ----------------
+
+// 8 个 16 位通道分量 -> Y
+inline __m128i lumaSSE2(__m128i b, __m128i g, __m128i r) {
+    __m128i y = _mm_add_epi16(_mm_mullo_epi16(b, _mm_set1_epi16(25)),
+        _mm_mullo_epi16(g, _mm_set1_epi16(129)));
+    y = _mm_add_epi16(y, _mm_mullo_epi16(r, _mm_set1_epi16(66)));
+    y = _mm_add_epi16(y, _mm_set1_epi16(128));
+    // 最大值 56228 超过 int16 但不超过 uint16，用逻辑右移
+    return _mm_add_epi16(_mm_srli_epi16(y, 8), _mm_set1_epi16(16));
+}
+
+inline __m128i chromaSSE2(__m128i c0, __m128i c1, __m128i c2, short k0, short k1, short k2) {
+    __m128i s = _mm_add_epi16(_mm_mullo_epi16(c0, _mm_set1_epi16(k0)),
+        _mm_mullo_epi16(c1, _mm_set1_epi16(k1)));
+    s = _mm_add_epi16(s, _mm_mullo_epi16(c2, _mm_set1_epi16(k2)));
+    s = _mm_add_epi16(s, _mm_set1_epi16(128));
+    return _mm_add_epi16(_mm_srai_epi16(s, 8), _mm_set1_epi16(128));
+}
+
+// 两组各 4 个 BGRA 像素 -> 8 个 16 位的 B/G/R
+inline void splitSSE2(__m128i p0, __m128i p1, __m128i& b, __m128i& g, __m128i& r) {
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    b = _mm_packs_epi32(_mm_and_si128(p0, mask), _mm_and_si128(p1, mask));
+    g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 8), mask),
+        _mm_and_si128(_mm_srli_epi32(p1, 8), mask));
+    r = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 16), mask),
+        _mm_and_si128(_mm_srli_epi32(p1, 16), mask));
+}
+
+// 上下两行各 4 像素 -> 2 个 2x2 平均像素，位于低 64 位
+inline __m128i box2x2SSE2(const uint8_t* s0, const uint8_t* s1) {
+    __m128i a = _mm_avg_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s0)),
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(s1)));
+    a = _mm_avg_epu8(a, _mm_srli_epi64(a, 32));
+    return _mm_shuffle_epi32(a, _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+void rowYSSE2(const uint8_t* src, uint8_t* dst, int width) {
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const __m128i* p = reinterpret_cast<const __m128i*>(src + x * 4);
+        __m128i b0, g0, r0, b1, g1, r1;
+        splitSSE2(_mm_loadu_si128(p), _mm_loadu_si128(p + 1), b0, g0, r0);
+        splitSSE2(_mm_loadu_si128(p + 2), _mm_loadu_si128(p + 3), b1, g1, r1);
+        __m128i y = _mm_packus_epi16(lumaSSE2(b0, g0, r0), lumaSSE2(b1, g1, r1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), y);
+    }
+    rowYScalar(src, dst, x, width);
+}
+
+template<bool NV12>
+void rowUVSSE2(const uint8_t* src0, const uint8_t* src1, uint8_t* u, uint8_t* v, int width) {
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const uint8_t* s0 = src0 + x * 4;
+        const uint8_t* s1 = src1 + x * 4;
+        __m128i q0 = _mm_unpacklo_epi64(box2x2SSE2(s0, s1), box2x2SSE2(s0 + 16, s1 + 16));
+        __m128i q1 = _mm_unpacklo_epi64(box2x2SSE2(s0 + 32, s1 + 32), box2x2SSE2(s0 + 48, s1 + 48));
+        __m128i b, g, r;
+        splitSSE2(q0, q1, b, g, r);
+        __m128i u8 = _mm_packus_epi16(chromaSSE2(b, g, r, 112, -74, -38), _mm_setzero_si128());
+        __m128i v8 = _mm_packus_epi16(chromaSSE2(r, g, b, 112, -94, -18), _mm_setzero_si128());
+        if (NV12) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(u + x), _mm_unpacklo_epi8(u8, v8));
+        }
+        else {
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(u + x / 2), u8);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(v + x / 2), v8);
+        }
+    }
+    rowUVScalar<NV12>(src0, src1, u, v, x, width);
+}
+
+// 上下两行各 32 字节 -> 16 字节：行平均后奇偶字节按 16 位再平均
+inline __m128i halve32SSE2(const uint8_t* s0, const uint8_t* s1) {
+    const __m128i mask = _mm_set1_epi16(0xFF);
+    __m128i a = _mm_avg_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s0)),
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(s1)));
+    __m128i b = _mm_avg_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s0 + 16)),
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(s1 + 16)));
+    a = _mm_avg_epu16(_mm_and_si128(a, mask), _mm_srli_epi16(a, 8));
+    b = _mm_avg_epu16(_mm_and_si128(b, mask), _mm_srli_epi16(b, 8));
+    return _mm_packus_epi16(a, b);
+}
+
+void rowHalveSSE2(const uint8_t* src0, const uint8_t* src1, uint8_t* dst, int dstWidth) {
+    int x = 0;
+    for (; x + 16 <= dstWidth; x += 16) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), halve32SSE2(src0 + 2 * x, src1 + 2 * x));
+    }
+    rowHalveScalar(src0, src1, dst, x, dstWidth);
+}
+
+// ---------------- AVX2 内核 ----------------
+
+CC_TARGET_AVX2 inline __m256i lumaAVX2(__m256i b, __m256i g, __m256i r) {
+    __m256i y = _mm256_add_epi16(_mm256_mullo_epi16(b, _mm256_set1_epi16(25)),
+        _mm256_mullo_epi16(g, _mm256_set1_epi16(129)));
+    y = _mm256_add_epi16(y, _mm256_mullo_epi16(r, _mm256_set1_epi16(66)));
+    y = _mm256_add_epi16(y, _mm256_set1_epi16(128));
+    return _mm256_add_epi16(_mm256_srli_epi16(y, 8), _mm256_set1_epi16(16));
+}
+
+CC_TARGET_AVX2 inline __m256i chromaAVX2(__m256i c0, __m256i c1, __m256i c2, short k0, short k1, short k2) {
+    __m256i s = _mm256_add_epi16(_mm256_mullo_epi16(c0, _mm256_set1_epi16(k0)),
+        _mm256_mullo_epi16(c1, _mm256_set1_epi16(k1)));
+    s = _mm256_add_epi16(s, _mm256_mullo_epi16(c2, _mm256_set1_epi16(k2)));
+    s = _mm256_add_epi16(s, _mm256_set1_epi16(128));
+    return _mm256_add_epi16(_mm256_srai_epi16(s, 8), _mm256_set1_epi16(128));
+}
+
+// 注意 packs 按 128 位通道各自打包，结果顺序需要调用方重新排列
+CC_TARGET_AVX2 inline void splitAVX2(__m256i p0, __m256i p1, __m256i& b, __m256i& g, __m256i& r) {
+    const __m256i mask = _mm256_set1_epi32(0xFF);
+    b = _mm256_packs_epi32(_mm256_and_si256(p0, mask), _mm256_and_si256(p1, mask));
+    g = _mm256_packs_epi32(_mm256_and_si256(_mm256_srli_epi32(p0, 8), mask),
+        _mm256_and_si256(_mm256_srli_epi32(p1, 8), mask));
+    r = _mm256_packs_epi32(_mm256_and_si256(_mm256_srli_epi32(p0, 16), mask),
+        _mm256_and_si256(_mm256_srli_epi32(p1, 16), mask));
+}
+
+// 上下两行各 8 像素 -> 4 个 2x2 平均像素，位于低 128 位
+CC_TARGET_AVX2 inline __m256i box2x2AVX2(const uint8_t* s0, const uint8_t* s1) {
+    __m256i a = _mm256_avg_epu8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(s0)),
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s1)));
+    a = _mm256_avg_epu8(a, _mm256_srli_epi64(a, 32));
+    a = _mm256_shuffle_epi32(a, _MM_SHUFFLE(3, 1, 2, 0));
+    return _mm256_permute4x64_epi64(a, _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+CC_TARGET_AVX2 void rowYAVX2(const uint8_t* src, uint8_t* dst, int width) {
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    int x = 0;
+    for (; x + 32 <= width; x += 32) {
+        const __m256i* p = reinterpret_cast<const __m256i*>(src + x * 4);
+        __m256i b0, g0, r0, b1, g1, r1;
+        splitAVX2(_mm256_loadu_si256(p), _mm256_loadu_si256(p + 1), b0, g0, r0);
+        splitAVX2(_mm256_loadu_si256(p + 2), _mm256_loadu_si256(p + 3), b1, g1, r1);
+        __m256i y = _mm256_packus_epi16(lumaAVX2(b0, g0, r0), lumaAVX2(b1, g1, r1));
+        y = _mm256_permutevar8x32_epi32(y, order);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x), y);
+    }
+    rowYSSE2(src + x * 4, dst + x, width - x);
+}
+
+template<bool NV12>
+CC_TARGET_AVX2 void rowUVAVX2(const uint8_t* src0, const uint8_t* src1, uint8_t* u, uint8_t* v, int width) {
+    int x = 0;
+    for (; x + 32 <= width; x += 32) {
+        const uint8_t* s0 = src0 + x * 4;
+        const uint8_t* s1 = src1 + x * 4;
+        __m256i q0 = _mm256_permute2x128_si256(box2x2AVX2(s0, s1), box2x2AVX2(s0 + 32, s1 + 32), 0x20);
+        __m256i q1 = _mm256_permute2x128_si256(box2x2AVX2(s0 + 64, s1 + 64), box2x2AVX2(s0 + 96, s1 + 96), 0x20);
+        __m256i b, g, r;
+        splitAVX2(q0, q1, b, g, r);
+        __m256i u16 = _mm256_permute4x64_epi64(chromaAVX2(b, g, r, 112, -74, -38), _MM_SHUFFLE(3, 1, 2, 0));
+        __m256i v16 = _mm256_permute4x64_epi64(chromaAVX2(r, g, b, 112, -94, -18), _MM_SHUFFLE(3, 1, 2, 0));
+        __m128i u8 = _mm_packus_epi16(_mm256_castsi256_si128(u16), _mm256_extracti128_si256(u16, 1));
+        __m128i v8 = _mm_packus_epi16(_mm256_castsi256_si128(v16), _mm256_extracti128_si256(v16, 1));
+        if (NV12) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(u + x), _mm_unpacklo_epi8(u8, v8));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(u + x + 16), _mm_unpackhi_epi8(u8, v8));
+        }
+        else {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(u + x / 2), u8);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(v + x / 2), v8);
+        }
+    }
+    if (NV12) {
+        rowUVSSE2<true>(src0 + x * 4, src1 + x * 4, u + x, nullptr, width - x);
+    }
+    else {
+        rowUVSSE2<false>(src0 + x * 4, src1 + x * 4, u + x / 2, v + x / 2, width - x);
+    }
+}
+CC_TARGET_AVX2 void rowHalveAVX2(const uint8_t* src0, const uint8_t* src1, uint8_t* dst, int dstWidth) {
+    const __m256i mask = _mm256_set1_epi16(0xFF);
+    int x = 0;
+    for (; x + 32 <= dstWidth; x += 32) {
+        const uint8_t* s0 = src0 + 2 * x;
+        const uint8_t* s1 = src1 + 2 * x;
+        __m256i a = _mm256_avg_epu8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(s0)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s1)));
+        __m256i b = _mm256_avg_epu8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(s0 + 32)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s1 + 32)));
+        a = _mm256_avg_epu16(_mm256_and_si256(a, mask), _mm256_srli_epi16(a, 8));
+        b = _mm256_avg_epu16(_mm256_and_si256(b, mask), _mm256_srli_epi16(b, 8));
+        // packus 按 128 位通道交错，恢复成连续顺序
+        __m256i out = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x), out);
+    }
+    rowHalveSSE2(src0 + 2 * x, src1 + 2 * x, dst + x, dstWidth - x);
+}
+#endif // CC_X86
+
+bool cpuHasAvx2() {
+#if defined(CC_X86) && defined(_MSC_VER)
+    int info[4] = { 0 };
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx) return false;
+    // 操作系统需要保存 YMM 寄存器状态
+    if ((_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#elif defined(CC_X86)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+} // namespace
+
+// ---------------- 条带线程池 ----------------
+// 调用线程自己处理第 0 条带，其余条带交给常驻的辅助线程，避免每帧创建线程
+struct ColorConverter::Pool
+{
+    explicit Pool(int helperCount) {
+        for (int i = 0; i < helperCount; ++i) {
+            threads.emplace_back([this, i]() { loop(i + 1); });
+        }
+    }
+
+    ~Pool() {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            quit = true;
+        }
+        startCond.notify_all();
+        for (auto& t : threads) t.join();
+    }
+
+    int helperCount() const { return static_cast<int>(threads.size()); }
+
+    void run(int bandCount, const std::function<void(int)>& fn) {
+        if (bandCount <= 1 || threads.empty()) {
+            for (int i = 0; i < bandCount; ++i) fn(i);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            job = &fn;
+            bands = bandCount;
+            pending = static_cast<int>(threads.size());
+            ++generation;
+        }
+        startCond.notify_all();
+        fn(0);
+        std::unique_lock<std::mutex> lock(mutex);
+        doneCond.wait(lock, [this]() { return pending == 0; });
+        job = nullptr;
+    }
+
+    void loop(int band) {
+        uint64_t seen = 0;
+        while (true) {
+            const std::function<void(int)>* fn = nullptr;
+            int bandCount = 0;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                startCond.wait(lock, [&]() { return quit || generation != seen; });
+                if (quit) return;
+                seen = generation;
+                fn = job;
+                bandCount = bands;
+            }
+            if (band < bandCount) (*fn)(band);
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                if (--pending == 0) doneCond.notify_one();
+            }
+        }
+    }
+
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable startCond;
+    std::condition_variable doneCond;
+    const std::function<void(int)>* job = nullptr;
+    int bands = 0;
+    int pending = 0;
+    uint64_t generation = 0;
+    bool quit = false;
+};
+
+ColorConverter::ColorConverter(int threadCount)
+    : m_isa(detectIsa())
+{
+    if (threadCount <= 0) {
+        int hw = static_cast<int>(std::thread::hardware_concurrency());
+        threadCount = std::max(1, std::min(hw, MAX_AUTO_THREADS));
+    }
+    m_pool = std::make_unique<Pool>(threadCount - 1);
+}
+
+ColorConverter::~ColorConverter()
+{}
+
+ColorConverter::Isa ColorConverter::detectIsa()
+{
+#ifdef CC_X86
+    return cpuHasAvx2() ? Isa::AVX2 : Isa::SSE2;
+#else
+    return Isa::Scalar;
+#endif
+}
+
+const char* ColorConverter::isaName(Isa isa)
+{
+    switch (isa) {
+    case Isa::AVX2: return "AVX2";
+    case Isa::SSE2: return "SSE2";
+    default: return "Scalar";
+    }
+}
+
+void ColorConverter::setIsa(Isa isa)
+{
+    Isa best = detectIsa();
+    m_isa = (static_cast<int>(isa) > static_cast<int>(best)) ? best : isa;
+}
+
+ColorConverter::Isa ColorConverter::isa() const
+{
+    return m_isa;
+}
+
+int ColorConverter::threadCount() const
+{
+    return m_pool->helperCount() + 1;
+}
+
+bool ColorConverter::convertBgra(const uint8_t* src, int srcStride, int width, int height,
+    uint8_t* const dst[], const int dstStride[], OutputFormat format)
+{
+    if (!src || width <= 0 || height <= 0 || (width & 1) || (height & 1)) {
+        return false;
+    }
+
+    const bool nv12 = (format == OutputFormat::NV12);
+    const Isa isa = m_isa;
+
+    // 条带按偶数行对齐，保证每个条带内的色度行完整
+    int bandCount = std::min(threadCount(), std::max(1, height / MIN_BAND_ROWS));
+    int rowsPerBand = (((height + bandCount - 1) / bandCount) + 1) & ~1;
+
+    auto convertBand = [&](int band) {
+        int y0 = band * rowsPerBand;
+        int y1 = std::min(height, y0 + rowsPerBand);
+        for (int y = y0; y < y1; y += 2) {
+            const uint8_t* s0 = src + static_cast<ptrdiff_t>(y) * srcStride;
+            const uint8_t* s1 = s0 + srcStride;
+            uint8_t* y0Row = dst[0] + static_cast<ptrdiff_t>(y) * dstStride[0];
+            uint8_t* y1Row = y0Row + dstStride[0];
+            uint8_t* uRow = dst[1] + static_cast<ptrdiff_t>(y / 2) * dstStride[1];
+            uint8_t* vRow = nv12 ? nullptr : dst[2] + static_cast<ptrdiff_t>(y / 2) * dstStride[2];
+
+            switch (isa) {
+#ifdef CC_X86
+            case Isa::AVX2:
+                rowYAVX2(s0, y0Row, width);
+                rowYAVX2(s1, y1Row, width);
+                if (nv12) rowUVAVX2<true>(s0, s1, uRow, vRow, width);
+                else rowUVAVX2<false>(s0, s1, uRow, vRow, width);
+                break;
+            case Isa::SSE2:
+                rowYSSE2(s0, y0Row, width);
+                rowYSSE2(s1, y1Row, width);
+                if (nv12) rowUVSSE2<true>(s0, s1, uRow, vRow, width);
+                else rowUVSSE2<false>(s0, s1, uRow, vRow, width);
+                break;
+#endif
+            default:
+                rowYScalar(s0, y0Row, 0, width);
+                rowYScalar(s1, y1Row, 0, width);
+                if (nv12) rowUVScalar<true>(s0, s1, uRow, vRow, 0, width);
+                else rowUVScalar<false>(s0, s1, uRow, vRow, 0, width);
+                break;
+            }
+        }
+    };
+
+    m_pool->run(bandCount, convertBand);
+    return true;
+}
+
+bool ColorConverter::halvePlane(const uint8_t* src, int srcStride, int width, int height,
+    uint8_t* dst, int dstStride)
+{
+    if (!src || !dst || width <= 0 || height <= 0 || (width & 1) || (height & 1)) {
+        return false;
+    }
+
+    const int dstWidth = width / 2;
+    const int dstHeight = height / 2;
+    const Isa isa = m_isa;
+
+    int bandCount = std::min(threadCount(), std::max(1, dstHeight / MIN_BAND_ROWS));
+    int rowsPerBand = (dstHeight + bandCount - 1) / bandCount;
+
+    auto halveBand = [&](int band) {
+        int y0 = band * rowsPerBand;
+        int y1 = std::min(dstHeight, y0 + rowsPerBand);
+        for (int y = y0; y < y1; ++y) {
+            const uint8_t* s0 = src + static_cast<ptrdiff_t>(2 * y) * srcStride;
+            const uint8_t* s1 = s0 + srcStride;
+            uint8_t* d = dst + static_cast<ptrdiff_t>(y) * dstStride;
+            switch (isa) {
+#ifdef CC_X86
+            case Isa::AVX2: rowHalveAVX2(s0, s1, d, dstWidth); break;
+            case Isa::SSE2: rowHalveSSE2(s0, s1, d, dstWidth); break;
+#endif
+            default: rowHalveScalar(s0, s1, d, 0, dstWidth); break;
+            }
+        }
+    };
+
+    m_pool->run(bandCount, halveBand);
+    return true;
+}
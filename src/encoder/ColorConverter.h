@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+
+// BGRA -> I420 / NV12 颜色空间转换（BT.601 limited range，与 swscale 默认一致）
+// - 行内核：AVX2 / SSE2 / 标量三套实现，运行时按 CPU 选择
+// - 按水平条带切分整帧，由一个小线程池并行处理
+// 只做同尺寸转换，缩放或其它输入格式仍走 swscale；另外提供单平面 2:1 缩小（simulcast 的图像金字塔）
+class ColorConverter
+{
+public:
+    enum class OutputFormat { I420, NV12 };
+    enum class Isa { Scalar, SSE2, AVX2 };
+
+    // threadCount <= 0 时按 CPU 核数自动选择（最多 4 个）
+    explicit ColorConverter(int threadCount = 0);
+    ~ColorConverter();
+
+    ColorConverter(const ColorConverter&) = delete;
+    ColorConverter& operator=(const ColorConverter&) = delete;
+
+    // dst/dstStride 与 AVFrame::data/linesize 的布局一致
+    // I420 使用 dst[0..2]，NV12 使用 dst[0..1]；宽高必须为偶数
+    bool convertBgra(const uint8_t* src, int srcStride, int width, int height,
+        uint8_t* const dst[], const int dstStride[], OutputFormat format);
+
+    // 单个 8 位平面缩小为 1/2（2x2 平均），width/height 为源尺寸，必须为偶数
+    bool halvePlane(const uint8_t* src, int srcStride, int width, int height,
+        uint8_t* dst, int dstStride);
+
+    // 强制指定内核（用于测试/基准对比），不支持的指令集会退回到可用的最高级别
+    void setIsa(Isa isa);
+    Isa isa() const;
+    int threadCount() const;
+
+    static Isa detectIsa();
+    static const char* isaName(Isa isa);
+
+private:
+    struct Pool;
+
+    Isa m_isa;
+    std::unique_ptr<Pool> m_pool;
+};
@@ -0,0 +1,169 @@
+#include "EncodeWorker.h"
+#include "VideoEncoder.h"
+#include "SimulcastEncoder.h"
+#include "HybridTileEncoder.h"
+#include <QDebug>
+
+// 取帧等待超时，保证 stop() 之后能及时退出
+static const int SLOT_WAIT_TIMEOUT_MS = 100;
+
+// 可以逐字节比较的 4 字节/像素格式
+static bool isPacked32(QVideoFrameFormat::PixelFormat format)
+{
+    switch (format) {
+    case QVideoFrameFormat::Format_BGRA8888:
+    case QVideoFrameFormat::Format_BGRX8888:
+    case QVideoFrameFormat::Format_RGBA8888:
+    case QVideoFrameFormat::Format_RGBX8888:
+    case QVideoFrameFormat::Format_ARGB8888:
+    case QVideoFrameFormat::Format_XRGB8888:
+    case QVideoFrameFormat::Format_ABGR8888:
+    case QVideoFrameFormat::Format_XBGR8888:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// 无损块按 BGRA 编码，接收端也按 BGRA 合成
+static bool isBgra(QVideoFrameFormat::PixelFormat format)
+{
+    return format == QVideoFrameFormat::Format_BGRA8888 || format == QVideoFrameFormat::Format_BGRX8888;
+}
+
+EncodeWorker::EncodeWorker(FrameSlot<CapturedFrame>::Ptr slot, VideoEncoder* encoder,
+    CaptureStats::Ptr stats, CaptureScheduler* scheduler, QObject* parent)
+    : QObject(parent), m_slot(slot), m_encoder(encoder), m_stats(stats), m_scheduler(scheduler),
+    m_stopRequested(false), m_hybridResetRequested(false)
+{}
+
+EncodeWorker::EncodeWorker(FrameSlot<CapturedFrame>::Ptr slot, SimulcastEncoder* simulcast,
+    CaptureStats::Ptr stats, CaptureScheduler* scheduler, QObject* parent)
+    : QObject(parent), m_slot(slot), m_simulcast(simulcast), m_stats(stats), m_scheduler(scheduler),
+    m_stopRequested(false), m_hybridResetRequested(false)
+{}
+
+EncodeWorker::~EncodeWorker()
+{}
+
+void EncodeWorker::startLoop()
+{
+    qDebug() << "Encode thread start";
+    while (!m_stopRequested.loadRelaxed()) {
+        CapturedFrame captured;
+        if (!m_slot->take(captured, SLOT_WAIT_TIMEOUT_MS)) {
+            continue;
+        }
+        const QVideoFrame& frame = captured.frame;
+
+        FrameMeta meta;
+        meta.captureTimeUs = captured.captureTimeUs;
+        diffFrame(frame, meta);
+
+        // 首帧/分辨率变化不代表内容活跃，不用来触发 Burst
+        if (m_scheduler) {
+            m_scheduler->reportFrame(meta.captureTimeUs, meta.fullFrame ? 0.0 : meta.dirtyRatio,
+                meta.isIdentical());
+        }
+        // 画面静止时仍要响应关键帧请求（PLI、新观众）和按时间强制的关键帧，否则要等画面变化才出图
+        if (meta.isIdentical() && !keyframePending(meta.captureTimeUs)) {
+            CaptureStats::inc(m_stats->identicalFrames);
+            continue;
+        }
+
+        meta.frameId = ++m_frameId;
+        if (m_encoder) {
+            m_encoder->encode(frame, meta);
+            CaptureStats::inc(m_stats->encodedFrames);
+        }
+        else if (m_simulcast) {
+            m_simulcast->encode(frame, meta);
+            CaptureStats::inc(m_stats->encodedFrames);
+        }
+    }
+    qDebug() << "Encode thread exit";
+    emit finished();
+}
+
+bool EncodeWorker::keyframePending(qint64 captureTimeUs) const
+{
+    if (m_encoder) return m_encoder->keyframePending(captureTimeUs);
+    if (m_simulcast) return m_simulcast->keyframePending(captureTimeUs);
+    return false;
+}
+
+void EncodeWorker::stop()
+{
+    m_stopRequested.storeRelaxed(true);
+    m_slot->notifyAll();
+}
+
+void EncodeWorker::setHybridTilesEnabled(bool enabled)
+{
+    if (enabled && !m_hybrid) {
+        m_hybrid = std::make_unique<HybridTileEncoder>();
+    }
+    else if (!enabled) {
+        m_hybrid.reset();
+    }
+}
+
+void EncodeWorker::resetHybridTiles()
+{
+    m_hybridResetRequested.storeRelaxed(true);
+}
+
+void EncodeWorker::confirmHybridTiles(TileUpdate::Ptr update, bool delivered)
+{
+    if (!update) return;
+    QMutexLocker guard(&m_confirmMutex);
+    m_confirmations.emplace_back(std::move(update), delivered);
+}
+
+void EncodeWorker::diffFrame(const QVideoFrame& frame, FrameMeta& meta)
+{
+    meta.fullFrame = true;
+    meta.dirtyRects = { QRect(0, 0, frame.width(), frame.height()) };
+
+    // 无法比较的格式：重置参考帧，整帧编码
+    if (!isPacked32(frame.pixelFormat())) {
+        m_differ.reset();
+        return;
+    }
+
+    QVideoFrame mapped = frame;
+    if (!mapped.map(QVideoFrame::ReadOnly)) {
+        m_differ.reset();
+        return;
+    }
+    TileDiffer::Result result = m_differ.diff(mapped.bits(0), mapped.bytesPerLine(0),
+        mapped.width(), mapped.height());
+
+    // 趁画面还映射着编码静止的块；其它 4 字节格式不做混合编码，只走视频
+    if (m_hybrid && isBgra(frame.pixelFormat())) {
+        std::vector<std::pair<TileUpdate::Ptr, bool>> confirmations;
+        {
+            QMutexLocker guard(&m_confirmMutex);
+            confirmations.swap(m_confirmations);
+        }
+        for (const auto& confirmation : confirmations) {
+            m_hybrid->confirm(*confirmation.first, confirmation.second);
+        }
+        if (m_hybridResetRequested.fetchAndStoreRelaxed(false)) {
+            m_hybrid->reset();
+        }
+        TileUpdate::Ptr update = m_hybrid->update(mapped.bits(0), mapped.bytesPerLine(0),
+            mapped.width(), mapped.height(), result, meta.captureTimeUs);
+        if (update) {
+            m_stats->losslessTiles.fetch_add(update->tileCount(), std::memory_order_relaxed);
+            m_stats->losslessBytes.fetch_add(update->size(), std::memory_order_relaxed);
+            emit tileUpdateReady(update);
+        }
+    }
+    mapped.unmap();
+
+    meta.fullFrame = result.fullFrame;
+    meta.dirtyRects = result.dirtyRects;
+    meta.dirtyRatio = result.totalTiles > 0 ?
+        static_cast<double>(result.dirtyTiles) / result.totalTiles : 1.0;
+}
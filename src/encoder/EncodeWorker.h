@@ -0,0 +1,70 @@
+#pragma once
+#include <QObject>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QVideoFrame>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "TileUpdate.h"
+#include "../Capture/FrameSlot.hpp"
+#include "../Capture/FrameMeta.h"
+#include "../Capture/CaptureStats.h"
+#include "../Capture/TileDiffer.h"
+#include "../Capture/CaptureScheduler.h"
+
+class VideoEncoder;
+class SimulcastEncoder;
+class HybridTileEncoder;
+
+// 编码线程：从 FrameSlot 中取最新帧交给 VideoEncoder
+// 通过 moveToThread 运行在独立线程，避免 sws_scale/x264 阻塞 GUI 线程
+// 编码前先做 64x64 分块比较，与上一帧完全相同的帧直接跳过（编码器有待输出的关键帧时除外）
+// simulcast 模式下交给 SimulcastEncoder：本线程只做转换和缩小，各层在自己的线程编码
+// 混合编码模式下，比较结果同时交给 HybridTileEncoder，静止下来的块另外无损编码
+class EncodeWorker : public QObject
+{
+    Q_OBJECT
+public:
+    EncodeWorker(FrameSlot<CapturedFrame>::Ptr slot, VideoEncoder* encoder,
+        CaptureStats::Ptr stats, CaptureScheduler* scheduler, QObject* parent = nullptr);
+    EncodeWorker(FrameSlot<CapturedFrame>::Ptr slot, SimulcastEncoder* simulcast,
+        CaptureStats::Ptr stats, CaptureScheduler* scheduler, QObject* parent = nullptr);
+    ~EncodeWorker();
+
+    // 线程主循环，由 QThread::started 触发
+    void startLoop();
+    // 请求退出主循环（线程安全）
+    void stop();
+
+    // 混合编码：需在线程启动前设置
+    void setHybridTilesEnabled(bool enabled);
+    // 丢弃已发送块的状态，重新发送重置消息和全部静止块（线程安全，例如对端重新连接时）
+    void resetHybridTiles();
+    // tileUpdateReady 发出的消息的发送结果（线程安全），在下一帧比较前交给 HybridTileEncoder
+    void confirmHybridTiles(TileUpdate::Ptr update, bool delivered);
+
+signals:
+    void finished();
+    // 一批无损块更新 / 作废，在编码线程发射
+    void tileUpdateReady(TileUpdate::Ptr update);
+
+private:
+    // 计算当前帧相对上一帧的脏区域；混合编码模式下顺带编码静止的块
+    void diffFrame(const QVideoFrame& frame, FrameMeta& meta);
+    // 编码器（或 simulcast 任意一层）有待输出的关键帧
+    bool keyframePending(qint64 captureTimeUs) const;
+
+    FrameSlot<CapturedFrame>::Ptr m_slot;
+    VideoEncoder* m_encoder = nullptr; // 不持有，生命周期由 ScreenCaptureService 管理
+    SimulcastEncoder* m_simulcast = nullptr; // 同上，与 m_encoder 只有一个非空
+    CaptureStats::Ptr m_stats;
+    CaptureScheduler* m_scheduler = nullptr; // 不持有，根据比较结果切换帧率模式
+    TileDiffer m_differ;
+    std::unique_ptr<HybridTileEncoder> m_hybrid; // 未开启混合编码时为空
+    quint64 m_frameId = 0;
+    QAtomicInt m_stopRequested;
+    QAtomicInt m_hybridResetRequested;
+    QMutex m_confirmMutex;
+    std::vector<std::pair<TileUpdate::Ptr, bool>> m_confirmations; // 受 m_confirmMutex 保护
+};
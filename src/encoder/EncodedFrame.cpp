@@ -0,0 +1,53 @@
+#include "EncodedFrame.h"
+
+EncodedFrame::Ptr EncodedFrame::fromPacket(AVPacket* pkt, uint32_t rtpTimestamp, const FrameMeta& meta,
+    VideoCodec codec)
+{
+    AVPacket* owned = av_packet_alloc();
+    if (!owned) return nullptr;
+    // 只转移引用，不复制数据；pkt 之后是一个空包
+    av_packet_move_ref(owned, pkt);
+
+    std::shared_ptr<EncodedFrame> frame(new EncodedFrame());
+    frame->m_pkt = owned;
+    frame->m_timestamp = rtpTimestamp;
+    frame->m_meta = meta;
+    frame->m_codec = codec;
+    if (codec != VideoCodec::AV1) {
+        frame->m_nals = parseAnnexB(owned->data, owned->size);
+    }
+    return frame;
+}
+
+EncodedFrame::~EncodedFrame()
+{
+    av_packet_free(&m_pkt);
+}
+
+QVector<EncodedFrame::Nal> EncodedFrame::parseAnnexB(const uint8_t* data, int size)
+{
+    QVector<Nal> nals;
+    int nalStart = -1;
+    int i = 0;
+    while (i + 3 <= size) {
+        // 00 00 01 之前多出的一个 0 属于 4 字节 start code
+        if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1) {
+            if (nalStart >= 0) {
+                int end = (i > nalStart && data[i - 1] == 0) ? i - 1 : i;
+                if (end > nalStart) nals.push_back({ nalStart, end - nalStart });
+            }
+            i += 3;
+            nalStart = i;
+        }
+        else if (data[i + 2] > 1) {
+            i += 3; // 第三个字节既不是 0 也不是 1，前三个位置都不可能是 start code 的起点
+        }
+        else {
+            ++i;
+        }
+    }
+    if (nalStart >= 0 && size > nalStart) {
+        nals.push_back({ nalStart, size - nalStart });
+    }
+    return nals;
+}
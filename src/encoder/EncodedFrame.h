@@ -0,0 +1,62 @@
+#pragma once
+#include <QMetaType>
+#include <QVector>
+#include <cstdint>
+#include <memory>
+#include "../Capture/FrameMeta.h"
+#include "../rtc/VideoCodec.hpp"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+// 一帧完整的编码结果
+// H.264 / H.265 为 access unit：该帧的全部 NALU，Annex-B 格式，带 start code
+// AV1 为时间单元：低开销格式的 OBU 序列，没有 NALU
+// 直接接管 AVPacket 的引用计数缓冲区，编码器 -> 发送端全程不拷贝
+// 通过 shared_ptr<const> 在线程间传递，最后一个持有者释放时归还 AVPacket
+class EncodedFrame
+{
+public:
+    using Ptr = std::shared_ptr<const EncodedFrame>;
+
+    // 单个 NALU 在 data() 中的位置（不含 start code）
+    struct Nal {
+        int offset = 0;
+        int size = 0;
+    };
+
+    // 接管 pkt 的数据，pkt 被重置为空包，可以继续用于 avcodec_receive_packet
+    static Ptr fromPacket(AVPacket* pkt, uint32_t rtpTimestamp, const FrameMeta& meta,
+        VideoCodec codec = VideoCodec::H264);
+
+    ~EncodedFrame();
+
+    EncodedFrame(const EncodedFrame&) = delete;
+    EncodedFrame& operator=(const EncodedFrame&) = delete;
+
+    const uint8_t* data() const { return m_pkt->data; }
+    int size() const { return m_pkt->size; }
+
+    uint32_t timestamp() const { return m_timestamp; }  // 90kHz RTP 时间戳
+    int64_t pts() const { return m_pkt->pts; }          // 编码器时间基（1/90000）下的 pts
+    bool isKeyFrame() const { return (m_pkt->flags & AV_PKT_FLAG_KEY) != 0; }
+    const FrameMeta& meta() const { return m_meta; }
+    VideoCodec codec() const { return m_codec; }
+    // AV1 时为空
+    const QVector<Nal>& nalUnits() const { return m_nals; }
+
+    // 按 00 00 01 / 00 00 00 01 切分 Annex-B 码流
+    static QVector<Nal> parseAnnexB(const uint8_t* data, int size);
+
+private:
+    EncodedFrame() = default;
+
+    AVPacket* m_pkt = nullptr;
+    uint32_t m_timestamp = 0;
+    FrameMeta m_meta;
+    VideoCodec m_codec = VideoCodec::H264;
+    QVector<Nal> m_nals;
+};
+
+Q_DECLARE_METATYPE(EncodedFrame::Ptr)
@@ -0,0 +1,148 @@
+#include "EncoderBackend.h"
+
+namespace {
+
+// libx264：tune=zerolatency 关闭前瞻与帧级多线程缓冲，每送入一帧立即输出一帧
+class X264Backend : public EncoderBackend
+{
+public:
+    explicit X264Backend(const AVCodec* encoder) : EncoderBackend(VideoCodec::H264, encoder) {}
+
+    void applyLowLatency(AVCodecContext*, AVDictionary** opts, const QByteArray& preset) const override {
+        av_dict_set(opts, "preset", preset.isEmpty() ? "ultrafast" : preset.constData(), 0);
+        av_dict_set(opts, "tune", "zerolatency", 0);
+        av_dict_set(opts, "forced-idr", "1", 0); // 强制关键帧时输出 IDR，而不是普通 I 帧
+    }
+
+    void applyGopPolicy(AVCodecContext*, AVDictionary** opts, GopPolicy policy) const override {
+        if (policy == GopPolicy::Periodic) return;
+        // 场景切换也不插 I 帧，避免码率尖峰
+        appendParams(opts, "x264-params", "scenecut=0");
+        if (policy == GopPolicy::IntraRefresh) {
+            // 开启后 x264 把 keyint 当作刷新周期，不再周期性输出 IDR
+            av_dict_set(opts, "intra-refresh", "1", 0);
+        }
+    }
+
+    bool supportsIntraRefresh() const override { return true; }
+    // libx264 在每帧编码前比较码率字段，有变化时调用 x264_encoder_reconfig
+    bool supportsLiveBitrate() const override { return true; }
+};
+
+// libx265：同样的 zerolatency 调优；没有 GLOBAL_HEADER 时 VPS/SPS/PPS 随每个关键帧重复发送
+class X265Backend : public EncoderBackend
+{
+public:
+    explicit X265Backend(const AVCodec* encoder) : EncoderBackend(VideoCodec::H265, encoder) {}
+
+    void applyLowLatency(AVCodecContext*, AVDictionary** opts, const QByteArray& preset) const override {
+        av_dict_set(opts, "preset", preset.isEmpty() ? "ultrafast" : preset.constData(), 0);
+        av_dict_set(opts, "tune", "zerolatency", 0);
+        av_dict_set(opts, "forced-idr", "1", 0);
+        appendParams(opts, "x265-params", "log-level=error:repeat-headers=1");
+    }
+
+    void applyGopPolicy(AVCodecContext*, AVDictionary** opts, GopPolicy policy) const override {
+        switch (policy) {
+        case GopPolicy::Periodic:
+            // 周期 IDR 由调用方强制，保留场景切换
+            appendParams(opts, "x265-params", "keyint=-1");
+            break;
+        case GopPolicy::Infinite:
+            // x265 用 keyint=-1 表示只在开头输出一个关键帧
+            appendParams(opts, "x265-params", "keyint=-1:scenecut=0");
+            break;
+        case GopPolicy::IntraRefresh:
+            // 与 x264 相同：keyint 作为刷新周期，帧内块按列逐帧推进
+            appendParams(opts, "x265-params", "intra-refresh=1:scenecut=0");
+            break;
+        }
+    }
+
+    bool supportsIntraRefresh() const override { return true; }
+};
+
+// libsvtav1：低延迟预测结构（只参考前向帧，无重排），scm=1 强制开启屏幕内容模式
+class SvtAv1Backend : public EncoderBackend
+{
+public:
+    explicit SvtAv1Backend(const AVCodec* encoder) : EncoderBackend(VideoCodec::AV1, encoder) {}
+
+    void applyLowLatency(AVCodecContext*, AVDictionary** opts, const QByteArray& preset) const override {
+        // SVT-AV1 的 preset 是 0（最慢）~ 13（最快）的数字
+        av_dict_set(opts, "preset", preset.isEmpty() ? "12" : preset.constData(), 0);
+        appendParams(opts, "svtav1-params", "pred-struct=1:scm=1");
+    }
+
+    void applyGopPolicy(AVCodecContext*, AVDictionary** opts, GopPolicy policy) const override {
+        if (policy == GopPolicy::Periodic) return;
+        // 关闭场景切换检测；无限 GOP 由调用方设置的 gop_size 实现
+        appendParams(opts, "svtav1-params", "scd=0");
+    }
+};
+
+// libaom-av1：realtime 模式，tune-content=screen 开启调色板与帧内块复制
+class AomAv1Backend : public EncoderBackend
+{
+public:
+    explicit AomAv1Backend(const AVCodec* encoder) : EncoderBackend(VideoCodec::AV1, encoder) {}
+
+    void applyLowLatency(AVCodecContext*, AVDictionary** opts, const QByteArray& preset) const override {
+        av_dict_set(opts, "usage", "realtime", 0);
+        // preset 对应 cpu-used（0 ~ 8，越大越快）
+        av_dict_set(opts, "cpu-used", preset.isEmpty() ? "8" : preset.constData(), 0);
+        av_dict_set(opts, "lag-in-frames", "0", 0);
+        av_dict_set(opts, "row-mt", "1", 0);
+        av_dict_set(opts, "tune-content", "screen", 0);
+    }
+
+    void applyGopPolicy(AVCodecContext* ctx, AVDictionary**, GopPolicy policy) const override {
+        if (policy == GopPolicy::Periodic) return;
+        // 关键帧最小间隔与最大间隔相同，libaom 不会再自动插入关键帧
+        ctx->keyint_min = ctx->gop_size;
+    }
+};
+
+} // namespace
+
+void EncoderBackend::appendParams(AVDictionary** opts, const char* key, const char* params)
+{
+    const AVDictionaryEntry* entry = av_dict_get(*opts, key, nullptr, 0);
+    if (!entry) {
+        av_dict_set(opts, key, params, 0);
+        return;
+    }
+    const QByteArray merged = QByteArray(entry->value) + ':' + params;
+    av_dict_set(opts, key, merged.constData(), 0);
+}
+
+EncoderBackend::Ptr EncoderBackend::create(VideoCodec codec)
+{
+    switch (codec) {
+    case VideoCodec::H264:
+        if (const AVCodec* encoder = avcodec_find_encoder_by_name("libx264")) return Ptr(new X264Backend(encoder));
+        break;
+    case VideoCodec::H265:
+        if (const AVCodec* encoder = avcodec_find_encoder_by_name("libx265")) return Ptr(new X265Backend(encoder));
+        break;
+    case VideoCodec::AV1:
+        if (const AVCodec* encoder = avcodec_find_encoder_by_name("libsvtav1")) return Ptr(new SvtAv1Backend(encoder));
+        if (const AVCodec* encoder = avcodec_find_encoder_by_name("libaom-av1")) return Ptr(new AomAv1Backend(encoder));
+        break;
+    }
+    return nullptr;
+}
+
+bool EncoderBackend::isAvailable(VideoCodec codec)
+{
+    return create(codec) != nullptr;
+}
+
+QList<VideoCodec> EncoderBackend::availableCodecs()
+{
+    QList<VideoCodec> codecs;
+    for (VideoCodec codec : { VideoCodec::AV1, VideoCodec::H265, VideoCodec::H264 }) {
+        if (isAvailable(codec)) codecs.append(codec);
+    }
+    return codecs;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <QByteArray>
+#include <QList>
+#include <memory>
+#include "../rtc/VideoCodec.hpp"
+
+// FFmpeg 是 C 语言库
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/dict.h>
+}
+
+// 编码器后端：VideoEncoder 的流程（颜色转换、时间戳、码率、关键帧请求）各格式通用，
+// 只有打开编码器时的参数因格式而异，收在这里。都是 FFmpeg 中的 CPU 编码器：
+// - H.264：libx264
+// - H.265：libx265
+// - AV1：libsvtav1 优先，没有时用 libaom-av1；都开启屏幕内容工具（调色板 / 帧内块复制）
+class EncoderBackend
+{
+public:
+    using Ptr = std::unique_ptr<EncoderBackend>;
+
+    // GOP 策略，对应 VideoEncoder::KeyframeMode；gop_size 由调用方设置
+    // （Periodic 与 Infinite 都是无限 GOP，周期 IDR 由 VideoEncoder 按采集时间强制）
+    enum class GopPolicy { Periodic, Infinite, IntraRefresh };
+
+    // 当前 FFmpeg 中没有该格式的编码器时返回 nullptr
+    static Ptr create(VideoCodec codec);
+    static bool isAvailable(VideoCodec codec);
+    // 可用的格式，按同等画质下所需码率从低到高排列（AV1、H.265、H.264）
+    static QList<VideoCodec> availableCodecs();
+
+    virtual ~EncoderBackend() = default;
+
+    VideoCodec codec() const { return m_codec; }
+    const AVCodec* encoder() const { return m_encoder; }
+
+    // 低延迟参数：preset、零延迟、关闭前瞻等；preset 为空时使用后端的默认值
+    virtual void applyLowLatency(AVCodecContext* ctx, AVDictionary** opts, const QByteArray& preset) const = 0;
+    virtual void applyGopPolicy(AVCodecContext* ctx, AVDictionary** opts, GopPolicy policy) const = 0;
+    virtual bool supportsIntraRefresh() const { return false; }
+    // FFmpeg 的封装能否在编码过程中响应 bit_rate 的变化，不能时需要重新打开编码器
+    virtual bool supportsLiveBitrate() const { return false; }
+
+protected:
+    EncoderBackend(VideoCodec codec, const AVCodec* encoder)
+        : m_codec(codec), m_encoder(encoder) {}
+
+    // 向 "x264-params" 这类 key=value:key=value 形式的选项追加参数
+    static void appendParams(AVDictionary** opts, const char* key, const char* params);
+
+private:
+    VideoCodec m_codec;
+    const AVCodec* m_encoder;
+};
@@ -0,0 +1,187 @@
+#include "FrameConverter.h"
+#include <QDebug>
+
+extern "C" {
+#include <libavutil/pixdesc.h>
+}
+
+FrameConverter::FrameConverter()
+{}
+
+FrameConverter::~FrameConverter()
+{
+    if (m_swsCtx) {
+        sws_freeContext(m_swsCtx);
+        m_swsCtx = nullptr;
+    }
+    if (m_areaCtx) {
+        sws_freeContext(m_areaCtx);
+        m_areaCtx = nullptr;
+    }
+    for (AVFrame*& frame : m_scratch) {
+        av_frame_free(&frame);
+    }
+}
+
+ColorConverter& FrameConverter::colorConverter()
+{
+    if (!m_converter) {
+        m_converter = std::make_unique<ColorConverter>();
+        qDebug() << "Using" << ColorConverter::isaName(m_converter->isa())
+            << "color converter with" << m_converter->threadCount() << "threads";
+    }
+    return *m_converter;
+}
+
+bool FrameConverter::convert(const QVideoFrame& frame, AVFrame* dst)
+{
+    const QVideoFrameFormat::PixelFormat pixFmt = frame.pixelFormat();
+    const bool fastPath = (pixFmt == QVideoFrameFormat::Format_BGRA8888 ||
+        pixFmt == QVideoFrameFormat::Format_BGRX8888) &&
+        !(frame.width() & 1) && !(frame.height() & 1);
+
+    if (fastPath && frame.width() == dst->width && frame.height() == dst->height) {
+        if (colorConverter().convertBgra(frame.bits(0), frame.bytesPerLine(0), frame.width(), frame.height(),
+            dst->data, dst->linesize, ColorConverter::OutputFormat::I420)) {
+            return true;
+        }
+    }
+    // 采集画面通常比编码尺寸大（如 1080p -> 360p）：转换后再在 I420 上缩小
+    else if (fastPath && frame.width() >= dst->width && frame.height() >= dst->height) {
+        if (convertAndDownscale(frame, dst)) return true;
+    }
+    return convertWithSws(frame, dst);
+}
+
+bool FrameConverter::halveI420(const AVFrame* src, AVFrame* dst)
+{
+    ColorConverter& converter = colorConverter();
+    for (int plane = 0; plane < 3; ++plane) {
+        const int width = plane == 0 ? src->width : src->width / 2;
+        const int height = plane == 0 ? src->height : src->height / 2;
+        if (!converter.halvePlane(src->data[plane], src->linesize[plane], width, height,
+            dst->data[plane], dst->linesize[plane])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+AVFrame* FrameConverter::scratchFrame(size_t index, int width, int height)
+{
+    if (m_scratch.size() <= index) m_scratch.resize(index + 1, nullptr);
+    AVFrame*& frame = m_scratch[index];
+    if (frame && frame->width == width && frame->height == height) return frame;
+
+    av_frame_free(&frame);
+    frame = av_frame_alloc();
+    if (!frame) return nullptr;
+    frame->format = AV_PIX_FMT_YUV420P;
+    frame->width = width;
+    frame->height = height;
+    if (av_frame_get_buffer(frame, 32) < 0) {
+        av_frame_free(&frame);
+        return nullptr;
+    }
+    return frame;
+}
+
+bool FrameConverter::convertAndDownscale(const QVideoFrame& frame, AVFrame* dst)
+{
+    // 1. 采集尺寸的 SIMD 转换
+    AVFrame* current = scratchFrame(0, frame.width(), frame.height());
+    if (!current || !colorConverter().convertBgra(frame.bits(0), frame.bytesPerLine(0),
+        frame.width(), frame.height(), current->data, current->linesize, ColorConverter::OutputFormat::I420)) {
+        return false;
+    }
+
+    // 2. 还有 2 倍以上的余量时 2x2 平均减半（色度平面也要能减半，宽高须为 4 的倍数），
+    //    恰好是 2 倍时直接写进 dst
+    size_t index = 1;
+    while (current->width >= dst->width * 2 && current->height >= dst->height * 2 &&
+        !(current->width & 3) && !(current->height & 3)) {
+        const bool last = current->width == dst->width * 2 && current->height == dst->height * 2;
+        AVFrame* half = last ? dst : scratchFrame(index++, current->width / 2, current->height / 2);
+        if (!half || !halveI420(current, half)) return false;
+        if (last) return true;
+        current = half;
+    }
+
+    // 3. 剩下不到 2 倍（或不能再减半）的比例用区域平均
+    if (!m_areaCtx || current->width != m_areaSrcW || current->height != m_areaSrcH ||
+        dst->width != m_areaDstW || dst->height != m_areaDstH) {
+        if (m_areaCtx) sws_freeContext(m_areaCtx);
+        m_areaCtx = sws_getContext(current->width, current->height, AV_PIX_FMT_YUV420P,
+            dst->width, dst->height, AV_PIX_FMT_YUV420P, SWS_AREA, nullptr, nullptr, nullptr);
+        m_areaSrcW = current->width;
+        m_areaSrcH = current->height;
+        m_areaDstW = dst->width;
+        m_areaDstH = dst->height;
+    }
+    if (!m_areaCtx) return false;
+    sws_scale(m_areaCtx, current->data, current->linesize, 0, current->height, dst->data, dst->linesize);
+    return true;
+}
+
+AVPixelFormat FrameConverter::toAVPixelFormat(QVideoFrameFormat::PixelFormat format)
+{
+    switch (format) {
+    case QVideoFrameFormat::Format_BGRA8888: return AV_PIX_FMT_BGRA;
+    case QVideoFrameFormat::Format_BGRX8888: return AV_PIX_FMT_BGR0;
+    case QVideoFrameFormat::Format_RGBA8888: return AV_PIX_FMT_RGBA;
+    case QVideoFrameFormat::Format_RGBX8888: return AV_PIX_FMT_RGB0;
+    case QVideoFrameFormat::Format_ARGB8888: return AV_PIX_FMT_ARGB;
+    case QVideoFrameFormat::Format_XRGB8888: return AV_PIX_FMT_0RGB;
+    case QVideoFrameFormat::Format_ABGR8888: return AV_PIX_FMT_ABGR;
+    case QVideoFrameFormat::Format_XBGR8888: return AV_PIX_FMT_0BGR;
+    case QVideoFrameFormat::Format_NV12: return AV_PIX_FMT_NV12;
+    case QVideoFrameFormat::Format_YUV420P: return AV_PIX_FMT_YUV420P;
+    default: return AV_PIX_FMT_BGRA;
+    }
+}
+
+bool FrameConverter::convertWithSws(const QVideoFrame& frame, AVFrame* dst)
+{
+    const AVPixelFormat srcFmt = toAVPixelFormat(frame.pixelFormat());
+
+    if (!m_swsCtx || frame.width() != m_lastSrcW || frame.height() != m_lastSrcH ||
+        srcFmt != m_lastSrcFmt || dst->width != m_lastDstW || dst->height != m_lastDstH) {
+        qDebug() << "Source format changed to" << frame.width() << "x" << frame.height()
+            << av_get_pix_fmt_name(srcFmt) << "- Recreating SwsContext";
+
+        // 如果旧的存在，先释放
+        if (m_swsCtx) {
+            sws_freeContext(m_swsCtx);
+            m_swsCtx = nullptr;
+        }
+
+        // 更新记录
+        m_lastSrcW = frame.width();
+        m_lastSrcH = frame.height();
+        m_lastSrcFmt = srcFmt;
+        m_lastDstW = dst->width;
+        m_lastDstH = dst->height;
+
+        m_swsCtx = sws_getContext(
+            frame.width(), frame.height(), srcFmt,        // 输入
+            dst->width, dst->height, AV_PIX_FMT_YUV420P,  // 输出
+            SWS_BICUBIC, nullptr, nullptr, nullptr
+        );
+    }
+
+    // 安全检查：如果上下文创建失败，不要继续，否则 sws_scale 会崩溃
+    if (!m_swsCtx) {
+        return false;
+    }
+
+    // 执行转换（多平面格式需要传入所有平面）
+    const uint8_t* srcData[4] = { nullptr };
+    int srcLinesize[4] = { 0 };
+    for (int i = 0; i < frame.planeCount() && i < 4; ++i) {
+        srcData[i] = frame.bits(i);
+        srcLinesize[i] = frame.bytesPerLine(i);
+    }
+
+    sws_scale(m_swsCtx, srcData, srcLinesize, 0, frame.height(), dst->data, dst->linesize);
+    return true;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <QVideoFrame>
+#include <memory>
+#include <vector>
+#include "ColorConverter.h"
+
+// FFmpeg 是 C 语言库
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+#include <libswscale/swscale.h>
+}
+
+// Qt 采集帧 -> I420 AVFrame
+// BGRA/BGRX 输入先按采集尺寸走 ColorConverter 的 SIMD 快速路径；需要缩小时再在 I420 上
+// 逐级 2:1 平均（halveI420），剩下不是 2 倍的部分用 swscale 的区域平均。其它像素格式、
+// 奇数尺寸和放大回退到 swscale 一步完成
+// VideoEncoder 与 simulcast 的图像金字塔共用；只在一个线程内使用
+class FrameConverter
+{
+public:
+    FrameConverter();
+    ~FrameConverter();
+
+    FrameConverter(const FrameConverter&) = delete;
+    FrameConverter& operator=(const FrameConverter&) = delete;
+
+    // frame 需已 map；dst 为已分配好的 YUV420P 帧，输出尺寸即 dst 的宽高
+    bool convert(const QVideoFrame& frame, AVFrame* dst);
+
+    // 快速路径的转换器（首次使用时创建）
+    ColorConverter& colorConverter();
+
+    // I420 缩小为 1/2（各平面 2x2 平均），dst 须为 src 一半大小；src 宽高须为 4 的倍数
+    bool halveI420(const AVFrame* src, AVFrame* dst);
+
+    // Qt 像素格式 -> FFmpeg 像素格式，未列出的按 BGRA 处理
+    static AVPixelFormat toAVPixelFormat(QVideoFrameFormat::PixelFormat format);
+
+private:
+    bool convertWithSws(const QVideoFrame& frame, AVFrame* dst);
+    // 采集尺寸 SIMD 转换 + 在 I420 上缩小到 dst 的尺寸
+    bool convertAndDownscale(const QVideoFrame& frame, AVFrame* dst);
+    // 第 index 个中间帧，尺寸变化时重新分配
+    AVFrame* scratchFrame(size_t index, int width, int height);
+
+    std::unique_ptr<ColorConverter> m_converter;
+    SwsContext* m_swsCtx = nullptr;
+
+    // 缩小用的中间帧：[0] 为采集尺寸，之后依次为逐级 2:1 的结果
+    std::vector<AVFrame*> m_scratch;
+    SwsContext* m_areaCtx = nullptr;   // I420 -> I420 区域平均，处理 2:1 之后剩下的比例
+    int m_areaSrcW = -1;
+    int m_areaSrcH = -1;
+    int m_areaDstW = -1;
+    int m_areaDstH = -1;
+
+    // 记录上一次输入的源分辨率 / 格式和输出尺寸，变化时重建 SwsContext
+    int m_lastSrcW = -1;
+    int m_lastSrcH = -1;
+    AVPixelFormat m_lastSrcFmt = AV_PIX_FMT_NONE;
+    int m_lastDstW = -1;
+    int m_lastDstH = -1;
+};
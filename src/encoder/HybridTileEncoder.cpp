@@ -0,0 +1,90 @@
+#include "HybridTileEncoder.h"
+#include "../Capture/MediaClock.h"
+#include <algorithm>
+#include <memory>
+
+HybridTileEncoder::HybridTileEncoder() = default;
+
+void HybridTileEncoder::setConfig(const Config& config)
+{
+    m_config = config;
+}
+
+void HybridTileEncoder::reset()
+{
+    m_tiles.clear();
+    m_width = 0;
+    m_height = 0;
+    m_resetPending = true;
+}
+
+TileUpdate::Ptr HybridTileEncoder::update(const uint8_t* pixels, int stride, int width, int height,
+    const TileDiffer::Result& diff, qint64 captureTimeUs)
+{
+    if (diff.totalTiles <= 0 || static_cast<int>(diff.dirtyMask.size()) != diff.totalTiles) return nullptr;
+    m_lastCaptureUs = captureTimeUs;
+
+    // 首帧 / 尺寸变化：所有块从现在开始计时，接收端清空缓存
+    if (diff.fullFrame || width != m_width || height != m_height ||
+        static_cast<int>(m_tiles.size()) != diff.totalTiles) {
+        m_tiles.assign(diff.totalTiles, TileState{ captureTimeUs, false, 0 });
+        m_width = width;
+        m_height = height;
+        m_resetPending = true;
+    }
+
+    const int tileSize = TileDiffer::TILE_SIZE;
+    auto message = std::make_shared<TileUpdate>(MediaClock::rtpTimestamp(captureTimeUs),
+        width, height, tileSize, m_resetPending);
+    if (++m_sequence == 0) ++m_sequence;
+    message->setSequence(m_sequence);
+    m_resetPending = false;
+
+    // 变化的块重新计时；接收端缓存着（或即将收到）的要作废，与同一时间戳的视频帧一起生效
+    if (!diff.fullFrame) {
+        for (int i = 0; i < diff.totalTiles; ++i) {
+            if (!diff.dirtyMask[i]) continue;
+            TileState& tile = m_tiles[i];
+            tile.lastChangeUs = captureTimeUs;
+            if (tile.sent || tile.inFlight) {
+                tile.sent = false;
+                tile.inFlight = 0;
+                message->addInvalidation(static_cast<uint32_t>(i));
+            }
+        }
+    }
+
+    // 静止够久的块无损编码，超出每帧上限的留到下一帧
+    const qint64 settleUs = static_cast<qint64>(m_config.settleMs) * 1000;
+    int encoded = 0;
+    for (int i = 0; i < diff.totalTiles && encoded < m_config.maxTilesPerUpdate; ++i) {
+        TileState& tile = m_tiles[i];
+        if (tile.sent || tile.inFlight || captureTimeUs - tile.lastChangeUs < settleUs) continue;
+
+        const int x = (i % diff.tilesX) * tileSize;
+        const int y = (i / diff.tilesX) * tileSize;
+        const int w = std::min(tileSize, width - x);
+        const int h = std::min(tileSize, height - y);
+        message->addTile(static_cast<uint32_t>(i), m_codec,
+            pixels + static_cast<ptrdiff_t>(y) * stride + x * 4, stride, w, h);
+        tile.inFlight = m_sequence;
+        ++encoded;
+    }
+
+    if (message->isEmpty()) return nullptr;
+    return message;
+}
+
+void HybridTileEncoder::confirm(const TileUpdate& update, bool delivered)
+{
+    if (!delivered && (update.header().isReset() || update.hasInvalidations())) {
+        reset();
+        return;
+    }
+    for (TileState& tile : m_tiles) {
+        if (tile.inFlight != update.sequence()) continue;
+        tile.inFlight = 0;
+        if (delivered) tile.sent = true;
+        else tile.lastChangeUs = m_lastCaptureUs; // 不在每一帧重试
+    }
+}
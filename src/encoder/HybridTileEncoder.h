@@ -0,0 +1,54 @@
+#pragma once
+#include <QtGlobal>
+#include <vector>
+#include "TileCodec.h"
+#include "TileUpdate.h"
+#include "../Capture/TileDiffer.h"
+
+// 混合编码的发送端：按 TileDiffer 的 64x64 块跟踪每块最近一次变化的时刻
+// - 连续 settleMs 没有变化的块用 TileCodec 无损编码发送一次，接收端缓存后覆盖在视频上，
+//   低码率下被视频编码器抹糊的文字因此保持清晰
+// - 已发送的块再次变化时发送作废，接收端改回显示视频；运动区域始终走视频编码器
+// - 块在发送成功（confirm）后才算已发送，没有送达的块重新编码
+// 只在编码线程使用
+class HybridTileEncoder
+{
+public:
+    struct Config {
+        int settleMs = 200;          // 块静止多久后发送无损数据
+        int maxTilesPerUpdate = 128; // 每帧最多编码的块数，首帧/整屏切换时分摊到后续几帧
+    };
+
+    HybridTileEncoder();
+
+    void setConfig(const Config& config);
+    const Config& config() const { return m_config; }
+
+    // 每个采集帧调用一次（包括与上一帧相同、不送去编码的帧）
+    // pixels 为当前帧（BGRA），diff 为同一帧的比较结果；没有需要发送的内容时返回空
+    TileUpdate::Ptr update(const uint8_t* pixels, int stride, int width, int height,
+        const TileDiffer::Result& diff, qint64 captureTimeUs);
+
+    // 丢弃所有块的状态，下一帧发送重置消息，静止的块重新发送（对端重新连接时）
+    void reset();
+
+    // update 返回的消息的发送结果：送达的块记为已发送，没有送达的块再静止一个周期后重新编码；
+    // 含作废或重置的消息没有送达时，接收端的缓存状态未知，整体重置
+    void confirm(const TileUpdate& update, bool delivered);
+
+private:
+    struct TileState {
+        qint64 lastChangeUs = 0;
+        bool sent = false;     // 接收端持有该块的无损数据
+        uint32_t inFlight = 0; // 已编码、等待发送结果的消息序号，0 表示没有
+    };
+
+    Config m_config;
+    TileCodec m_codec;
+    std::vector<TileState> m_tiles;
+    int m_width = 0;
+    int m_height = 0;
+    bool m_resetPending = true;
+    uint32_t m_sequence = 0;
+    qint64 m_lastCaptureUs = 0;
+};
@@ -0,0 +1,144 @@
+#include "I420Pyramid.h"
+#include <QDebug>
+#include <chrono>
+
+static qint64 steadyNowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 编码线程仍持有该层上一帧的引用时换一块新缓冲区。
+// 与 av_frame_make_writable 不同，不拷贝旧内容：整层都会被重写
+static bool prepareWritable(AVFrame* frame) {
+    if (av_frame_is_writable(frame)) return true;
+    const int format = frame->format;
+    const int width = frame->width;
+    const int height = frame->height;
+    av_frame_unref(frame);
+    frame->format = format;
+    frame->width = width;
+    frame->height = height;
+    return av_frame_get_buffer(frame, 32) >= 0;
+}
+
+I420Pyramid::I420Pyramid()
+{}
+
+I420Pyramid::~I420Pyramid()
+{
+    release();
+}
+
+void I420Pyramid::release()
+{
+    for (Level& level : m_levels) {
+        av_frame_free(&level.frame);
+        if (level.sws) {
+            sws_freeContext(level.sws);
+            level.sws = nullptr;
+        }
+    }
+    m_levels.clear();
+}
+
+bool I420Pyramid::init(const QVector<SimulcastLayer>& layers)
+{
+    release();
+
+    for (int i = 0; i < layers.size(); ++i) {
+        const SimulcastLayer& layer = layers[i];
+        if (layer.width <= 0 || layer.height <= 0 || (layer.width & 1) || (layer.height & 1)) {
+            qDebug() << "Invalid simulcast layer size" << layer.width << "x" << layer.height;
+            release();
+            return false;
+        }
+
+        Level level;
+        level.frame = av_frame_alloc();
+        level.frame->format = AV_PIX_FMT_YUV420P;
+        level.frame->width = layer.width;
+        level.frame->height = layer.height;
+        if (av_frame_get_buffer(level.frame, 32) < 0) {
+            av_frame_free(&level.frame);
+            release();
+            return false;
+        }
+
+        if (i > 0) {
+            // 优先找恰好 2 倍大的层（SIMD 2x2 平均），否则从紧邻的上一层缩小
+            level.source = i - 1;
+            for (int j = 0; j < i; ++j) {
+                if (layers[j].width == layer.width * 2 && layers[j].height == layer.height * 2) {
+                    level.source = j;
+                    level.halve = true;
+                    break;
+                }
+            }
+            if (!level.halve) {
+                const SimulcastLayer& source = layers[level.source];
+                level.sws = sws_getContext(source.width, source.height, AV_PIX_FMT_YUV420P,
+                    layer.width, layer.height, AV_PIX_FMT_YUV420P, SWS_AREA, nullptr, nullptr, nullptr);
+                if (!level.sws) {
+                    m_levels.push_back(level);
+                    release();
+                    return false;
+                }
+            }
+        }
+        m_levels.push_back(level);
+    }
+    return !m_levels.empty();
+}
+
+bool I420Pyramid::build(const QVideoFrame& inputFrame, std::vector<FramePtr>& out)
+{
+    out.clear();
+    if (m_levels.empty()) return false;
+
+    // 1. 最高一层：采集帧转换（尺寸不同时由 FrameConverter 转换后缩小）
+    const qint64 convertStartUs = steadyNowUs();
+    QVideoFrame mapped = inputFrame;
+    if (!mapped.map(QVideoFrame::ReadOnly)) {
+        qDebug() << "Map frame failed";
+        return false;
+    }
+    AVFrame* top = m_levels[0].frame;
+    bool converted = prepareWritable(top) && m_converter.convert(mapped, top);
+    mapped.unmap();
+    if (!converted) return false;
+
+    // 2. 其余各层逐级缩小，源层总在本层之前
+    const qint64 scaleStartUs = steadyNowUs();
+    m_lastConvertUs = scaleStartUs - convertStartUs;
+    for (size_t i = 1; i < m_levels.size(); ++i) {
+        if (!prepareWritable(m_levels[i].frame) || !scaleLevel(m_levels[i])) {
+            return false;
+        }
+    }
+    m_lastScaleUs = steadyNowUs() - scaleStartUs;
+
+    // 3. 交给各层编码线程的是新的引用，原帧留作下一帧的缓冲区
+    out.reserve(m_levels.size());
+    for (const Level& level : m_levels) {
+        AVFrame* ref = av_frame_clone(level.frame);
+        if (!ref) {
+            out.clear();
+            return false;
+        }
+        out.emplace_back(ref, [](AVFrame* frame) { av_frame_free(&frame); });
+    }
+    return true;
+}
+
+bool I420Pyramid::scaleLevel(Level& level)
+{
+    const AVFrame* src = m_levels[level.source].frame;
+    AVFrame* dst = level.frame;
+
+    if (level.halve) {
+        return m_converter.halveI420(src, dst);
+    }
+
+    sws_scale(level.sws, src->data, src->linesize, 0, src->height, dst->data, dst->linesize);
+    return true;
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <QVideoFrame>
+#include <QVector>
+#include <QtGlobal>
+#include <memory>
+#include <vector>
+#include "FrameConverter.h"
+#include "SimulcastLayer.h"
+
+// FFmpeg 是 C 语言库
+extern "C" {
+#include <libavutil/frame.h>
+#include <libswscale/swscale.h>
+}
+
+// simulcast 的图像金字塔：每帧只做一次 BGRA -> I420 转换（最高一层），
+// 其余各层从比它大的层逐级缩小得到
+// - 恰好 2:1 的层用 FrameConverter::halveI420（SIMD，与转换共用线程池）
+// - 其它比例（如 1080p -> 720p）从上一层用 swscale 的区域平均缩小
+// 各层的缓冲区循环使用；编码线程仍持有上一帧的引用时，写入前会分配新的缓冲区
+// 只在一个线程内使用（EncodeWorker 的编码线程）
+class I420Pyramid
+{
+public:
+    using FramePtr = std::shared_ptr<AVFrame>;
+
+    I420Pyramid();
+    ~I420Pyramid();
+
+    I420Pyramid(const I420Pyramid&) = delete;
+    I420Pyramid& operator=(const I420Pyramid&) = delete;
+
+    // 层按从大到小排列，宽高必须为偶数
+    bool init(const QVector<SimulcastLayer>& layers);
+
+    // 转换并缩小一帧，out[i] 为第 i 层画面的一个新引用
+    bool build(const QVideoFrame& frame, std::vector<FramePtr>& out);
+
+    int levelCount() const { return static_cast<int>(m_levels.size()); }
+
+    // 最近一次 build() 中颜色转换 / 缩小的耗时（微秒）
+    qint64 lastConvertUs() const { return m_lastConvertUs; }
+    qint64 lastScaleUs() const { return m_lastScaleUs; }
+
+private:
+    struct Level {
+        AVFrame* frame = nullptr;
+        int source = -1;            // 由哪一层缩小得到，-1 表示直接由采集帧转换
+        bool halve = false;         // source 恰好是本层的 2 倍
+        SwsContext* sws = nullptr;  // 非 2:1 时使用
+    };
+
+    void release();
+    bool scaleLevel(Level& level);
+
+    std::vector<Level> m_levels;
+    FrameConverter m_converter;
+    qint64 m_lastConvertUs = 0;
+    qint64 m_lastScaleUs = 0;
+};
@@ -0,0 +1,135 @@
+#include "SimulcastEncoder.h"
+#include <QDebug>
+
+// 取帧等待超时，保证 stop() 之后能及时退出
+static const int SLOT_WAIT_TIMEOUT_MS = 100;
+
+SimulcastEncoder::SimulcastEncoder()
+{}
+
+SimulcastEncoder::~SimulcastEncoder()
+{
+    stop();
+}
+
+void SimulcastEncoder::setCodec(VideoCodec codec)
+{
+    m_codec = codec;
+}
+
+VideoCodec SimulcastEncoder::codec() const
+{
+    return m_codec;
+}
+
+void SimulcastEncoder::setKeyframeMode(VideoEncoder::KeyframeMode mode, int intervalMs)
+{
+    m_keyframeMode = mode;
+    m_keyframeIntervalMs = intervalMs;
+}
+
+bool SimulcastEncoder::init(const QVector<SimulcastLayer>& layers, int fps)
+{
+    stop();
+    m_layers.clear();
+    m_layerConfig = layers;
+
+    if (layers.isEmpty() || !m_pyramid.init(layers)) {
+        qDebug() << "Simulcast pyramid init failed";
+        return false;
+    }
+
+    for (int i = 0; i < layers.size(); ++i) {
+        const SimulcastLayer& config = layers[i];
+        auto layer = std::make_unique<Layer>();
+        layer->encoder.setCodec(m_codec);
+        layer->encoder.setKeyframeMode(m_keyframeMode, m_keyframeIntervalMs);
+        if (!layer->encoder.init(config.width, config.height, fps, config.bitrate)) {
+            qDebug() << "Simulcast layer" << i << "encoder init failed";
+            m_layers.clear();
+            return false;
+        }
+        // 回调里再取 onEncodedData，init 之后设置回调也能生效
+        layer->encoder.onEncodedData = [this](EncodedFrame::Ptr frame) {
+            if (onEncodedData) onEncodedData(std::move(frame));
+        };
+        m_layers.push_back(std::move(layer));
+        qDebug() << "Simulcast layer" << i << ":" << config.width << "x" << config.height
+            << config.bitrate << "bps";
+    }
+
+    m_stopRequested = false;
+    for (auto& layer : m_layers) {
+        Layer* raw = layer.get();
+        layer->thread = std::thread([this, raw]() { layerLoop(*raw); });
+    }
+    return true;
+}
+
+void SimulcastEncoder::stop()
+{
+    m_stopRequested = true;
+    for (auto& layer : m_layers) {
+        layer->slot.notifyAll();
+    }
+    for (auto& layer : m_layers) {
+        if (layer->thread.joinable()) layer->thread.join();
+    }
+}
+
+void SimulcastEncoder::encode(const QVideoFrame& frame, const FrameMeta& meta)
+{
+    if (m_layers.empty()) return;
+    if (!m_pyramid.build(frame, m_levelFrames)) return;
+
+    for (size_t i = 0; i < m_layers.size(); ++i) {
+        LayerFrame layerFrame;
+        layerFrame.frame = std::move(m_levelFrames[i]);
+        layerFrame.meta = meta;
+        layerFrame.meta.layer = static_cast<int>(i);
+        if (m_layers[i]->slot.put(std::move(layerFrame))) {
+            m_layers[i]->superseded.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    m_levelFrames.clear();
+}
+
+void SimulcastEncoder::layerLoop(Layer& layer)
+{
+    while (!m_stopRequested.load()) {
+        LayerFrame layerFrame;
+        if (!layer.slot.take(layerFrame, SLOT_WAIT_TIMEOUT_MS)) {
+            continue;
+        }
+        layer.encoder.encodeYuv(layerFrame.frame.get(), layerFrame.meta);
+    }
+}
+
+void SimulcastEncoder::requestKeyframe(int layer)
+{
+    for (size_t i = 0; i < m_layers.size(); ++i) {
+        if (layer < 0 || static_cast<size_t>(layer) == i) {
+            m_layers[i]->encoder.requestKeyframe();
+        }
+    }
+}
+
+bool SimulcastEncoder::keyframePending(qint64 captureTimeUs) const
+{
+    for (const auto& layer : m_layers) {
+        if (layer->encoder.keyframePending(captureTimeUs)) return true;
+    }
+    return false;
+}
+
+void SimulcastEncoder::setLayerBitrate(int layer, int bitrate)
+{
+    if (layer < 0 || static_cast<size_t>(layer) >= m_layers.size()) return;
+    m_layers[layer]->encoder.setTargetBitrate(bitrate);
+}
+
+quint64 SimulcastEncoder::supersededFrameCount(int layer) const
+{
+    if (layer < 0 || static_cast<size_t>(layer) >= m_layers.size()) return 0;
+    return m_layers[layer]->superseded.load(std::memory_order_relaxed);
+}
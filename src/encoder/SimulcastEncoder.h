@@ -0,0 +1,82 @@
+#pragma once
+#include <QVideoFrame>
+#include <QVector>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "VideoEncoder.h"
+#include "I420Pyramid.h"
+#include "SimulcastLayer.h"
+#include "../Capture/FrameSlot.hpp"
+#include "../Capture/FrameMeta.h"
+
+// simulcast 编码：一次采集、一次颜色转换，缩小成若干层后每层一个编码器、一个线程
+// encode() 运行在 EncodeWorker 的编码线程，只负责构建图像金字塔并把各层画面放进各自的槽位；
+// 各层编码线程从槽位取最新一帧编码，某一层编码慢时只丢该层的旧帧，不拖慢其它层
+// 编码结果的 meta().layer 为层序号（0 为最高一层），由传输端按观众选择转发哪一层
+class SimulcastEncoder
+{
+public:
+    SimulcastEncoder();
+    ~SimulcastEncoder();
+
+    SimulcastEncoder(const SimulcastEncoder&) = delete;
+    SimulcastEncoder& operator=(const SimulcastEncoder&) = delete;
+
+    // 需在 init 之前设置，各层相同
+    void setCodec(VideoCodec codec);
+    VideoCodec codec() const;
+    void setKeyframeMode(VideoEncoder::KeyframeMode mode, int intervalMs = 0);
+
+    // 层按从大到小排列；任意一层的编码器打开失败时整体失败
+    bool init(const QVector<SimulcastLayer>& layers, int fps);
+    const QVector<SimulcastLayer>& layers() const { return m_layerConfig; }
+    int layerCount() const { return m_layerConfig.size(); }
+
+    // 由编码线程调用，meta 原样随各层的编码结果传出（layer 字段除外）
+    void encode(const QVideoFrame& frame, const FrameMeta& meta = FrameMeta());
+
+    // 请求某一层下一帧输出关键帧，layer < 0 时所有层（可在任意线程调用）
+    void requestKeyframe(int layer = -1);
+    // 任意一层有待输出的关键帧（见 VideoEncoder::keyframePending，可在任意线程调用）
+    bool keyframePending(qint64 captureTimeUs) const;
+    // 调整某一层的码率（可在任意线程调用）
+    void setLayerBitrate(int layer, int bitrate);
+
+    // 最近一次 encode() 中颜色转换 / 金字塔缩小的耗时（微秒），在编码线程读取
+    qint64 lastConvertUs() const { return m_pyramid.lastConvertUs(); }
+    qint64 lastScaleUs() const { return m_pyramid.lastScaleUs(); }
+    // 各层编码线程来不及处理、被新帧覆盖的帧数
+    quint64 supersededFrameCount(int layer) const;
+
+    // 编码结果回调，运行在各层的编码线程（不同层并发调用）
+    std::function<void(EncodedFrame::Ptr)> onEncodedData;
+
+private:
+    // 金字塔交给某一层编码线程的一帧
+    struct LayerFrame {
+        I420Pyramid::FramePtr frame;
+        FrameMeta meta;
+    };
+
+    struct Layer {
+        VideoEncoder encoder;
+        FrameSlot<LayerFrame> slot;
+        std::thread thread;
+        std::atomic<quint64> superseded{ 0 };
+    };
+
+    void layerLoop(Layer& layer);
+    void stop();
+
+    VideoCodec m_codec = VideoCodec::H264;
+    VideoEncoder::KeyframeMode m_keyframeMode = VideoEncoder::KeyframeMode::IntraRefresh;
+    int m_keyframeIntervalMs = 0;
+    QVector<SimulcastLayer> m_layerConfig;
+    std::vector<std::unique_ptr<Layer>> m_layers;
+    I420Pyramid m_pyramid;                 // 只在编码线程访问
+    std::vector<I420Pyramid::FramePtr> m_levelFrames;
+    std::atomic<bool> m_stopRequested{ false };
+};
@@ -0,0 +1,26 @@
+#pragma once
+#include <QVector>
+
+// simulcast 的一层：编码分辨率与码率，下标 0 为最高一层
+// 同一份采集画面缩小后按层编码，传输端为每个观众选择其中一层转发
+struct SimulcastLayer
+{
+    int width = 0;
+    int height = 0;
+    int bitrate = 0; // bps
+
+    bool operator==(const SimulcastLayer& other) const {
+        return width == other.width && height == other.height && bitrate == other.bitrate;
+    }
+    bool operator!=(const SimulcastLayer& other) const { return !(*this == other); }
+};
+
+// 默认三层：1080p / 720p / 360p，360p 由 720p 精确 2:1 缩小得到
+inline QVector<SimulcastLayer> defaultSimulcastLayers()
+{
+    return {
+        { 1920, 1080, 4500000 },
+        { 1280, 720, 2000000 },
+        { 640, 360, 600000 },
+    };
+}
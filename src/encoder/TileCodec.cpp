@@ -0,0 +1,313 @@
+#include "TileCodec.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define TC_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(TC_X86) && (defined(__GNUC__) || defined(__clang__))
+#define TC_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TC_TARGET_AVX2
+#endif
+
+namespace {
+
+// 操作码，与 QOI 相同（OP_UP 占用 QOI 的 RGBA）
+const uint8_t OP_INDEX = 0x00; // 00xxxxxx：颜色缓存下标
+const uint8_t OP_DIFF = 0x40;  // 01rrggbb：与前一像素的差 -2..1
+const uint8_t OP_LUMA = 0x80;  // 10gggggg + rrrrbbbb：绿色差 -32..31，红/蓝相对绿色差 -8..7
+const uint8_t OP_RUN = 0xC0;   // 11xxxxxx：重复前一像素 1..62 次
+const uint8_t OP_RGB = 0xFE;   // + r g b
+const uint8_t OP_UP = 0xFF;    // + (n - 1)：复制上一行同位置的 n 个像素
+const uint8_t MASK_2 = 0xC0;
+
+const int MAX_RUN = 62;
+const int MAX_UP = 256;
+
+// 像素按小端读成 uint32：B | G << 8 | R << 16 | A << 24，比较时去掉 alpha
+const uint32_t RGB_MASK = 0x00FFFFFF;
+const uint32_t ALPHA = 0xFF000000;
+
+inline uint32_t loadPixel(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return v & RGB_MASK;
+}
+
+inline void storePixel(uint8_t* p, uint32_t v) {
+    v |= ALPHA;
+    std::memcpy(p, &v, 4);
+}
+
+inline int hashPixel(uint32_t px) {
+    const int b = px & 0xFF;
+    const int g = (px >> 8) & 0xFF;
+    const int r = (px >> 16) & 0xFF;
+    return (r * 3 + g * 5 + b * 7 + 0xFF * 11) & 63;
+}
+
+// 从 p 开始有多少个像素等于 value（value 已去掉 alpha）
+int runLengthScalar(const uint8_t* p, int n, uint32_t value) {
+    int i = 0;
+    while (i < n && loadPixel(p + i * 4) == value) ++i;
+    return i;
+}
+
+// a、b 两行从头开始有多少个像素相同
+int matchLengthScalar(const uint8_t* a, const uint8_t* b, int n) {
+    int i = 0;
+    while (i < n && loadPixel(a + i * 4) == loadPixel(b + i * 4)) ++i;
+    return i;
+}
+
+#ifdef TC_X86
+// movemask 结果（每像素 4 位）中从低位开始连续相等的像素数
+inline int leadingEqualPixels(uint32_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long bit;
+    _BitScanForward(&bit, ~mask);
+    return static_cast<int>(bit) / 4;
+#else
+    return __builtin_ctz(~mask) / 4;
+#endif
+}
+
+int runLengthSSE2(const uint8_t* p, int n, uint32_t value) {
+    const __m128i mask = _mm_set1_epi32(static_cast<int>(RGB_MASK));
+    const __m128i v = _mm_set1_epi32(static_cast<int>(value));
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i px = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i * 4)), mask);
+        const uint32_t eq = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi32(px, v)));
+        if (eq != 0xFFFF) return i + leadingEqualPixels(eq);
+    }
+    return i + runLengthScalar(p + i * 4, n - i, value);
+}
+
+int matchLengthSSE2(const uint8_t* a, const uint8_t* b, int n) {
+    const __m128i mask = _mm_set1_epi32(static_cast<int>(RGB_MASK));
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i x = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i * 4)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i * 4)));
+        x = _mm_and_si128(x, mask);
+        const uint32_t eq = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi32(x, _mm_setzero_si128())));
+        if (eq != 0xFFFF) return i + leadingEqualPixels(eq);
+    }
+    return i + matchLengthScalar(a + i * 4, b + i * 4, n - i);
+}
+
+// 尾部不调用 SSE2 版本：在 AVX2 函数里混入非 VEX 编码的 SSE 指令会有状态切换开销
+TC_TARGET_AVX2 int runLengthAVX2(const uint8_t* p, int n, uint32_t value) {
+    const __m256i mask = _mm256_set1_epi32(static_cast<int>(RGB_MASK));
+    const __m256i v = _mm256_set1_epi32(static_cast<int>(value));
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i px = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i * 4)), mask);
+        const uint32_t eq = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi32(px, v)));
+        if (eq != 0xFFFFFFFFu) return i + leadingEqualPixels(eq);
+    }
+    return i + runLengthScalar(p + i * 4, n - i, value);
+}
+
+TC_TARGET_AVX2 int matchLengthAVX2(const uint8_t* a, const uint8_t* b, int n) {
+    const __m256i mask = _mm256_set1_epi32(static_cast<int>(RGB_MASK));
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i * 4)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i * 4)));
+        x = _mm256_and_si256(x, mask);
+        const uint32_t eq = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi32(x, _mm256_setzero_si256())));
+        if (eq != 0xFFFFFFFFu) return i + leadingEqualPixels(eq);
+    }
+    return i + matchLengthScalar(a + i * 4, b + i * 4, n - i);
+}
+#endif
+
+int runLength(const uint8_t* p, int n, uint32_t value, ColorConverter::Isa isa) {
+#ifdef TC_X86
+    if (isa == ColorConverter::Isa::AVX2) return runLengthAVX2(p, n, value);
+    if (isa == ColorConverter::Isa::SSE2) return runLengthSSE2(p, n, value);
+#endif
+    (void)isa;
+    return runLengthScalar(p, n, value);
+}
+
+int matchLength(const uint8_t* a, const uint8_t* b, int n, ColorConverter::Isa isa) {
+#ifdef TC_X86
+    if (isa == ColorConverter::Isa::AVX2) return matchLengthAVX2(a, b, n);
+    if (isa == ColorConverter::Isa::SSE2) return matchLengthSSE2(a, b, n);
+#endif
+    (void)isa;
+    return matchLengthScalar(a, b, n);
+}
+
+} // namespace
+
+TileCodec::TileCodec()
+    : m_isa(std::min(ColorConverter::detectIsa(), ColorConverter::Isa::SSE2))
+{}
+
+void TileCodec::setIsa(ColorConverter::Isa isa)
+{
+    ColorConverter::Isa best = ColorConverter::detectIsa();
+    m_isa = (static_cast<int>(isa) > static_cast<int>(best)) ? best : isa;
+}
+
+size_t TileCodec::maxEncodedSize(int width, int height)
+{
+    return static_cast<size_t>(width) * height * 4;
+}
+
+size_t TileCodec::encode(const uint8_t* pixels, int stride, int width, int height, std::vector<uint8_t>& out) const
+{
+    const size_t start = out.size();
+    out.resize(start + maxEncodedSize(width, height));
+    uint8_t* o = out.data() + start;
+
+    uint32_t index[64] = {};
+    uint32_t prev = 0;
+
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* row = pixels + static_cast<ptrdiff_t>(y) * stride;
+        const uint8_t* above = y > 0 ? row - stride : nullptr;
+        int x = 0;
+        while (x < width) {
+            const uint32_t px = loadPixel(row + x * 4);
+            const int remaining = width - x;
+
+            // 与前一像素相同：RUN；上一行同位置连续相同的更长时改用 UP
+            // 运行长度不跨行，跨行的重复由 UP 处理
+            // 先比较首个像素，大多数像素两者都不成立，省掉 SIMD 调用
+            const int run = px == prev ? runLength(row + x * 4, remaining, prev, m_isa) : 0;
+            const int up = (above && loadPixel(above + x * 4) == px) ?
+                matchLength(row + x * 4, above + x * 4, remaining, m_isa) : 0;
+
+            if (up > run && up >= 2) {
+                for (int left = up; left > 0;) {
+                    const int n = std::min(left, MAX_UP);
+                    *o++ = OP_UP;
+                    *o++ = static_cast<uint8_t>(n - 1);
+                    left -= n;
+                }
+                x += up;
+                prev = loadPixel(row + (x - 1) * 4);
+                index[hashPixel(prev)] = prev;
+                continue;
+            }
+            if (run > 0) {
+                for (int left = run; left > 0;) {
+                    const int n = std::min(left, MAX_RUN);
+                    *o++ = static_cast<uint8_t>(OP_RUN | (n - 1));
+                    left -= n;
+                }
+                x += run;
+                continue;
+            }
+
+            const int h = hashPixel(px);
+            if (index[h] == px) {
+                *o++ = static_cast<uint8_t>(OP_INDEX | h);
+            }
+            else {
+                index[h] = px;
+                const int db = static_cast<int8_t>((px & 0xFF) - (prev & 0xFF));
+                const int dg = static_cast<int8_t>(((px >> 8) & 0xFF) - ((prev >> 8) & 0xFF));
+                const int dr = static_cast<int8_t>(((px >> 16) & 0xFF) - ((prev >> 16) & 0xFF));
+                const int drdg = dr - dg;
+                const int dbdg = db - dg;
+                if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                    *o++ = static_cast<uint8_t>(OP_DIFF | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2));
+                }
+                else if (dg >= -32 && dg <= 31 && drdg >= -8 && drdg <= 7 && dbdg >= -8 && dbdg <= 7) {
+                    *o++ = static_cast<uint8_t>(OP_LUMA | (dg + 32));
+                    *o++ = static_cast<uint8_t>(((drdg + 8) << 4) | (dbdg + 8));
+                }
+                else {
+                    *o++ = OP_RGB;
+                    *o++ = static_cast<uint8_t>((px >> 16) & 0xFF);
+                    *o++ = static_cast<uint8_t>((px >> 8) & 0xFF);
+                    *o++ = static_cast<uint8_t>(px & 0xFF);
+                }
+            }
+            prev = px;
+            ++x;
+        }
+    }
+
+    const size_t written = static_cast<size_t>(o - (out.data() + start));
+    out.resize(start + written);
+    return written;
+}
+
+bool TileCodec::decode(const uint8_t* data, size_t size, int width, int height, uint8_t* dst, int dstStride)
+{
+    const uint8_t* in = data;
+    const uint8_t* end = data + size;
+    uint32_t index[64] = {};
+    uint32_t prev = 0;
+
+    for (int y = 0; y < height; ++y) {
+        uint8_t* row = dst + static_cast<ptrdiff_t>(y) * dstStride;
+        const uint8_t* above = y > 0 ? row - dstStride : nullptr;
+        int x = 0;
+        while (x < width) {
+            if (in >= end) return false;
+            const uint8_t op = *in++;
+
+            if (op == OP_UP) {
+                if (in >= end || !above) return false;
+                const int n = *in++ + 1;
+                if (n > width - x) return false;
+                std::memcpy(row + x * 4, above + x * 4, static_cast<size_t>(n) * 4);
+                x += n;
+                prev = loadPixel(row + (x - 1) * 4);
+                index[hashPixel(prev)] = prev;
+                continue;
+            }
+            if (op == OP_RGB) {
+                if (end - in < 3) return false;
+                prev = (static_cast<uint32_t>(in[0]) << 16) | (static_cast<uint32_t>(in[1]) << 8) | in[2];
+                in += 3;
+            }
+            else if ((op & MASK_2) == OP_RUN) {
+                const int n = (op & 0x3F) + 1;
+                if (n > width - x) return false;
+                for (int i = 0; i < n; ++i) storePixel(row + (x + i) * 4, prev);
+                x += n;
+                continue;
+            }
+            else if ((op & MASK_2) == OP_INDEX) {
+                prev = index[op & 0x3F];
+            }
+            else if ((op & MASK_2) == OP_DIFF) {
+                const int dr = ((op >> 4) & 3) - 2;
+                const int dg = ((op >> 2) & 3) - 2;
+                const int db = (op & 3) - 2;
+                const uint32_t r = (((prev >> 16) & 0xFF) + dr) & 0xFF;
+                const uint32_t g = (((prev >> 8) & 0xFF) + dg) & 0xFF;
+                const uint32_t b = ((prev & 0xFF) + db) & 0xFF;
+                prev = (r << 16) | (g << 8) | b;
+            }
+            else { // OP_LUMA
+                if (in >= end) return false;
+                const int dg = (op & 0x3F) - 32;
+                const int drdg = (*in >> 4) - 8;
+                const int dbdg = (*in & 0x0F) - 8;
+                ++in;
+                const uint32_t r = (((prev >> 16) & 0xFF) + dg + drdg) & 0xFF;
+                const uint32_t g = (((prev >> 8) & 0xFF) + dg) & 0xFF;
+                const uint32_t b = ((prev & 0xFF) + dg + dbdg) & 0xFF;
+                prev = (r << 16) | (g << 8) | b;
+            }
+            index[hashPixel(prev)] = prev;
+            storePixel(row + x * 4, prev);
+            ++x;
+        }
+    }
+    return in == end;
+}
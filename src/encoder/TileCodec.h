@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ColorConverter.h"
+
+// 屏幕块的无损压缩（混合编码模式中静止的文字/界面块）
+// 格式参考 QOI：逐像素输出 INDEX / DIFF / LUMA / RUN / RGB 操作，只有 64 项的颜色缓存，
+// 没有熵编码，编解码都只需一遍扫描
+// - 屏幕画面不透明，去掉 QOI 的 RGBA 操作，改为 UP：复制上一行同位置的 1..256 个像素，
+//   纯色背景和重复的行（文字行间、表格线）都只需 1~2 个字节
+// - 编码端的 RUN / UP 长度用 SSE2 一次比较 4 个像素。AVX2 版本一次比较 8 个，但屏幕内容的
+//   游程大多在第一组比较内结束，实测反而比 SSE2 慢，只在 setIsa 显式指定时使用
+// 输入输出都是 BGRA（4 字节/像素），忽略 alpha，解码输出的 alpha 为 0xFF
+// 一个块的编码流不含宽高，由调用方（块更新消息）给出
+class TileCodec
+{
+public:
+    TileCodec();
+
+    // 编码结果追加到 out 末尾，返回追加的字节数
+    size_t encode(const uint8_t* pixels, int stride, int width, int height, std::vector<uint8_t>& out) const;
+
+    // 数据不完整或越界时返回 false（dst 中可能已写入部分像素）
+    static bool decode(const uint8_t* data, size_t size, int width, int height, uint8_t* dst, int dstStride);
+
+    // 单个块编码结果的上限（全部是 RGB 操作）
+    static size_t maxEncodedSize(int width, int height);
+
+    // 强制指定内核（用于测试/基准对比），不支持的指令集会退回到可用的最高级别
+    // 默认使用 SSE2（CPU 支持时）
+    void setIsa(ColorConverter::Isa isa);
+    ColorConverter::Isa isa() const { return m_isa; }
+
+private:
+    ColorConverter::Isa m_isa;
+};
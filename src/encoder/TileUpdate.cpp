@@ -0,0 +1,117 @@
+#include "TileUpdate.h"
+#include "TileCodec.h"
+
+namespace {
+
+// 每个块的 index + size
+const size_t TILE_ENTRY_SIZE = 8;
+
+void putU16(uint8_t* p, uint16_t v)
+{
+    p[0] = static_cast<uint8_t>(v >> 8);
+    p[1] = static_cast<uint8_t>(v);
+}
+
+void putU32(uint8_t* p, uint32_t v)
+{
+    p[0] = static_cast<uint8_t>(v >> 24);
+    p[1] = static_cast<uint8_t>(v >> 16);
+    p[2] = static_cast<uint8_t>(v >> 8);
+    p[3] = static_cast<uint8_t>(v);
+}
+
+uint16_t getU16(const uint8_t* p)
+{
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+uint32_t getU32(const uint8_t* p)
+{
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+        (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+} // namespace
+
+TileUpdate::TileUpdate(uint32_t timestamp, int width, int height, int tileSize, bool reset)
+    : m_data(HEADER_SIZE)
+{
+    m_header.flags = reset ? FLAG_RESET : 0;
+    m_header.timestamp = timestamp;
+    m_header.width = width;
+    m_header.height = height;
+    m_header.tileSize = tileSize;
+
+    uint8_t* out = m_data.data();
+    out[0] = MAGIC;
+    out[1] = VERSION;
+    out[2] = m_header.flags;
+    out[3] = 0;
+    putU32(out + 4, timestamp);
+    putU16(out + 8, static_cast<uint16_t>(width));
+    putU16(out + 10, static_cast<uint16_t>(height));
+    putU16(out + 12, static_cast<uint16_t>(tileSize));
+    putU16(out + 14, 0);
+}
+
+void TileUpdate::beginTile(uint32_t index)
+{
+    const size_t offset = m_data.size();
+    m_data.resize(offset + TILE_ENTRY_SIZE);
+    putU32(m_data.data() + offset, index);
+    putU32(m_data.data() + offset + 4, 0);
+    ++m_header.tileCount;
+    putU16(m_data.data() + 14, static_cast<uint16_t>(m_header.tileCount));
+}
+
+void TileUpdate::addInvalidation(uint32_t index)
+{
+    beginTile(index);
+    ++m_invalidations;
+}
+
+size_t TileUpdate::addTile(uint32_t index, const TileCodec& codec, const uint8_t* pixels, int stride,
+    int width, int height)
+{
+    beginTile(index);
+    const size_t sizeOffset = m_data.size() - 4;
+    const size_t written = codec.encode(pixels, stride, width, height, m_data);
+    putU32(m_data.data() + sizeOffset, static_cast<uint32_t>(written));
+    return written;
+}
+
+bool TileUpdate::parse(const uint8_t* data, size_t size, Header& header, std::vector<Tile>& tiles)
+{
+    tiles.clear();
+    if (size < HEADER_SIZE || data[0] != MAGIC || data[1] != VERSION) return false;
+
+    header.flags = data[2];
+    header.timestamp = getU32(data + 4);
+    header.width = getU16(data + 8);
+    header.height = getU16(data + 10);
+    header.tileSize = getU16(data + 12);
+    header.tileCount = getU16(data + 14);
+    if (header.width <= 0 || header.height <= 0 || header.width > MAX_DIMENSION ||
+        header.height > MAX_DIMENSION || header.tileSize < MIN_TILE_SIZE) {
+        return false;
+    }
+
+    const uint64_t totalTiles =
+        ((static_cast<uint64_t>(header.width) + header.tileSize - 1) / header.tileSize) *
+        ((static_cast<uint64_t>(header.height) + header.tileSize - 1) / header.tileSize);
+
+    size_t offset = HEADER_SIZE;
+    tiles.reserve(header.tileCount);
+    for (int i = 0; i < header.tileCount; ++i) {
+        if (size - offset < TILE_ENTRY_SIZE) return false;
+        Tile tile;
+        tile.index = getU32(data + offset);
+        tile.size = getU32(data + offset + 4);
+        offset += TILE_ENTRY_SIZE;
+        if (tile.index >= totalTiles || size - offset < tile.size) return false;
+        tile.data = data + offset;
+        offset += tile.size;
+        tiles.push_back(tile);
+    }
+    return offset == size;
+}
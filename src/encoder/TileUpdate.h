@@ -0,0 +1,87 @@
+#pragma once
+#include <QMetaType>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class TileCodec;
+
+// 混合编码模式下的一批块更新：静止块的无损数据，以及重新变化、需要作废的块
+// 经可靠有序的 DataChannel 发送，接收端缓存后覆盖在解码出的视频画面上
+// 消息格式（多字节字段为网络字节序）：
+//
+//   0      1      2      3
+//   magic  ver    flags  reserved    flags bit0 = 重置（画面尺寸变化或重新连接，接收端清空缓存）
+//   timestamp (uint32)               90kHz 采集时间戳，与视频帧的 RTP 时间戳是同一时钟
+//   width (uint16) height (uint16)   采集画面尺寸
+//   tileSize (uint16) tileCount (uint16)
+//   tileCount 个块：index (uint32) size (uint32) + size 字节 TileCodec 数据
+//                   index 为按行排列的块序号，size = 0 表示作废该块
+class TileUpdate
+{
+public:
+    using Ptr = std::shared_ptr<const TileUpdate>;
+
+    static constexpr uint8_t MAGIC = 0x54; // 'T'
+    static constexpr uint8_t VERSION = 1;
+    static constexpr size_t HEADER_SIZE = 16;
+    static constexpr uint8_t FLAG_RESET = 0x01;
+    // 接收端接受的画面尺寸与块大小范围，宽高来自对端，超出时拒绝整条消息，避免按任意尺寸分配画布
+    static constexpr int MAX_DIMENSION = 8192;
+    static constexpr int MIN_TILE_SIZE = 16;
+
+    struct Header {
+        uint8_t flags = 0;
+        uint32_t timestamp = 0;
+        int width = 0;
+        int height = 0;
+        int tileSize = 0;
+        int tileCount = 0;
+
+        bool isReset() const { return (flags & FLAG_RESET) != 0; }
+    };
+
+    // 解析出的一个块，data 指向消息内部
+    struct Tile {
+        uint32_t index = 0;
+        const uint8_t* data = nullptr;
+        uint32_t size = 0;
+
+        bool isInvalidation() const { return size == 0; }
+    };
+
+    // 发送端：按块逐个追加，压缩数据直接写进消息缓冲区
+    TileUpdate(uint32_t timestamp, int width, int height, int tileSize, bool reset);
+
+    void addInvalidation(uint32_t index);
+    // 返回压缩后的字节数
+    size_t addTile(uint32_t index, const TileCodec& codec, const uint8_t* pixels, int stride,
+        int width, int height);
+
+    const Header& header() const { return m_header; }
+    int tileCount() const { return m_header.tileCount; }
+    // 既没有块也不是重置消息，不需要发送
+    bool isEmpty() const { return m_header.tileCount == 0 && !m_header.isReset(); }
+
+    const uint8_t* data() const { return m_data.data(); }
+    size_t size() const { return m_data.size(); }
+
+    // 发送端本地的消息序号（不写入消息），发送结果据此对应回各块
+    uint32_t sequence() const { return m_sequence; }
+    void setSequence(uint32_t sequence) { m_sequence = sequence; }
+    bool hasInvalidations() const { return m_invalidations > 0; }
+
+    // 接收端：校验并拆出各块，失败返回 false
+    static bool parse(const uint8_t* data, size_t size, Header& header, std::vector<Tile>& tiles);
+
+private:
+    void beginTile(uint32_t index);
+
+    Header m_header;
+    std::vector<uint8_t> m_data;
+    uint32_t m_sequence = 0;
+    int m_invalidations = 0;
+};
+
+Q_DECLARE_METATYPE(TileUpdate::Ptr)
@@ -1,6 +1,22 @@
 #include "VideoEncoder.h"
 #include <QDebug>
 #include <libavutil/frame.h>
+#include <algorithm>
+#include <chrono>
+
+// ؼ֡ԵĬϼ
+static const int DEFAULT_IDR_INTERVAL_MS = 2000;
+static const int DEFAULT_REFRESH_INTERVAL_MS = 1000;
+//  X264_KEYINT_MAX_INFINITE ͬx264 Ϊ GOP
+static const int INFINITE_GOP = 1 << 30;
+// ߵʵı仯ñ´򿪣֮ټһʱ
+static const double BITRATE_REOPEN_MIN_CHANGE = 0.2;
+static const qint64 BITRATE_REOPEN_INTERVAL_US = 2 * 1000 * 1000;
+
+static qint64 steadyNowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 
 VideoEncoder::VideoEncoder(QObject* parent) : QObject(parent) {
     m_pkt = av_packet_alloc();
@@ -13,38 +29,27 @@ VideoEncoder::~VideoEncoder() {
 bool VideoEncoder::init(int width, int height, int fps, int bitrate) {
     m_targetW = width;
     m_targetH = height;
-
-    // 1.  H.264 
-    const AVCodec* codec = avcodec_find_encoder(AV_CODEC_ID_H264);
-    if (!codec) {
-        qDebug() << "H.264 Encoder not found!";
+    m_fps = fps > 0 ? fps : 30;
+    m_frameCount = 0;
+    m_lastPts = AV_NOPTS_VALUE;
+    m_lastKeyframePts = AV_NOPTS_VALUE;
+    m_framesSinceKeyframe = 0;
+    m_keyframeDuePts = AV_NOPTS_VALUE;
+
+    // 1. ʽѡ
+    m_backend = EncoderBackend::create(m_codec);
+    if (!m_backend) {
+        qDebug() << videoCodecName(m_codec) << "Encoder not found!";
         return false;
     }
+    qDebug() << "Using" << m_backend->encoder()->name << "for" << videoCodecName(m_codec);
 
-    // 2. 
-    m_codecCtx = avcodec_alloc_context3(codec);
-    m_codecCtx->bit_rate = bitrate;
-    m_codecCtx->width = width;
-    m_codecCtx->height = height;
-    m_codecCtx->time_base = { 1, fps };
-    m_codecCtx->framerate = { fps, 1 };
-    m_codecCtx->gop_size = 10; // ؼ֡
-    m_codecCtx->max_b_frames = 0; // ʵʱ 0 B֡ӳ
-    m_codecCtx->pix_fmt = AV_PIX_FMT_YUV420P; // H.264 ׼ʽ
-
-    // 3. 򿪱 (preset=ultrafast ѹʻȡٶ)
-    AVDictionary* opts = nullptr;
-    av_dict_set(&opts, "preset", "ultrafast", 0);
-    av_dict_set(&opts, "tune", "zerolatency", 0);
-
-    m_codecCtx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
-
-    if (avcodec_open2(m_codecCtx, codec, &opts) < 0) {
-        qDebug() << "Could not open codec";
+    // 2. ò򿪱
+    if (!openCodec(bitrate)) {
         return false;
     }
 
-    // 4.  YUV ֡ڴ
+    // 3.  YUV ֡ڴ
     m_frameYUV = av_frame_alloc();
     m_frameYUV->format = m_codecCtx->pix_fmt;
     m_frameYUV->width = m_codecCtx->width;
@@ -54,59 +59,111 @@ bool VideoEncoder::init(int width, int height, int fps, int bitrate) {
     return true;
 }
 
-void VideoEncoder::encode(const QVideoFrame& inputFrame) {
+bool VideoEncoder::openCodec(int bitrate) {
+    m_codecCtx = avcodec_alloc_context3(m_backend->encoder());
+    applyBitrate(bitrate);
+    m_wantedBitrate = bitrate;
+    m_codecCtx->width = m_targetW;
+    m_codecCtx->height = m_targetH;
+    // ʱֱʹ RTP  90kHz ʱӣpts ɲɼʱ㣨ɱ֡ʣ
+    m_codecCtx->time_base = { 1, RTP_CLOCK_RATE };
+    m_codecCtx->framerate = { m_fps, 1 };
+    m_codecCtx->max_b_frames = 0; // ʵʱ 0 B֡ӳ
+    m_codecCtx->pix_fmt = AV_PIX_FMT_YUV420P; // ͨõʽ
+    m_codecCtx->thread_count = m_threadCount;
+
+    // Ĭ preset ƫٶȣѹʻȡӳ
+    AVDictionary* opts = nullptr;
+    m_backend->applyLowLatency(m_codecCtx, &opts, m_preset);
+    applyKeyframeMode(&opts, m_fps);
+
+    //  AV_CODEC_FLAG_GLOBAL_HEADER / ͷÿؼ֡ڷͣ
+    // ն˲Ҫ extradata ɴؼ֡ʼ
+
+    const int ret = avcodec_open2(m_codecCtx, m_backend->encoder(), &opts);
+    av_dict_free(&opts);
+    if (ret < 0) {
+        qDebug() << "Could not open codec";
+        avcodec_free_context(&m_codecCtx);
+        return false;
+    }
+    return true;
+}
+
+void VideoEncoder::encode(const QVideoFrame& inputFrame, const FrameMeta& meta) {
     if (!m_codecCtx) return;
 
     // A. ӳ Qt ֡ڴ
+    const qint64 convertStartUs = steadyNowUs();
     QVideoFrame cloneFrame = inputFrame;
     if (!cloneFrame.map(QVideoFrame::ReadOnly)) {
         qDebug() << "Map frame failed";
         return;
     }
 
-    // B. ֱ/ʽת (SWS Scale)
-    // ʹ 2K/4Kᱻǿŵ 1920x1080 YUV420P
-    if (!m_swsCtx || cloneFrame.width() != m_lastSrcW ||
-        cloneFrame.height() != m_lastSrcH) {
-        qDebug() << "Source resolution changed to" << cloneFrame.width() << "x" << cloneFrame.height() << "- Recreating SwsContext";
-
-        // ɵĴڣͷ
-        if (m_swsCtx) {
-            sws_freeContext(m_swsCtx);
-            m_swsCtx = nullptr;
-        }
-
-        // ¼¼
-        m_lastSrcW = cloneFrame.width();
-        m_lastSrcH = cloneFrame.height();
-
-        
-        // 򻯼 RGB32 (AV_PIX_FMT_BGRA  RGBA)
-        m_swsCtx = sws_getContext(
-            cloneFrame.width(), cloneFrame.height(), AV_PIX_FMT_BGRA, // 
-            m_targetW, m_targetH, AV_PIX_FMT_YUV420P,               // 
-            SWS_BICUBIC, nullptr, nullptr, nullptr
-        );
-    }
-
-    // ȫ飺ĴʧܣҪ sws_scale 
-    if (!m_swsCtx) {
+    // һ֡Ļдǰȷд
+    if (av_frame_make_writable(m_frameYUV) < 0) {
         cloneFrame.unmap();
         return;
     }
 
-    // ִת
-    const uint8_t* srcData[4] = { cloneFrame.bits(0) };
-    int srcLinesize[4] = { cloneFrame.bytesPerLine(0) };
+    // B. ֱ/ʽת
+    // BGRA/BGRX 밴ɼߴ SIMD · I420 Сߴ磻ظʽ˵ swscale
+    const bool converted = m_converter.convert(cloneFrame, m_frameYUV);
+    cloneFrame.unmap();
+    if (!converted) return;
+    m_lastConvertUs = steadyNowUs() - convertStartUs;
 
-    sws_scale(m_swsCtx, srcData, srcLinesize, 0, cloneFrame.height(),
-        m_frameYUV->data, m_frameYUV->linesize);
+    encodeFrame(m_frameYUV, meta);
+}
 
-    cloneFrame.unmap();
+void VideoEncoder::encodeYuv(AVFrame* frame, const FrameMeta& meta) {
+    if (!m_codecCtx || !frame) return;
+    if (frame->width != m_targetW || frame->height != m_targetH || frame->format != AV_PIX_FMT_YUV420P) {
+        qDebug() << "Unexpected YUV frame" << frame->width << "x" << frame->height
+            << "for encoder" << m_targetW << "x" << m_targetH;
+        return;
+    }
+    m_lastConvertUs = 0;
+    encodeFrame(frame, meta);
+}
+
+void VideoEncoder::encodeFrame(AVFrame* frame, const FrameMeta& meta) {
+    // ʵֻڱ߳ڡ֮֡Ч
+    const int pendingBitrate = m_pendingBitrate.exchange(0);
+    if (pendingBitrate > 0) {
+        m_wantedBitrate = pendingBitrate;
+    }
+    if (m_wantedBitrate > 0 && m_wantedBitrate != m_codecCtx->bit_rate) {
+        updateBitrate();
+        if (!m_codecCtx) return;
+    }
+    const qint64 encodeStartUs = steadyNowUs();
 
     // C. ͸
-    m_frameYUV->pts = m_frameCount++; // ʱ
-    int ret = avcodec_send_frame(m_codecCtx, m_frameYUV);
+    // ʱýʱӵĲɼʱ̣΢룩㵽 90kHz SR е RTP ʱͬԴ
+    // ûвɼʱʱ֡ʵ
+    int64_t pts = meta.captureTimeUs >= 0 ?
+        MediaClock::rtpTicks(meta.captureTimeUs) :
+        static_cast<int64_t>(m_frameCount) * RTP_CLOCK_RATE / m_fps;
+    if (m_lastPts != AV_NOPTS_VALUE && pts <= m_lastPts) {
+        pts = m_lastPts + 1; // Ҫ pts ϸ
+    }
+    m_lastPts = pts;
+    m_frameCount++;
+    frame->pts = pts;
+
+    // ؼ֡ɼʱ㣺ɼ֡滭ݱ仯֡ GOP ڵ֡ʱᱻ
+    //  1fps ʱ 2 ļһӣԼڱ֡ʼˢʱǿ
+    bool forceKeyframe = m_keyframeRequested.exchange(false);
+    m_framesSinceKeyframe++;
+    if (m_keyframeDeadline > 0 && m_lastKeyframePts != AV_NOPTS_VALUE &&
+        pts - m_lastKeyframePts >= m_keyframeDeadline &&
+        m_framesSinceKeyframe < m_codecCtx->gop_size) {
+        forceKeyframe = true;
+    }
+    frame->pict_type = forceKeyframe ? AV_PICTURE_TYPE_I : AV_PICTURE_TYPE_NONE;
+    int ret = avcodec_send_frame(m_codecCtx, frame);
 
     // D. ձİ
     while (ret >= 0) {
@@ -114,74 +171,140 @@ void VideoEncoder::encode(const QVideoFrame& inputFrame) {
         if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) break;
         else if (ret < 0) break;
 
+        // ǿƵġġ´򿪱Ĺؼ֡Լ֡ˢµ㶼¼ʱ
+        if (m_pkt->flags & AV_PKT_FLAG_KEY) {
+            m_lastKeyframePts = m_pkt->pts != AV_NOPTS_VALUE ? m_pkt->pts : pts;
+            m_framesSinceKeyframe = 0;
+            m_keyframeDuePts = m_keyframeDeadline > 0 ? m_lastKeyframePts + m_keyframeDeadline : AV_NOPTS_VALUE;
+        }
+
         if (onEncodedData) {
-            uint8_t* data = m_pkt->data;
-            int size = m_pkt->size;
-
-            //  Annex-B ʽȡ NALU
-            // Ҫҵ 00 00 01  00 00 00 01 ָ
-            int curPos = 0;
-            while (curPos < size) {
-                // Ѱ start code
-                int nalStart = -1;
-                int prefixLen = 0;
-
-                // 򵥵 start code ߼
-                // ע⣺ FFmpeg Ǳ׼ Annex-B
-                // ʵ avcodec_receive_packet ͨͷ Start Code
-
-                // ǰĿʼֱͨӾ Start Code
-                if (curPos + 4 <= size && data[curPos] == 0 && data[curPos + 1] == 0 && data[curPos + 2] == 0 && data[curPos + 3] == 1) {
-                    nalStart = curPos + 4;
-                    prefixLen = 4;
-                }
-                else if (curPos + 3 <= size && data[curPos] == 0 && data[curPos + 1] == 0 && data[curPos + 2] == 1) {
-                    nalStart = curPos + 3;
-                    prefixLen = 3;
-                }
-
-                if (nalStart == -1) {
-                    // Ҳ start codeⱾݣ̫ܣ߽
-                    break;
-                }
-
-                // Ѱһ start code ȷǰ NALU λ
-                int nextNalStart = size; // ĬΪβ
-                for (int i = nalStart; i < size - 3; ++i) {
-                    if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1) {
-                        nextNalStart = i; // 00 00 01
-                        // ǰ滹и 0Ǿ 00 00 00 01һλ
-                        if (i > 0 && data[i - 1] == 0) nextNalStart = i - 1;
-                        break;
-                    }
-                }
-
-                int nalSize = nextNalStart - nalStart;
-                if (nalSize > 0) {
-                    std::vector<uint8_t> nalBuffer(data + nalStart, data + nalStart + nalSize);
-
-                    //  PTS (Presentation Time Stamp) Ӧ 90kHz ʱ
-                    // ffmpeg  pts ͨ time_base ( 1/30)
-                    // RTP Ҫ 90000Hz
-                    
-                    uint32_t rtpTimestamp = 0;
-                    if (m_pkt->pts != AV_NOPTS_VALUE) {
-                        // 򻯼㣺Ϊ time_base = {1, fps}
-                        //  pts ֡ 0, 1, 2...
-                        // 90kHz ÿ֡ = 90000 / fps
-                        //  fps=30 -> 3000
-                        rtpTimestamp = static_cast<uint32_t>(m_pkt->pts * (90000 / 30));
-                    }
-
-                    // صȥ NALU  + ʱ
-                    onEncodedData(nalBuffer, rtpTimestamp);
-                }
-
-                curPos = nextNalStart;
+            // time_base Ѿ 1/90000pts ֱӾ RTP ʱ 32 λƣ
+            uint32_t rtpTimestamp = 0;
+            if (m_pkt->pts != AV_NOPTS_VALUE) {
+                rtpTimestamp = static_cast<uint32_t>(m_pkt->pts);
             }
+
+            //  access unit һλصȥӹ m_pkt Ļ
+            EncodedFrame::Ptr encoded = EncodedFrame::fromPacket(m_pkt, rtpTimestamp, meta, m_codec);
+            if (encoded) onEncodedData(std::move(encoded));
         }
         av_packet_unref(m_pkt);
     }
+    m_lastEncodeUs = steadyNowUs() - encodeStartUs;
+}
+
+void VideoEncoder::setCodec(VideoCodec codec) {
+    m_codec = codec;
+}
+
+VideoCodec VideoEncoder::codec() const {
+    return m_codec;
+}
+
+QList<VideoCodec> VideoEncoder::availableCodecs() {
+    return EncoderBackend::availableCodecs();
+}
+
+void VideoEncoder::setPreset(const QByteArray& preset) {
+    m_preset = preset;
+}
+
+void VideoEncoder::setThreadCount(int threads) {
+    m_threadCount = threads > 0 ? threads : 0;
+}
+
+void VideoEncoder::setKeyframeMode(KeyframeMode mode, int intervalMs) {
+    m_keyframeMode = mode;
+    m_keyframeIntervalMs = intervalMs;
+}
+
+VideoEncoder::KeyframeMode VideoEncoder::keyframeMode() const {
+    return m_keyframeMode;
+}
+
+void VideoEncoder::applyKeyframeMode(AVDictionary** opts, int fps) {
+    KeyframeMode mode = m_keyframeMode;
+    if (mode == KeyframeMode::IntraRefresh && !m_backend->supportsIntraRefresh()) {
+        // û֡ˢµı˻ IDR֤;Ľնܿʼ
+        qDebug() << m_backend->encoder()->name << "has no intra refresh, using periodic keyframes";
+        mode = KeyframeMode::Periodic;
+    }
+
+    switch (mode) {
+    case KeyframeMode::Periodic: {
+        // ֡ IDR encodeFrame ɼʱǿ
+        const int intervalMs = m_keyframeIntervalMs > 0 ? m_keyframeIntervalMs : DEFAULT_IDR_INTERVAL_MS;
+        m_codecCtx->gop_size = INFINITE_GOP;
+        m_keyframeDeadline = static_cast<int64_t>(intervalMs) * RTP_CLOCK_RATE / 1000;
+        m_backend->applyGopPolicy(m_codecCtx, opts, EncoderBackend::GopPolicy::Periodic);
+        qDebug() << "Keyframe mode: periodic IDR every" << intervalMs << "ms";
+        break;
+    }
+    case KeyframeMode::OnDemand:
+        //  GOPؼֻ֡ requestKeyframe()¹ڼ / PLI / Ͷ˶֡
+        m_codecCtx->gop_size = INFINITE_GOP;
+        m_keyframeDeadline = 0;
+        m_backend->applyGopPolicy(m_codecCtx, opts, EncoderBackend::GopPolicy::Infinite);
+        qDebug() << "Keyframe mode: on demand (infinite GOP)";
+        break;
+    case KeyframeMode::IntraRefresh: {
+        // ˢڼ gop_size IDRˢ°֡ƽֻܰ֡ʻ㣻
+        // ֡ʽڻڵʱ仹ûµʱǿһؼ֡
+        // ʱ֡ʵͣؼ֡ʼҲС
+        const int intervalMs = m_keyframeIntervalMs > 0 ? m_keyframeIntervalMs : DEFAULT_REFRESH_INTERVAL_MS;
+        m_codecCtx->gop_size = std::max(2, fps * intervalMs / 1000);
+        m_keyframeDeadline = static_cast<int64_t>(intervalMs) * 2 * RTP_CLOCK_RATE / 1000;
+        m_backend->applyGopPolicy(m_codecCtx, opts, EncoderBackend::GopPolicy::IntraRefresh);
+        qDebug() << "Keyframe mode: intra refresh over" << m_codecCtx->gop_size << "frames";
+        break;
+    }
+    }
+}
+
+void VideoEncoder::requestKeyframe() {
+    m_keyframeRequested = true;
+}
+
+bool VideoEncoder::keyframePending(qint64 captureTimeUs) const {
+    if (m_keyframeRequested) return true;
+    const int64_t due = m_keyframeDuePts;
+    return due != AV_NOPTS_VALUE && captureTimeUs >= 0 && MediaClock::rtpTicks(captureTimeUs) >= due;
+}
+
+void VideoEncoder::setTargetBitrate(int bitrate) {
+    if (bitrate > 0) m_pendingBitrate = bitrate;
+}
+
+void VideoEncoder::applyBitrate(int bitrate) {
+    //  VBV = Ŀʣ 250msֹؼ֡/仯ʱ˲ʱʳ·
+    // libx264 ÿ֡ǰȽЩֶΣб仯ʱ x264_encoder_reconfig
+    m_codecCtx->bit_rate = bitrate;
+    m_codecCtx->rc_max_rate = bitrate;
+    m_codecCtx->rc_buffer_size = bitrate / 4;
+}
+
+void VideoEncoder::updateBitrate() {
+    const int64_t current = m_codecCtx->bit_rate;
+    if (m_backend->supportsLiveBitrate()) {
+        qDebug() << "Encoder target bitrate:" << current << "->" << m_wantedBitrate;
+        applyBitrate(m_wantedBitrate);
+        return;
+    }
+
+    // ´򿪵Ĵһؼ֡С仯Ⱥԣȱ仯ۻ㹻ִ
+    const double ratio = static_cast<double>(m_wantedBitrate) / current;
+    if (ratio > 1.0 - BITRATE_REOPEN_MIN_CHANGE && ratio < 1.0 + BITRATE_REOPEN_MIN_CHANGE) return;
+    const qint64 nowUs = steadyNowUs();
+    if (m_lastReopenUs >= 0 && nowUs - m_lastReopenUs < BITRATE_REOPEN_INTERVAL_US) return;
+    m_lastReopenUs = nowUs;
+
+    // ӳ±ڲûлѹֱ֡ӹرռ
+    qDebug() << "Reopening encoder for target bitrate:" << current << "->" << m_wantedBitrate;
+    avcodec_free_context(&m_codecCtx);
+    if (!openCodec(m_wantedBitrate) && !openCodec(static_cast<int>(current))) {
+        qDebug() << "Reopen encoder failed";
+    }
 }
 
 void VideoEncoder::cleanup() {
@@ -194,10 +317,6 @@ void VideoEncoder::cleanup() {
         av_frame_free(&m_frameYUV); // ָ
         m_frameYUV = nullptr;
     }
-    if (m_swsCtx) {
-        sws_freeContext(m_swsCtx);
-        m_swsCtx = nullptr;
-    }
     if (m_pkt) {
         av_packet_free(&m_pkt);
         m_pkt = nullptr;
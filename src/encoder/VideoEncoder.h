@@ -1,7 +1,15 @@
 #pragma once
 #include <QObject>
 #include <QVideoFrame>
+#include <QByteArray>
 #include <functional>
+#include <atomic>
+#include <memory>
+#include "FrameConverter.h"
+#include "EncodedFrame.h"
+#include "EncoderBackend.h"
+#include "../Capture/FrameMeta.h"
+#include "../Capture/MediaClock.h"
 
 // FFmpeg  C Կ
 extern "C" {
@@ -15,31 +23,102 @@ class VideoEncoder : public QObject
 {
     Q_OBJECT
 public:
+    // ؼ֡
+    // Periodic̶ IDR
+    // OnDemand GOPֻ requestKeyframe() ʱ IDR
+    // IntraRefresh֡ˢ£֡ں鰴зɢһˢڵĸ֡û IDR ʼ壻
+    //               ÿˢ֡ SPS/PPS ͻָ SEIն˿Դ￪ʼ
+    enum class KeyframeMode { Periodic, OnDemand, IntraRefresh };
+
     explicit VideoEncoder(QObject* parent = nullptr);
     ~VideoEncoder();
 
+    //  init ֮ǰáintervalMs Ϊ Periodic  IDR  / IntraRefresh ˢڣ
+    // <= 0 ʱʹĬֵOnDemand Ըò
+    void setKeyframeMode(KeyframeMode mode, int intervalMs = 0);
+    KeyframeMode keyframeMode() const;
+
+    //  init ֮ǰãʽĬ H.264ʽӦıʱ init ʧ
+    void setCodec(VideoCodec codec);
+    VideoCodec codec() const;
+    // ǰ FFmpeg пõıʽͬȻʴӵ͵
+    static QList<VideoCodec> availableCodecs();
+
+    //  init ֮ǰã preset = Ĭϣx264/x265 Ϊ ultrafast
+    // ߳0 = ɱ
+    void setPreset(const QByteArray& preset);
+    void setThreadCount(int threads);
+
     // ʼ (ĿΪ 1080p ScreenCaptureд)
     bool init(int width, int height, int fps, int bitrate);
 
-    // һ֡ Qt Ļ
-    void encode(const QVideoFrame& frame);
+    // һ֡ Qt Ļ棬meta ԭ onEncodedData
+    void encode(const QVideoFrame& frame, const FrameMeta& meta = FrameMeta());
+    // һ֡Ѿתõ I420 棨simulcast 㹲һתߴ init һ
+    // д frame  pts / pict_type÷Լе
+    void encodeYuv(AVFrame* frame, const FrameMeta& meta = FrameMeta());
+
+    // һ֡ǿƱΪ IDR̵߳ãյ PLI ʱ
+    void requestKeyframe();
+    // ɼʱΪ captureTimeUs ֡ͽʱǷؼ֡Ѿ󣬻һؼ֡ѳ
+    // ʱǿƵļ̵߳ã澲ֹʱ EncodeWorker ݴ˰ͬ֡Ҳ
+    bool keyframePending(qint64 captureTimeUs) const;
+
+    // Ŀʣbps̵߳ã
+    // һ֡ǰЧx264 ͨ reconfig ߵأҪ´򿪣
+    // һ֡ǹؼֻ֡Ӧϴı仯Ƶ
+    void setTargetBitrate(int bitrate);
 
-    // صõ H.264 ͨﴫȥ
-    std::function<void(const std::vector<uint8_t>&, uint32_t)> onEncodedData;
+    // һ encode() ɫת / ĺʱ΢룩ڱ̶߳ȡ
+    qint64 lastConvertUs() const { return m_lastConvertUs; }
+    qint64 lastEncodeUs() const { return m_lastEncodeUs; }
+
+    // صõͨﴫȥ
+    // ÿ֡صһΣЯ֡ access unit / ʱ䵥Ԫ90kHz ʱؼ֡Ǻ meta
+    std::function<void(EncodedFrame::Ptr)> onEncodedData;
 
 private:
     // Դͷ
     void cleanup();
 
+    // ʸ¡ʱ㡢ȡencode  encodeYuv 
+    void encodeFrame(AVFrame* frame, const FrameMeta& meta);
+
+    // ǰô򿪱ģinit ʵʱ´򿪹
+    bool openCodec(int bitrate);
+
+    //  + VBV ãinit ߵ
+    void applyBitrate(int bitrate);
+    // ñʸ m_wantedBitrate
+    void updateBitrate();
+
+    // ؼ֡ GOPͰʱǿƹؼ֡ļ
+    void applyKeyframeMode(AVDictionary** opts, int fps);
+
+    VideoCodec m_codec = VideoCodec::H264;
+    EncoderBackend::Ptr m_backend;
     AVCodecContext* m_codecCtx = nullptr;
     AVFrame* m_frameYUV = nullptr;     // ת YUV 
-    SwsContext* m_swsCtx = nullptr;    // ͼź͸ʽת
+    FrameConverter m_converter;        // BGRA -> I420SIMD ת + I420 Сʽ˵ swscale
     AVPacket* m_pkt = nullptr;
 
     int m_targetW = 1920; // ͳһΪ1080pķֱʣѹʱ
     int m_targetH = 1080;
     int m_frameCount = 0;
-
-    int m_lastSrcW = -1;// ¼һԴֱʣڼ仯
-    int m_lastSrcH = -1;
+    int m_fps = 30;                    // ֡ʣ֡ûвɼʱʱʹ
+    int64_t m_lastPts = AV_NOPTS_VALUE;
+    KeyframeMode m_keyframeMode = KeyframeMode::IntraRefresh;
+    int m_keyframeIntervalMs = 0;
+    int64_t m_keyframeDeadline = 0;    // һؼ֡ʱ90kHzʱǿƹؼ֡0 ʾǿ
+    int64_t m_lastKeyframePts = AV_NOPTS_VALUE; // һؼ֡ˢ㣩 pts
+    int m_framesSinceKeyframe = 0;
+    std::atomic<int64_t> m_keyframeDuePts{ AV_NOPTS_VALUE }; // ʱǿһؼ֡ pts keyframePending ȡ
+    QByteArray m_preset;
+    int m_threadCount = 0;
+    int m_wantedBitrate = 0;           // ֻڱ̷߳
+    qint64 m_lastReopenUs = -1;
+    qint64 m_lastConvertUs = 0;
+    qint64 m_lastEncodeUs = 0;
+    std::atomic<bool> m_keyframeRequested{ false };
+    std::atomic<int> m_pendingBitrate{ 0 }; // 0 ʾûдЧ
 };
\ No newline at end of file
@@ -0,0 +1,157 @@
+#include "Av1RtpDepacketizer.hpp"
+
+// 聚合头各字段
+static const uint8_t AGG_Z = 0x80;
+static const uint8_t AGG_Y = 0x40;
+static const int AGG_W_SHIFT = 4;
+// OBU 头：forbidden(1) type(4) extension_flag(1) has_size_field(1) reserved(1)
+static const uint8_t OBU_EXTENSION_FLAG = 0x04;
+static const uint8_t OBU_HAS_SIZE_FIELD = 0x02;
+static const int OBU_TEMPORAL_DELIMITER = 2;
+static const int OBU_TILE_LIST = 8;
+
+static uint8_t byteAt(const rtc::binary& data, size_t index)
+{
+    return std::to_integer<uint8_t>(data[index]);
+}
+
+// LEB128 最多 8 字节
+static bool readLeb128(const rtc::binary& data, size_t& pos, uint64_t& value)
+{
+    value = 0;
+    for (int i = 0; i < 8 && pos < data.size(); ++i) {
+        const uint8_t byte = byteAt(data, pos++);
+        value |= static_cast<uint64_t>(byte & 0x7F) << (7 * i);
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+static void writeLeb128(uint64_t value, rtc::binary& out)
+{
+    do {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        if (value) byte |= 0x80;
+        out.push_back(std::byte(byte));
+    } while (value);
+}
+
+// 追加一个完整的 OBU，补上 obu_size 字段
+static void appendObu(const rtc::binary& obu, rtc::binary& out)
+{
+    if (obu.empty()) return;
+    const uint8_t header = byteAt(obu, 0);
+    const int type = (header >> 3) & 0x0F;
+    // 负载里本不应出现这两种 OBU；时间分隔符由 assembleTemporalUnit 统一加在开头
+    if (type == OBU_TEMPORAL_DELIMITER || type == OBU_TILE_LIST) return;
+
+    if (header & OBU_HAS_SIZE_FIELD) {
+        out.insert(out.end(), obu.begin(), obu.end());
+        return;
+    }
+    const size_t headerSize = (header & OBU_EXTENSION_FLAG) ? 2 : 1;
+    if (obu.size() < headerSize) return;
+    out.push_back(std::byte(header | OBU_HAS_SIZE_FIELD));
+    if (headerSize == 2) out.push_back(obu[1]);
+    writeLeb128(obu.size() - headerSize, out);
+    out.insert(out.end(), obu.begin() + headerSize, obu.end());
+}
+
+Av1RtpDepacketizer::Av1RtpDepacketizer() {}
+
+Av1RtpDepacketizer::~Av1RtpDepacketizer() {}
+
+rtc::binary Av1RtpDepacketizer::assembleTemporalUnit(const std::vector<Payload>& payloads)
+{
+    // 时间分隔符 OBU：type = 2，has_size_field = 1，obu_size = 0
+    rtc::binary out{ std::byte(0x12), std::byte(0x00) };
+    const size_t emptySize = out.size();
+
+    rtc::binary fragment;          // 尚未收完的 OBU
+    bool fragmentValid = false;
+
+    for (const Payload& payload : payloads) {
+        const rtc::binary& data = payload.data;
+        if (data.empty()) continue;
+        // 中间丢了包，跨包的 OBU 已经不完整
+        if (payload.afterGap) {
+            fragment.clear();
+            fragmentValid = false;
+        }
+
+        const uint8_t aggregation = byteAt(data, 0);
+        const bool z = (aggregation & AGG_Z) != 0;
+        const bool y = (aggregation & AGG_Y) != 0;
+        const int w = (aggregation >> AGG_W_SHIFT) & 0x03;
+
+        size_t pos = 1;
+        for (int index = 0; pos < data.size(); ++index) {
+            const bool lastCounted = (w != 0 && index == w - 1);
+            uint64_t length = data.size() - pos;
+            if (!lastCounted && (!readLeb128(data, pos, length) || length > data.size() - pos)) {
+                // 长度字段损坏，本包剩余部分无法解析
+                fragment.clear();
+                fragmentValid = false;
+                break;
+            }
+            const auto begin = data.begin() + pos;
+            const auto end = begin + static_cast<ptrdiff_t>(length);
+            pos += static_cast<size_t>(length);
+
+            if (index == 0 && z) {
+                // 续接上一个包的分片；前面的分片丢了就整个跳过
+                if (fragmentValid) fragment.insert(fragment.end(), begin, end);
+            }
+            else {
+                fragment.assign(begin, end);
+                fragmentValid = true;
+            }
+
+            const bool continuesInNextPacket = y && pos >= data.size();
+            if (!continuesInNextPacket) {
+                if (fragmentValid) appendObu(fragment, out);
+                fragment.clear();
+                fragmentValid = false;
+            }
+            if (lastCounted) break;
+        }
+    }
+
+    if (out.size() == emptySize) out.clear();
+    return out;
+}
+
+rtc::message_ptr Av1RtpDepacketizer::reassemble(message_buffer& buffer)
+{
+    // 收到 marker 包时调用，buffer 按序列号排序；以 marker 包的时间戳为准，
+    // 更早时间戳的包是丢了 marker 的上一帧残留
+    const rtc::message_ptr& last = *buffer.rbegin();
+    const auto* lastHeader = reinterpret_cast<const rtc::RtpHeader*>(last->data());
+    const uint32_t timestamp = lastHeader->timestamp();
+    const uint8_t payloadType = lastHeader->payloadType();
+
+    std::vector<Payload> payloads;
+    payloads.reserve(buffer.size());
+    bool hasPrevious = false;
+    uint16_t previousSeq = 0;
+    for (const rtc::message_ptr& packet : buffer) {
+        if (packet->size() < sizeof(rtc::RtpHeader)) continue;
+        const auto* header = reinterpret_cast<const rtc::RtpHeader*>(packet->data());
+        if (header->timestamp() != timestamp) continue;
+
+        const size_t headerSize = header->getSize() + header->getExtensionHeaderSize();
+        const size_t paddingSize = header->padding() ? std::to_integer<uint8_t>(packet->back()) : 0;
+        if (packet->size() <= headerSize + paddingSize) continue;
+
+        Payload payload;
+        payload.data.assign(packet->begin() + headerSize, packet->end() - paddingSize);
+        payload.afterGap = hasPrevious && static_cast<uint16_t>(previousSeq + 1) != header->seqNumber();
+        payloads.push_back(std::move(payload));
+        hasPrevious = true;
+        previousSeq = header->seqNumber();
+    }
+
+    // 解析失败时给出空帧，由上层丢弃并请求关键帧
+    return rtc::make_message(assembleTemporalUnit(payloads), createFrameInfo(timestamp, payloadType));
+}
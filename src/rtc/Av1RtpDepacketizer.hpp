@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <rtc/rtc.hpp>
+
+// AV1 RTP 解包（AV1 RTP Payload Format），libdatachannel 只提供了 AV1 打包器
+// 每个 RTP 负载 = 1 字节聚合头 Z|Y|W(2)|N|保留(3) + 若干 OBU 元素：
+// - Z：第一个元素是上一个包里 OBU 的后续分片；Y：最后一个元素在下一个包里继续
+// - W = 0 时每个元素前都有 LEB128 长度；W = 1..3 时元素个数为 W，最后一个元素不带长度
+// 输出 FFmpeg 解码器接受的低开销码流格式：以时间分隔符开头，每个 OBU 都带 obu_size 字段
+class Av1RtpDepacketizer final : public rtc::VideoRtpDepacketizer
+{
+public:
+    struct Payload {
+        rtc::binary data;       // 去掉 RTP 头和填充后的负载
+        bool afterGap = false;  // 与前一个包的序列号不连续
+    };
+
+    Av1RtpDepacketizer();
+    ~Av1RtpDepacketizer();
+
+    // 把同一帧的负载（按序列号排好）拼成一个时间单元；格式错误或缺了分片的 OBU 被丢弃
+    static rtc::binary assembleTemporalUnit(const std::vector<Payload>& payloads);
+
+private:
+    rtc::message_ptr reassemble(message_buffer& buffer) override;
+};
@@ -0,0 +1,182 @@
+#include "BandwidthEstimator.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+// 发送速率的采样窗口与平滑系数
+static const int64_t RATE_WINDOW_MS = 500;
+static const double RATE_SMOOTHING = 0.3;
+// RTT 基线的有效期，过期后用当前 RTT 重新建立（路由变化时基线会变）
+static const int64_t MIN_RTT_WINDOW_MS = 10000;
+// 目标码率变化超过该比例才通知编码器
+static const double REPORT_THRESHOLD = 0.05;
+
+BandwidthEstimator::BandwidthEstimator()
+    : BandwidthEstimator(Config())
+{}
+
+BandwidthEstimator::BandwidthEstimator(const Config& config)
+    : m_config(config)
+{
+    reset();
+}
+
+void BandwidthEstimator::setConfig(const Config& config)
+{
+    m_config = config;
+    reset();
+}
+
+void BandwidthEstimator::reset()
+{
+    m_target = std::clamp(m_config.startBitrate, m_config.minBitrate, m_config.maxBitrate);
+    m_reported = m_target;
+    m_lastBytes = 0;
+    m_lastBytesMs = -1;
+    m_sendRate = 0;
+    m_buffered = 0;
+    m_rttMs = -1;
+    m_minRttMs = -1;
+    m_minRttSinceMs = 0;
+    m_remb = 0;
+    m_rembMs = -1;
+    m_loss = 0.0;
+    m_lossMs = -1;
+    m_lastUpdateMs = -1;
+    m_lastDecreaseMs = -1;
+}
+
+void BandwidthEstimator::onBytesSent(uint64_t totalBytes, int64_t nowMs)
+{
+    if (m_lastBytesMs < 0 || totalBytes < m_lastBytes) {
+        m_lastBytes = totalBytes;
+        m_lastBytesMs = nowMs;
+        return;
+    }
+    const int64_t elapsed = nowMs - m_lastBytesMs;
+    if (elapsed < RATE_WINDOW_MS) return;
+
+    const int64_t rate = static_cast<int64_t>((totalBytes - m_lastBytes) * 8 * 1000 / elapsed);
+    m_sendRate = m_sendRate == 0 ? rate :
+        static_cast<int64_t>(RATE_SMOOTHING * rate + (1.0 - RATE_SMOOTHING) * m_sendRate);
+    m_lastBytes = totalBytes;
+    m_lastBytesMs = nowMs;
+}
+
+void BandwidthEstimator::onBufferedAmount(size_t bytes, int64_t nowMs)
+{
+    (void)nowMs;
+    m_buffered = bytes;
+}
+
+void BandwidthEstimator::onRtt(int64_t rttMs, int64_t nowMs)
+{
+    if (rttMs < 0) return;
+    m_rttMs = rttMs;
+    if (m_minRttMs < 0 || rttMs <= m_minRttMs || nowMs - m_minRttSinceMs > MIN_RTT_WINDOW_MS) {
+        m_minRttMs = rttMs;
+        m_minRttSinceMs = nowMs;
+    }
+}
+
+void BandwidthEstimator::onRemb(int64_t bitrate, int64_t nowMs)
+{
+    if (bitrate <= 0) return;
+    m_remb = bitrate;
+    m_rembMs = nowMs;
+}
+
+void BandwidthEstimator::onLoss(double fractionLost, int64_t nowMs)
+{
+    m_loss = std::clamp(fractionLost, 0.0, 1.0);
+    m_lossMs = nowMs;
+}
+
+int64_t BandwidthEstimator::queueDelayMs() const
+{
+    return static_cast<int64_t>(m_buffered) * 8 * 1000 / std::max(m_target, m_config.minBitrate);
+}
+
+bool BandwidthEstimator::rttElevated() const
+{
+    return m_rttMs >= 0 && m_minRttMs >= 0 && m_rttMs - m_minRttMs > m_config.rttIncreaseMs;
+}
+
+bool BandwidthEstimator::feedbackValid(int64_t nowMs) const
+{
+    return m_lossMs >= 0 && nowMs - m_lossMs <= m_config.feedbackTimeoutMs;
+}
+
+bool BandwidthEstimator::update(int64_t nowMs)
+{
+    const int64_t elapsed = m_lastUpdateMs < 0 ? 0 : std::min<int64_t>(nowMs - m_lastUpdateMs, 1000);
+    m_lastUpdateMs = nowMs;
+
+    const int64_t queueDelay = queueDelayMs();
+    const bool holding = m_lastDecreaseMs >= 0 && nowMs - m_lastDecreaseMs < m_config.holdAfterDecreaseMs;
+    const bool feedback = feedbackValid(nowMs);
+    const double loss = feedback ? m_loss : 0.0;
+    double target = m_target;
+
+    if (queueDelay > m_config.highQueueDelayMs || rttElevated() || loss > m_config.highLossFraction) {
+        // 拥塞：以实际送出的速率为基准下降，避免目标码率远高于链路能力时下降太慢
+        if (!holding) {
+            const double base = m_sendRate > 0 ? std::min<double>(m_target, m_sendRate) : m_target;
+            target = base * m_config.decreaseFactor;
+            m_lastDecreaseMs = nowMs;
+        }
+    }
+    else if (queueDelay <= m_config.lowQueueDelayMs && loss <= m_config.lowLossFraction && !holding &&
+        (feedback || !m_config.requireFeedback)) {
+        target *= 1.0 + m_config.increasePerSecond * elapsed / 1000.0;
+    }
+
+    if (m_rembMs >= 0 && nowMs - m_rembMs <= m_config.rembTimeoutMs) {
+        target = std::min<double>(target, static_cast<double>(m_remb));
+    }
+    m_target = std::clamp(static_cast<int>(target), m_config.minBitrate, m_config.maxBitrate);
+
+    if (std::abs(m_target - m_reported) > m_reported * REPORT_THRESHOLD) {
+        m_reported = m_target;
+        return true;
+    }
+    return false;
+}
+
+RembEstimator::RembEstimator()
+    : RembEstimator(BandwidthEstimator::Config())
+{}
+
+RembEstimator::RembEstimator(const BandwidthEstimator::Config& config)
+    : m_config(config)
+{}
+
+void RembEstimator::reset()
+{
+    m_bitrate = 0;
+    m_reported = 0;
+    m_lastStatsMs = -1;
+}
+
+bool RembEstimator::onReceiveStats(int64_t receiveRate, double fractionLost, int64_t nowMs)
+{
+    const int64_t elapsed = m_lastStatsMs < 0 ? 0 : std::min<int64_t>(nowMs - m_lastStatsMs, 1000);
+    m_lastStatsMs = nowMs;
+
+    if (fractionLost > m_config.highLossFraction && receiveRate > 0) {
+        // 收到的已经是链路能送达的速率，在此基础上再留出余量
+        const int64_t limit = static_cast<int64_t>(receiveRate * m_config.decreaseFactor);
+        m_bitrate = m_bitrate > 0 ? std::min(m_bitrate, limit) : limit;
+    }
+    else if (fractionLost <= m_config.lowLossFraction && m_bitrate > 0) {
+        const double grown = m_bitrate * (1.0 + m_config.increasePerSecond * elapsed / 1000.0);
+        m_bitrate = std::max(static_cast<int64_t>(grown), receiveRate * 3 / 2);
+    }
+    if (m_bitrate <= 0) return false;
+    m_bitrate = std::clamp<int64_t>(m_bitrate, m_config.minBitrate, m_config.maxBitrate);
+
+    if (m_reported == 0 || std::abs(m_bitrate - m_reported) > m_reported * REPORT_THRESHOLD) {
+        m_reported = m_bitrate;
+        return true;
+    }
+    return false;
+}
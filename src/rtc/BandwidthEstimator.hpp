@@ -0,0 +1,103 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// 发送端码率估计（AIMD）
+// 输入：
+// - 实际发送速率（累计发送字节数的增量：DataChannel 为 PeerConnection::bytesSent，轨道模式为送出的 RTP 字节）
+// - DataChannel 发送缓冲中的字节数 -> 换算成排队时延
+// - RTT，相对近期最小 RTT 的增长视为排队（DataChannel 取 SCTP 的 RTT，轨道模式取 RTCP RR）
+// - 轨道模式下接收端 RR 中的丢包率
+// - 轨道模式下接收端的 REMB，作为上限
+// 拥塞时按实际发送速率乘性下降，链路空闲时每秒按比例缓慢上升
+// 轨道模式没有发送缓冲可看（requireFeedback），近期没有收到 RR 时不上升
+class BandwidthEstimator
+{
+public:
+    struct Config {
+        int minBitrate = 300 * 1000;
+        int maxBitrate = 8 * 1000 * 1000;
+        int startBitrate = 4 * 1000 * 1000;
+        int64_t highQueueDelayMs = 150;   // 排队时延超过该值视为拥塞
+        int64_t lowQueueDelayMs = 30;     // 低于该值才允许上升
+        int64_t rttIncreaseMs = 100;      // RTT 比基线高出该值视为拥塞
+        double highLossFraction = 0.10;   // 丢包率超过该值视为拥塞
+        double lowLossFraction = 0.02;    // 不高于该值才允许上升
+        int64_t feedbackTimeoutMs = 5000; // RR 的丢包率在这段时间内有效
+        bool requireFeedback = false;     // 上升前需要有效的 RR
+        double decreaseFactor = 0.85;
+        double increasePerSecond = 0.08;
+        int64_t holdAfterDecreaseMs = 1000; // 下降后保持，等待缓冲排空
+        int64_t rembTimeoutMs = 5000;
+    };
+
+    BandwidthEstimator();
+    explicit BandwidthEstimator(const Config& config);
+
+    // 替换配置并重置估计
+    void setConfig(const Config& config);
+
+    // nowMs 为单调时钟毫秒数
+    void onBytesSent(uint64_t totalBytes, int64_t nowMs);   // 累计发送字节数
+    void onBufferedAmount(size_t bytes, int64_t nowMs);
+    void onRtt(int64_t rttMs, int64_t nowMs);
+    void onRemb(int64_t bitrate, int64_t nowMs);
+    void onLoss(double fractionLost, int64_t nowMs);        // RR 的 fraction lost（0~1）
+
+    // 根据当前输入重新计算目标码率，返回 true 表示变化足够大，需要通知编码器
+    bool update(int64_t nowMs);
+
+    int targetBitrate() const { return m_target; }
+    int64_t sendRate() const { return m_sendRate; }
+    int64_t queueDelayMs() const;
+    void reset();
+
+private:
+    bool rttElevated() const;
+    bool feedbackValid(int64_t nowMs) const;
+
+    Config m_config;
+    int m_target = 0;
+    int m_reported = 0;
+
+    uint64_t m_lastBytes = 0;
+    int64_t m_lastBytesMs = -1;
+    int64_t m_sendRate = 0;          // bps，指数平滑
+
+    size_t m_buffered = 0;
+    int64_t m_rttMs = -1;
+    int64_t m_minRttMs = -1;
+    int64_t m_minRttSinceMs = 0;
+
+    int64_t m_remb = 0;
+    int64_t m_rembMs = -1;
+
+    double m_loss = 0.0;
+    int64_t m_lossMs = -1;
+
+    int64_t m_lastUpdateMs = -1;
+    int64_t m_lastDecreaseMs = -1;
+};
+
+// 接收端的码率上限，轨道模式下经 REMB 告知发送端
+// 按每个统计窗口的接收速率与丢包率：丢包率超过高阈值时上限降到接收速率的 decreaseFactor 倍，
+// 不高于低阈值时每秒按比例回升（不低于接收速率的 1.5 倍），回升到 maxBitrate 即相当于不限制；其间保持
+class RembEstimator
+{
+public:
+    RembEstimator();
+    explicit RembEstimator(const BandwidthEstimator::Config& config);
+
+    // receiveRate 为窗口内的接收速率（bps）；返回 true 表示上限变化足够大，需要发送 REMB
+    bool onReceiveStats(int64_t receiveRate, double fractionLost, int64_t nowMs);
+
+    // 当前上限（bps），0 表示尚未出现丢包、不限制
+    int64_t bitrate() const { return m_bitrate; }
+    void reset();
+
+private:
+    BandwidthEstimator::Config m_config;
+    int64_t m_bitrate = 0;
+    int64_t m_reported = 0;
+    int64_t m_lastStatsMs = -1;
+};
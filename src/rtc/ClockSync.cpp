@@ -0,0 +1,129 @@
+#include "ClockSync.hpp"
+#include <cstdlib>
+
+// 1900-01-01 到 1970-01-01 的秒数
+static const uint64_t NTP_UNIX_OFFSET_SECONDS = 2208988800ULL;
+static const char* SENDER_REPORT_PREFIX = "sender-report:";
+// RTCP SR 的 payload type
+static const uint8_t RTCP_PT_SR = 200;
+
+uint64_t ntpFromUnixUs(int64_t unixUs)
+{
+    const uint64_t seconds = static_cast<uint64_t>(unixUs / 1000000) + NTP_UNIX_OFFSET_SECONDS;
+    const uint64_t fraction = (static_cast<uint64_t>(unixUs % 1000000) << 32) / 1000000;
+    return (seconds << 32) | fraction;
+}
+
+int64_t unixUsFromNtp(uint64_t ntp)
+{
+    const int64_t seconds = static_cast<int64_t>(ntp >> 32) - static_cast<int64_t>(NTP_UNIX_OFFSET_SECONDS);
+    const int64_t micros = static_cast<int64_t>(((ntp & 0xFFFFFFFFULL) * 1000000 + 0x80000000ULL) >> 32);
+    return seconds * 1000000 + micros;
+}
+
+std::string formatSenderReport(const SenderReport& report)
+{
+    return SENDER_REPORT_PREFIX + std::to_string(report.ntpTimestamp) + ":" + std::to_string(report.rtpTimestamp);
+}
+
+bool parseSenderReport(const std::string& text, SenderReport& report)
+{
+    const size_t prefixLen = std::char_traits<char>::length(SENDER_REPORT_PREFIX);
+    if (text.compare(0, prefixLen, SENDER_REPORT_PREFIX) != 0) return false;
+
+    const char* begin = text.c_str() + prefixLen;
+    char* end = nullptr;
+    const unsigned long long ntp = std::strtoull(begin, &end, 10);
+    if (end == begin || *end != ':') return false;
+    begin = end + 1;
+    const unsigned long long rtp = std::strtoull(begin, &end, 10);
+    if (end == begin || *end != '\0' || rtp > 0xFFFFFFFFULL) return false;
+
+    report.ntpTimestamp = ntp;
+    report.rtpTimestamp = static_cast<uint32_t>(rtp);
+    return true;
+}
+
+void RtpClockMapper::update(const SenderReport& report)
+{
+    m_report = report;
+    m_reportUnixUs = unixUsFromNtp(report.ntpTimestamp);
+    m_valid = true;
+}
+
+void RtpClockMapper::reset()
+{
+    m_valid = false;
+}
+
+bool RtpClockMapper::toSenderUnixUs(uint32_t rtpTimestamp, int64_t& unixUs) const
+{
+    if (!m_valid) return false;
+    // 按有符号差值处理 32 位回绕，帧可以在 SR 之前或之后
+    const int32_t delta = static_cast<int32_t>(rtpTimestamp - m_report.rtpTimestamp);
+    unixUs = m_reportUnixUs + static_cast<int64_t>(delta) * 1000000 / m_clockRate;
+    return true;
+}
+
+MediaClockSrReporter::MediaClockSrReporter(rtc::SSRC ssrc, ReportFn report, std::chrono::milliseconds interval)
+    : m_ssrc(ssrc), m_report(std::move(report)), m_interval(interval)
+{}
+
+void MediaClockSrReporter::outgoing(rtc::message_vector& messages, const rtc::message_callback& send)
+{
+    for (const auto& message : messages) {
+        if (!message || message->type == rtc::Message::Control) continue;
+        if (message->size() < sizeof(rtc::RtpHeader)) continue;
+        auto rtp = reinterpret_cast<const rtc::RtpHeader*>(message->data());
+        ++m_packetCount;
+        m_octetCount += static_cast<uint32_t>(message->size() - rtp->getSize());
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    if (m_packetCount > 0 && m_report && now - m_lastReport >= m_interval) {
+        m_lastReport = now;
+        send(makeSenderReport());
+    }
+}
+
+rtc::message_ptr MediaClockSrReporter::makeSenderReport() const
+{
+    const SenderReport report = m_report();
+    auto message = rtc::make_message(rtc::RtcpSr::Size(0), rtc::Message::Control);
+    auto sr = reinterpret_cast<rtc::RtcpSr*>(message->data());
+    sr->preparePacket(m_ssrc, 0);
+    sr->setNtpTimestamp(report.ntpTimestamp);
+    sr->setRtpTimestamp(report.rtpTimestamp);
+    sr->setPacketCount(m_packetCount);
+    sr->setOctetCount(m_octetCount);
+    return message;
+}
+
+SenderReportObserver::SenderReportObserver(ReportCallback callback)
+    : m_callback(std::move(callback))
+{}
+
+void SenderReportObserver::incoming(rtc::message_vector& messages, const rtc::message_callback& send)
+{
+    (void)send;
+    for (const auto& message : messages) {
+        if (!message || message->type != rtc::Message::Control) continue;
+
+        // 复合 RTCP 包：逐个子包查找 SR
+        size_t offset = 0;
+        while (offset + sizeof(rtc::RtcpHeader) <= message->size()) {
+            auto header = reinterpret_cast<const rtc::RtcpHeader*>(message->data() + offset);
+            const size_t length = header->lengthInBytes();
+            if (length < sizeof(rtc::RtcpHeader) || offset + length > message->size()) break;
+
+            if (header->payloadType() == RTCP_PT_SR && length >= rtc::RtcpSr::Size(0)) {
+                auto sr = reinterpret_cast<const rtc::RtcpSr*>(header);
+                SenderReport report;
+                report.ntpTimestamp = sr->ntpTimestamp();
+                report.rtpTimestamp = sr->rtpTimestamp();
+                if (m_callback) m_callback(report);
+            }
+            offset += length;
+        }
+    }
+}
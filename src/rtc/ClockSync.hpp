@@ -0,0 +1,84 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <rtc/rtc.hpp>
+
+// 发送端与接收端之间的 NTP <-> RTP 时钟对应（RTCP SR 的语义）
+// 发送端周期性给出「某一时刻的墙上时间（NTP）与同一时刻的 RTP 时间戳」，
+// 接收端据此把任意一帧的 RTP 时间戳换算回发送端的采集时刻：
+// - 两端系统时间同步（NTP）时，接收时刻 - 采集时刻 即为真实的单向延迟
+// - 帧间的发送端时间差用于平滑播放节奏
+
+// NTP 64 位时间戳：高 32 位为 1900-01-01 起的秒数，低 32 位为秒的小数部分
+uint64_t ntpFromUnixUs(int64_t unixUs);
+int64_t unixUsFromNtp(uint64_t ntp);
+
+struct SenderReport {
+    uint64_t ntpTimestamp = 0;
+    uint32_t rtpTimestamp = 0;
+};
+
+// DataChannel 模式没有 RTCP，SR 以文本消息发送："sender-report:<ntp>:<rtp>"
+std::string formatSenderReport(const SenderReport& report);
+bool parseSenderReport(const std::string& text, SenderReport& report);
+
+// 接收端：用最近一次 SR 把 RTP 时间戳换算为发送端墙上时间
+class RtpClockMapper
+{
+public:
+    RtpClockMapper(uint32_t clockRate = 90000) : m_clockRate(clockRate) {}
+
+    void update(const SenderReport& report);
+    void reset();
+    bool isValid() const { return m_valid; }
+
+    // 与 SR 的 RTP 时间戳相差不超过半个 32 位周期（90kHz 下约 6.6 小时）时结果正确
+    bool toSenderUnixUs(uint32_t rtpTimestamp, int64_t& unixUs) const;
+
+private:
+    uint32_t m_clockRate;
+    bool m_valid = false;
+    SenderReport m_report;
+    int64_t m_reportUnixUs = 0;
+};
+
+// 轨道模式发送链：替代 rtc::RtcpSrReporter
+// RtcpSrReporter 把 SR 发出时的系统时间和最后一个包的 RTP 时间戳配对，差了一段采集 -> 发送的耗时；
+// 这里的 NTP/RTP 对由媒体时钟在同一时刻给出，与帧的时间戳同源
+class MediaClockSrReporter final : public rtc::MediaHandler
+{
+public:
+    using ReportFn = std::function<SenderReport()>;
+
+    MediaClockSrReporter(rtc::SSRC ssrc, ReportFn report,
+        std::chrono::milliseconds interval = std::chrono::milliseconds(1000));
+
+    void outgoing(rtc::message_vector& messages, const rtc::message_callback& send) override;
+
+private:
+    rtc::message_ptr makeSenderReport() const;
+
+    rtc::SSRC m_ssrc;
+    ReportFn m_report;
+    std::chrono::milliseconds m_interval;
+    std::chrono::steady_clock::time_point m_lastReport;
+    uint32_t m_packetCount = 0;
+    uint32_t m_octetCount = 0;
+};
+
+// 轨道模式接收链：从收到的 RTCP 中取出 SR，回调在网络线程执行
+// RtcpReceivingSession 会消费掉 RTCP，需要把本处理器链在它之后（incoming 自链尾向前执行）
+class SenderReportObserver final : public rtc::MediaHandler
+{
+public:
+    using ReportCallback = std::function<void(const SenderReport& report)>;
+
+    explicit SenderReportObserver(ReportCallback callback);
+
+    void incoming(rtc::message_vector& messages, const rtc::message_callback& send) override;
+
+private:
+    ReportCallback m_callback;
+};
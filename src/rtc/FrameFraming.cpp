@@ -0,0 +1,241 @@
+#include "FrameFraming.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+void putU16(uint8_t* p, uint16_t v)
+{
+    p[0] = static_cast<uint8_t>(v >> 8);
+    p[1] = static_cast<uint8_t>(v);
+}
+
+void putU32(uint8_t* p, uint32_t v)
+{
+    p[0] = static_cast<uint8_t>(v >> 24);
+    p[1] = static_cast<uint8_t>(v >> 16);
+    p[2] = static_cast<uint8_t>(v >> 8);
+    p[3] = static_cast<uint8_t>(v);
+}
+
+uint16_t getU16(const uint8_t* p)
+{
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+uint32_t getU32(const uint8_t* p)
+{
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+        (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+// frameId 允许回绕：a 比 b 新
+bool isNewer(uint32_t a, uint32_t b)
+{
+    return static_cast<int32_t>(a - b) > 0;
+}
+
+} // namespace
+
+void FrameHeader::write(uint8_t* out) const
+{
+    out[0] = MAGIC;
+    out[1] = VERSION;
+    out[2] = static_cast<uint8_t>(codec);
+    out[3] = flags;
+    putU32(out + 4, frameId);
+    putU32(out + 8, timestamp);
+    putU32(out + 12, frameSize);
+    putU32(out + 16, fragOffset);
+    putU16(out + 20, fragIndex);
+    putU16(out + 22, fragCount);
+}
+
+bool FrameHeader::read(const uint8_t* in, size_t size)
+{
+    if (size < SIZE || in[0] != MAGIC || in[1] != VERSION || !isKnownVideoCodec(in[2])) return false;
+
+    codec = static_cast<VideoCodec>(in[2]);
+    flags = in[3];
+    frameId = getU32(in + 4);
+    timestamp = getU32(in + 8);
+    frameSize = getU32(in + 12);
+    fragOffset = getU32(in + 16);
+    fragIndex = getU16(in + 20);
+    fragCount = getU16(in + 22);
+
+    const size_t payload = size - SIZE;
+    return frameSize > 0 && fragCount > 0 && fragIndex < fragCount &&
+        fragOffset <= frameSize && payload <= frameSize - fragOffset;
+}
+
+FrameFragmenter::FrameFragmenter(size_t maxMessageSize)
+    : m_buffer(std::max(maxMessageSize, FrameHeader::SIZE + 1))
+{}
+
+int FrameFragmenter::send(const uint8_t* data, size_t size, FrameHeader header, const SendFn& sendFn)
+{
+    const size_t payloadSize = maxPayloadSize();
+    const size_t count = (size + payloadSize - 1) / payloadSize;
+    if (size == 0 || size > UINT32_MAX || count > UINT16_MAX) return -1;
+
+    header.frameSize = static_cast<uint32_t>(size);
+    header.fragCount = static_cast<uint16_t>(count);
+
+    uint8_t* out = reinterpret_cast<uint8_t*>(m_buffer.data());
+    size_t offset = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const size_t chunk = std::min(payloadSize, size - offset);
+        header.fragIndex = static_cast<uint16_t>(i);
+        header.fragOffset = static_cast<uint32_t>(offset);
+        header.write(out);
+        std::memcpy(out + FrameHeader::SIZE, data + offset, chunk);
+        if (!sendFn(m_buffer.data(), FrameHeader::SIZE + chunk)) return -1;
+        offset += chunk;
+    }
+    return static_cast<int>(count);
+}
+
+FrameReassembler::FrameReassembler()
+    : FrameReassembler(Config())
+{}
+
+FrameReassembler::FrameReassembler(const Config& config)
+    : m_config(config)
+    , m_slots(std::max(1, config.maxPendingFrames))
+{}
+
+void FrameReassembler::reset()
+{
+    for (Slot& slot : m_slots) {
+        slot.active = false;
+    }
+    m_pendingBytes = 0;
+    m_hasDelivered = false;
+    m_lastDeliveredId = 0;
+}
+
+void FrameReassembler::push(const uint8_t* message, size_t size, int64_t nowMs, const FrameFn& onFrame)
+{
+    FrameHeader header;
+    if (!header.read(message, size)) {
+        ++m_stats.droppedFragments;
+        return;
+    }
+
+    expire(nowMs);
+
+    // 比已经交付的帧更旧：解码器用不上了
+    if (m_hasDelivered && !isNewer(header.frameId, m_lastDeliveredId)) {
+        ++m_stats.droppedFragments;
+        return;
+    }
+
+    Slot* slot = findSlot(header.frameId);
+    if (!slot) {
+        slot = acquireSlot(header, nowMs);
+        if (!slot) {
+            ++m_stats.droppedFragments;
+            return;
+        }
+    }
+
+    const size_t payload = size - FrameHeader::SIZE;
+    if (header.frameSize != slot->header.frameSize || header.fragCount != slot->header.fragCount ||
+        slot->received[header.fragIndex]) {
+        ++m_stats.droppedFragments;
+        return;
+    }
+
+    std::memcpy(slot->data.data() + header.fragOffset, message + FrameHeader::SIZE, payload);
+    slot->received[header.fragIndex] = 1;
+    slot->receivedBytes += static_cast<uint32_t>(payload);
+    ++slot->receivedCount;
+
+    if (slot->receivedCount < slot->header.fragCount) return;
+
+    if (slot->receivedBytes != slot->header.frameSize) {
+        // 分片数对上但长度对不上，说明分片不属于同一次发送
+        ++m_stats.evictedFrames;
+        release(*slot);
+        return;
+    }
+
+    evictOlderThan(header.frameId);
+    m_lastDeliveredId = header.frameId;
+    m_hasDelivered = true;
+    ++m_stats.completedFrames;
+    if (onFrame) onFrame(slot->header, slot->data.data(), slot->header.frameSize);
+    release(*slot);
+}
+
+void FrameReassembler::expire(int64_t nowMs)
+{
+    for (Slot& slot : m_slots) {
+        if (slot.active && nowMs - slot.firstSeenMs > m_config.deadlineMs) {
+            ++m_stats.expiredFrames;
+            release(slot);
+        }
+    }
+}
+
+FrameReassembler::Slot* FrameReassembler::findSlot(uint32_t frameId)
+{
+    for (Slot& slot : m_slots) {
+        if (slot.active && slot.header.frameId == frameId) return &slot;
+    }
+    return nullptr;
+}
+
+FrameReassembler::Slot* FrameReassembler::acquireSlot(const FrameHeader& header, int64_t nowMs)
+{
+    if (header.frameSize > m_config.memoryBudget) return nullptr;
+
+    for (;;) {
+        Slot* freeSlot = nullptr;
+        Slot* oldest = nullptr;
+        for (Slot& slot : m_slots) {
+            if (!slot.active) {
+                if (!freeSlot) freeSlot = &slot;
+            }
+            else if (!oldest || isNewer(oldest->header.frameId, slot.header.frameId)) {
+                oldest = &slot;
+            }
+        }
+
+        if (freeSlot && m_pendingBytes + header.frameSize <= m_config.memoryBudget) {
+            freeSlot->active = true;
+            freeSlot->header = header;
+            freeSlot->firstSeenMs = nowMs;
+            freeSlot->receivedBytes = 0;
+            freeSlot->receivedCount = 0;
+            // 缓冲区只在帧变大时才会重新分配
+            freeSlot->data.resize(header.frameSize);
+            freeSlot->received.assign(header.fragCount, 0);
+            m_pendingBytes += header.frameSize;
+            return freeSlot;
+        }
+
+        // 空间不足：淘汰最旧的未完成帧；如果新帧本身就是最旧的，放弃新帧
+        if (!oldest || !isNewer(header.frameId, oldest->header.frameId)) return nullptr;
+        ++m_stats.evictedFrames;
+        release(*oldest);
+    }
+}
+
+void FrameReassembler::release(Slot& slot)
+{
+    if (!slot.active) return;
+    slot.active = false;
+    m_pendingBytes -= slot.header.frameSize;
+}
+
+void FrameReassembler::evictOlderThan(uint32_t frameId)
+{
+    for (Slot& slot : m_slots) {
+        if (slot.active && isNewer(frameId, slot.header.frameId)) {
+            ++m_stats.evictedFrames;
+            release(slot);
+        }
+    }
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "VideoCodec.hpp"
+
+// DataChannel 视频路径的应用层分帧
+// 每条消息 = 固定 24 字节头 + 一段帧数据，多字节字段为网络字节序：
+//
+//   0      1      2      3
+//   magic  ver    codec  flags       codec 见 VideoCodec，flags bit0 = 关键帧
+//   frameId (uint32)                 发送端递增的帧序号
+//   timestamp (uint32)               90kHz 采集时间戳（即 RTP 时间戳）
+//   frameSize (uint32)               整帧字节数
+//   fragOffset (uint32)              本分片数据在帧内的偏移
+//   fragIndex (uint16) fragCount (uint16)
+
+struct FrameHeader {
+    static constexpr uint8_t MAGIC = 0x56; // 'V'
+    static constexpr uint8_t VERSION = 1;
+    static constexpr size_t SIZE = 24;
+    static constexpr uint8_t FLAG_KEYFRAME = 0x01;
+
+    VideoCodec codec = VideoCodec::H264;
+    uint8_t flags = 0;
+    uint32_t frameId = 0;
+    uint32_t timestamp = 0;
+    uint32_t frameSize = 0;
+    uint32_t fragOffset = 0;
+    uint16_t fragIndex = 0;
+    uint16_t fragCount = 0;
+
+    bool isKeyFrame() const { return (flags & FLAG_KEYFRAME) != 0; }
+
+    void write(uint8_t* out) const;
+    // 校验 magic/版本/字段一致性，失败返回 false
+    bool read(const uint8_t* in, size_t size);
+};
+
+// 发送端：把一帧切成若干条消息，复用同一块缓冲区，每个分片不再单独分配内存
+class FrameFragmenter
+{
+public:
+    // 16KB 是各家 SCTP 实现都能保证的消息长度
+    static constexpr size_t DEFAULT_MAX_MESSAGE_SIZE = 16 * 1024;
+
+    using SendFn = std::function<bool(const std::byte* data, size_t size)>;
+
+    explicit FrameFragmenter(size_t maxMessageSize = DEFAULT_MAX_MESSAGE_SIZE);
+
+    // header 中的 frameSize/fragOffset/fragIndex/fragCount 由这里填写
+    // 返回发送的分片数，任一分片发送失败时返回 -1
+    int send(const uint8_t* data, size_t size, FrameHeader header, const SendFn& sendFn);
+
+    size_t maxPayloadSize() const { return m_buffer.size() - FrameHeader::SIZE; }
+
+private:
+    std::vector<std::byte> m_buffer;
+};
+
+// 接收端：按 frameId 重组分片
+// - 固定数量的槽位，缓冲区按帧大小增长后一直复用，稳定后不再分配内存
+// - 所有未完成帧占用的内存不超过 memoryBudget，超出时先淘汰最旧的帧
+// - 超过 deadlineMs 仍未收齐的帧被淘汰；较新的帧完成后，更旧的未完成帧也一并丢弃
+class FrameReassembler
+{
+public:
+    struct Config {
+        int maxPendingFrames = 8;
+        size_t memoryBudget = 8 * 1024 * 1024;
+        int64_t deadlineMs = 500;
+    };
+
+    struct Stats {
+        uint64_t completedFrames = 0;
+        uint64_t expiredFrames = 0;     // 超过期限被淘汰
+        uint64_t evictedFrames = 0;     // 因槽位/内存预算被淘汰，或被更新的帧取代
+        uint64_t droppedFragments = 0;  // 格式错误、过期帧或重复的分片
+    };
+
+    // 完整的一帧：data 指向内部缓冲区，仅在回调期间有效
+    using FrameFn = std::function<void(const FrameHeader& header, const uint8_t* data, size_t size)>;
+
+    FrameReassembler();
+    explicit FrameReassembler(const Config& config);
+
+    // nowMs 为单调时钟毫秒数
+    void push(const uint8_t* message, size_t size, int64_t nowMs, const FrameFn& onFrame);
+    // 淘汰超时帧（没有新消息到达时也可定期调用）
+    void expire(int64_t nowMs);
+    void reset();
+
+    const Stats& stats() const { return m_stats; }
+    size_t pendingBytes() const { return m_pendingBytes; }
+
+private:
+    struct Slot {
+        bool active = false;
+        FrameHeader header;
+        int64_t firstSeenMs = 0;
+        uint32_t receivedBytes = 0;
+        uint16_t receivedCount = 0;
+        std::vector<uint8_t> data;
+        std::vector<uint8_t> received; // 每个分片是否已到达
+    };
+
+    Slot* findSlot(uint32_t frameId);
+    Slot* acquireSlot(const FrameHeader& header, int64_t nowMs);
+    void release(Slot& slot);
+    void evictOlderThan(uint32_t frameId);
+
+    Config m_config;
+    std::vector<Slot> m_slots;
+    size_t m_pendingBytes = 0;
+    bool m_hasDelivered = false;
+    uint32_t m_lastDeliveredId = 0;
+    Stats m_stats;
+};
@@ -0,0 +1,114 @@
+#include "FrameSendQueue.hpp"
+#include <algorithm>
+
+FrameSendQueue::FrameSendQueue()
+    : FrameSendQueue(Config())
+{}
+
+FrameSendQueue::FrameSendQueue(const Config& config)
+    : m_config(config)
+{}
+
+void FrameSendQueue::setConfig(const Config& config)
+{
+    m_config = config;
+}
+
+void FrameSendQueue::clear()
+{
+    m_queue.clear();
+    m_paused = false;
+    m_waitKeyframe = false;
+    m_keyframeNeeded = false;
+}
+
+void FrameSendQueue::requireKeyframe()
+{
+    m_waitKeyframe = true;
+    m_keyframeNeeded = true;
+}
+
+void FrameSendQueue::push(EncodedFrame::Ptr frame, int64_t nowMs)
+{
+    if (!frame) return;
+    ++m_stats.queuedFrames;
+
+    // 关键帧可以独立解码，之前排队的帧都不用再发
+    if (frame->isKeyFrame()) {
+        m_stats.droppedSuperseded += m_queue.size();
+        m_queue.clear();
+    }
+    else if (static_cast<int>(m_queue.size()) >= std::max(1, m_config.maxQueuedFrames)) {
+        // 队列已满：丢掉最旧的一帧，由 pump() 负责请求关键帧
+        drop(m_queue.front(), m_stats.droppedStale);
+        m_queue.pop_front();
+    }
+    m_queue.push_back({ std::move(frame), nowMs });
+}
+
+void FrameSendQueue::drop(const Entry& entry, uint64_t& counter)
+{
+    ++counter;
+    // 无论丢的是关键帧还是 delta 帧，后续 delta 帧都引用不到了。
+    // 每次断链只请求一次关键帧；但如果丢的正是用于恢复的关键帧，需要再请求一次
+    if (!m_waitKeyframe || entry.frame->isKeyFrame()) {
+        m_waitKeyframe = true;
+        m_keyframeNeeded = true;
+    }
+}
+
+void FrameSendQueue::dropExpired(int64_t nowMs)
+{
+    while (!m_queue.empty() && nowMs - m_queue.front().enqueuedMs > m_config.deadlineMs) {
+        drop(m_queue.front(), m_stats.droppedStale);
+        m_queue.pop_front();
+    }
+}
+
+bool FrameSendQueue::pump(int64_t nowMs, const BufferedFn& buffered, const SendFn& send)
+{
+    while (!m_queue.empty()) {
+        const size_t amount = buffered ? buffered() : 0;
+        if (m_paused) {
+            if (amount > m_config.lowWatermark) break;
+            m_paused = false;
+        }
+        else if (amount >= m_config.highWatermark) {
+            m_paused = true;
+            ++m_stats.pausedCount;
+            break;
+        }
+
+        Entry entry = std::move(m_queue.front());
+        m_queue.pop_front();
+
+        if (nowMs - entry.enqueuedMs > m_config.deadlineMs) {
+            drop(entry, m_stats.droppedStale);
+            continue;
+        }
+        if (m_waitKeyframe && !entry.frame->isKeyFrame()) {
+            ++m_stats.droppedDependent;
+            continue;
+        }
+
+        send(entry.frame);
+        m_waitKeyframe = false;
+
+        const int64_t delay = nowMs - entry.enqueuedMs;
+        ++m_stats.sentFrames;
+        m_stats.lastQueueDelayMs = delay;
+        m_stats.maxQueueDelayMs = std::max(m_stats.maxQueueDelayMs, delay);
+        m_stats.totalQueueDelayMs += delay;
+    }
+
+    // 暂停期间也要清理过期帧，恢复发送时不会先发一批旧画面
+    if (m_paused) {
+        dropExpired(nowMs);
+    }
+
+    // 暂停期间请求的关键帧大概率也会过期，等缓冲排空后再请求
+    if (!m_keyframeNeeded || m_paused) return false;
+    m_keyframeNeeded = false;
+    ++m_stats.keyframeRequests;
+    return true;
+}
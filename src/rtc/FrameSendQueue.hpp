@@ -0,0 +1,83 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include "../encoder/EncodedFrame.h"
+
+// 发送端背压：编码输出先进入这里，再按传输层缓冲水位送出
+// - 传输缓冲超过高水位后暂停发送，降到低水位以下再恢复（滞回）
+// - 排队超过 deadline 还没送出的帧直接丢弃，而不是继续排队增加延迟
+// - 丢弃 delta 帧后参考链断开，后续 delta 帧一并丢弃，直到送出关键帧；
+//   pump() 返回 true 时调用方应向编码器请求关键帧
+// - 新的关键帧到达时，排在它前面的帧都已无意义，直接丢弃
+// 水位与 deadline 只在 DataChannel 模式下起作用：RTP 轨道没有发送缓冲，buffered 总是 0，
+// 帧入队后立即送出，队列只负责等待关键帧
+// 只在一个线程内使用（PeerConnectionManager 的主线程）
+class FrameSendQueue
+{
+public:
+    struct Config {
+        size_t highWatermark = 1024 * 1024;   // 传输层缓冲字节数上限
+        size_t lowWatermark = 256 * 1024;     // 恢复发送的水位
+        int64_t deadlineMs = 150;             // 帧在队列中的最长等待时间
+        int maxQueuedFrames = 30;
+    };
+
+    struct Stats {
+        uint64_t queuedFrames = 0;
+        uint64_t sentFrames = 0;
+        uint64_t droppedStale = 0;        // 超过 deadline
+        uint64_t droppedDependent = 0;    // 参考帧已丢弃，等待关键帧
+        uint64_t droppedSuperseded = 0;   // 被更新的关键帧取代
+        uint64_t keyframeRequests = 0;
+        uint64_t pausedCount = 0;         // 触发高水位的次数
+        int64_t lastQueueDelayMs = 0;     // 入队 -> 送出
+        int64_t maxQueueDelayMs = 0;
+        int64_t totalQueueDelayMs = 0;
+
+        double averageQueueDelayMs() const {
+            return sentFrames ? static_cast<double>(totalQueueDelayMs) / sentFrames : 0.0;
+        }
+    };
+
+    using BufferedFn = std::function<size_t()>;
+    using SendFn = std::function<void(const EncodedFrame::Ptr& frame)>;
+
+    FrameSendQueue();
+    explicit FrameSendQueue(const Config& config);
+
+    void setConfig(const Config& config);
+    const Config& config() const { return m_config; }
+
+    // nowMs 为单调时钟毫秒数
+    void push(EncodedFrame::Ptr frame, int64_t nowMs);
+
+    // 在水位允许的范围内尽量发送。返回 true 表示参考链已断开，需要向编码器请求关键帧
+    // （暂停期间不会返回 true，恢复发送后才请求）
+    bool pump(int64_t nowMs, const BufferedFn& buffered, const SendFn& send);
+
+    void clear();
+    // 对端从码流中途加入：送出关键帧之前丢弃 delta 帧，下一次 pump() 请求关键帧
+    void requireKeyframe();
+    size_t size() const { return m_queue.size(); }
+    bool isPaused() const { return m_paused; }
+    const Stats& stats() const { return m_stats; }
+
+private:
+    struct Entry {
+        EncodedFrame::Ptr frame;
+        int64_t enqueuedMs = 0;
+    };
+
+    // 丢弃一帧并进入等待关键帧状态
+    void drop(const Entry& entry, uint64_t& counter);
+    void dropExpired(int64_t nowMs);
+
+    Config m_config;
+    std::deque<Entry> m_queue;
+    bool m_paused = false;
+    bool m_waitKeyframe = false;    // 参考链已断开，只能发送关键帧
+    bool m_keyframeNeeded = false;  // 尚未通知调用方请求关键帧
+    Stats m_stats;
+};
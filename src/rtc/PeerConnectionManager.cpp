@@ -1,78 +1,626 @@
 #include "PeerConnectionManager.hpp"
 #include "../signaling/WsSignalingClient.hpp"
+#include "Av1RtpDepacketizer.hpp"
+#include "RtcpFeedback.hpp"
+#include <QJsonArray>
 #include <QJsonObject>
 #include <QJsonDocument>
 #include <QDebug>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <utility>
+
+// RTP 视频轨道参数
+static const char* VIDEO_TRACK_MID = "video";
+static const char* VIDEO_TRACK_CNAME = "video-stream";
+static const char* VIDEO_STREAM_ID = "shared-screen";
+static const char* VIDEO_CHANNEL_LABEL = "video-stream";
+static const char* TILE_CHANNEL_LABEL = "screen-tiles";
+static const int H264_PAYLOAD_TYPE = 96;
+static const int H265_PAYLOAD_TYPE = 97;
+static const int AV1_PAYLOAD_TYPE = 98;
+// DataChannel 模式下接收端请求关键帧的文本消息
+static const char* KEYFRAME_REQUEST_MESSAGE = "keyframe-request";
+// DataChannel 模式下接收端更新视口的文本消息：viewport:<宽>x<高>
+static const char* VIEWPORT_MESSAGE_PREFIX = "viewport:";
+// ICE 消息中发送方在这条连接里的角色（data.session）：共享者 / 观众
+static const char* ICE_SESSION_SHARE = "share";
+static const char* ICE_SESSION_VIEW = "view";
+// 带宽估计的采样周期
+static const int BWE_INTERVAL_MS = 200;
+// 发送统计日志间隔
+static const int64_t SEND_STATS_LOG_INTERVAL_MS = 5000;
+// SR（NTP <-> RTP 对应关系）发送间隔
+static const int64_t SENDER_REPORT_INTERVAL_MS = 1000;
+// 决定编码格式的第一个观众最多等待 answer 的时间，超时后关闭，让推迟的用户继续
+static const int CODEC_ANSWER_TIMEOUT_MS = 10000;
+
+// 块更新通道是可靠的，消息一定能收齐；整屏文字的无损数据可达数 MB，放宽内存预算和期限
+static FrameReassembler::Config tileReassemblerConfig()
+{
+    FrameReassembler::Config config;
+    config.memoryBudget = 32 * 1024 * 1024;
+    config.deadlineMs = 10000;
+    return config;
+}
+
+static int64_t steadyNowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 媒体时钟当前时刻的 NTP <-> RTP 对应关系
+static SenderReport currentSenderReport(const MediaClock& clock)
+{
+    const qint64 nowUs = clock.nowUs();
+    SenderReport report;
+    report.ntpTimestamp = ntpFromUnixUs(clock.wallClockUs(nowUs));
+    report.rtpTimestamp = MediaClock::rtpTimestamp(nowUs);
+    return report;
+}
+
+// 视频媒体中按顺序第一个属于 allowed 的编码格式
+static bool firstSupportedCodec(const rtc::Description::Media& media, const QList<VideoCodec>& allowed,
+    VideoCodec& codec, int& payloadType)
+{
+    for (int pt : media.payloadTypes()) {
+        const rtc::Description::Media::RtpMap* map = media.rtpMap(pt);
+        VideoCodec candidate;
+        if (map && videoCodecFromName(map->format, candidate) && allowed.contains(candidate)) {
+            codec = candidate;
+            payloadType = pt;
+            return true;
+        }
+    }
+    return false;
+}
+
+static rtc::Description::Media* findVideoMedia(rtc::Description& desc)
+{
+    for (int i = 0; i < desc.mediaCount(); ++i) {
+        auto entry = desc.media(i);
+        if (!std::holds_alternative<rtc::Description::Media*>(entry)) continue;
+        rtc::Description::Media* media = std::get<rtc::Description::Media*>(entry);
+        if (media->type() == "video") return media;
+    }
+    return nullptr;
+}
+
+static QJsonArray codecNames(const QList<VideoCodec>& codecs)
+{
+    QJsonArray names;
+    for (VideoCodec codec : codecs) {
+        names.append(QString::fromLatin1(videoCodecName(codec)));
+    }
+    return names;
+}
+
+static bool parseViewportMessage(const std::string& text, int& width, int& height)
+{
+    const std::string prefix(VIEWPORT_MESSAGE_PREFIX);
+    if (text.compare(0, prefix.size(), prefix) != 0) return false;
+    return std::sscanf(text.c_str() + prefix.size(), "%dx%d", &width, &height) == 2;
+}
+
+PeerConnectionManager::PeerSession::PeerSession(const QString& id, bool caller)
+    : peerId(id)
+    , isCaller(caller)
+    , tileReassembler(tileReassemblerConfig())
+{}
 
 PeerConnectionManager::PeerConnectionManager(QObject* parent)
     : QObject(parent)
     , m_ws(nullptr)
-    , m_pc(nullptr)
-    , m_videoChannel(nullptr)
-    , m_isCaller(false)
-{}
+    , m_transportMode(TransportMode::RtpTrack)
+{
+    m_bweTimer = new QTimer(this);
+    m_bweTimer->setInterval(BWE_INTERVAL_MS);
+    connect(m_bweTimer, &QTimer::timeout, this, &PeerConnectionManager::updateBandwidthEstimate);
+    // 缓冲超过高水位后没有新帧也要定期检查，及时恢复发送、清理过期帧
+    connect(m_bweTimer, &QTimer::timeout, this, &PeerConnectionManager::pumpSendQueues);
+    connect(m_bweTimer, &QTimer::timeout, this, &PeerConnectionManager::sendSenderReports);
+    m_sendClock.start();
+}
 
 PeerConnectionManager::~PeerConnectionManager()
 {}
 
+void PeerConnectionManager::setMediaClock(MediaClock::Ptr clock)
+{
+    m_mediaClock = std::move(clock);
+}
+
+void PeerConnectionManager::setTransportMode(TransportMode mode)
+{
+    m_transportMode = mode;
+}
+
+PeerConnectionManager::TransportMode PeerConnectionManager::transportMode() const
+{
+    return m_transportMode;
+}
+
+void PeerConnectionManager::setVideoCodecPreferences(const QList<VideoCodec>& codecs)
+{
+    if (!codecs.isEmpty()) m_sendCodecs = codecs;
+}
+
+void PeerConnectionManager::setDecodableVideoCodecs(const QList<VideoCodec>& codecs)
+{
+    if (!codecs.isEmpty()) m_decodableCodecs = codecs;
+}
+
+VideoCodec PeerConnectionManager::videoCodec() const
+{
+    return m_videoCodec;
+}
+
+void PeerConnectionManager::setSimulcastLayers(const QVector<SimulcastLayer>& layers)
+{
+    m_simulcastLayers = layers;
+    for (const SessionPtr& peer : std::as_const(m_viewers)) {
+        peer->layerSelector.setLayers(layers);
+    }
+}
+
+void PeerConnectionManager::setViewportSize(int width, int height)
+{
+    if (width == m_viewportWidth && height == m_viewportHeight) return;
+    m_viewportWidth = width;
+    m_viewportHeight = height;
+    sendViewport();
+}
+
+void PeerConnectionManager::sendViewport()
+{
+    if (m_viewportWidth <= 0 || m_viewportHeight <= 0) return;
+    if (!m_presenter || !m_presenter->videoChannel || !m_presenter->videoChannel->isOpen()) return;
+    m_presenter->videoChannel->send(std::string(VIEWPORT_MESSAGE_PREFIX) +
+        std::to_string(m_viewportWidth) + "x" + std::to_string(m_viewportHeight));
+}
+
+QList<VideoCodec> PeerConnectionManager::offerCodecs() const
+{
+    for (const SessionPtr& peer : m_viewers) {
+        if (peer->codecNegotiated) return { m_videoCodec };
+    }
+    return m_sendCodecs;
+}
+
+bool PeerConnectionManager::codecPending() const
+{
+    bool pending = false;
+    for (const SessionPtr& peer : m_viewers) {
+        if (peer->codecNegotiated) return false;
+        if (peer->offeredCodecs.size() > 1) pending = true;
+    }
+    return pending;
+}
+
+void PeerConnectionManager::startDeferredViewers()
+{
+    const QStringList deferred = std::exchange(m_deferredViewers, QStringList());
+    for (const QString& peerId : deferred) {
+        // 等待期间离开的用户不再连接；格式仍未确定时 start 会再次推迟
+        if (m_sharing && m_peers.contains(peerId)) start(peerId);
+    }
+}
+
+void PeerConnectionManager::setSendCodec(const SessionPtr& peer, VideoCodec codec)
+{
+    peer->videoCodec = codec;
+    peer->codecNegotiated = true;
+    for (const SessionPtr& other : std::as_const(m_viewers)) {
+        if (other == peer || !other->codecNegotiated) continue;
+        // 编码器正在为其他观众工作，格式不能再变；对端不支持时收不到视频（sendEncodedFrame 按格式过滤）
+        if (codec != m_videoCodec) {
+            WARNING() << "Viewer" << peer->peerId << "negotiated" << videoCodecName(codec)
+                << "but the encoder is running" << videoCodecName(m_videoCodec);
+        }
+        return;
+    }
+    m_videoCodec = codec;
+    qDebug() << "Negotiated video codec:" << videoCodecName(codec);
+    emit videoCodecNegotiated(codec);
+    // 在 answer 处理完之后再向其他用户发 offer
+    if (!m_deferredViewers.isEmpty()) {
+        QMetaObject::invokeMethod(this, [this]() { startDeferredViewers(); }, Qt::QueuedConnection);
+    }
+}
+
+PeerConnectionManager::SessionPtr PeerConnectionManager::createSession(const QString& peerId, bool caller)
+{
+    auto peer = std::make_shared<PeerSession>(peerId, caller);
+    peer->transportMode = m_transportMode;
+    peer->sendQueue.setConfig(m_sendQueueConfig);
+    peer->layerSelector.setLayers(m_simulcastLayers);
+    return peer;
+}
+
+PeerConnectionManager::SessionPtr PeerConnectionManager::viewer(const QString& peerId) const
+{
+    return m_viewers.value(peerId);
+}
+
+PeerConnectionManager::SessionPtr PeerConnectionManager::current(const WeakSession& weak) const
+{
+    SessionPtr peer = weak.lock();
+    if (!peer) return nullptr;
+    const bool alive = peer->isCaller ? m_viewers.value(peer->peerId) == peer : m_presenter == peer;
+    return alive ? peer : nullptr;
+}
+
 void PeerConnectionManager::start(const QString& targetId)
 {
-    m_targetPeerId = targetId;
-    m_isCaller = true;
-    createPeerConnection();
-    setupDataChannel(); // the user who send the offer must establish DataChannel
-    // sendtest();
+    if (targetId.isEmpty() || targetId == m_myId || m_viewers.contains(targetId)) return;
+    if (codecPending()) {
+        if (!m_deferredViewers.contains(targetId)) m_deferredViewers.append(targetId);
+        qDebug() << "Viewer" << targetId << "waits for the video codec to be negotiated";
+        return;
+    }
+
+    SessionPtr peer = createSession(targetId, true);
+    peer->offeredCodecs = offerCodecs();
+    m_viewers.insert(targetId, peer);
+    qDebug() << "Connecting viewer" << targetId << "," << m_viewers.size() << "viewers";
+
+    if (peer->offeredCodecs.size() > 1) {
+        // 这个观众的 answer 决定编码格式：迟迟不回复时关闭，不让推迟的用户一直等下去
+        const WeakSession weak = peer;
+        QTimer::singleShot(CODEC_ANSWER_TIMEOUT_MS, this, [this, weak]() {
+            SessionPtr pending = current(weak);
+            if (!pending || pending->codecNegotiated || m_deferredViewers.isEmpty()) return;
+            WARNING() << "Viewer" << pending->peerId << "did not answer in time, closing";
+            closeViewer(pending->peerId);
+            });
+    }
+
+    createPeerConnection(peer);
+    // 块更新通道与传输方式无关，要在生成 offer 之前建立
+    setupTileChannel(peer);
+    if (peer->transportMode == TransportMode::RtpTrack) {
+        setupVideoTrack(peer);
+    }
+    else {
+        setupDataChannel(peer); // the user who send the offer must establish DataChannel
+    }
+}
+
+void PeerConnectionManager::startSharing()
+{
+    m_sharing = true;
+    for (const QString& peerId : std::as_const(m_peers)) {
+        start(peerId);
+    }
+}
+
+void PeerConnectionManager::stopSharing()
+{
+    m_sharing = false;
+    m_deferredViewers.clear();
+    const QStringList viewers = m_viewers.keys();
+    for (const QString& peerId : viewers) {
+        closeViewer(peerId);
+    }
+}
+
+void PeerConnectionManager::closeViewer(const QString& peerId)
+{
+    SessionPtr peer = m_viewers.take(peerId);
+    if (!peer) return;
+    closeSession(peer);
+    qDebug() << "Viewer" << peerId << "closed," << m_viewers.size() << "viewers left";
+    emit viewerDisconnected(peerId);
+    // 带宽最差的观众离开后编码码率可以回升
+    updateTargetBitrate();
+    // 决定编码格式的观众没有回复就离开了，由推迟的用户中的下一个决定
+    if (!codecPending()) startDeferredViewers();
+}
+
+void PeerConnectionManager::closePresenter()
+{
+    if (!m_presenter) return;
+    SessionPtr peer = std::move(m_presenter);
+    closeSession(peer);
+    emit p2pDisconnected();
 }
 
-void PeerConnectionManager::createPeerConnection()
+void PeerConnectionManager::closeSession(const SessionPtr& peer)
+{
+    if (peer->isCaller) stopBandwidthEstimation(peer);
+    // 会话已从表中移除，close() 触发的回调切回主线程后会被忽略
+    if (peer->pc) peer->pc->close();
+}
+
+int PeerConnectionManager::viewerCount() const
+{
+    return static_cast<int>(m_viewers.size());
+}
+
+void PeerConnectionManager::createPeerConnection(const SessionPtr& peer)
 {
     rtc::Configuration config;
 
-    m_pc = std::make_shared<rtc::PeerConnection>(config);
+    peer->pc = std::make_shared<rtc::PeerConnection>(config);
+    const WeakSession weak = peer;
+    const QString peerId = peer->peerId;
+    // ICE 消息带上本端在这条连接中的角色，对端据此区分同一用户的共享 / 观看两条连接
+    const QString role = QString::fromLatin1(peer->isCaller ? ICE_SESSION_SHARE : ICE_SESSION_VIEW);
 
     // 1. Status monitoring
-    m_pc->onStateChange([this](rtc::PeerConnection::State state) {
-        QMetaObject::invokeMethod(this, [this, state]() {
+    peer->pc->onStateChange([this, weak](rtc::PeerConnection::State state) {
+        QMetaObject::invokeMethod(this, [this, weak, state]() {
+            SessionPtr peer = current(weak);
+            if (!peer) return;
             if (state == rtc::PeerConnection::State::Connected) {
-                qDebug() << "P2P handshaking successfully!";
+                qDebug() << "P2P handshaking successfully with" << peer->peerId;
             }
             else if (state == rtc::PeerConnection::State::Disconnected ||
-                state == rtc::PeerConnection::State::Failed) {
-                emit p2pDisconnected();
+                state == rtc::PeerConnection::State::Failed ||
+                state == rtc::PeerConnection::State::Closed) {
+                // 只关闭这一条连接，其他观众不受影响
+                if (peer->isCaller) closeViewer(peer->peerId);
+                else closePresenter();
             }
             });
         });
 
     // 2. ICE Exchange
-    m_pc->onLocalCandidate([this](rtc::Candidate cand) {
+    peer->pc->onLocalCandidate([this, peerId, role](rtc::Candidate cand) {
         QJsonObject data;
         data["candidate"] = QString::fromStdString(cand.candidate());
         data["sdpMid"] = QString::fromStdString(cand.mid());
-        sendSignalingMessage(stype_to_string(SignalingType::ICE), m_targetPeerId, data);
+        data["session"] = role;
+        sendSignalingMessage(stype_to_string(SignalingType::ICE), peerId, data);
         });
 
     // 3. SDP Exchange (Generate Offer/Answer)
-    m_pc->onLocalDescription([this](rtc::Description desc) {
+    peer->pc->onLocalDescription([this, weak](rtc::Description desc) {
+        SessionPtr peer = weak.lock();
+        if (!peer) return;
         QJsonObject data;
         data["sdp"] = QString::fromStdString(desc);
+        // DataChannel 模式的 SDP 里没有视频媒体，编码格式随 offer/answer 消息协商
+        if (desc.type() == rtc::Description::Type::Offer && peer->transportMode == TransportMode::DataChannel) {
+            data["videoCodecs"] = codecNames(peer->offeredCodecs);
+        }
+        else if (desc.type() == rtc::Description::Type::Answer && peer->answerWithCodec) {
+            data["videoCodec"] = QString::fromLatin1(videoCodecName(peer->videoCodec));
+        }
+        // 接收端的显示区域，发送端据此选择 simulcast 层
+        if (desc.type() == rtc::Description::Type::Answer && m_viewportWidth > 0 && m_viewportHeight > 0) {
+            QJsonObject viewport;
+            viewport["width"] = m_viewportWidth;
+            viewport["height"] = m_viewportHeight;
+            data["viewport"] = viewport;
+        }
         QString type = (desc.type() == rtc::Description::Type::Offer) ? 
             stype_to_string(SignalingType::OFFER) : stype_to_string(SignalingType::ANSWER);
-        sendSignalingMessage(type, m_targetPeerId, data);
+        sendSignalingMessage(type, peer->peerId, data);
         });
 
     // 4. Peer bind DataChannel
-    m_pc->onDataChannel([this](std::shared_ptr<rtc::DataChannel> dc) {
+    peer->pc->onDataChannel([this, weak](std::shared_ptr<rtc::DataChannel> dc) {
+        SessionPtr peer = weak.lock();
+        if (!peer) return;
         // Recv the established channel
-        if (dc->label() == "video-stream") {
-            bindDataChannel(dc);
+        if (dc->label() == VIDEO_CHANNEL_LABEL) {
+            bindDataChannel(peer, dc);
+        }
+        else if (dc->label() == TILE_CHANNEL_LABEL) {
+            bindTileChannel(peer, dc);
+        }
+        });
+
+    // 5. Peer bind video track
+    peer->pc->onTrack([this, weak](std::shared_ptr<rtc::Track> track) {
+        SessionPtr peer = weak.lock();
+        if (peer && track->description().type() == "video") {
+            bindReceiveTrack(peer, track);
+        }
+        });
+}
+
+void PeerConnectionManager::setupVideoTrack(const SessionPtr& peer)
+{
+    if (!peer->pc) {
+        WARNING() << "PeerConnection has not been created!";
+        return;
+    }
+
+    std::random_device rd;
+    peer->videoSsrc = static_cast<rtc::SSRC>(rd());
+
+    // 只发送的视频轨道，按偏好顺序列出能编码的格式，SDP 中带 nack / nack pli 反馈
+    // 发送链要等 answer 确定格式后再建立（bindSendTrack）
+    rtc::Description::Video media(VIDEO_TRACK_MID, rtc::Description::Direction::SendOnly);
+    for (VideoCodec codec : peer->offeredCodecs) {
+        switch (codec) {
+        case VideoCodec::H264: media.addH264Codec(H264_PAYLOAD_TYPE); break;
+        case VideoCodec::H265: media.addH265Codec(H265_PAYLOAD_TYPE); break;
+        case VideoCodec::AV1: media.addAV1Codec(AV1_PAYLOAD_TYPE); break;
         }
+    }
+    media.addSSRC(peer->videoSsrc, VIDEO_TRACK_CNAME, VIDEO_STREAM_ID, VIDEO_TRACK_CNAME);
+    peer->videoTrack = peer->pc->addTrack(media);
+
+    const WeakSession weak = peer;
+    peer->videoTrack->onOpen([this, weak]() {
+        qDebug("video track open successfully!");
+        QMetaObject::invokeMethod(this, [this, weak]() {
+            SessionPtr peer = current(weak);
+            if (!peer) return;
+            startBandwidthEstimation(peer);
+            emit viewerConnected(peer->peerId);
+            emit videoTransportOpened();
+            });
+        });
+
+    peer->videoTrack->onClosed([this, weak]() {
+        QMetaObject::invokeMethod(this, [this, weak]() {
+            if (SessionPtr peer = current(weak)) stopBandwidthEstimation(peer);
+            });
+        });
+
+    // 添加轨道不会自动触发协商，需要手动生成 offer
+    peer->pc->setLocalDescription();
+}
+
+void PeerConnectionManager::bindSendTrack(const SessionPtr& peer, const rtc::Description& answer)
+{
+    if (!peer->videoTrack) return;
+
+    // 接收端只保留了能解码的格式，取其中第一个本端也能编码的；对端没有给出可用格式时按 H.264 发送
+    rtc::Description remote = answer;
+    VideoCodec codec = VideoCodec::H264;
+    int payloadType = H264_PAYLOAD_TYPE;
+    const rtc::Description::Media* media = findVideoMedia(remote);
+    if (!media || !firstSupportedCodec(*media, peer->offeredCodecs, codec, payloadType)) {
+        WARNING() << "No common video codec in answer, falling back to H264";
+    }
+    setSendCodec(peer, codec);
+
+    // 发送链：打包 -> RTCP SR -> NACK 重传缓存；PLI/FIR 触发关键帧
+    // 编码器的时间基就是 90kHz，sendFrame 时直接使用帧的 RTP 时间戳（媒体时钟的采集时刻）
+    // 每个观众的轨道各自打包，NACK 重传缓存也各自独立
+    const rtc::SSRC ssrc = peer->videoSsrc;
+    peer->rtpConfig = std::make_shared<rtc::RtpPacketizationConfig>(
+        ssrc, VIDEO_TRACK_CNAME, static_cast<uint8_t>(payloadType), rtc::RtpPacketizer::VideoClockRate);
+    std::shared_ptr<rtc::RtpPacketizer> packetizer;
+    switch (codec) {
+    case VideoCodec::H264:
+        packetizer = std::make_shared<rtc::H264RtpPacketizer>(rtc::NalUnit::Separator::StartSequence, peer->rtpConfig);
+        break;
+    case VideoCodec::H265:
+        packetizer = std::make_shared<rtc::H265RtpPacketizer>(rtc::NalUnit::Separator::StartSequence, peer->rtpConfig);
+        break;
+    case VideoCodec::AV1:
+        // 编码器输出的是整个时间单元（带 obu_size 的 OBU 序列）
+        packetizer = std::make_shared<rtc::AV1RtpPacketizer>(
+            rtc::AV1RtpPacketizer::Packetization::TemporalUnit, peer->rtpConfig);
+        break;
+    }
+    peer->videoTrack->setMediaHandler(packetizer);
+    if (m_mediaClock) {
+        // SR 的 NTP/RTP 对与帧时间戳同源，接收端可以换算出每帧的采集时刻
+        MediaClock::Ptr clock = m_mediaClock;
+        peer->videoTrack->chainMediaHandler(std::make_shared<MediaClockSrReporter>(ssrc, [clock]() {
+            return currentSenderReport(*clock);
+            }));
+    }
+    else {
+        peer->videoTrack->chainMediaHandler(std::make_shared<rtc::RtcpSrReporter>(peer->rtpConfig));
+    }
+    peer->videoTrack->chainMediaHandler(std::make_shared<rtc::RtcpNackResponder>());
+    const WeakSession weak = peer;
+    peer->videoTrack->chainMediaHandler(std::make_shared<rtc::PliHandler>([this, weak]() {
+        QMetaObject::invokeMethod(this, [this, weak]() {
+            if (SessionPtr peer = current(weak)) {
+                emit keyframeRequested(peer->layerSelector.keyframeLayer());
+            }
+            });
+        }));
+    // 接收端的 REMB 作为该观众的码率上限
+    peer->videoTrack->chainMediaHandler(std::make_shared<rtc::RembHandler>([this, weak](unsigned int bitrate) {
+        QMetaObject::invokeMethod(this, [this, weak, bitrate]() {
+            SessionPtr peer = current(weak);
+            if (peer && peer->bweClock.isValid()) {
+                peer->bwe.onRemb(bitrate, peer->bweClock.elapsed());
+            }
+            });
+        }));
+    // RR 的丢包率与 RTT、送出的 RTP 字节数是轨道模式下带宽估计的输入（SCTP 的统计不包含 RTP）
+    // RTT 用 RR 回显的 SR 时间计算，当前时刻要与 SR 的 NTP 时间同源
+    SenderFeedbackMonitor::NtpNowFn ntpNow;
+    if (m_mediaClock) {
+        MediaClock::Ptr clock = m_mediaClock;
+        ntpNow = [clock]() { return currentSenderReport(*clock).ntpTimestamp; };
+    }
+    else {
+        ntpNow = []() {
+            return ntpFromUnixUs(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count());
+        };
+    }
+    peer->feedback = std::make_shared<SenderFeedbackMonitor>(ssrc, std::move(ntpNow),
+        [this, weak](const SenderFeedbackMonitor::Report& report) {
+            QMetaObject::invokeMethod(this, [this, weak, report]() {
+                SessionPtr peer = current(weak);
+                if (!peer || !peer->bweClock.isValid()) return;
+                const int64_t nowMs = peer->bweClock.elapsed();
+                peer->bwe.onLoss(report.fractionLost, nowMs);
+                peer->bwe.onRtt(report.rttMs, nowMs);
+                });
+        });
+    peer->videoTrack->chainMediaHandler(peer->feedback);
+}
+
+void PeerConnectionManager::bindReceiveTrack(const SessionPtr& peer, std::shared_ptr<rtc::Track> track)
+{
+    peer->videoTrack = track;
+
+    // 处理 offer 时已去掉不能解码的格式，第一个就是发送端将要使用的格式
+    VideoCodec codec = peer->videoCodec;
+    int payloadType = 0;
+    firstSupportedCodec(track->description(), m_decodableCodecs, codec, payloadType);
+
+    // 接收链：RTP 解包为 Annex-B access unit / AV1 时间单元，RtcpReceivingSession 负责 RR 和 PLI
+    switch (codec) {
+    case VideoCodec::H264:
+        track->setMediaHandler(std::make_shared<rtc::H264RtpDepacketizer>(
+            rtc::NalUnit::Separator::LongStartSequence));
+        break;
+    case VideoCodec::H265:
+        track->setMediaHandler(std::make_shared<rtc::H265RtpDepacketizer>(
+            rtc::NalUnit::Separator::LongStartSequence));
+        break;
+    case VideoCodec::AV1:
+        track->setMediaHandler(std::make_shared<Av1RtpDepacketizer>());
+        break;
+    }
+    track->chainMediaHandler(std::make_shared<rtc::RtcpReceivingSession>());
+    // 接收链上的 RTCP 自链尾向前处理，SR 观察者要放在 RtcpReceivingSession 之后才能看到 SR
+    track->chainMediaHandler(std::make_shared<SenderReportObserver>([this](const SenderReport& report) {
+        emit senderReportReceived(report.ntpTimestamp, report.rtpTimestamp);
+        }));
+
+    // 按接收速率和丢包率估计码率上限，经 RtcpReceivingSession 以 REMB 发给发送端
+    const WeakSession weak = peer;
+    peer->remb.reset();
+    track->chainMediaHandler(std::make_shared<ReceiveStatsMonitor>([this, weak](const ReceiveStatsMonitor::Stats& stats) {
+        QMetaObject::invokeMethod(this, [this, weak, stats]() {
+            SessionPtr peer = current(weak);
+            if (!peer || !peer->videoTrack) return;
+            if (peer->remb.onReceiveStats(stats.bitrate, stats.fractionLost, m_sendClock.elapsed())) {
+                qDebug() << "Requesting bitrate" << peer->remb.bitrate() << "receive rate" << stats.bitrate
+                    << "loss" << stats.fractionLost;
+                peer->videoTrack->requestBitrate(static_cast<unsigned int>(peer->remb.bitrate()));
+            }
+            });
+        }));
+
+    track->onOpen([this, weak]() {
+        qDebug("video track open successfully!");
+        QMetaObject::invokeMethod(this, [this, weak]() {
+            if (current(weak)) emit p2pConnected();
+            });
+        });
+
+    track->onFrame([this](rtc::binary data, rtc::FrameInfo info) {
+        // 直接在网络线程发射，接收方用 DirectConnection 可以省掉一次到主线程的中转
+        QByteArray qData(reinterpret_cast<const char*>(data.data()), data.size());
+        emit encodedFrameReceived(qData, info.timestamp);
         });
 }
 
-void PeerConnectionManager::setupDataChannel()
+void PeerConnectionManager::setupDataChannel(const SessionPtr& peer)
 {
-    if (!m_pc) {
-        WARNING() << "Datachannel has already builed!";
+    if (!peer->pc) {
+        WARNING() << "PeerConnection has not been created!";
+        return;
     }
 
     rtc::DataChannelInit initConf;
@@ -80,27 +628,78 @@ void PeerConnectionManager::setupDataChannel()
     initConf.reliability.rexmit = 0;
     initConf.reliability.unordered = false;
 
-    auto dc = m_pc->createDataChannel("video-stream", initConf);
-    bindDataChannel(dc);
+    auto dc = peer->pc->createDataChannel(VIDEO_CHANNEL_LABEL, initConf);
+    bindDataChannel(peer, dc);
 }
 
-void PeerConnectionManager::bindDataChannel(std::shared_ptr<rtc::DataChannel> dc)
+void PeerConnectionManager::bindDataChannel(const SessionPtr& peer, std::shared_ptr<rtc::DataChannel> dc)
 {
-    m_videoChannel = dc;
+    peer->videoChannel = dc;
+    peer->reassembler.reset();
+    peer->sendFrameId = 0;
+    const WeakSession weak = peer;
 
-    m_videoChannel->onOpen([this]() {
+    // 发送缓冲降到低水位时立即恢复发送，并重新估计让码率尽快回升
+    dc->setBufferedAmountLowThreshold(peer->sendQueue.config().lowWatermark);
+    dc->onBufferedAmountLow([this, weak]() {
+        QMetaObject::invokeMethod(this, [this, weak]() {
+            SessionPtr peer = current(weak);
+            if (!peer) return;
+            pumpSendQueue(peer);
+            estimateBandwidth(peer);
+            updateTargetBitrate();
+            });
+        });
+
+    dc->onOpen([this, weak]() {
         qDebug("datachannel open successfully!");
-        if(m_isCaller) sendtest();    
-        QMetaObject::invokeMethod(this, [this]() {
-            emit p2pConnected();
-            if(m_isCaller) emit dataChannelOpened();
+        SessionPtr peer = weak.lock();
+        if (!peer) return;
+        if (peer->isCaller) sendtest(peer);
+        QMetaObject::invokeMethod(this, [this, weak]() {
+            SessionPtr peer = current(weak);
+            if (!peer) return;
+            if (peer->isCaller) {
+                emit dataChannelOpened();
+                startBandwidthEstimation(peer);
+                emit viewerConnected(peer->peerId);
+                emit videoTransportOpened();
+            }
+            else {
+                emit p2pConnected();
+            }
             });
         });
 
-    m_videoChannel->onMessage([this](std::variant<rtc::binary, rtc::string> data) {
+    dc->onMessage([this, weak](std::variant<rtc::binary, rtc::string> data) {
         // 文本消息
         if (std::holds_alternative<rtc::string>(data)) {
             auto &str = std::get<rtc::string>(data);
+            if (str == KEYFRAME_REQUEST_MESSAGE) {
+                // 接收端解码失败，请求关键帧（DataChannel 模式没有 RTCP PLI）
+                QMetaObject::invokeMethod(this, [this, weak]() {
+                    if (SessionPtr peer = current(weak)) {
+                        emit keyframeRequested(peer->layerSelector.keyframeLayer());
+                    }
+                    });
+                return;
+            }
+            int width = 0;
+            int height = 0;
+            if (parseViewportMessage(str, width, height)) {
+                // 接收端窗口大小变化，重新选择 simulcast 层
+                QMetaObject::invokeMethod(this, [this, weak, width, height]() {
+                    if (SessionPtr peer = current(weak)) {
+                        peer->layerSelector.setViewport(width, height, m_sendClock.elapsed());
+                    }
+                    });
+                return;
+            }
+            SenderReport report;
+            if (parseSenderReport(str, report)) {
+                emit senderReportReceived(report.ntpTimestamp, report.rtpTimestamp);
+                return;
+            }
             qDebug() << "Callee received text:" << QString::fromStdString(str);
 
             // 比如这里你可�? emit 信号，通知 UI 显示消息
@@ -108,16 +707,53 @@ void PeerConnectionManager::bindDataChannel(std::shared_ptr<rtc::DataChannel> dc
         }
 
         if (std::holds_alternative<rtc::binary>(data)) {
+            SessionPtr peer = weak.lock();
+            if (!peer) return;
             auto& binData = std::get<rtc::binary>(data);
 
-            QByteArray qData(reinterpret_cast<const char*>(binData.data()), binData.size());
+            // 每条消息是一帧的一个分片，收齐后才交给上层
+            // onMessage 对同一通道是串行回调的，重组器只在这里访问
+            const int64_t nowMs = steadyNowMs();
+            peer->reassembler.push(reinterpret_cast<const uint8_t*>(binData.data()), binData.size(), nowMs,
+                [this](const FrameHeader& header, const uint8_t* frame, size_t size) {
+                    QByteArray qData(reinterpret_cast<const char*>(frame), static_cast<int>(size));
+                    emit encodedFrameReceived(qData, header.timestamp);
+                });
+        }
+        });
+}
 
-            qDebug() << "received qData:" << qData.toHex(' ');
+void PeerConnectionManager::setupTileChannel(const SessionPtr& peer)
+{
+    if (!peer->pc) return;
 
-            // QMetaObject::invokeMethod(this, [this, qData]() {
-            //     emit encodedFrameReceived(qData);
-            //     });
-        }
+    // 默认即可靠有序
+    auto dc = peer->pc->createDataChannel(TILE_CHANNEL_LABEL);
+    bindTileChannel(peer, dc);
+}
+
+void PeerConnectionManager::bindTileChannel(const SessionPtr& peer, std::shared_ptr<rtc::DataChannel> dc)
+{
+    peer->tileChannel = dc;
+    peer->tileReassembler.reset();
+    const WeakSession weak = peer;
+
+    dc->onOpen([this, weak]() {
+        QMetaObject::invokeMethod(this, [this, weak]() {
+            SessionPtr peer = current(weak);
+            if (peer && peer->isCaller) emit tileChannelOpened();
+            });
+        });
+
+    dc->onMessage([this, weak](std::variant<rtc::binary, rtc::string> data) {
+        if (!std::holds_alternative<rtc::binary>(data)) return;
+        SessionPtr peer = weak.lock();
+        if (!peer) return;
+        auto& binData = std::get<rtc::binary>(data);
+        peer->tileReassembler.push(reinterpret_cast<const uint8_t*>(binData.data()), binData.size(), steadyNowMs(),
+            [this](const FrameHeader&, const uint8_t* message, size_t size) {
+                emit tileUpdateReceived(QByteArray(reinterpret_cast<const char*>(message), static_cast<int>(size)));
+            });
         });
 }
 
@@ -132,35 +768,113 @@ void PeerConnectionManager::handleSignalingMessage(const QJsonObject& json)
         if (type == SignalingType::REGISTER_SUCCESS) {
             m_myId = data["peerId"].toString();
             qDebug() << "My ID:" << m_myId;
+            m_peers.clear();
+            for (const QJsonValue& value : data["peers"].toArray()) {
+                const QString peerId = value.toString();
+                if (!peerId.isEmpty() && peerId != m_myId) m_peers.append(peerId);
+            }
             emit peersList(data["peers"].toArray());
         }
         else if (type == SignalingType::PEER_JOINED) {
             emit peerJoined(data["id"].toString());
         }
+        else if (type == SignalingType::PEER_LEFT) {
+            const QString peerId = data["id"].toString();
+            m_peers.removeAll(peerId);
+            closeViewer(peerId);
+            if (m_presenter && m_presenter->peerId == peerId) closePresenter();
+        }
         else if (type == SignalingType::OFFER) {
             m_targetPeerId = from;
-            m_isCaller = false;
 
-            if (!m_pc) {   // �? 只在没有 PC 时才创建一�?
-                createPeerConnection();
-            }
+            // 一次只观看一个共享者：新的 offer（包括同一共享者重新共享）取代之前的连接
+            closePresenter();
+            m_presenter = createSession(from, false);
+            createPeerConnection(m_presenter);
+            const SessionPtr& peer = m_presenter;
 
             // set remote Offer
             std::string sdp = data["sdp"].toString().toStdString();
-            m_pc->setRemoteDescription(rtc::Description(sdp, rtc::Description::Type::Offer));
+            rtc::Description offer(sdp, rtc::Description::Type::Offer);
+
+            // 编码协商：轨道模式从 SDP 中去掉不能解码的格式，answer 会原样保留剩下的；
+            // DataChannel 模式从 offer 消息的格式列表里选择，并在 answer 中告知
+            VideoCodec codec = VideoCodec::H264;
+            int payloadType = 0;
+            peer->answerWithCodec = data.contains("videoCodecs");
+            if (rtc::Description::Media* video = findVideoMedia(offer)) {
+                for (int pt : video->payloadTypes()) {
+                    const rtc::Description::Media::RtpMap* map = video->rtpMap(pt);
+                    VideoCodec candidate;
+                    if (!map || !videoCodecFromName(map->format, candidate) ||
+                        !m_decodableCodecs.contains(candidate)) {
+                        video->removeRtpMap(pt);
+                    }
+                }
+                if (!firstSupportedCodec(*video, m_decodableCodecs, codec, payloadType)) {
+                    WARNING() << "No decodable video codec in offer";
+                }
+            }
+            else if (peer->answerWithCodec) {
+                std::vector<VideoCodec> offered;
+                for (const QJsonValue& name : data["videoCodecs"].toArray()) {
+                    VideoCodec candidate;
+                    if (videoCodecFromName(name.toString().toStdString(), candidate)) offered.push_back(candidate);
+                }
+                const std::vector<VideoCodec> decodable(m_decodableCodecs.begin(), m_decodableCodecs.end());
+                if (!negotiateVideoCodec(offered, decodable, codec)) {
+                    WARNING() << "No decodable video codec in offer, falling back to H264";
+                    codec = VideoCodec::H264;
+                }
+            }
+            peer->videoCodec = codec;
+            peer->codecNegotiated = true;
+            qDebug() << "Negotiated receive video codec:" << videoCodecName(codec);
+            emit receiveVideoCodecNegotiated(codec);
+            peer->pc->setRemoteDescription(offer);
 
             // automatically generate Answer (libdatachannel when recv setRemoteDescription)
             // setLocalDescription will callback onLocalDescription to send Answer
             // Peer will recv DataChannel in signaling
         }
         else if (type == SignalingType::ANSWER) {
+            SessionPtr peer = viewer(from);
+            if (!peer) {
+                WARNING() << "Answer from" << from << "without a pending offer";
+                return;
+            }
             std::string sdp = data["sdp"].toString().toStdString();
-            m_pc->setRemoteDescription(rtc::Description(sdp, rtc::Description::Type::Answer));
+            rtc::Description answer(sdp, rtc::Description::Type::Answer);
+            const QJsonObject viewport = data["viewport"].toObject();
+            peer->layerSelector.setViewport(viewport["width"].toInt(), viewport["height"].toInt(),
+                m_sendClock.elapsed());
+            if (peer->transportMode == TransportMode::RtpTrack) {
+                bindSendTrack(peer, answer);
+            }
+            else {
+                // 对端没有回复格式（旧版本）时按 H.264 发送
+                VideoCodec codec = VideoCodec::H264;
+                if (!videoCodecFromName(data["videoCodec"].toString().toStdString(), codec) ||
+                    !peer->offeredCodecs.contains(codec)) {
+                    codec = VideoCodec::H264;
+                }
+                setSendCodec(peer, codec);
+            }
+            peer->pc->setRemoteDescription(answer);
         }
         else if (type == SignalingType::ICE) {
+            // 对端是共享者时属于观看连接，否则属于共享给它的连接；旧版本不带角色，优先共享连接
+            const QString role = data["session"].toString();
+            const SessionPtr presenter = (m_presenter && m_presenter->peerId == from) ? m_presenter : nullptr;
+            SessionPtr peer;
+            if (role == ICE_SESSION_SHARE) peer = presenter;
+            else if (role == ICE_SESSION_VIEW) peer = viewer(from);
+            else peer = viewer(from) ? viewer(from) : presenter;
+            if (!peer || !peer->pc) return;
+
             std::string cand = data["candidate"].toString().toStdString();
             std::string mid = data["sdpMid"].toString().toStdString();
-            m_pc->addRemoteCandidate(rtc::Candidate(cand, mid));
+            peer->pc->addRemoteCandidate(rtc::Candidate(cand, mid));
         }
         });
 }
@@ -214,17 +928,20 @@ void PeerConnectionManager::onConnectServer(const QString& url)
 
 void PeerConnectionManager::onSignalingMessage(const QJsonObject& obj)
 {
+    // 旧接口，只作用于观看连接
+    if (!m_presenter || !m_presenter->pc) return;
+    const std::shared_ptr<rtc::PeerConnection>& pc = m_presenter->pc;
     const QString type = obj.value("type").toString();
 
     if (type == "offer" || type == "answer") {
         std::string sdp = obj.value("sdp").toString().toStdString();
         std::string stype = type.toStdString();
         rtc::Description desc(sdp, stype);
-        m_pc->setRemoteDescription(desc);
+        pc->setRemoteDescription(desc);
 
         // 
-        if (!m_isCaller && type == "offer") {
-            m_pc->setLocalDescription();  // 
+        if (type == "offer") {
+            pc->setLocalDescription();  // 
         } 
     }else if (type == "candidate") {
         std::string candidate = obj.value("candidate").toString().toStdString();
@@ -232,13 +949,16 @@ void PeerConnectionManager::onSignalingMessage(const QJsonObject& obj)
         // int mlineindex = obj.value("mlineindex").toInt();
 
         rtc::Candidate cand(candidate, mid);
-        m_pc->addRemoteCandidate(cand);
+        pc->addRemoteCandidate(cand);
     }
 }
 
 void PeerConnectionManager::onJoined(const QString& peerId)
 {
     m_targetPeerId = peerId;
+    if (!m_peers.contains(peerId)) m_peers.append(peerId);
+    // 共享中有新用户加入：单独建立一条连接，已有观众不受影响
+    if (m_sharing) start(peerId);
 }
 
 
@@ -247,34 +967,303 @@ void PeerConnectionManager::registerClient()
     QJsonObject data;
     sendSignalingMessage("REGISTER_REQUEST", "Server", data);
 }
-void PeerConnectionManager::sendtest(){
-    if (m_videoChannel && m_videoChannel->isOpen()){
+void PeerConnectionManager::requestKeyframe()
+{
+    if (!m_presenter) return;
+    // 轨道模式：通过 RTCP PLI；DataChannel 模式：发送文本请求
+    if (m_presenter->videoTrack && m_presenter->videoTrack->isOpen()) {
+        m_presenter->videoTrack->requestKeyframe();
+    }
+    else if (m_presenter->videoChannel && m_presenter->videoChannel->isOpen()) {
+        m_presenter->videoChannel->send(std::string(KEYFRAME_REQUEST_MESSAGE));
+    }
+}
+
+void PeerConnectionManager::startBandwidthEstimation(const SessionPtr& peer)
+{
+    // 轨道模式没有发送缓冲可看，只有收到 RR 时才知道链路状况，没有 RR 时不上升
+    BandwidthEstimator::Config bweConfig;
+    bweConfig.requireFeedback = peer->transportMode == TransportMode::RtpTrack;
+    peer->bwe.setConfig(bweConfig);
+    peer->bweClock.start();
+    peer->layerSelector.reset();
+    peer->layerSelector.setAvailableBitrate(peer->bwe.targetBitrate(), m_sendClock.elapsed());
+    // 新观众从码流中途加入，先等关键帧；下面的 pump 立即请求
+    peer->sendQueue.requireKeyframe();
+    if (!m_bweTimer->isActive()) m_bweTimer->start();
+    updateTargetBitrate();
+    pumpSendQueue(peer);
+}
+
+void PeerConnectionManager::stopBandwidthEstimation(const SessionPtr& peer)
+{
+    peer->bweClock.invalidate();
+    // 连接断开后排队的帧没有意义，重连后从关键帧开始
+    peer->sendQueue.clear();
+    peer->layerSelector.reset();
+
+    for (const SessionPtr& other : std::as_const(m_viewers)) {
+        if (other->bweClock.isValid()) return;
+    }
+    m_bweTimer->stop();
+}
+
+void PeerConnectionManager::updateBandwidthEstimate()
+{
+    for (const SessionPtr& peer : std::as_const(m_viewers)) {
+        estimateBandwidth(peer);
+    }
+    updateTargetBitrate();
+}
+
+void PeerConnectionManager::estimateBandwidth(const SessionPtr& peer)
+{
+    if (!peer->pc || !peer->bweClock.isValid()) return;
+
+    const int64_t nowMs = peer->bweClock.elapsed();
+    if (peer->transportMode == TransportMode::RtpTrack) {
+        // bytesSent / rtt 只统计 SCTP；RTP 的发送字节由发送链统计，丢包率和 RTT 随 RR 送来
+        // RTP 包直接发出，没有应用层可见的发送缓冲
+        if (peer->feedback) peer->bwe.onBytesSent(peer->feedback->bytesSent(), nowMs);
+    }
+    else {
+        peer->bwe.onBytesSent(peer->pc->bytesSent(), nowMs);
+        if (auto rtt = peer->pc->rtt()) {
+            peer->bwe.onRtt(rtt->count(), nowMs);
+        }
+        if (peer->videoChannel) {
+            peer->bwe.onBufferedAmount(peer->videoChannel->bufferedAmount(), nowMs);
+        }
+    }
+
+    if (peer->bwe.update(nowMs)) {
+        qDebug() << "Viewer" << peer->peerId << "target bitrate" << peer->bwe.targetBitrate()
+            << "send rate" << peer->bwe.sendRate() << "queue delay" << peer->bwe.queueDelayMs() << "ms";
+    }
+    // 每次都更新：升层需要码率持续足够一段时间
+    peer->layerSelector.setAvailableBitrate(peer->bwe.targetBitrate(), m_sendClock.elapsed());
+}
+
+void PeerConnectionManager::updateTargetBitrate()
+{
+    // simulcast 各层的码率固定，选层器按层的配置码率比较带宽估计；改动层码率会让两者不一致
+    if (m_simulcastLayers.size() > 1) return;
+
+    // 单层编码要让最差的观众也跟得上
+    int bitrate = 0;
+    for (const SessionPtr& peer : std::as_const(m_viewers)) {
+        if (!peer->bweClock.isValid()) continue;
+        const int target = peer->bwe.targetBitrate();
+        if (bitrate == 0 || target < bitrate) bitrate = target;
+    }
+    if (bitrate <= 0 || bitrate == m_targetBitrate) return;
+    m_targetBitrate = bitrate;
+    qDebug() << "Encoder target bitrate" << bitrate << "for" << m_viewers.size() << "viewers";
+    emit targetBitrateChanged(bitrate);
+}
+
+void PeerConnectionManager::sendSenderReports()
+{
+    // 轨道模式由发送链上的 MediaClockSrReporter 通过 RTCP 发送
+    if (!m_mediaClock) return;
+
+    const int64_t nowMs = m_sendClock.elapsed();
+    std::string report;
+    for (const SessionPtr& peer : std::as_const(m_viewers)) {
+        if (peer->transportMode != TransportMode::DataChannel) continue;
+        if (!peer->videoChannel || !peer->videoChannel->isOpen()) continue;
+        if (peer->lastSenderReportMs >= 0 && nowMs - peer->lastSenderReportMs < SENDER_REPORT_INTERVAL_MS) continue;
+        peer->lastSenderReportMs = nowMs;
+        if (report.empty()) report = formatSenderReport(currentSenderReport(*m_mediaClock));
+        peer->videoChannel->send(report);
+    }
+}
+
+void PeerConnectionManager::sendtest(const SessionPtr& peer){
+    if (peer->videoChannel && peer->videoChannel->isOpen()){
         qDebug("message send!");
-        m_videoChannel->send("Hello from sender!");
+        peer->videoChannel->send("Hello from sender!");
     }
 }
 
-void PeerConnectionManager::sendEncodedFrame(const QByteArray& data, uint32_t timestamp)
+void PeerConnectionManager::setSendQueueConfig(const FrameSendQueue::Config& config)
 {
-    // 仅通过数据通道发送视频帧
-    if (m_videoChannel && m_videoChannel->isOpen()) {
-        // 转换�? libdatachannel 需要的 std::byte 格式
-        // 注意：DataChannel 默认 MTU 限制（通常 64KB - 头部）�?
-        // 如果你的图片很大（例�? 4K 截图），这里会失败，需要分片�?
-        // 但对�? 1080p 的中等质�? JPEG (通常 < 100KB)，这可能勉强能行，建议分片�?
-        // *简单方�?*：控�? JPEG 质量，确保每帧小�? 64KB�?
+    m_sendQueueConfig = config;
+    for (const SessionPtr& peer : std::as_const(m_viewers)) {
+        peer->sendQueue.setConfig(config);
+        if (peer->videoChannel) {
+            peer->videoChannel->setBufferedAmountLowThreshold(config.lowWatermark);
+        }
+    }
+}
 
-        try {
-            std::vector<std::byte> binData(data.size());
-            std::memcpy(binData.data(), data.constData(), data.size());
+FrameSendQueue::Stats PeerConnectionManager::sendStats() const
+{
+    FrameSendQueue::Stats total;
+    for (const SessionPtr& peer : m_viewers) {
+        const FrameSendQueue::Stats& stats = peer->sendQueue.stats();
+        total.queuedFrames += stats.queuedFrames;
+        total.sentFrames += stats.sentFrames;
+        total.droppedStale += stats.droppedStale;
+        total.droppedDependent += stats.droppedDependent;
+        total.droppedSuperseded += stats.droppedSuperseded;
+        total.keyframeRequests += stats.keyframeRequests;
+        total.pausedCount += stats.pausedCount;
+        total.lastQueueDelayMs = std::max(total.lastQueueDelayMs, stats.lastQueueDelayMs);
+        total.maxQueueDelayMs = std::max(total.maxQueueDelayMs, stats.maxQueueDelayMs);
+        total.totalQueueDelayMs += stats.totalQueueDelayMs;
+    }
+    return total;
+}
+
+void PeerConnectionManager::sendEncodedFrame(EncodedFrame::Ptr frame)
+{
+    if (!frame || frame->size() <= 0) return;
+
+    // 一次编码分发给所有观众：各发送队列持有同一份编码输出的引用，不拷贝
+    const int64_t nowMs = m_sendClock.elapsed();
+    for (const SessionPtr& peer : std::as_const(m_viewers)) {
+        // 视频通道尚未打开，或对端不能解码编码器当前的格式
+        if (!peer->bweClock.isValid() || peer->videoCodec != frame->codec()) continue;
+
+        // simulcast：只转发为该观众选定的那一层，换层时等到目标层的关键帧
+        const bool accepted = peer->layerSelector.accept(frame->meta().layer, frame->isKeyFrame(), nowMs);
+        const int keyframeLayer = peer->layerSelector.takeKeyframeRequest(nowMs);
+        if (keyframeLayer >= 0) {
+            qDebug() << "Viewer" << peer->peerId << "switching to simulcast layer" << keyframeLayer
+                << ", requesting keyframe";
+            emit keyframeRequested(keyframeLayer);
+        }
+        if (!accepted) continue;
+
+        peer->sendQueue.push(frame, nowMs);
+        pumpSendQueue(peer);
+    }
+}
+
+void PeerConnectionManager::sendTileUpdate(TileUpdate::Ptr update)
+{
+    if (!update || update->size() == 0) return;
+
+    // 有观众收不到时整条消息算作没有送达，编码端重新发送其中的块
+    bool delivered = true;
+    std::vector<std::shared_ptr<rtc::DataChannel>> channels;
+    for (const SessionPtr& peer : std::as_const(m_viewers)) {
+        if (!peer->tileChannel) continue;
+        if (peer->tileChannel->isOpen()) channels.push_back(peer->tileChannel);
+        else delivered = false;
+    }
+    if (channels.empty()) {
+        emit tileUpdateSent(update, false);
+        return;
+    }
+
+    // 可靠通道不丢弃也不排队等待：块更新只在画面静止下来后发送一次，作废消息只有几个字节
+    // 只分帧一次，每个分片依次发给所有观众；帧序号对每个通道都是递增的
+    FrameHeader header;
+    header.codec = m_videoCodec;
+    header.frameId = ++m_sendTileId;
+    header.timestamp = update->header().timestamp;
+    m_tileFragmenter.send(update->data(), update->size(), header,
+        [&channels, &delivered](const std::byte* data, size_t size) {
+            for (const std::shared_ptr<rtc::DataChannel>& channel : channels) {
+                try {
+                    channel->send(data, size);
+                }
+                catch (...) {
+                    qDebug() << "Send tile update failed. Channel might be closed.";
+                    delivered = false;
+                }
+            }
+            return true;
+        });
+    emit tileUpdateSent(update, delivered);
+}
+
+size_t PeerConnectionManager::transportBufferedAmount(const PeerSession& peer) const
+{
+    // 轨道的 RTP 包经 SRTP 直接写进 UDP 套接字，Track::bufferedAmount() 始终为 0：
+    // 轨道模式没有可看的发送缓冲，水位与 deadline 不起作用，拥塞只靠带宽估计降码率
+    if (peer.transportMode == TransportMode::RtpTrack) return 0;
+    return peer.videoChannel ? peer.videoChannel->bufferedAmount() : 0;
+}
+
+void PeerConnectionManager::pumpSendQueues()
+{
+    for (const SessionPtr& peer : std::as_const(m_viewers)) {
+        if (peer->bweClock.isValid()) pumpSendQueue(peer);
+    }
+}
+
+void PeerConnectionManager::pumpSendQueue(const SessionPtr& peer)
+{
+    const int64_t nowMs = m_sendClock.elapsed();
+    const bool keyframeNeeded = peer->sendQueue.pump(nowMs,
+        [this, &peer]() { return transportBufferedAmount(*peer); },
+        [this, &peer](const EncodedFrame::Ptr& frame) { sendFrameNow(peer, frame); });
+
+    if (keyframeNeeded) {
+        // 丢帧后参考链断开（或新观众加入），让编码器尽快给出关键帧
+        qDebug() << "Viewer" << peer->peerId << "needs a keyframe, requesting";
+        emit keyframeRequested(peer->layerSelector.keyframeLayer());
+    }
+    if (peer->lastSendStatsLogMs < 0 || nowMs - peer->lastSendStatsLogMs >= SEND_STATS_LOG_INTERVAL_MS) {
+        peer->lastSendStatsLogMs = nowMs;
+        logSendStats(*peer);
+    }
+}
+
+void PeerConnectionManager::logSendStats(const PeerSession& peer)
+{
+    const FrameSendQueue::Stats& stats = peer.sendQueue.stats();
+    if (stats.queuedFrames == 0) return;
 
-            QByteArray byteArray(reinterpret_cast<const char*>(binData.data()), binData.size());
-            // 显示十六进制
-            qDebug() << "original binData :" << byteArray.toHex(' ');
+    qDebug().nospace() << "Send stats [" << peer.peerId << "]: queued=" << stats.queuedFrames
+        << " sent=" << stats.sentFrames
+        << " stale=" << stats.droppedStale
+        << " dependent=" << stats.droppedDependent
+        << " superseded=" << stats.droppedSuperseded
+        << " keyframeRequests=" << stats.keyframeRequests
+        << " paused=" << stats.pausedCount
+        << " | queue delay avg " << stats.averageQueueDelayMs() << "ms max " << stats.maxQueueDelayMs << "ms";
+}
+
+void PeerConnectionManager::sendFrameNow(const SessionPtr& peer, const EncodedFrame::Ptr& frame)
+{
+    if (peer->transportMode == TransportMode::RtpTrack) {
+        if (peer->videoTrack && peer->videoTrack->isOpen()) {
+            // 打包器按 start code 切分 NALU（AV1 按 OBU），超过 MTU 的单元再分片
+            try {
+                peer->videoTrack->sendFrame(reinterpret_cast<const std::byte*>(frame->data()),
+                    static_cast<size_t>(frame->size()), rtc::FrameInfo(frame->timestamp()));
+            }
+            catch (...) {
+                qDebug() << "Send frame failed. Track might be closed.";
+            }
+        }
+        else {
+            qDebug() << "Video track not open. Dropping encoded frame.";
+        }
+        return;
+    }
 
+    // 仅通过数据通道发送视频帧
+    if (peer->videoChannel && peer->videoChannel->isOpen()) {
+        // 加上帧头并按 SCTP 消息长度分片，分片直接从编码器的缓冲区拷进复用的发送缓冲区
+        FrameHeader header;
+        header.codec = frame->codec();
+        header.flags = frame->isKeyFrame() ? FrameHeader::FLAG_KEYFRAME : 0;
+        header.frameId = ++peer->sendFrameId;
+        header.timestamp = frame->timestamp();
 
-            qDebug("video data send!");
-            m_videoChannel->send(binData); // 时间戳没有send出去
+        const std::shared_ptr<rtc::DataChannel>& channel = peer->videoChannel;
+        try {
+            // send() 返回 false 只表示数据进入了发送缓冲，并不是失败
+            peer->fragmenter.send(frame->data(), static_cast<size_t>(frame->size()), header,
+                [&channel](const std::byte* data, size_t size) {
+                    channel->send(data, size);
+                    return true;
+                });
         }
         catch (...) {
             qDebug() << "Send frame failed. Channel might be busy or closed.";
@@ -357,3 +1346,8 @@ QString PeerConnectionManager::target() const
 {
     return m_targetPeerId;
 }
+
+QStringList PeerConnectionManager::peers() const
+{
+    return m_peers;
+}
@@ -1,62 +1,259 @@
 #pragma once
 #include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QList>
+#include <QHash>
+#include <QStringList>
 #include <memory>
 #include <rtc/rtc.hpp>
 
 #include "signaling-server/src/Common.hpp"
+#include "../encoder/EncodedFrame.h"
+#include "../encoder/TileUpdate.h"
+#include "FrameFraming.hpp"
+#include "BandwidthEstimator.hpp"
+#include "FrameSendQueue.hpp"
+#include "ClockSync.hpp"
+#include "RtcpFeedback.hpp"
+#include "SimulcastLayerSelector.hpp"
+#include "../Capture/MediaClock.h"
 
 class WsSignalingClient;
 
+// 信令与 P2P 连接管理
+// 共享屏幕时为每个观众建立一条 PeerConnection（本端发起），编码只做一次，
+// 编码输出按引用计数分发到各观众的发送队列，背压、带宽估计、simulcast 选层和关键帧等待各自独立；
+// 观看时与共享者之间只有一条连接（对端发起）
 class PeerConnectionManager : public QObject {
     Q_OBJECT
 public:
+    // 视频传输方式
+    // RtpTrack：RTP 媒体轨道（H.264 / H.265 / AV1 打包 + NACK 重传 + SR + PLI 关键帧请求）
+    // DataChannel：整帧通过不重传的 DataChannel 发送，保留用于对比
+    enum class TransportMode { RtpTrack, DataChannel };
+
     PeerConnectionManager(QObject* parent = nullptr);
     ~PeerConnectionManager();
 
+    // 发送端媒体时钟（来自 ScreenCaptureService），用于生成 SR；需在 start() 之前设置
+    void setMediaClock(MediaClock::Ptr clock);
+
+    // 仅对主动发起方生效，需在 start() 之前设置；接收方按对端 offer 自动适配
+    void setTransportMode(TransportMode mode);
+    TransportMode transportMode() const;
+
+    // 编码协商：发起方（发送端）按偏好顺序在 offer 中列出能编码的格式，
+    // 接收端只保留能解码的格式，最终使用双方都支持的第一个
+    // 轨道模式通过 SDP 的 rtpmap 协商，DataChannel 模式通过 offer/answer 消息中的 videoCodecs/videoCodec 字段
+    // 所有观众共用一个编码器：第一个观众协商出的格式确定之后，后来的观众只提供这一种格式
+    void setVideoCodecPreferences(const QList<VideoCodec>& codecs);
+    void setDecodableVideoCodecs(const QList<VideoCodec>& codecs);
+    VideoCodec videoCodec() const;   // 发送端（编码器）使用的格式
+
+    // 发送端：编码器的 simulcast 层（来自 ScreenCaptureService），按对端的带宽估计和视口只转发其中一层
+    // 不设置（或只有一层）时转发所有帧
+    void setSimulcastLayers(const QVector<SimulcastLayer>& layers);
+    // 接收端：显示区域大小（物理像素），随 answer 告知发送端；
+    // DataChannel 模式下之后的变化通过文本消息更新，轨道模式只在协商时生效
+    void setViewportSize(int width, int height);
+
     void registerClient();
+    // 向一个观众发起连接（已有连接时直接返回）
     void start(const QString& targetId);
-    void sendEncodedVideoFrame(const QByteArray& encodedData);
+    // 开始共享：向当前所有在线用户发起连接，之后新加入的用户自动连接
+    void startSharing();
+    // 停止共享：关闭所有观众的连接
+    void stopSharing();
+    bool isSharing() const { return m_sharing; }
+    // 关闭与一个观众的连接
+    void closeViewer(const QString& peerId);
+    int viewerCount() const;
     QString id() const;
-    QString target() const;
+    QString target() const;          // 最近加入的用户
+    QStringList peers() const;       // 当前在线的其他用户
 
 signals:
     void signalingConnected();
     void signalingError(const QString& msg);
     void peerJoined(const QString& peerId);
     void peersList(const QJsonArray& list);
+    // 观看端：与共享者之间的视频通道打开 / 断开
     void p2pConnected();     // datachannel has established
     void p2pDisconnected();
-    void encodedFrameReceived(QByteArray data);
+    // 共享端：一个观众的视频通道打开 / 连接断开
+    void viewerConnected(const QString& peerId);
+    void viewerDisconnected(const QString& peerId);
+    // 收到一帧完整的 access unit 及其 90kHz 采集时间戳，在网络线程发射
+    void encodedFrameReceived(QByteArray data, quint32 rtpTimestamp);
+    // 收到发送端的 NTP <-> RTP 对应关系（RTCP SR / DataChannel 上的同等消息），在网络线程发射
+    void senderReportReceived(quint64 ntpTimestamp, quint32 rtpTimestamp);
+    // 收到一条完整的混合编码块更新消息（TileUpdate 格式），在网络线程发射
+    void tileUpdateReceived(QByteArray data);
 
     void connected();
     void disconnected();
     void errorOccurred(const QString& msg);
     void messageReceived(const QString& msg); 
     void dataChannelOpened();
+    void videoTransportOpened();   // 发送端一个观众的视频通道（轨道或 DataChannel）可用
+    // 发送端一个观众的块更新通道可用：新观众的块缓存从空开始，所有观众一起重置（块更新只生成一份）
+    void tileChannelOpened();
+    // 一条块更新的发送结果：所有观众的块通道都已打开且发送成功时 delivered 为 true
+    void tileUpdateSent(TileUpdate::Ptr update, bool delivered);
+    // 对端请求关键帧（PLI/FIR），或发送端需要关键帧（丢帧、切换 simulcast 层、新观众加入）
+    // layer 为需要关键帧的 simulcast 层，-1 表示全部（未启用 simulcast）
+    void keyframeRequested(int layer);
+    // 编码器的目标码率（bps）：所有观众带宽估计的最小值
+    // 启用 simulcast 时不发射：各层保持配置的码率，带宽估计只用于给每个观众选层
+    void targetBitrateChanged(int bitrate);
+    // 发送端编码格式协商完成（第一个观众），在视频通道打开（videoTransportOpened）之前发射
+    void videoCodecNegotiated(VideoCodec codec);
+    // 观看端编码格式协商完成，在视频通道打开（p2pConnected）之前发射
+    void receiveVideoCodecNegotiated(VideoCodec codec);
 
 public:
     void onConnectServer(const QString& url);
     void onSignalingMessage(const QJsonObject& obj);
     void onJoined(const QString& peerId);
-    void sendEncodedFrame(const QByteArray& data, uint32_t timestamp);
+    void sendEncodedFrame(EncodedFrame::Ptr frame);
+    // 混合编码的块更新，经可靠有序的块通道发送（两种传输方式都有），通道未打开时丢弃
+    // 结果通过 tileUpdateSent 通知编码端
+    void sendTileUpdate(TileUpdate::Ptr update);
+    // 接收端请求对端发送关键帧
+    void requestKeyframe();
+    // 发送队列的水位 / deadline 配置，对所有观众生效；只有 DataChannel 模式有发送缓冲，
+    // 轨道模式下队列只负责等待关键帧
+    void setSendQueueConfig(const FrameSendQueue::Config& config);
+    // 所有观众发送队列的统计之和（延迟取最大值）
+    FrameSendQueue::Stats sendStats() const;
 
 private:
+    // 与一个对端之间的连接及其收发状态
+    // 共享时每个观众一个（isCaller），观看时与共享者之间一个
+    // 网络线程的回调持有 weak_ptr，连接关闭后回调不再访问已释放的状态
+    struct PeerSession {
+        PeerSession(const QString& id, bool caller);
+
+        QString peerId;
+        bool isCaller;
+        std::shared_ptr<rtc::PeerConnection> pc;
+        std::shared_ptr<rtc::DataChannel> videoChannel;
+        std::shared_ptr<rtc::DataChannel> tileChannel;
+        std::shared_ptr<rtc::Track> videoTrack;
+        std::shared_ptr<rtc::RtpPacketizationConfig> rtpConfig;
+        rtc::SSRC videoSsrc = 0;
+        TransportMode transportMode = TransportMode::RtpTrack;
+        QList<VideoCodec> offeredCodecs;  // 发起方：offer 中列出的格式
+        VideoCodec videoCodec = VideoCodec::H264;
+        bool codecNegotiated = false;
+        bool answerWithCodec = false; // DataChannel 模式：answer 中带上选定的格式
+
+        // DataChannel 模式的分帧 / 重组
+        FrameFragmenter fragmenter;
+        FrameReassembler reassembler;
+        uint32_t sendFrameId = 0;
+
+        // 接收块更新的重组；发送的分帧所有观众共用一份
+        FrameReassembler tileReassembler;
+
+        // 发送端带宽估计、背压与 simulcast 选层，只在主线程访问
+        BandwidthEstimator bwe;
+        std::shared_ptr<SenderFeedbackMonitor> feedback;  // 轨道模式：送出的 RTP 字节与 RR
+        QElapsedTimer bweClock;       // 视频通道打开后开始计时，无效表示尚未开始发送
+        FrameSendQueue sendQueue;
+        SimulcastLayerSelector layerSelector;
+        int64_t lastSendStatsLogMs = -1;
+        int64_t lastSenderReportMs = -1;
+
+        // 接收端（轨道模式）：按接收速率与丢包率给出 REMB，只在主线程访问
+        RembEstimator remb;
+    };
+    using SessionPtr = std::shared_ptr<PeerSession>;
+    using WeakSession = std::weak_ptr<PeerSession>;
+
     void handleSignalingMessage(const QJsonObject& json);
     void sendSignalingMessage(const QString& type, const QString& to, const QJsonObject& data);
-    void sendtest();
-    void createPeerConnection();
-    void setupDataChannel();
-    void bindDataChannel(std::shared_ptr<rtc::DataChannel> dc);
+    void sendtest(const SessionPtr& peer);
+    SessionPtr createSession(const QString& peerId, bool caller);
+    void createPeerConnection(const SessionPtr& peer);
+    void closeSession(const SessionPtr& peer);
+    void closePresenter();
+    // 已连接的会话：本端共享给 peerId 的观众 / 正在观看的共享者
+    SessionPtr viewer(const QString& peerId) const;
+    // 回调切回主线程后取会话：连接已关闭或被替换时返回空
+    SessionPtr current(const WeakSession& weak) const;
+    // offer 中列出的编码格式：已有观众协商出格式后只提供这一种
+    QList<VideoCodec> offerCodecs() const;
+    // 已经按完整格式列表发出 offer、还没有观众回复 answer：编码格式尚未确定
+    bool codecPending() const;
+    // 格式确定（或等待中的观众离开）后，向推迟的用户发出 offer
+    void startDeferredViewers();
+    void setupDataChannel(const SessionPtr& peer);
+    void bindDataChannel(const SessionPtr& peer, std::shared_ptr<rtc::DataChannel> dc);
+    // 混合编码的块更新通道：可靠有序，块缓存的更新与作废不能丢
+    void setupTileChannel(const SessionPtr& peer);
+    void bindTileChannel(const SessionPtr& peer, std::shared_ptr<rtc::DataChannel> dc);
+    void setupVideoTrack(const SessionPtr& peer);
+    // 收到 answer 后按协商结果建立发送链（打包器 -> SR -> NACK -> PLI/REMB -> RR 与发送字节统计）
+    void bindSendTrack(const SessionPtr& peer, const rtc::Description& answer);
+    void bindReceiveTrack(const SessionPtr& peer, std::shared_ptr<rtc::Track> track);
+    // 观众协商出的格式：第一个观众确定编码器使用的格式，之后的 offer 只提供这一种
+    void setSendCodec(const SessionPtr& peer, VideoCodec codec);
+    void startBandwidthEstimation(const SessionPtr& peer);
+    void stopBandwidthEstimation(const SessionPtr& peer);
+    void updateBandwidthEstimate();
+    void estimateBandwidth(const SessionPtr& peer);
+    // 汇总各观众的带宽估计，变化时通知编码器（仅单层编码）
+    void updateTargetBitrate();
+    void pumpSendQueues();
+    void pumpSendQueue(const SessionPtr& peer);
+    void sendFrameNow(const SessionPtr& peer, const EncodedFrame::Ptr& frame);
+    // DataChannel 的发送缓冲字节数；轨道模式没有发送缓冲，总是 0
+    size_t transportBufferedAmount(const PeerSession& peer) const;
+    void logSendStats(const PeerSession& peer);
+    // DataChannel 模式周期性发送 SR
+    void sendSenderReports();
+    void sendViewport();
 
     
     
 private:
     std::shared_ptr<rtc::WebSocket> m_ws;
-    std::shared_ptr<rtc::PeerConnection> m_pc;
-    std::shared_ptr<rtc::DataChannel> m_videoChannel;
+    TransportMode m_transportMode;
+
+    // 共享：每个观众一条连接；观看：与共享者之间的一条连接
+    QHash<QString, SessionPtr> m_viewers;
+    SessionPtr m_presenter;
+    bool m_sharing = false;
+    // 编码格式确定前加入的用户，等第一个观众的 answer 之后再发 offer（编码器只有一个，
+    // 同时按完整列表发出的 offer 可能各自选中不同的格式）
+    QStringList m_deferredViewers;
+
+    QList<VideoCodec> m_sendCodecs{ VideoCodec::H264 };
+    QList<VideoCodec> m_decodableCodecs{ VideoCodec::H264 };
+    VideoCodec m_videoCodec = VideoCodec::H264;
+
+    // 发送端带宽估计的周期任务，有观众在发送时运行
+    QTimer* m_bweTimer = nullptr;
+    int m_targetBitrate = 0;    // 最近一次通知编码器的目标码率
+
+    // 发送端背压与 simulcast 的配置，新观众按此创建
+    FrameSendQueue::Config m_sendQueueConfig;
+    QVector<SimulcastLayer> m_simulcastLayers;
+    QElapsedTimer m_sendClock;
+
+    // 块更新只分帧一次，分片依次发给所有块通道已打开的观众；帧序号与视频帧分开计数
+    FrameFragmenter m_tileFragmenter;
+    uint32_t m_sendTileId = 0;
+
+    int m_viewportWidth = 0;    // 接收端本地的显示区域
+    int m_viewportHeight = 0;
+
+    MediaClock::Ptr m_mediaClock;
 
     QString m_serverUrl;
     QString m_myId;
     QString m_targetPeerId;
-    bool m_isCaller; 
+    QStringList m_peers;
 };
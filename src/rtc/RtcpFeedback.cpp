@@ -0,0 +1,119 @@
+#include "RtcpFeedback.hpp"
+#include <algorithm>
+
+// RTCP SR / RR 的 payload type
+static const uint8_t RTCP_PT_SR = 200;
+static const uint8_t RTCP_PT_RR = 201;
+
+// 报告块的字段按网络字节序逐字节读取，不依赖各平台的 ntohl
+static uint32_t readBe32(const void* data)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+}
+
+SenderFeedbackMonitor::SenderFeedbackMonitor(rtc::SSRC ssrc, NtpNowFn ntpNow, ReportCallback callback)
+    : m_ssrc(ssrc), m_ntpNow(std::move(ntpNow)), m_callback(std::move(callback))
+{}
+
+void SenderFeedbackMonitor::outgoing(rtc::message_vector& messages, const rtc::message_callback& send)
+{
+    (void)send;
+    uint64_t bytes = 0;
+    for (const auto& message : messages) {
+        if (message && message->type != rtc::Message::Control) bytes += message->size();
+    }
+    m_bytesSent.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void SenderFeedbackMonitor::incoming(rtc::message_vector& messages, const rtc::message_callback& send)
+{
+    (void)send;
+    for (const auto& message : messages) {
+        if (!message || message->type != rtc::Message::Control) continue;
+
+        // 复合 RTCP 包：逐个子包查找 RR（以及对端也发送媒体时 SR 里带的报告块）
+        size_t offset = 0;
+        while (offset + sizeof(rtc::RtcpHeader) <= message->size()) {
+            auto header = reinterpret_cast<const rtc::RtcpHeader*>(message->data() + offset);
+            const size_t length = header->lengthInBytes();
+            if (length < sizeof(rtc::RtcpHeader) || offset + length > message->size()) break;
+
+            const uint8_t count = header->reportCount();
+            if (header->payloadType() == RTCP_PT_RR && length >= rtc::RtcpRr::SizeWithReportBlocks(count)) {
+                auto rr = reinterpret_cast<const rtc::RtcpRr*>(header);
+                for (int i = 0; i < count; ++i) onReportBlock(*rr->getReportBlock(i));
+            }
+            else if (header->payloadType() == RTCP_PT_SR && length >= rtc::RtcpSr::Size(count)) {
+                auto sr = reinterpret_cast<const rtc::RtcpSr*>(header);
+                for (int i = 0; i < count; ++i) onReportBlock(*sr->getReportBlock(i));
+            }
+            offset += length;
+        }
+    }
+}
+
+void SenderFeedbackMonitor::onReportBlock(const rtc::RtcpReportBlock& block)
+{
+    if (readBe32(&block._ssrc) != m_ssrc || !m_callback) return;
+
+    Report report;
+    report.fractionLost = reinterpret_cast<const uint8_t*>(&block._fractionLostAndPacketsLost)[0] / 256.0;
+
+    // LSR / DLSR 与 NTP 时间戳的中间 32 位同单位（1/65536 秒）；LSR 为 0 表示接收端还没收到 SR
+    const uint32_t lastSr = readBe32(&block._lastReport);
+    const uint32_t delaySinceSr = readBe32(&block._delaySinceLastReport);
+    if (lastSr != 0 && m_ntpNow) {
+        const uint32_t now = static_cast<uint32_t>(m_ntpNow() >> 16);
+        const uint32_t rtt = now - lastSr - delaySinceSr;
+        if (rtt < 0x80000000u) {
+            report.rttMs = static_cast<int64_t>((static_cast<uint64_t>(rtt) * 1000) >> 16);
+        }
+    }
+    m_callback(report);
+}
+
+ReceiveStatsMonitor::ReceiveStatsMonitor(StatsCallback callback, std::chrono::milliseconds window)
+    : m_callback(std::move(callback)), m_window(window)
+{}
+
+void ReceiveStatsMonitor::incoming(rtc::message_vector& messages, const rtc::message_callback& send)
+{
+    (void)send;
+    const auto now = std::chrono::steady_clock::now();
+    for (const auto& message : messages) {
+        if (!message || message->type == rtc::Message::Control) continue;
+        if (message->size() < sizeof(rtc::RtpHeader)) continue;
+        auto rtp = reinterpret_cast<const rtc::RtpHeader*>(message->data());
+        const uint16_t seq = rtp->seqNumber();
+
+        if (!m_started) {
+            m_started = true;
+            m_highestSeq = seq;
+            m_windowStart = now;
+            m_expected = 1;
+        }
+        else {
+            // 按有符号差值处理回绕；乱序、重复的包不推进序号
+            const int16_t delta = static_cast<int16_t>(seq - m_highestSeq);
+            if (delta > 0) {
+                m_highestSeq = seq;
+                m_expected += static_cast<uint64_t>(delta);
+            }
+        }
+        ++m_received;
+        m_bytes += message->size();
+    }
+
+    if (!m_started || now - m_windowStart < m_window) return;
+    const auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(now - m_windowStart).count();
+    Stats stats;
+    stats.bitrate = static_cast<int64_t>(m_bytes * 8 * 1000 / std::max<int64_t>(elapsedMs, 1));
+    stats.fractionLost = m_expected > m_received ?
+        static_cast<double>(m_expected - m_received) / m_expected : 0.0;
+    m_windowStart = now;
+    m_expected = 0;
+    m_received = 0;
+    m_bytes = 0;
+    if (m_callback) m_callback(stats);
+}
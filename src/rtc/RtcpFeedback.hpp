@@ -0,0 +1,67 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <rtc/rtc.hpp>
+
+// 轨道模式的拥塞反馈
+// PeerConnection::bytesSent / rtt 只统计 SCTP（DataChannel），RTP 轨道的发送字节、丢包率和 RTT
+// 要在媒体处理链上自己统计：发送端看送出的 RTP 和接收端回的 RR，接收端看收到的 RTP
+
+// 发送链：统计送出的 RTP 字节数，并从接收端的 RR 中取出本端 SSRC 的丢包率与 RTT
+// RR 的回调在网络线程执行；需要链在发送链末尾，incoming 时最先看到 RTCP
+class SenderFeedbackMonitor final : public rtc::MediaHandler
+{
+public:
+    struct Report {
+        double fractionLost = 0.0;   // 上一个 RR 以来的丢包率（0~1）
+        int64_t rttMs = -1;          // RR 没有回显 SR 时为 -1
+    };
+    // 当前时刻的 NTP 时间，须与本端 SR 中的 NTP 时间戳同源
+    using NtpNowFn = std::function<uint64_t()>;
+    using ReportCallback = std::function<void(const Report& report)>;
+
+    SenderFeedbackMonitor(rtc::SSRC ssrc, NtpNowFn ntpNow, ReportCallback callback);
+
+    void incoming(rtc::message_vector& messages, const rtc::message_callback& send) override;
+    void outgoing(rtc::message_vector& messages, const rtc::message_callback& send) override;
+
+    // 累计送出的 RTP 字节数（含包头），可在任意线程读取
+    uint64_t bytesSent() const { return m_bytesSent.load(std::memory_order_relaxed); }
+
+private:
+    void onReportBlock(const rtc::RtcpReportBlock& block);
+
+    rtc::SSRC m_ssrc;
+    NtpNowFn m_ntpNow;
+    ReportCallback m_callback;
+    std::atomic<uint64_t> m_bytesSent{ 0 };
+};
+
+// 接收链：按固定窗口统计收到的 RTP 速率与按序号推算的丢包率，回调在网络线程执行
+// 需要链在接收链末尾（incoming 自链尾向前执行），在解包之前看到 RTP 包
+class ReceiveStatsMonitor final : public rtc::MediaHandler
+{
+public:
+    struct Stats {
+        int64_t bitrate = 0;         // 窗口内的接收速率（bps）
+        double fractionLost = 0.0;   // 窗口内的丢包率（0~1）
+    };
+    using StatsCallback = std::function<void(const Stats& stats)>;
+
+    explicit ReceiveStatsMonitor(StatsCallback callback,
+        std::chrono::milliseconds window = std::chrono::milliseconds(1000));
+
+    void incoming(rtc::message_vector& messages, const rtc::message_callback& send) override;
+
+private:
+    StatsCallback m_callback;
+    std::chrono::milliseconds m_window;
+    std::chrono::steady_clock::time_point m_windowStart;
+    bool m_started = false;
+    uint16_t m_highestSeq = 0;
+    uint64_t m_expected = 0;         // 窗口内序号前进的个数
+    uint64_t m_received = 0;
+    uint64_t m_bytes = 0;
+};
@@ -0,0 +1,134 @@
+#include "SimulcastLayerSelector.hpp"
+
+SimulcastLayerSelector::SimulcastLayerSelector()
+    : SimulcastLayerSelector(Config())
+{}
+
+SimulcastLayerSelector::SimulcastLayerSelector(const Config& config)
+    : m_config(config)
+{}
+
+void SimulcastLayerSelector::setLayers(const QVector<SimulcastLayer>& layers)
+{
+    m_layers = layers;
+    reset();
+}
+
+void SimulcastLayerSelector::reset()
+{
+    m_current = -1;
+    m_target = -1;
+    m_upCandidate = -1;
+    m_upCandidateSinceMs = -1;
+    m_keyframePending = false;
+    m_lastKeyframeRequestMs = -1;
+}
+
+void SimulcastLayerSelector::setViewport(int width, int height, int64_t nowMs)
+{
+    m_viewportWidth = width > 0 ? width : 0;
+    m_viewportHeight = height > 0 ? height : 0;
+    if (m_target >= 0) updateTarget(nowMs);
+}
+
+void SimulcastLayerSelector::setAvailableBitrate(int bitrate, int64_t nowMs)
+{
+    m_bitrate = bitrate;
+    if (m_target >= 0) updateTarget(nowMs);
+}
+
+int SimulcastLayerSelector::desiredLayer() const
+{
+    const int last = m_layers.size() - 1;
+
+    // 带宽：码率放得下的最高一层，都放不下时用最低一层；码率未知时不限制
+    int byBitrate = 0;
+    if (m_bitrate > 0) {
+        byBitrate = last;
+        for (int i = 0; i <= last; ++i) {
+            if (m_layers[i].bitrate <= m_bitrate * m_config.bitrateHeadroom) {
+                byBitrate = i;
+                break;
+            }
+        }
+    }
+
+    // 视口：能完整覆盖视口的最小一层，视口比最高一层还大时用最高一层
+    int byViewport = 0;
+    if (m_viewportWidth > 0 && m_viewportHeight > 0) {
+        for (int i = last; i >= 0; --i) {
+            if (m_layers[i].width >= m_viewportWidth && m_layers[i].height >= m_viewportHeight) {
+                byViewport = i;
+                break;
+            }
+        }
+    }
+
+    // 下标越大层越低
+    return byBitrate > byViewport ? byBitrate : byViewport;
+}
+
+void SimulcastLayerSelector::updateTarget(int64_t nowMs)
+{
+    const int desired = desiredLayer();
+    if (m_target < 0 || desired > m_target) {
+        // 第一次选择或降层：立即切换
+        setTarget(desired);
+        m_upCandidate = -1;
+        return;
+    }
+    if (desired == m_target) {
+        m_upCandidate = -1;
+        return;
+    }
+
+    // 升层：同一个候选持续 upswitchHoldMs 之后才切换
+    if (desired != m_upCandidate) {
+        m_upCandidate = desired;
+        m_upCandidateSinceMs = nowMs;
+        return;
+    }
+    if (nowMs - m_upCandidateSinceMs >= m_config.upswitchHoldMs) {
+        setTarget(desired);
+        m_upCandidate = -1;
+    }
+}
+
+void SimulcastLayerSelector::setTarget(int layer)
+{
+    if (layer == m_target) return;
+    m_target = layer;
+    // 已经在转发目标层（例如降层后又很快回到原来的层）时不需要关键帧
+    m_keyframePending = (m_target != m_current);
+    m_lastKeyframeRequestMs = -1;
+}
+
+bool SimulcastLayerSelector::accept(int layer, bool keyFrame, int64_t nowMs)
+{
+    if (!isActive()) return true;
+    if (layer < 0 || layer >= m_layers.size()) return false;
+    if (m_target < 0) updateTarget(nowMs);
+
+    if (layer == m_target && m_current != m_target) {
+        // 只能从关键帧开始转发新的一层，之前继续转发当前层
+        if (!keyFrame) return false;
+        m_current = m_target;
+        m_keyframePending = false;
+        return true;
+    }
+    return layer == m_current;
+}
+
+int SimulcastLayerSelector::takeKeyframeRequest(int64_t nowMs)
+{
+    if (!isActive() || !m_keyframePending || m_current == m_target) return -1;
+    if (m_lastKeyframeRequestMs >= 0 && nowMs - m_lastKeyframeRequestMs < m_config.keyframeRetryMs) return -1;
+    m_lastKeyframeRequestMs = nowMs;
+    return m_target;
+}
+
+int SimulcastLayerSelector::keyframeLayer() const
+{
+    if (!isActive()) return -1;
+    return m_current >= 0 ? m_current : m_target;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <QVector>
+#include "../encoder/SimulcastLayer.h"
+
+// 为一个观众选择 simulcast 层
+// - 带宽：该观众的目标码率（BandwidthEstimator）留出余量后能容纳的最高一层
+// - 视口：接收端显示区域（物理像素）能完整容纳的最小一层，更高的层只是浪费带宽和解码
+// 两者取较低的一层。降层立即进行；升层要求条件持续一段时间，避免在两层之间来回切换
+// 切换只在目标层的关键帧处完成：之前继续转发当前层，同时向编码器请求目标层的关键帧
+// 只在一个线程内使用（PeerConnectionManager 的主线程）
+class SimulcastLayerSelector
+{
+public:
+    struct Config {
+        double bitrateHeadroom = 0.9;   // 层码率不超过目标码率的该比例
+        int64_t upswitchHoldMs = 3000;  // 升层条件需持续的时间
+        int64_t keyframeRetryMs = 500;  // 等待目标层关键帧期间重复请求的间隔
+    };
+
+    SimulcastLayerSelector();
+    explicit SimulcastLayerSelector(const Config& config);
+
+    // 下标 0 为最高一层；少于两层时不做选择，所有帧都转发
+    void setLayers(const QVector<SimulcastLayer>& layers);
+    bool isActive() const { return m_layers.size() > 1; }
+
+    // nowMs 为单调时钟毫秒数
+    // 接收端显示区域（物理像素），<= 0 表示未知，不按视口限制
+    void setViewport(int width, int height, int64_t nowMs);
+    void setAvailableBitrate(int bitrate, int64_t nowMs);
+
+    // 这一帧是否转发给该观众；目标层的关键帧到达时完成切换
+    bool accept(int layer, bool keyFrame, int64_t nowMs);
+    // 正在等待切换且距上次请求已超过 keyframeRetryMs 时返回目标层，调用方向编码器请求关键帧；否则返回 -1
+    int takeKeyframeRequest(int64_t nowMs);
+    // 接收端 / 发送队列请求关键帧时应该请求的层；未启用时为 -1（全部层）
+    int keyframeLayer() const;
+
+    int currentLayer() const { return m_current; }  // -1 表示还没有开始转发
+    int targetLayer() const { return m_target; }
+    // 重新连接后从头选择，等待目标层的关键帧
+    void reset();
+
+private:
+    int desiredLayer() const;
+    void updateTarget(int64_t nowMs);
+    void setTarget(int layer);
+
+    Config m_config;
+    QVector<SimulcastLayer> m_layers;
+    int m_viewportWidth = 0;
+    int m_viewportHeight = 0;
+    int m_bitrate = 0;
+
+    int m_current = -1;
+    int m_target = -1;
+    int m_upCandidate = -1;             // 等待确认的升层目标
+    int64_t m_upCandidateSinceMs = -1;
+    bool m_keyframePending = false;
+    int64_t m_lastKeyframeRequestMs = -1;
+};
@@ -0,0 +1,49 @@
+#include "VideoCodec.hpp"
+#include <algorithm>
+#include <cctype>
+
+static const VideoCodec ALL_CODECS[] = { VideoCodec::H264, VideoCodec::H265, VideoCodec::AV1 };
+
+const char* videoCodecName(VideoCodec codec)
+{
+    switch (codec) {
+    case VideoCodec::H264: return "H264";
+    case VideoCodec::H265: return "H265";
+    case VideoCodec::AV1: return "AV1";
+    }
+    return "unknown";
+}
+
+bool videoCodecFromName(const std::string& name, VideoCodec& codec)
+{
+    std::string upper(name);
+    std::transform(upper.begin(), upper.end(), upper.begin(),
+        [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    for (VideoCodec candidate : ALL_CODECS) {
+        if (upper == videoCodecName(candidate)) {
+            codec = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool isKnownVideoCodec(uint8_t value)
+{
+    for (VideoCodec candidate : ALL_CODECS) {
+        if (static_cast<uint8_t>(candidate) == value) return true;
+    }
+    return false;
+}
+
+bool negotiateVideoCodec(const std::vector<VideoCodec>& offered,
+    const std::vector<VideoCodec>& supported, VideoCodec& chosen)
+{
+    for (VideoCodec codec : offered) {
+        if (std::find(supported.begin(), supported.end(), codec) != supported.end()) {
+            chosen = codec;
+            return true;
+        }
+    }
+    return false;
+}
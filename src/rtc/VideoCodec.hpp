@@ -0,0 +1,21 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 视频编码格式，数值即 DataChannel 帧头中的 codec 字段（见 FrameFraming.hpp），不能改动
+enum class VideoCodec : uint8_t {
+    H264 = 1,
+    H265 = 2,
+    AV1 = 3,
+};
+
+// SDP rtpmap 中的编码名（"H264" / "H265" / "AV1"），信令里的编码协商也使用这个名字
+const char* videoCodecName(VideoCodec codec);
+// 不区分大小写；未知名字返回 false
+bool videoCodecFromName(const std::string& name, VideoCodec& codec);
+bool isKnownVideoCodec(uint8_t value);
+
+// 编码协商：按发送端的偏好顺序，选第一个接收端也支持的格式；没有交集时返回 false
+bool negotiateVideoCodec(const std::vector<VideoCodec>& offered,
+    const std::vector<VideoCodec>& supported, VideoCodec& chosen);
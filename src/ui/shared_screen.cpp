@@ -1,6 +1,14 @@
 #include "shared_screen.h"
 #include <ui_shared_screen.h>
 
+// 远程屏幕窗口的初始大小
+static const QSize REMOTE_SCREEN_SIZE(960, 540);
+// 共享屏幕时是否同时编码多个分辨率（1080p/720p/360p），供多个观众按各自的带宽和窗口选择；
+// 只有一个观众时多余的层只是浪费 CPU
+static const bool ENABLE_SIMULCAST = false;
+// 混合编码：静止下来的文字/界面块另外无损发送，接收端覆盖在视频上；运动区域仍走视频编码器
+static const bool ENABLE_HYBRID_TILES = true;
+
 // 添加诊断函数
 void shared_screen::log(const QString& msg) {
     // 如果当前不在主线程，转发给主线程
@@ -297,11 +305,68 @@ shared_screen::shared_screen(QWidget *parent)
     connect(btnRecord, &QPushButton::clicked, this, &shared_screen::on_btnRecordClicked);
     connect(btnRaiseHand, &QPushButton::clicked, this, &shared_screen::on_btnRaiseHandClicked);
     connect(btnLeave, &QPushButton::clicked, this, &shared_screen::on_btnLeaveClicked);
-    connect(pcMgr, &PeerConnectionManager::dataChannelOpened,
+    connect(pcMgr, &PeerConnectionManager::videoTransportOpened,
             // 绑定到 ScreenCaptureService 的 startCapture 槽函数
             CaptureService, &ScreenCaptureService::startCapture);
     connect(CaptureService, &ScreenCaptureService::encodedFrameReady,
             pcMgr, &PeerConnectionManager::sendEncodedFrame);
+    connect(pcMgr, &PeerConnectionManager::keyframeRequested,
+            CaptureService, &ScreenCaptureService::requestKeyframe);
+    connect(pcMgr, &PeerConnectionManager::targetBitrateChanged,
+            CaptureService, &ScreenCaptureService::setTargetBitrate);
+    // SR 中的 NTP <-> RTP 对应关系与帧时间戳都来自采集端的媒体时钟
+    pcMgr->setMediaClock(CaptureService->mediaClock());
+    // 编码协商：优先使用同等画质下码率更低的格式（AV1 > H.265 > H.264），以本机 FFmpeg 实际可用的为准
+    pcMgr->setVideoCodecPreferences(VideoEncoder::availableCodecs());
+    pcMgr->setDecodableVideoCodecs(VideoDecoder::availableCodecs());
+    connect(pcMgr, &PeerConnectionManager::videoCodecNegotiated,
+            CaptureService, &ScreenCaptureService::setVideoCodec);
+    // simulcast：一次采集按多个分辨率编码，传输端按对端的带宽和视口只转发其中一层
+    if (ENABLE_SIMULCAST)
+        CaptureService->setSimulcastLayers(defaultSimulcastLayers());
+    pcMgr->setSimulcastLayers(CaptureService->simulcastLayers());
+    // 混合编码：块更新经可靠的块通道发送；通道重新打开时对端的缓存为空，全部重新发送
+    CaptureService->setHybridTilesEnabled(ENABLE_HYBRID_TILES);
+    connect(CaptureService, &ScreenCaptureService::tileUpdateReady,
+            pcMgr, &PeerConnectionManager::sendTileUpdate);
+    connect(pcMgr, &PeerConnectionManager::tileChannelOpened,
+            CaptureService, &ScreenCaptureService::resetTileCache);
+    connect(pcMgr, &PeerConnectionManager::tileUpdateSent,
+            CaptureService, &ScreenCaptureService::confirmTileUpdate);
+    // 多个观众共用一次编码，每个观众一条连接
+    auto showViewerCount = [this]() {
+        if (isScreenSharing)
+            ui->statusLabel->setText(QString(u8"正在共享屏幕（%1 位观众）").arg(pcMgr->viewerCount()));
+    };
+    connect(pcMgr, &PeerConnectionManager::viewerConnected, this, showViewerCount);
+    connect(pcMgr, &PeerConnectionManager::viewerDisconnected, this, showViewerCount);
+    // 作为观众时告诉发送端自己的显示区域，随 answer 发送
+    reportRemoteViewport(REMOTE_SCREEN_SIZE);
+
+    // ===== 接收端：解码并显示对端的屏幕 =====
+    remoteVideo = new VideoReceiver(this);
+    // 网络线程直接入队解码，省掉一次到主线程的中转
+    connect(pcMgr, &PeerConnectionManager::encodedFrameReceived,
+            remoteVideo, &VideoReceiver::pushEncodedFrame, Qt::DirectConnection);
+    // SR 在网络线程到达，排队到 GUI 线程更新时钟映射
+    connect(pcMgr, &PeerConnectionManager::senderReportReceived,
+            remoteVideo, &VideoReceiver::onSenderReport);
+    connect(pcMgr, &PeerConnectionManager::receiveVideoCodecNegotiated,
+            remoteVideo, &VideoReceiver::setVideoCodec);
+    // 块更新在网络线程到达，排队到 GUI 线程与视频帧一起合成
+    connect(pcMgr, &PeerConnectionManager::tileUpdateReceived,
+            remoteVideo, &VideoReceiver::pushTileUpdate);
+    connect(pcMgr, &PeerConnectionManager::p2pConnected, this, [this]() {
+        ensureRemoteScreenWidget();
+        remoteVideo->setVideoSink(remoteScreenWidget->videoSink());
+        remoteVideo->start();
+    });
+    connect(pcMgr, &PeerConnectionManager::p2pDisconnected, remoteVideo, &VideoReceiver::stop);
+    connect(remoteVideo, &VideoReceiver::keyframeRequested,
+            pcMgr, &PeerConnectionManager::requestKeyframe);
+    connect(remoteVideo, &VideoReceiver::videoStarted, this, [this]() {
+        if (remoteScreenWidget) remoteScreenWidget->show();
+    });
             
     if (ui->btnSend)
         connect(ui->btnSend, &QPushButton::clicked, this, &shared_screen::on_btnSendClicked);
@@ -470,14 +535,15 @@ void shared_screen::on_btnShareScreenClicked()
 
     if(!isScreenSharing){
         // startP2P();
-        QString targetId = pcMgr->target();
-        if (targetId.isEmpty()) {
+        if (pcMgr->peers().isEmpty()) {
             QMessageBox::warning(this, "提示", "无其他在线用户");
             return;
         }
-        pcMgr->start(targetId);
+        // 向所有在线用户发起连接，之后加入的用户自动连接
+        pcMgr->startSharing();
     }
     else{
+        pcMgr->stopSharing();
         CaptureService->stopCapture();
     }
     // CaptureService->startCapture();
@@ -1260,6 +1326,35 @@ void shared_screen::ensureParticipantsDock()
     layout->addWidget(participantsList);
 }
 
+// 显示对端共享屏幕的独立窗口，收到第一帧后才显示
+void shared_screen::ensureRemoteScreenWidget()
+{
+    if (remoteScreenWidget)
+        return;
+
+    remoteScreenWidget = new QVideoWidget(this);
+    remoteScreenWidget->setWindowFlags(Qt::Window);
+    remoteScreenWidget->setWindowTitle(u8"远程屏幕");
+    remoteScreenWidget->resize(REMOTE_SCREEN_SIZE);
+    remoteScreenWidget->setStyleSheet("background:black;");
+    remoteScreenWidget->installEventFilter(this);
+    remoteScreenWidget->hide();
+}
+
+// 视口按物理像素计算，高分屏上同样大小的窗口需要更高的一层
+void shared_screen::reportRemoteViewport(const QSize &size)
+{
+    const qreal ratio = devicePixelRatioF();
+    pcMgr->setViewportSize(qRound(size.width() * ratio), qRound(size.height() * ratio));
+}
+
+bool shared_screen::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == remoteScreenWidget && event->type() == QEvent::Resize)
+        reportRemoteViewport(static_cast<QResizeEvent *>(event)->size());
+    return QMainWindow::eventFilter(watched, event);
+}
+
 // 聊天框中的系统消息
 void shared_screen::appendSystemMessage(const QString &text)
 {
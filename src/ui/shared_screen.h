@@ -55,6 +55,8 @@
 #include "src/rtc/PeerConnectionManager.hpp"
 #include "signaling-server/src/Common.hpp"
 #include "src/Capture/ScreenCaptureService.h"
+#include "src/decoder/VideoReceiver.h"
+#include "src/decoder/VideoDecoder.h"
 #include "src/encoder/VideoEncoder.h"
 
 using namespace std;
@@ -95,6 +97,8 @@ protected:
     // 空格"按住说话"演示（按下临时开麦，松开恢复）
     void keyPressEvent(QKeyEvent *event) override;
     void keyReleaseEvent(QKeyEvent *event) override;
+    // 远程屏幕窗口大小变化时通知发送端（simulcast 按视口选层）
+    bool eventFilter(QObject *watched, QEvent *event) override;
 
 private slots:
     // 已有按钮
@@ -129,6 +133,8 @@ private:
     // ===== 帮助函数 =====
     void toggleChatPanel();
     void ensureParticipantsDock();
+    void ensureRemoteScreenWidget();
+    void reportRemoteViewport(const QSize &size);
     void appendSystemMessage(const QString &text);
     void appendRemoteMessage(const QString &sender, const QString &text);
     void updateChatBadge();
@@ -151,6 +157,8 @@ private:
     // ===== 新增：P2P 相关 =====
     PeerConnectionManager* pcMgr;
     ScreenCaptureService* CaptureService;
+    VideoReceiver* remoteVideo = nullptr;
+    QPointer<QVideoWidget> remoteScreenWidget; // 对端共享的屏幕
     bool isConnected;
     
     // 状态管理